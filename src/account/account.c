@@ -227,6 +227,8 @@ void secFreeAccountContent(struct oidc_account* p) {
   account_setPassword(p, NULL);
   account_setRefreshToken(p, NULL);
   account_setAccessToken(p, NULL);
+  account_setUserinfo(p, NULL, 0);
+  account_setExchangedTokens(p, NULL);
   account_setCertPath(p, NULL);
   account_setRedirectUris(p, NULL);
   account_setUsedState(p, NULL);
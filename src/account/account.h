@@ -3,6 +3,7 @@
 
 #include "issuer.h"
 #include "utils/file_io/promptCryptFileUtils.h"
+#include "utils/vector.h"
 #include "wrapper/cjson.h"
 #include "wrapper/list.h"
 
@@ -14,25 +15,58 @@ struct token {
   unsigned long token_expires_at;
 };
 
+/**
+ * userinfo response cached for the account until @c expires_at
+ */
+struct userinfo {
+  char*         json;
+  unsigned long expires_at;
+};
+
+/**
+ * access token obtained through a token exchange; cached for the account per
+ * audience, resource and scope until @c expires_at
+ */
+struct exchanged_token {
+  char*         audience;
+  char*         resource;
+  char*         scope;
+  char*         access_token;
+  unsigned long expires_at;
+};
+
+/**
+ * usage of a loaded account; used to unload idle accounts when the agent keeps
+ * more accounts loaded than allowed
+ */
+struct account_usage {
+  time_t        loaded_at;
+  time_t        last_used;
+  unsigned long requests;
+};
+
 struct oidc_account {
-  struct oidc_issuer* issuer;
-  char*               shortname;
-  char*               clientname;
-  char*               client_id;
-  char*               client_secret;
-  char*               scope;
-  char*               audience;
-  char*               username;
-  char*               password;
-  char*               refresh_token;
-  struct token        token;
-  char*               cert_path;
-  list_t*             redirect_uris;
-  char*               usedState;
-  unsigned char       usedStateChecked;
-  time_t              death;
-  char*               code_challenge_method;
-  unsigned char       mode;
+  struct oidc_issuer*  issuer;
+  char*                shortname;
+  char*                clientname;
+  char*                client_id;
+  char*                client_secret;
+  char*                scope;
+  char*                audience;
+  char*                username;
+  char*                password;
+  char*                refresh_token;
+  struct token         token;
+  struct userinfo      userinfo;
+  vector_t*            exchanged_tokens;
+  char*                cert_path;
+  list_t*              redirect_uris;
+  char*                usedState;
+  unsigned char        usedStateChecked;
+  time_t               death;
+  char*                code_challenge_method;
+  unsigned char        mode;
+  struct account_usage usage;
 };
 
 #define ACCOUNT_MODE_CONFIRM 0x01
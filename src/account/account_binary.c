@@ -0,0 +1,318 @@
+#include "account_binary.h"
+
+#include "account/setandget.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * The record is written in two passes with the same code: the first pass only
+ * counts the bytes (@c buf is @c NULL), the second one fills the buffer.
+ */
+struct binary_writer {
+  unsigned char* buf;
+  size_t         len;
+};
+
+static void _writeLE(unsigned char* out, uint64_t v, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = (v >> (8 * i)) & 0xFF;
+  }
+}
+
+static uint64_t _readLE(const unsigned char* in, size_t n) {
+  uint64_t v = 0;
+  for (size_t i = 0; i < n; i++) {
+    v |= (uint64_t)in[i] << (8 * i);
+  }
+  return v;
+}
+
+static void _writeField(struct binary_writer* w, enum account_binary_tag tag,
+                        const void* data, size_t len) {
+  if (w->buf) {
+    w->buf[w->len] = tag;
+    _writeLE(w->buf + w->len + 1, len, 4);
+    memcpy(w->buf + w->len + ACCOUNT_BINARY_FIELD_HEADER_LEN, data, len);
+  }
+  w->len += ACCOUNT_BINARY_FIELD_HEADER_LEN + len;
+}
+
+static void _writeString(struct binary_writer* w, enum account_binary_tag tag,
+                         const char* str) {
+  if (str != NULL) {
+    _writeField(w, tag, str, strlen(str));
+  }
+}
+
+static void _writeNumber(struct binary_writer* w, enum account_binary_tag tag,
+                         uint64_t v) {
+  if (v == 0) {
+    return;
+  }
+  unsigned char le[8];
+  _writeLE(le, v, sizeof(le));
+  _writeField(w, tag, le, sizeof(le));
+}
+
+static void _writeHeader(struct binary_writer* w) {
+  if (w->buf) {
+    memcpy(w->buf, ACCOUNT_BINARY_MAGIC, 3);
+    w->buf[3] = ACCOUNT_BINARY_VERSION;
+  }
+  w->len = ACCOUNT_BINARY_HEADER_LEN;
+}
+
+static void _finishRecord(struct binary_writer* w) {
+  _writeLE(w->buf + 4, w->len, 4);
+}
+
+static void _writeIssuer(struct binary_writer* w, const struct oidc_issuer* i) {
+  if (i == NULL) {
+    return;
+  }
+  _writeString(w, ACCOUNT_BINARY_ISSUER_URL, i->issuer_url);
+  _writeString(w, ACCOUNT_BINARY_CONFIGURATION_ENDPOINT,
+               i->configuration_endpoint);
+  _writeString(w, ACCOUNT_BINARY_TOKEN_ENDPOINT, i->token_endpoint);
+  _writeString(w, ACCOUNT_BINARY_AUTHORIZATION_ENDPOINT,
+               i->authorization_endpoint);
+  _writeString(w, ACCOUNT_BINARY_REVOCATION_ENDPOINT, i->revocation_endpoint);
+  _writeString(w, ACCOUNT_BINARY_REGISTRATION_ENDPOINT,
+               i->registration_endpoint);
+  _writeString(w, ACCOUNT_BINARY_USERINFO_ENDPOINT, i->userinfo_endpoint);
+  _writeString(w, ACCOUNT_BINARY_DEVICE_AUTHORIZATION_ENDPOINT,
+               i->device_authorization_endpoint.url);
+  _writeNumber(w, ACCOUNT_BINARY_DAE_SET_BY_USER,
+               i->device_authorization_endpoint.setByUser);
+  _writeString(w, ACCOUNT_BINARY_SCOPES_SUPPORTED, i->scopes_supported);
+  _writeString(w, ACCOUNT_BINARY_GRANT_TYPES_SUPPORTED,
+               i->grant_types_supported);
+  _writeString(w, ACCOUNT_BINARY_RESPONSE_TYPES_SUPPORTED,
+               i->response_types_supported);
+}
+
+static void _writeAccount(struct binary_writer*      w,
+                          const struct oidc_account* p,
+                          const char*                redirect_uris) {
+  _writeHeader(w);
+  _writeString(w, ACCOUNT_BINARY_SHORTNAME, p->shortname);
+  _writeString(w, ACCOUNT_BINARY_CLIENTNAME, p->clientname);
+  _writeString(w, ACCOUNT_BINARY_CLIENT_ID, p->client_id);
+  _writeString(w, ACCOUNT_BINARY_CLIENT_SECRET, p->client_secret);
+  _writeString(w, ACCOUNT_BINARY_SCOPE, p->scope);
+  _writeString(w, ACCOUNT_BINARY_AUDIENCE, p->audience);
+  _writeString(w, ACCOUNT_BINARY_USERNAME, p->username);
+  _writeString(w, ACCOUNT_BINARY_PASSWORD, p->password);
+  _writeString(w, ACCOUNT_BINARY_REFRESH_TOKEN, p->refresh_token);
+  _writeString(w, ACCOUNT_BINARY_ACCESS_TOKEN, p->token.access_token);
+  _writeNumber(w, ACCOUNT_BINARY_TOKEN_EXPIRES_AT, p->token.token_expires_at);
+  _writeString(w, ACCOUNT_BINARY_CERT_PATH, p->cert_path);
+  _writeString(w, ACCOUNT_BINARY_REDIRECT_URIS, redirect_uris);
+  _writeString(w, ACCOUNT_BINARY_CODE_CHALLENGE_METHOD,
+               p->code_challenge_method);
+  _writeNumber(w, ACCOUNT_BINARY_DEATH, p->death);
+  _writeNumber(w, ACCOUNT_BINARY_MODE, p->mode);
+  _writeNumber(w, ACCOUNT_BINARY_LOADED_AT, p->usage.loaded_at);
+  _writeNumber(w, ACCOUNT_BINARY_LAST_USED, p->usage.last_used);
+  _writeNumber(w, ACCOUNT_BINARY_REQUESTS, p->usage.requests);
+  _writeIssuer(w, p->issuer);
+}
+
+/**
+ * @brief encodes an account including its issuer into the binary format
+ * @param len is set to the length of the returned buffer
+ * @return the binary record or @c NULL on failure. Has to be freed after
+ * usage.
+ */
+unsigned char* accountToBinary(const struct oidc_account* p, size_t* len) {
+  if (p == NULL || len == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  char* redirect_uris = NULL;
+  if (p->redirect_uris && p->redirect_uris->len > 0) {
+    redirect_uris = listToDelimitedString(p->redirect_uris, " ");
+  }
+  struct binary_writer w = {};
+  _writeAccount(&w, p, redirect_uris);
+  w.buf = secAlloc(w.len);
+  if (w.buf == NULL) {
+    secFree(redirect_uris);
+    oidc_errno = OIDC_EALLOC;
+    return NULL;
+  }
+  _writeAccount(&w, p, redirect_uris);
+  _finishRecord(&w);
+  secFree(redirect_uris);
+  *len = w.len;
+  return w.buf;
+}
+
+/**
+ * A field of a binary record. @c data points into the record and is not
+ * nullterminated; it is @c NULL if the field is not present.
+ */
+struct account_binary_field {
+  const char* data;
+  size_t      len;
+};
+
+/**
+ * the fields of a binary record; only valid as long as the record is
+ */
+struct account_binary_view {
+  unsigned char               version;
+  struct account_binary_field fields[ACCOUNT_BINARY_MAX_TAG + 1];
+};
+
+/**
+ * @brief parses a binary record into a view without copying any values
+ * @param view is filled with pointers into @p buf
+ * @return an oidc_error code; @c OIDC_EBINVER if the record was written by a
+ * newer version, @c OIDC_EBINFMT if it is malformed
+ */
+static oidc_error_t _view(const unsigned char* buf, size_t len,
+                          struct account_binary_view* view) {
+  if (buf == NULL || view == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+  memset(view, 0, sizeof(*view));
+  if (len < ACCOUNT_BINARY_HEADER_LEN ||
+      memcmp(buf, ACCOUNT_BINARY_MAGIC, 3) != 0) {
+    oidc_errno = OIDC_EBINFMT;
+    return oidc_errno;
+  }
+  view->version = buf[3];
+  if (view->version == 0 || view->version > ACCOUNT_BINARY_VERSION) {
+    oidc_errno = OIDC_EBINVER;
+    return oidc_errno;
+  }
+  if (_readLE(buf + 4, 4) != len) {  // truncated or trailing data
+    oidc_errno = OIDC_EBINFMT;
+    return oidc_errno;
+  }
+  size_t pos = ACCOUNT_BINARY_HEADER_LEN;
+  while (pos < len) {
+    if (len - pos < ACCOUNT_BINARY_FIELD_HEADER_LEN) {
+      oidc_errno = OIDC_EBINFMT;
+      return oidc_errno;
+    }
+    const unsigned char tag       = buf[pos];
+    const size_t        field_len = _readLE(buf + pos + 1, 4);
+    pos += ACCOUNT_BINARY_FIELD_HEADER_LEN;
+    if (field_len > len - pos) {
+      oidc_errno = OIDC_EBINFMT;
+      return oidc_errno;
+    }
+    if (tag <= ACCOUNT_BINARY_MAX_TAG) {
+      view->fields[tag].data = (const char*)buf + pos;
+      view->fields[tag].len  = field_len;
+    }
+    pos += field_len;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @return a nullterminated copy of the field or @c NULL if it is not present.
+ * Has to be freed after usage.
+ */
+static char* _viewString(const struct account_binary_view* view,
+                         enum account_binary_tag           tag) {
+  const struct account_binary_field* f = &view->fields[tag];
+  if (f->data == NULL) {
+    return NULL;
+  }
+  char* str = secAlloc(f->len + 1);
+  if (str == NULL) {
+    oidc_errno = OIDC_EALLOC;
+    return NULL;
+  }
+  memcpy(str, f->data, f->len);
+  return str;
+}
+
+/**
+ * @return the numeric value of the field or @c 0 if it is not present
+ */
+static unsigned long _viewNumber(const struct account_binary_view* view,
+                                 enum account_binary_tag           tag) {
+  const struct account_binary_field* f = &view->fields[tag];
+  if (f->data == NULL || f->len > 8) {
+    return 0;
+  }
+  return _readLE((const unsigned char*)f->data, f->len);
+}
+
+static struct oidc_issuer* _issuerFromView(
+    const struct account_binary_view* v) {
+  struct oidc_issuer* iss = secAlloc(sizeof(struct oidc_issuer));
+  issuer_setIssuerUrl(iss, _viewString(v, ACCOUNT_BINARY_ISSUER_URL));
+  issuer_setConfigurationEndpoint(
+      iss, _viewString(v, ACCOUNT_BINARY_CONFIGURATION_ENDPOINT));
+  issuer_setTokenEndpoint(iss, _viewString(v, ACCOUNT_BINARY_TOKEN_ENDPOINT));
+  issuer_setAuthorizationEndpoint(
+      iss, _viewString(v, ACCOUNT_BINARY_AUTHORIZATION_ENDPOINT));
+  issuer_setRevocationEndpoint(
+      iss, _viewString(v, ACCOUNT_BINARY_REVOCATION_ENDPOINT));
+  issuer_setRegistrationEndpoint(
+      iss, _viewString(v, ACCOUNT_BINARY_REGISTRATION_ENDPOINT));
+  issuer_setUserinfoEndpoint(
+      iss, _viewString(v, ACCOUNT_BINARY_USERINFO_ENDPOINT));
+  issuer_setDeviceAuthorizationEndpoint(
+      iss, _viewString(v, ACCOUNT_BINARY_DEVICE_AUTHORIZATION_ENDPOINT),
+      _viewNumber(v, ACCOUNT_BINARY_DAE_SET_BY_USER));
+  issuer_setScopesSupported(
+      iss, _viewString(v, ACCOUNT_BINARY_SCOPES_SUPPORTED));
+  issuer_setGrantTypesSupported(
+      iss, _viewString(v, ACCOUNT_BINARY_GRANT_TYPES_SUPPORTED));
+  issuer_setResponseTypesSupported(
+      iss, _viewString(v, ACCOUNT_BINARY_RESPONSE_TYPES_SUPPORTED));
+  return iss;
+}
+
+/**
+ * @brief decodes a binary record created with @c accountToBinary
+ * @return a pointer to the oidc_account. Has to be freed after usage. On
+ * failure NULL is returned.
+ */
+struct oidc_account* getAccountFromBinary(const unsigned char* buf,
+                                          size_t               len) {
+  struct account_binary_view v;
+  if (_view(buf, len, &v) != OIDC_SUCCESS) {
+    return NULL;
+  }
+  struct oidc_account* p = secAlloc(sizeof(struct oidc_account));
+  account_setIssuer(p, _issuerFromView(&v));
+  account_setName(p, _viewString(&v, ACCOUNT_BINARY_SHORTNAME), NULL);
+  account_setClientName(p, _viewString(&v, ACCOUNT_BINARY_CLIENTNAME));
+  account_setClientId(p, _viewString(&v, ACCOUNT_BINARY_CLIENT_ID));
+  account_setClientSecret(p, _viewString(&v, ACCOUNT_BINARY_CLIENT_SECRET));
+  account_setScopeExact(p, _viewString(&v, ACCOUNT_BINARY_SCOPE));
+  account_setAudience(p, _viewString(&v, ACCOUNT_BINARY_AUDIENCE));
+  account_setUsername(p, _viewString(&v, ACCOUNT_BINARY_USERNAME));
+  account_setPassword(p, _viewString(&v, ACCOUNT_BINARY_PASSWORD));
+  account_setRefreshToken(p, _viewString(&v, ACCOUNT_BINARY_REFRESH_TOKEN));
+  account_setAccessToken(p, _viewString(&v, ACCOUNT_BINARY_ACCESS_TOKEN));
+  account_setTokenExpiresAt(
+      p, _viewNumber(&v, ACCOUNT_BINARY_TOKEN_EXPIRES_AT));
+  account_setCertPath(p, _viewString(&v, ACCOUNT_BINARY_CERT_PATH));
+  char* redirect_uris = _viewString(&v, ACCOUNT_BINARY_REDIRECT_URIS);
+  if (redirect_uris) {
+    account_setRedirectUris(p, delimitedStringToList(redirect_uris, ' '));
+    secFree(redirect_uris);
+  }
+  account_setCodeChallengeMethod(
+      p, _viewString(&v, ACCOUNT_BINARY_CODE_CHALLENGE_METHOD));
+  account_setDeath(p, _viewNumber(&v, ACCOUNT_BINARY_DEATH));
+  p->mode            = _viewNumber(&v, ACCOUNT_BINARY_MODE);
+  p->usage.loaded_at = _viewNumber(&v, ACCOUNT_BINARY_LOADED_AT);
+  p->usage.last_used = _viewNumber(&v, ACCOUNT_BINARY_LAST_USED);
+  p->usage.requests  = _viewNumber(&v, ACCOUNT_BINARY_REQUESTS);
+  return p;
+}
@@ -0,0 +1,64 @@
+#ifndef ACCOUNT_BINARY_H
+#define ACCOUNT_BINARY_H
+
+#include "account.h"
+#include "utils/oidc_error.h"
+
+#include <stddef.h>
+
+/**
+ * Binary account encoding. A record starts with the three magic bytes "OAB",
+ * a version byte and the length of the whole record (4 bytes, little endian),
+ * followed by fields. Every field is a one byte tag, the length of the value
+ * (4 bytes, little endian) and the value. Strings are stored without a
+ * terminating null byte, numbers as 8 bytes little endian. Fields that are not
+ * set are omitted, unknown tags are skipped, so fields can be added without
+ * bumping the version. JSON stays the external format; this
+ * encoding is meant for data that only the agent itself reads back.
+ */
+#define ACCOUNT_BINARY_MAGIC "OAB"
+#define ACCOUNT_BINARY_VERSION 1
+#define ACCOUNT_BINARY_HEADER_LEN 8
+#define ACCOUNT_BINARY_FIELD_HEADER_LEN 5
+
+enum account_binary_tag {
+  ACCOUNT_BINARY_SHORTNAME             = 1,
+  ACCOUNT_BINARY_CLIENTNAME            = 2,
+  ACCOUNT_BINARY_CLIENT_ID             = 3,
+  ACCOUNT_BINARY_CLIENT_SECRET         = 4,
+  ACCOUNT_BINARY_SCOPE                 = 5,
+  ACCOUNT_BINARY_AUDIENCE              = 6,
+  ACCOUNT_BINARY_USERNAME              = 7,
+  ACCOUNT_BINARY_PASSWORD              = 8,
+  ACCOUNT_BINARY_REFRESH_TOKEN         = 9,
+  ACCOUNT_BINARY_ACCESS_TOKEN          = 10,
+  ACCOUNT_BINARY_TOKEN_EXPIRES_AT      = 11,
+  ACCOUNT_BINARY_CERT_PATH             = 12,
+  ACCOUNT_BINARY_REDIRECT_URIS         = 13,  // space separated
+  ACCOUNT_BINARY_CODE_CHALLENGE_METHOD = 14,
+  ACCOUNT_BINARY_DEATH                 = 15,
+  ACCOUNT_BINARY_MODE                  = 16,
+  ACCOUNT_BINARY_LOADED_AT             = 17,
+  ACCOUNT_BINARY_LAST_USED             = 18,
+  ACCOUNT_BINARY_REQUESTS              = 19,
+
+  ACCOUNT_BINARY_ISSUER_URL                    = 32,
+  ACCOUNT_BINARY_CONFIGURATION_ENDPOINT        = 33,
+  ACCOUNT_BINARY_TOKEN_ENDPOINT                = 34,
+  ACCOUNT_BINARY_AUTHORIZATION_ENDPOINT        = 35,
+  ACCOUNT_BINARY_REVOCATION_ENDPOINT           = 36,
+  ACCOUNT_BINARY_REGISTRATION_ENDPOINT         = 37,
+  ACCOUNT_BINARY_USERINFO_ENDPOINT             = 38,
+  ACCOUNT_BINARY_DEVICE_AUTHORIZATION_ENDPOINT = 39,
+  ACCOUNT_BINARY_DAE_SET_BY_USER               = 40,
+  ACCOUNT_BINARY_SCOPES_SUPPORTED              = 41,
+  ACCOUNT_BINARY_GRANT_TYPES_SUPPORTED         = 42,
+  ACCOUNT_BINARY_RESPONSE_TYPES_SUPPORTED      = 43,
+
+  ACCOUNT_BINARY_MAX_TAG = 47,
+};
+
+unsigned char* accountToBinary(const struct oidc_account* p, size_t* len);
+struct oidc_account* getAccountFromBinary(const unsigned char* buf, size_t len);
+
+#endif  // ACCOUNT_BINARY_H
@@ -10,6 +10,7 @@ void _secFreeIssuer(struct oidc_issuer* iss) {
   issuer_setAuthorizationEndpoint(iss, NULL);
   issuer_setRevocationEndpoint(iss, NULL);
   issuer_setRegistrationEndpoint(iss, NULL);
+  issuer_setUserinfoEndpoint(iss, NULL);
   issuer_setDeviceAuthorizationEndpoint(iss, NULL, 0);
   issuer_setScopesSupported(iss, NULL);
   issuer_setGrantTypesSupported(iss, NULL);
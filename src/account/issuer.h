@@ -16,6 +16,7 @@ struct oidc_issuer {
   char*                                authorization_endpoint;
   char*                                revocation_endpoint;
   char*                                registration_endpoint;
+  char*                                userinfo_endpoint;
   struct device_authorization_endpoint device_authorization_endpoint;
 
   char* scopes_supported;          // space delimited
@@ -42,6 +43,9 @@ inline static char* issuer_getRevocationEndpoint(struct oidc_issuer* iss) {
 inline static char* issuer_getRegistrationEndpoint(struct oidc_issuer* iss) {
   return iss ? iss->registration_endpoint : NULL;
 };
+inline static char* issuer_getUserinfoEndpoint(struct oidc_issuer* iss) {
+  return iss ? iss->userinfo_endpoint : NULL;
+};
 inline static char* issuer_getDeviceAuthorizationEndpoint(
     struct oidc_issuer* iss) {
   return iss ? iss->device_authorization_endpoint.url : NULL;
@@ -108,6 +112,14 @@ inline static void issuer_setRegistrationEndpoint(struct oidc_issuer* iss,
   secFree(iss->registration_endpoint);
   iss->registration_endpoint = registration_endpoint;
 }
+inline static void issuer_setUserinfoEndpoint(struct oidc_issuer* iss,
+                                              char* userinfo_endpoint) {
+  if (iss->userinfo_endpoint == userinfo_endpoint) {
+    return;
+  }
+  secFree(iss->userinfo_endpoint);
+  iss->userinfo_endpoint = userinfo_endpoint;
+}
 inline static void issuer_setDeviceAuthorizationEndpoint(
     struct oidc_issuer* iss, char* device_authorization_endpoint,
     int setByUser) {
@@ -5,8 +5,7 @@
 #include "defines/ipc_values.h"
 #include "defines/oidc_values.h"
 #include "defines/settings.h"
-#include "utils/file_io/file_io.h"
-#include "utils/file_io/oidc_file_io.h"
+#include "utils/file_io/configCache.h"
 #include "utils/json.h"
 #include "utils/listUtils.h"
 #include "utils/pass.h"
@@ -140,91 +139,58 @@ int compIssuerUrls(const char* a, const char* b) {
 }
 
 void printIssuerHelp(const char* url) {
-  char* fileContent = NULL;
-  if (fileDoesExist(ETC_ISSUER_CONFIG_FILE)) {
-    // Read the etc version by default, we have put some additional info there,
-    // usually this won't be the case for the user space one.
-    fileContent = readFile(ETC_ISSUER_CONFIG_FILE);
-  } else {
-    // Read the user space issuer.config only if there is no etc version. This
-    // might be the case when a user installed the agent completly in the suer
-    // space.
-    fileContent = readOidcFile(ISSUER_CONFIG_FILENAME);
-  }
-  if (fileContent == NULL) {
+  // Use the etc version by default, we have put some additional info there,
+  // usually this won't be the case for the user space one. The user space
+  // issuer.config is only used if there is no etc version. This might be the
+  // case when a user installed the agent completly in the suer space.
+  char* line = configCache_getLine(
+      configCache_fileExists(CONFIG_CACHE_ETC_ISSUERS)
+          ? CONFIG_CACHE_ETC_ISSUERS
+          : CONFIG_CACHE_ISSUERS,
+      url);
+  if (line == NULL) {
     return;
   }
-  char* elem = strtok(fileContent, "\n");
-  while (elem != NULL) {
-    char* space = strchr(elem, ' ');
-    if (space) {
-      *space = '\0';
+  char* reg_uri = strchr(line, ' ');
+  if (reg_uri && strValid(reg_uri + 1)) {
+    reg_uri++;
+    char* contact = strchr(reg_uri, ' ');
+    if (contact) {
+      *contact = '\0';
+      contact++;
     }
-    if (compIssuerUrls(url, elem)) {
-      if (space) {
-        char* reg_uri = space + 1;
-        space         = strchr(reg_uri, ' ');
-        char* contact = NULL;
-        if (space) {
-          *space  = '\0';
-          contact = space + 1;
-        }
-        if (strValid(reg_uri)) {
-          printStdout("You can try to register a client manually at '%s'\n",
-                      reg_uri);
-        }
-        if (strValid(contact)) {
-          printStdout("You can contact the OpenID Provider at '%s'\n", contact);
-        }
-      } else {
-        printStdout("Unfortunately no contact information were found for "
-                    "issuer '%s'\n",
-                    url);
-      }
-      break;
+    if (strValid(reg_uri)) {
+      printStdout("You can try to register a client manually at '%s'\n",
+                  reg_uri);
     }
-    elem = strtok(NULL, "\n");
+    if (strValid(contact)) {
+      printStdout("You can contact the OpenID Provider at '%s'\n", contact);
+    }
+  } else {
+    printStdout("Unfortunately no contact information were found for "
+                "issuer '%s'\n",
+                url);
   }
-  secFree(fileContent);
+  secFree(line);
 }
 
+/**
+ * @brief returns the issuers from the user's issuer.config followed by the
+ * ones only listed in the global issuer.config
+ */
 list_t* getSuggestableIssuers() {
-  list_t* issuers = list_new();
-  issuers->free   = (void (*)(void*)) & _secFree;
+  list_t* issuers = configCache_getIssuers(CONFIG_CACHE_ISSUERS);
   issuers->match  = (matchFunction)compIssuerUrls;
-
-  char* fileContent = readOidcFile(ISSUER_CONFIG_FILENAME);
-  if (fileContent) {
-    char* elem = strtok(fileContent, "\n");
-    while (elem != NULL) {
-      char* space = strchr(elem, ' ');
-      if (space) {
-        *space = '\0';
-      }
-      if (findInList(issuers, elem) == NULL) {
-        list_rpush(issuers, list_node_new(oidc_sprintf(elem)));
-      }
-      elem = strtok(NULL, "\n");
-    }
-    secFree(fileContent);
-  }
-
-  fileContent = readFile(ETC_ISSUER_CONFIG_FILE);
-  if (fileContent) {
-    char* elem = strtok(fileContent, "\n");
-    while (elem != NULL) {
-      char* space = strchr(elem, ' ');
-      if (space) {
-        *space = '\0';
-      }
-      if (findInList(issuers, elem) == NULL) {
-        list_rpush(issuers, list_node_new(oidc_sprintf(elem)));
-      }
-      elem = strtok(NULL, "\n");
+  list_t*          etc = configCache_getIssuers(CONFIG_CACHE_ETC_ISSUERS);
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(etc, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    if (!configCache_hasIssuer(CONFIG_CACHE_ISSUERS, node->val)) {
+      list_rpush(issuers, list_node_new(oidc_strcopy(node->val)));
     }
-    secFree(fileContent);
   }
-
+  list_iterator_destroy(it);
+  secFreeList(etc);
   return issuers;
 }
 
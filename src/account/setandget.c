@@ -38,6 +38,10 @@ char* account_getDeviceAuthorizationEndpoint(const struct oidc_account* p) {
            : NULL;
 }
 
+char* account_getUserinfoEndpoint(const struct oidc_account* p) {
+  return p ? p->issuer ? issuer_getUserinfoEndpoint(p->issuer) : NULL : NULL;
+}
+
 char* account_getScopesSupported(const struct oidc_account* p) {
   return p ? p->issuer ? issuer_getScopesSupported(p->issuer) : NULL : NULL;
 }
@@ -95,6 +99,18 @@ unsigned long account_getTokenExpiresAt(const struct oidc_account* p) {
   return p ? p->token.token_expires_at : 0;
 }
 
+char* account_getUserinfo(const struct oidc_account* p) {
+  return p ? p->userinfo.json : NULL;
+}
+
+unsigned long account_getUserinfoExpiresAt(const struct oidc_account* p) {
+  return p ? p->userinfo.expires_at : 0;
+}
+
+vector_t* account_getExchangedTokens(const struct oidc_account* p) {
+  return p ? p->exchanged_tokens : NULL;
+}
+
 char* account_getCertPath(const struct oidc_account* p) {
   return p ? p->cert_path : NULL;
 }
@@ -135,6 +151,22 @@ unsigned char account_getAlwaysAllowId(const struct oidc_account* p) {
   return p ? p->mode & ACCOUNT_MODE_ALWAYSALLOWID : 0;
 }
 
+time_t account_getLoadedAt(const struct oidc_account* p) {
+  return p ? p->usage.loaded_at : 0;
+}
+
+/**
+ * @return the time the account was last used for a request or, if it was not
+ * used yet, the time it was loaded
+ */
+time_t account_getLastUsed(const struct oidc_account* p) {
+  return p ? p->usage.last_used ?: p->usage.loaded_at : 0;
+}
+
+unsigned long account_getRequestCount(const struct oidc_account* p) {
+  return p ? p->usage.requests : 0;
+}
+
 void account_setIssuerUrl(struct oidc_account* p, char* issuer_url) {
   if (!p->issuer) {
     p->issuer = secAlloc(sizeof(struct oidc_issuer));
@@ -272,6 +304,25 @@ void account_setTokenExpiresAt(struct oidc_account* p,
   p->token.token_expires_at = token_expires_at;
 }
 
+void account_setUserinfo(struct oidc_account* p, char* userinfo,
+                         unsigned long expires_at) {
+  p->userinfo.expires_at = expires_at;
+  if (p->userinfo.json == userinfo) {
+    return;
+  }
+  secFree(p->userinfo.json);
+  p->userinfo.json = userinfo;
+}
+
+void account_setExchangedTokens(struct oidc_account* p,
+                                vector_t*            exchanged_tokens) {
+  if (p->exchanged_tokens == exchanged_tokens) {
+    return;
+  }
+  secFreeVector(p->exchanged_tokens);
+  p->exchanged_tokens = exchanged_tokens;
+}
+
 void account_setCertPath(struct oidc_account* p, char* cert_path) {
   if (p->cert_path == cert_path) {
     return;
@@ -332,6 +383,15 @@ void account_setAlwaysAllowId(struct oidc_account* p) {
   p->mode |= ACCOUNT_MODE_ALWAYSALLOWID;
 }
 
+void account_setLoadedAt(struct oidc_account* p, time_t loaded_at) {
+  p->usage.loaded_at = loaded_at;
+}
+
+void account_recordUse(struct oidc_account* p) {
+  p->usage.last_used = time(NULL);
+  p->usage.requests++;
+}
+
 int account_refreshTokenIsValid(const struct oidc_account* p) {
   char* refresh_token = account_getRefreshToken(p);
   int   ret           = strValid(refresh_token);
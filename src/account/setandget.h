@@ -11,6 +11,7 @@ char* account_getAuthorizationEndpoint(const struct oidc_account* p);
 char* account_getRevocationEndpoint(const struct oidc_account* p);
 char* account_getRegistrationEndpoint(const struct oidc_account* p);
 char* account_getDeviceAuthorizationEndpoint(const struct oidc_account* p);
+char* account_getUserinfoEndpoint(const struct oidc_account* p);
 char* account_getScopesSupported(const struct oidc_account* p);
 char* account_getGrantTypesSupported(const struct oidc_account* p);
 char* account_getResponseTypesSupported(const struct oidc_account* p);
@@ -25,6 +26,9 @@ char* account_getPassword(const struct oidc_account* p);
 char* account_getRefreshToken(const struct oidc_account* p);
 char* account_getAccessToken(const struct oidc_account* p);
 unsigned long account_getTokenExpiresAt(const struct oidc_account* p);
+char*         account_getUserinfo(const struct oidc_account* p);
+unsigned long account_getUserinfoExpiresAt(const struct oidc_account* p);
+vector_t*     account_getExchangedTokens(const struct oidc_account* p);
 char*         account_getCertPath(const struct oidc_account* p);
 list_t*       account_getRedirectUris(const struct oidc_account* p);
 size_t        account_getRedirectUrisCount(const struct oidc_account* p);
@@ -35,6 +39,9 @@ unsigned char account_getConfirmationRequired(const struct oidc_account* p);
 unsigned char account_getNoWebServer(const struct oidc_account* p);
 unsigned char account_getNoScheme(const struct oidc_account* p);
 unsigned char account_getAlwaysAllowId(const struct oidc_account* p);
+time_t        account_getLoadedAt(const struct oidc_account* p);
+time_t        account_getLastUsed(const struct oidc_account* p);
+unsigned long account_getRequestCount(const struct oidc_account* p);
 
 void account_setIssuerUrl(struct oidc_account* p, char* issuer_url);
 void account_setClientName(struct oidc_account* p, char* clientname);
@@ -53,6 +60,10 @@ void account_setRefreshToken(struct oidc_account* p, char* refresh_token);
 void account_setAccessToken(struct oidc_account* p, char* access_token);
 void account_setTokenExpiresAt(struct oidc_account* p,
                                unsigned long        token_expires_at);
+void account_setUserinfo(struct oidc_account* p, char* userinfo,
+                         unsigned long expires_at);
+void account_setExchangedTokens(struct oidc_account* p,
+                                vector_t*            exchanged_tokens);
 void account_setCertPath(struct oidc_account* p, char* cert_path);
 void account_setRedirectUris(struct oidc_account* p, list_t* redirect_uris);
 void account_setUsedState(struct oidc_account* p, char* used_state);
@@ -64,6 +75,8 @@ void account_setConfirmationRequired(struct oidc_account* p);
 void account_setNoWebServer(struct oidc_account* p);
 void account_setNoScheme(struct oidc_account* p);
 void account_setAlwaysAllowId(struct oidc_account* p);
+void account_setLoadedAt(struct oidc_account* p, time_t loaded_at);
+void account_recordUse(struct oidc_account* p);
 int  account_refreshTokenIsValid(const struct oidc_account* p);
 
 #endif  // ACCOUNT_SETANDGET_H
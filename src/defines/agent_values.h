@@ -7,6 +7,8 @@
 #define AGENT_KEY_SHORTNAME "name"
 #define AGENT_KEY_CERTPATH "cert_path"
 #define AGENT_KEY_EXPIRESAT "expires_at"
+#define AGENT_KEY_CONFIG_ENDPOINT "configuration_endpoint"
+#define AGENT_KEY_MODE "mode"
 
 // INTERNAL / CLI FLOW VALUES
 #define FLOW_VALUE_CODE "code"
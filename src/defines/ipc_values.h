@@ -32,6 +32,9 @@
 #define IPC_KEY_FILENAME "filename"
 #define IPC_KEY_DATA "data"
 #define IPC_KEY_ONLYAT "only_at"
+#define IPC_KEY_USERINFO "userinfo"
+#define IPC_KEY_REVOKE "revoke"
+#define IPC_KEY_RESOURCE "resource"
 
 // STATUS
 #define STATUS_SUCCESS "success"
@@ -39,6 +42,8 @@
 #define STATUS_ACCEPTED "accepted"
 #define STATUS_NOTFOUND "NotFound"
 #define STATUS_FOUNDBUTDONE "FoundButReceived"
+#define STATUS_ENCRYPTIONREQUIRED "EncryptionRequired"
+#define STATUS_REJECTED "Rejected"
 
 // REQUEST VALUES
 #define REQUEST_VALUE_ADD "add"
@@ -64,6 +69,8 @@
 #define REQUEST_VALUE_FILEREAD "file_read"
 #define REQUEST_VALUE_FILEREMOVE "file_remove"
 #define REQUEST_VALUE_DELETECLIENT "delete_client"
+#define REQUEST_VALUE_USERINFO "userinfo"
+#define REQUEST_VALUE_TOKENEXCHANGE "token_exchange"
 
 // RESPONSE TEMPLATES
 #define RESPONSE_SUCCESS "{\"" IPC_KEY_STATUS "\":\"" STATUS_SUCCESS "\"}"
@@ -81,6 +88,11 @@
 #define RESPONSE_ERROR_CLIENT_INFO                                   \
   "{\"" IPC_KEY_STATUS "\":\"" STATUS_FAILURE "\",\"" OIDC_KEY_ERROR \
   "\":\"%s\",\"" IPC_KEY_CLIENT "\":%s,\"" IPC_KEY_INFO "\":\"%s\"}"
+#define RESPONSE_ENCRYPTIONREQUIRED \
+  "{\"" IPC_KEY_STATUS "\":\"" STATUS_ENCRYPTIONREQUIRED "\"}"
+#define RESPONSE_REJECTED                                            \
+  "{\"" IPC_KEY_STATUS "\":\"" STATUS_REJECTED "\",\"" OIDC_KEY_ERROR \
+  "\":\"%s\"}"
 #define RESPONSE_STATUS_SUCCESS \
   "{\"" IPC_KEY_STATUS "\":\"" STATUS_SUCCESS "\"}"
 #define RESPONSE_STATUS_CONFIG \
@@ -92,6 +104,9 @@
 #define RESPONSE_STATUS_IDTOKEN                        \
   "{\"" IPC_KEY_STATUS "\":\"%s\",\"" OIDC_KEY_IDTOKEN \
   "\":\"%s\",\"" OIDC_KEY_ISSUER "\":\"%s\"}"
+#define RESPONSE_STATUS_USERINFO                      \
+  "{\"" IPC_KEY_STATUS "\":\"%s\",\"" IPC_KEY_USERINFO \
+  "\":%s,\"" OIDC_KEY_ISSUER "\":\"%s\"}"
 #define RESPONSE_STATUS_REGISTER \
   "{\"" IPC_KEY_STATUS "\":\"%s\",\"response\":%s}"
 #define RESPONSE_STATUS_CODEURI                   \
@@ -140,6 +155,9 @@
   "\":\"%s\"}"
 #define REQUEST_REMOVEALL \
   "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_REMOVEALL "\"}"
+#define REQUEST_REMOVEALL_REVOKE                                \
+  "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_REMOVEALL "\",\"" \
+  IPC_KEY_REVOKE "\":1}"
 #define REQUEST_DELETE                                                      \
   "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_DELETE "\",\"" IPC_KEY_CONFIG \
   "\":%s}"
@@ -191,6 +209,14 @@
   "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_IDTOKEN              \
   "\",\"" IPC_KEY_SHORTNAME "\":\"%s\",\"" IPC_KEY_APPLICATIONHINT \
   "\":\"%s\"}"
+#define REQUEST_USERINFO_ISSUER                                    \
+  "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_USERINFO             \
+  "\",\"" IPC_KEY_ISSUERURL "\":\"%s\",\"" IPC_KEY_APPLICATIONHINT \
+  "\":\"%s\"}"
+#define REQUEST_USERINFO_ACCOUNT                                   \
+  "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_USERINFO             \
+  "\",\"" IPC_KEY_SHORTNAME "\":\"%s\",\"" IPC_KEY_APPLICATIONHINT \
+  "\":\"%s\"}"
 #define REQUEST_FILEWRITE                               \
   "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_FILEWRITE \
   "\",\"" IPC_KEY_FILENAME "\":\"%s\",\"" IPC_KEY_DATA "\":\"%s\"}"
@@ -211,6 +237,9 @@
 #define INT_REQUEST_VALUE_QUERY_ACCDEFAULT "query_account_default"
 
 #define INT_IPC_KEY_OIDCERRNO "oidc_errno"
+#define INT_IPC_KEY_PEERUID "peer_uid"
+#define INT_IPC_KEY_ADMISSION "admission"
+#define INT_IPC_KEY_SCHEDULER "scheduler"
 
 #define INT_REQUEST_UPD_REFRESH                               \
   "{\"" IPC_KEY_REQUEST "\":\"" INT_REQUEST_VALUE_UPD_REFRESH \
@@ -13,6 +13,7 @@
 #define OIDC_KEY_REVOCATION_ENDPOINT "revocation_endpoint"
 #define OIDC_KEY_REGISTRATION_ENDPOINT "registration_endpoint"
 #define OIDC_KEY_DEVICE_AUTHORIZATION_ENDPOINT "device_authorization_endpoint"
+#define OIDC_KEY_USERINFO_ENDPOINT "userinfo_endpoint"
 #define OIDC_KEY_ISSUER "issuer"
 
 // CLIENT KEYS
@@ -32,6 +33,7 @@
 #define OIDC_KEY_RESPONSETYPE "response_type"
 #define OIDC_KEY_SCOPE "scope"
 #define OIDC_KEY_AUDIENCE "audience"
+#define OIDC_KEY_RESOURCE "resource"
 #define GOOGLE_KEY_ACCESSTYPE "access_type"
 // AUTH CODE FLOW
 #define OIDC_KEY_REDIRECTURI "redirect_uri"
@@ -47,6 +49,10 @@
 // REVOCATION
 #define OIDC_KEY_TOKENTYPE_HINT "token_type_hint"
 #define OIDC_KEY_TOKEN "token"
+// TOKEN EXCHANGE
+#define OIDC_KEY_SUBJECT_TOKEN "subject_token"
+#define OIDC_KEY_SUBJECT_TOKEN_TYPE "subject_token_type"
+#define OIDC_KEY_REQUESTED_TOKEN_TYPE "requested_token_type"
 // CLIENT REGISTRATION
 #define OIDC_KEY_APPLICATIONTYPE "application_type"
 #define OIDC_KEY_CLIENTNAME "client_name"
@@ -74,6 +80,8 @@
 #define OIDC_GRANTTYPE_AUTHCODE "authorization_code"
 #define OIDC_GRANTTYPE_IMPLICIT "implicit"
 #define OIDC_GRANTTYPE_DEVICE "urn:ietf:params:oauth:grant-type:device_code"
+#define OIDC_GRANTTYPE_TOKENEXCHANGE \
+  "urn:ietf:params:oauth:grant-type:token-exchange"
 #define OIDC_PROVIDER_DEFAULT_GRANTTYPES \
   "[\"" OIDC_GRANTTYPE_AUTHCODE "\", \"" OIDC_GRANTTYPE_IMPLICIT "\"]"
 
@@ -91,6 +99,8 @@
 
 // TOKENTYPES
 #define OIDC_TOKENTYPE_REFRESH "refresh_token"
+#define OIDC_TOKENTYPE_URN_ACCESS \
+  "urn:ietf:params:oauth:token-type:access_token"
 
 // PROVIDER FIXES
 #define GOOGLE_ISSUER_URL "https://accounts.google.com/"
@@ -10,6 +10,11 @@
  * the name of the environment variable used to locate the remote TCP socket
  */
 #define OIDC_REMOTE_SOCK_ENV_NAME "OIDC_REMOTE_SOCK"
+/**
+ * the name of the environment variable that tells clients that the agent
+ * accepts unencrypted requests from local peers
+ */
+#define OIDC_FAST_IPC_ENV_NAME "OIDC_FAST_IPC"
 /**
  * the name of the environment variable that holds the agent pid
  */
@@ -41,6 +46,10 @@
 #define PUBCLIENTS_FILENAME "pubclients.config"
 #define ETC_PUBCLIENTS_CONFIG_FILE \
   CONFIG_PATH "/oidc-agent/" PUBCLIENTS_FILENAME
+#define STATE_SNAPSHOT_FILENAME "agent-state.snapshot"
+#define STATE_UNLOADED_FILENAME STATE_SNAPSHOT_FILENAME ".unloaded"
+#define KEYSTORE_FILENAME "accounts.keystore"
+#define KDF_CONFIG_FILENAME "kdf.config"
 
 #define MAX_PASS_TRIES 3
 /**
@@ -54,6 +63,50 @@
 
 #define HTTP_DEFAULT_PORT 4242
 #define HTTP_FALLBACK_PORT 8080
+/**
+ * number of threads serving a redirect listener
+ */
+#define HTTPSERVER_THREAD_POOL_SIZE 2
+/**
+ * seconds after which an inactive connection to a redirect listener is closed
+ */
+#define HTTPSERVER_CONN_TIMEOUT 30
+
+#define REMOTE_DEFAULT_PORT 42424
+/**
+ * address the remote token server binds to if none is given; other hosts can
+ * only connect if another address is given explicitly
+ */
+#define REMOTE_DEFAULT_BIND_ADDRESS "127.0.0.1"
+/**
+ * number of worker threads of the remote token server
+ */
+#define REMOTE_WORKER_POOL_SIZE 4
+/**
+ * maximum number of concurrent connections to the remote token server
+ */
+#define REMOTE_MAX_CONNECTIONS 4096
+/**
+ * default maximum number of concurrent connections from a single client host
+ */
+#define REMOTE_DEFAULT_CLIENT_LIMIT 16
+/**
+ * seconds after which an idle remote session is closed
+ */
+#define REMOTE_SESSION_IDLE_TIMEOUT 30
+/**
+ * maximum length of a decrypted request to the remote token server
+ */
+#define REMOTE_MAX_REQUEST_LEN 4096
+/**
+ * maximum number of access token responses cached by the remote token server
+ */
+#define REMOTE_TOKEN_CACHE_SIZE 256
+
+/**
+ * the socket of a multi-user system agent
+ */
+#define MULTI_USER_SOCKET_PATH "/run/oidc-agent/oidc-agent.sock"
 
 #define CONF_ENDPOINT_SUFFIX ".well-known/openid-configuration"
 
@@ -0,0 +1,229 @@
+#ifndef __APPLE__
+#define _XOPEN_SOURCE 700
+#endif
+#include "admission.h"
+#include "ipc/peercred.h"
+#include "utils/json.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+#include "wrapper/list.h"
+
+#include <time.h>
+
+/**
+ * admission counters of one peer uid; @c tokens is a token bucket that holds
+ * at most @c peer_rate tokens and is refilled with @c peer_rate tokens per
+ * second
+ */
+struct peer_quota {
+  uid_t         uid;
+  unsigned char known;
+  size_t        inflight;
+  double        tokens;
+  double        last_refill;
+  unsigned long admitted;
+  unsigned long rejected;
+};
+
+static struct admission_limits limits = {ADMISSION_DEFAULT_MAX_CONNECTIONS, 0,
+                                         0};
+
+static size_t        open_connections = 0;
+static size_t        peak_connections = 0;
+static size_t        pending_rejects  = 0;
+static unsigned long accepted         = 0;
+static unsigned long rejected_maxcons = 0;
+static unsigned long rejected_quota   = 0;
+static unsigned long rejected_rate    = 0;
+
+/**
+ * used for all connections if no per-peer limit is set, so that the peer
+ * credentials do not have to be determined for every connection
+ */
+static struct peer_quota any_peer = {0, 0, 0, 0, 0, 0, 0};
+static list_t*           peers    = NULL;
+
+void admission_setLimits(struct admission_limits new_limits) {
+  limits = new_limits;
+}
+
+static double _now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int _peerLimited() {
+  return limits.peer_max_connections > 0 || limits.peer_rate > 0;
+}
+
+static struct peer_quota* _newPeerQuota(uid_t uid, unsigned char known) {
+  struct peer_quota* quota = secAlloc(sizeof(struct peer_quota));
+  quota->uid               = uid;
+  quota->known             = known;
+  quota->tokens            = limits.peer_rate;
+  quota->last_refill       = _now();
+  return quota;
+}
+
+/**
+ * @brief returns the quota of the peer of @p sock; peers whose credentials
+ * cannot be determined share one entry
+ */
+static struct peer_quota* _getPeerQuota(int sock) {
+  struct peer_cred cred;
+  unsigned char    known = ipc_getPeerCredentials(sock, &cred) == OIDC_SUCCESS;
+  uid_t            uid   = known ? cred.uid : 0;
+  if (peers == NULL) {
+    peers       = list_new();
+    peers->free = (void (*)(void*)) & _secFree;
+  }
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(peers, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct peer_quota* quota = node->val;
+    if (quota->known == known && quota->uid == uid) {
+      list_iterator_destroy(it);
+      return quota;
+    }
+  }
+  list_iterator_destroy(it);
+  struct peer_quota* quota = _newPeerQuota(uid, known);
+  list_rpush(peers, list_node_new(quota));
+  return quota;
+}
+
+static int _takeToken(struct peer_quota* quota) {
+  if (limits.peer_rate == 0) {
+    return 1;
+  }
+  double now = _now();
+  quota->tokens += (now - quota->last_refill) * limits.peer_rate;
+  quota->last_refill = now;
+  if (quota->tokens > limits.peer_rate) {
+    quota->tokens = limits.peer_rate;
+  }
+  if (quota->tokens < 1) {
+    return 0;
+  }
+  quota->tokens -= 1;
+  return 1;
+}
+
+static oidc_error_t _reject(struct connection* con, struct peer_quota* quota,
+                            oidc_error_t error) {
+  if (quota != NULL) {
+    quota->rejected++;
+  }
+  if (pending_rejects < ADMISSION_MAX_PENDING_REJECTS) {
+    pending_rejects++;
+    con->rejected = error;
+  }
+  logger(NOTICE, "Rejected client connection: %s", oidc_serrorFor(error));
+  oidc_errno = error;
+  return error;
+}
+
+/**
+ * @brief decides if a newly accepted client connection is served
+ *
+ * An admitted connection is charged to the open connections and the quota of
+ * its peer until it is freed. A connection that is not admitted has
+ * @c con->rejected set to the reason; its request is read and answered with
+ * that error without being decrypted or passed to oidcd. If too many
+ * rejections are pending, @c con->rejected is not set and the connection
+ * should be closed right away.
+ * @param con the accepted client connection
+ * @return @c OIDC_SUCCESS if the connection was admitted, an error code
+ * otherwise
+ */
+oidc_error_t admission_admit(struct connection* con) {
+  if (limits.max_connections > 0 &&
+      open_connections >= limits.max_connections) {
+    rejected_maxcons++;
+    return _reject(con, NULL, OIDC_EMAXCONS);
+  }
+  struct peer_quota* quota =
+      _peerLimited() ? _getPeerQuota(*(con->msgsock)) : &any_peer;
+  if (limits.peer_max_connections > 0 &&
+      quota->inflight >= limits.peer_max_connections) {
+    rejected_quota++;
+    return _reject(con, quota, OIDC_EPEERQUOTA);
+  }
+  if (!_takeToken(quota)) {
+    rejected_rate++;
+    return _reject(con, quota, OIDC_ERATELIMIT);
+  }
+  quota->inflight++;
+  quota->admitted++;
+  con->quota = quota;
+  accepted++;
+  open_connections++;
+  if (open_connections > peak_connections) {
+    peak_connections = open_connections;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief releases the admission of a client connection; called when the
+ * connection is freed
+ */
+void admission_release(struct connection* con) {
+  if (con->quota != NULL) {
+    con->quota->inflight--;
+    con->quota = NULL;
+    open_connections--;
+  }
+  if (con->rejected != OIDC_SUCCESS) {
+    con->rejected = OIDC_SUCCESS;
+    pending_rejects--;
+  }
+}
+
+static cJSON* _peerQuotaToJSON(const struct peer_quota* quota) {
+  char* uid = quota->known ? oidc_sprintf("%lu", (unsigned long)quota->uid)
+                           : oidc_strcopy("unknown");
+  cJSON* json = generateJSONObject(
+      "uid", cJSON_String, uid, "open", cJSON_Number, (long)quota->inflight,
+      "admitted", cJSON_Number, (long)quota->admitted, "rejected", cJSON_Number,
+      (long)quota->rejected, NULL);
+  secFree(uid);
+  return json;
+}
+
+/**
+ * @brief returns the admission counters as a json object string
+ * @param only_uid if not @c NULL, only the per-peer counters of this uid are
+ * included
+ * @return a pointer to the json string. Has to be freed after usage.
+ */
+char* admission_getStatsJSON(const uid_t* only_uid) {
+  cJSON* peers_j = generateJSONArray(NULL);
+  if (peers != NULL) {
+    list_node_t*     node;
+    list_iterator_t* it = list_iterator_new(peers, LIST_HEAD);
+    while ((node = list_iterator_next(it))) {
+      const struct peer_quota* quota = node->val;
+      if (only_uid == NULL || (quota->known && quota->uid == *only_uid)) {
+        cJSON_AddItemToArray(peers_j, _peerQuotaToJSON(quota));
+      }
+    }
+    list_iterator_destroy(it);
+  }
+  char* peers_str = jsonToStringUnformatted(peers_j);
+  secFreeJson(peers_j);
+  cJSON* json = generateJSONObject(
+      "peers", cJSON_Array, peers_str, "open", cJSON_Number,
+      (long)open_connections, "peak", cJSON_Number, (long)peak_connections,
+      "max", cJSON_Number, (long)limits.max_connections, "accepted",
+      cJSON_Number, (long)accepted, "rejected_max_connections", cJSON_Number,
+      (long)rejected_maxcons, "rejected_peer_quota", cJSON_Number,
+      (long)rejected_quota, "rejected_rate_limit", cJSON_Number,
+      (long)rejected_rate, NULL);
+  secFree(peers_str);
+  char* stats = jsonToStringUnformatted(json);
+  secFreeJson(json);
+  return stats;
+}
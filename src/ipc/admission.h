@@ -0,0 +1,34 @@
+#ifndef IPC_ADMISSION_H
+#define IPC_ADMISSION_H
+
+#include "connection.h"
+#include "utils/oidc_error.h"
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define ADMISSION_DEFAULT_BACKLOG 128
+#define ADMISSION_DEFAULT_MAX_CONNECTIONS 256
+/**
+ * rejected connections are kept until the rejection was sent; if more are
+ * pending, further connections are closed without a response
+ */
+#define ADMISSION_MAX_PENDING_REJECTS 32
+
+/**
+ * limits for accepting client connections; @c 0 means unlimited.
+ * @c peer_max_connections limits the open connections per peer uid,
+ * @c peer_rate the connections per second per peer uid
+ */
+struct admission_limits {
+  size_t max_connections;
+  size_t peer_max_connections;
+  size_t peer_rate;
+};
+
+void         admission_setLimits(struct admission_limits limits);
+oidc_error_t admission_admit(struct connection* con);
+void         admission_release(struct connection* con);
+char*        admission_getStatsJSON(const uid_t* only_uid);
+
+#endif  // IPC_ADMISSION_H
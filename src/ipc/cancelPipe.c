@@ -0,0 +1,94 @@
+#include "cancelPipe.h"
+#include "utils/logger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * A pipe from oidcp to oidcd that is only used to cancel the request oidcd is
+ * working on; it is separate from the request pipes, so that oidcd can wait
+ * for it while waiting for an http transfer. oidcp writes a single byte for
+ * each cancelled request. The read end is non-blocking.
+ */
+static int cancel_fds[2] = {-1, -1};
+
+/**
+ * @brief creates the cancel pipe; must be called before oidcd is forked
+ */
+oidc_error_t cancelPipe_init() {
+  if (pipe(cancel_fds) != 0) {
+    oidc_setErrnoError();
+    cancel_fds[0] = cancel_fds[1] = -1;
+    return oidc_errno;
+  }
+  int flags = fcntl(cancel_fds[0], F_GETFL, 0);
+  fcntl(cancel_fds[0], F_SETFL, (flags == -1 ? 0 : flags) | O_NONBLOCK);
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief closes the write end; called in oidcd
+ */
+void cancelPipe_closeSender() {
+  if (cancel_fds[1] >= 0) {
+    close(cancel_fds[1]);
+    cancel_fds[1] = -1;
+  }
+}
+
+/**
+ * @brief closes the read end; called in oidcp
+ */
+void cancelPipe_closeReceiver() {
+  if (cancel_fds[0] >= 0) {
+    close(cancel_fds[0]);
+    cancel_fds[0] = -1;
+  }
+}
+
+/**
+ * @brief tells oidcd to cancel the request it is currently working on
+ */
+oidc_error_t cancelPipe_send() {
+  if (cancel_fds[1] < 0) {
+    oidc_errno = OIDC_ESOCKINV;
+    return oidc_errno;
+  }
+  const char c = 'c';
+  if (write(cancel_fds[1], &c, sizeof(c)) != sizeof(c)) {
+    logger(ERROR, "Could not send cancel to oidcd: %m");
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @return the read end of the cancel pipe, which becomes readable when a
+ * request is cancelled; @c -1 if there is no cancel pipe
+ */
+int cancelPipe_getFd() { return cancel_fds[0]; }
+
+/**
+ * @brief consumes pending cancellations without blocking
+ * @return @c 1 if a cancellation was pending, @c 0 otherwise
+ */
+int cancelPipe_consume() {
+  if (cancel_fds[0] < 0) {
+    return 0;
+  }
+  int  cancelled = 0;
+  char buf[16];
+  while (1) {
+    ssize_t n = read(cancel_fds[0], buf, sizeof(buf));
+    if (n > 0) {
+      cancelled = 1;
+      continue;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    return cancelled;
+  }
+}
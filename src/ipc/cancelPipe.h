@@ -0,0 +1,13 @@
+#ifndef OIDC_IPC_CANCELPIPE_H
+#define OIDC_IPC_CANCELPIPE_H
+
+#include "utils/oidc_error.h"
+
+oidc_error_t cancelPipe_init();
+void         cancelPipe_closeSender();
+void         cancelPipe_closeReceiver();
+oidc_error_t cancelPipe_send();
+int          cancelPipe_getFd();
+int          cancelPipe_consume();
+
+#endif  // OIDC_IPC_CANCELPIPE_H
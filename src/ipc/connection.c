@@ -1,4 +1,6 @@
 #include "connection.h"
+#include "admission.h"
+#include "cryptIpc.h"
 
 #include "utils/memory.h"
 
@@ -26,6 +28,7 @@ int connection_comparator(const struct connection* c1,
 }
 
 void _secFreeConnection(struct connection* con) {
+  admission_release(con);
   secFree(con->server);
   con->server = NULL;
   secFree(con->tcp_server);
@@ -37,5 +40,7 @@ void _secFreeConnection(struct connection* con) {
   }
   secFree(con->msgsock);
   con->msgsock = NULL;
+  secFreeIpcKey(con->ipc_key);
+  con->ipc_key = NULL;
   secFree(con);
 }
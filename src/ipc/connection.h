@@ -1,15 +1,32 @@
 #ifndef IPC_CONNECTION_H
 #define IPC_CONNECTION_H
 
+#include "utils/oidc_error.h"
+
 #include <stddef.h>
 #include <sys/un.h>
 #include <netinet/in.h>
 
+struct ipc_key;
+struct peer_quota;
+
+/**
+ * @c ipc_key is the session key of an encrypted request received on
+ * @c msgsock; it is owned by the connection and wiped when the connection is
+ * freed. @c quota is the admission counter an accepted client connection is
+ * charged to; @c rejected is set instead if the connection was not admitted.
+ * @c pipelined is set if the client sent more data while its request was
+ * queued; such a connection is not watched for reads anymore.
+ */
 struct connection {
   int*                sock;
   int*                msgsock;
   struct sockaddr_un* server;
   struct sockaddr_in* tcp_server;
+  struct ipc_key*     ipc_key;
+  struct peer_quota*  quota;
+  oidc_error_t        rejected;
+  unsigned char       pipelined;
 };
 
 int  connection_comparator(const struct connection* c1,
@@ -1,48 +1,138 @@
 #include "cryptCommunicator.h"
 #include "cryptIpc.h"
+#include "defines/ipc_values.h"
 #include "defines/settings.h"
 #include "ipc.h"
 #include "utils/crypt/ipcCryptUtils.h"
 #include "utils/json.h"
 #include "utils/logger.h"
 #include "utils/oidc_error.h"
+#include "utils/stringUtils.h"
 
 #include <sodium.h>
+#include <stdlib.h>
+
+/**
+ * set once the agent rejected an unencrypted request; all further requests of
+ * this thread use the encrypted protocol right away
+ */
+static __thread unsigned char plain_rejected = 0;
+
+/**
+ * set once an agent did not understand the binary envelope; all further
+ * requests of this thread use the text envelope right away
+ */
+static __thread unsigned char binary_rejected = 0;
 
 char* _ipc_vcryptCommunicateWithConnection(struct connection con,
+                                           unsigned char binary,
                                            const char* fmt, va_list args) {
   logger(DEBUG, "Doing encrypted ipc communication");
   if (ipc_connect(con) < 0) {
     return NULL;
   }
-  unsigned char* ipc_key = client_keyExchange(*(con.sock));
+  unsigned char* ipc_key = binary ? client_keyExchangeBinary(*(con.sock))
+                                  : client_keyExchange(*(con.sock));
   if (ipc_key == NULL) {
     ipc_closeConnection(&con);
     return NULL;
   }
-  oidc_error_t e = ipc_vcryptWrite(*(con.sock), ipc_key, fmt, args);
+  oidc_error_t e = binary
+                       ? ipc_vcryptWriteBinary(*(con.sock), ipc_key, fmt, args)
+                       : ipc_vcryptWrite(*(con.sock), ipc_key, fmt, args);
   if (e != OIDC_SUCCESS) {
     secFree(ipc_key);
     ipc_closeConnection(&con);
     return NULL;
   }
-
-  char* encryptedResponse = ipc_read(*(con.sock));
+  char* response = ipc_cryptReadResponse(*(con.sock), ipc_key);
   ipc_closeConnection(&con);
-  if (encryptedResponse == NULL) {
-    secFree(ipc_key);
+  secFree(ipc_key);
+  return response;
+}
+
+static oidc_error_t _initConnection(struct connection* con,
+                                    const char*        socket_path,
+                                    unsigned char      remote) {
+  return socket_path ? initConnectionWithPath(con, socket_path)
+                     : ipc_client_init(con, remote);
+}
+
+/**
+ * @brief does an encrypted request; the binary envelope is tried first and
+ * the text envelope is used if the agent does not support the binary one
+ * @param socket_path the socket to connect to; if @c NULL the socket is taken
+ * from the environment
+ */
+static char* _ipc_vcryptCommunicate(const char* socket_path,
+                                    unsigned char remote, const char* fmt,
+                                    va_list args) {
+  struct connection con = {0};
+  if (!binary_rejected) {
+    if (_initConnection(&con, socket_path, remote) != OIDC_SUCCESS) {
+      return NULL;
+    }
+    va_list binary_args;
+    va_copy(binary_args, args);
+    char* res = _ipc_vcryptCommunicateWithConnection(con, 1, fmt, binary_args);
+    va_end(binary_args);
+    if (res != NULL || oidc_errno != OIDC_ENOBINIPC) {
+      return res;
+    }
+    logger(DEBUG, "Agent does not support binary ipc, using text envelope");
+    binary_rejected = 1;
+    con             = (struct connection){0};
+  }
+  if (_initConnection(&con, socket_path, remote) != OIDC_SUCCESS) {
     return NULL;
   }
+  return _ipc_vcryptCommunicateWithConnection(con, 0, fmt, args);
+}
 
-  if (isJSONObject(encryptedResponse)) {
-    // Response not encrypted
-    secFree(ipc_key);
-    return encryptedResponse;
+static char* _ipc_vplainCommunicateWithPath(const char* socket_path,
+                                            const char* fmt, va_list args) {
+  logger(DEBUG, "Doing unencrypted ipc communication");
+  struct connection con = {0};
+  if (initConnectionWithPath(&con, socket_path) != OIDC_SUCCESS) {
+    return NULL;
   }
-  char* decryptedResponse = decryptForIpc(encryptedResponse, ipc_key);
-  secFree(encryptedResponse);
-  secFree(ipc_key);
-  return decryptedResponse;
+  if (ipc_connect(con) < 0) {
+    return NULL;
+  }
+  char* res = ipc_vwrite(*(con.sock), fmt, args) == OIDC_SUCCESS
+                  ? ipc_read(*(con.sock))
+                  : NULL;
+  ipc_closeConnection(&con);
+  return res;
+}
+
+/**
+ * @brief communicates with a local agent; if the agent announced through
+ * @c OIDC_FAST_IPC that it trusts local peers, the request is sent unencrypted,
+ * skipping the key exchange. If the agent rejects it, the request is repeated
+ * with encryption.
+ */
+static char* _ipc_vlocalCommunicateWithPath(const char* socket_path,
+                                            const char* fmt, va_list args) {
+  if (!plain_rejected && getenv(OIDC_FAST_IPC_ENV_NAME) != NULL) {
+    va_list plain_args;
+    va_copy(plain_args, args);
+    char* res = _ipc_vplainCommunicateWithPath(socket_path, fmt, plain_args);
+    va_end(plain_args);
+    if (res == NULL) {
+      return NULL;
+    }
+    char* status = getJSONValueFromString(res, IPC_KEY_STATUS);
+    if (!strequal(status, STATUS_ENCRYPTIONREQUIRED)) {
+      secFree(status);
+      return res;
+    }
+    logger(DEBUG, "Agent requires encryption");
+    secFree(status);
+    secFree(res);
+    plain_rejected = 1;
+  }
+  return _ipc_vcryptCommunicate(socket_path, 0, fmt, args);
 }
 
 char* ipc_cryptCommunicate(unsigned char remote, const char* fmt, ...) {
@@ -55,20 +145,18 @@ char* ipc_cryptCommunicate(unsigned char remote, const char* fmt, ...) {
 
 char* ipc_vcryptCommunicate(unsigned char remote, const char* fmt,
                             va_list args) {
-  static struct connection con;
-  if (ipc_client_init(&con, remote) != OIDC_SUCCESS) {
-    return NULL;
+  if (!remote) {
+    const char* path = getenv(OIDC_SOCK_ENV_NAME);
+    if (path != NULL) {
+      return _ipc_vlocalCommunicateWithPath(path, fmt, args);
+    }
   }
-  return _ipc_vcryptCommunicateWithConnection(con, fmt, args);
+  return _ipc_vcryptCommunicate(NULL, remote, fmt, args);
 }
 
 char* ipc_vcryptCommunicateWithPath(const char* socket_path, const char* fmt,
                                     va_list args) {
-  static struct connection con;
-  if (initConnectionWithPath(&con, socket_path) != OIDC_SUCCESS) {
-    return NULL;
-  }
-  return _ipc_vcryptCommunicateWithConnection(con, fmt, args);
+  return _ipc_vlocalCommunicateWithPath(socket_path, fmt, args);
 }
 
 char* ipc_cryptCommunicateWithPath(const char* socket_path, const char* fmt,
@@ -1,4 +1,5 @@
 #include "cryptIpc.h"
+#include "defines/ipc_values.h"
 #include "ipc.h"
 #include "utils/crypt/crypt.h"
 #include "utils/crypt/ipcCryptUtils.h"
@@ -47,8 +48,68 @@ oidc_error_t ipc_vcryptWrite(const int sock, const unsigned char* key,
   return e;
 }
 
+/**
+ * @brief encrypts a message into the binary envelope and writes it with a
+ * single write
+ */
+oidc_error_t ipc_vcryptWriteBinary(const int sock, const unsigned char* key,
+                                   const char* fmt, va_list args) {
+  char* msg = oidc_vsprintf(fmt, args);
+  if (msg == NULL) {
+    return oidc_errno;
+  }
+  logger(DEBUG, "Doing binary encrypted ipc write of %lu bytes: '%s'",
+         strlen(msg), msg);
+  size_t         len    = 0;
+  unsigned char* sealed = ipcCryptSealBinary(msg, strlen(msg), key, &len);
+  secFree(msg);
+  if (sealed == NULL) {
+    return oidc_errno;
+  }
+  oidc_error_t e = ipc_writeBytes(sock, sealed, len);
+  secFree(sealed);
+  return e;
+}
+
+/**
+ * @brief decrypts a message in either envelope format and frees it
+ * @return the decrypted message or @c NULL if it cannot be decrypted
+ */
+static char* _openEnvelope(char* msg, size_t len, const unsigned char* key) {
+  char* decrypted = ipcCryptIsBinary(msg, len)
+                        ? ipcCryptOpenBinary(msg, len, key)
+                        : decryptForIpc(msg, key);
+  secFree(msg);
+  return decrypted;
+}
+
+/**
+ * @brief reads an encrypted message in either envelope format
+ * @return the decrypted message; unencrypted json is returned as is. Has to be
+ * freed after usage.
+ */
+char* ipc_cryptReadResponse(const int sock, const unsigned char* key) {
+  size_t len = 0;
+  char*  msg = ipc_readBytes(sock, &len);
+  if (msg == NULL) {
+    return NULL;
+  }
+  if (isJSONObject(msg)) {  // Response not encrypted
+    return msg;
+  }
+  return _openEnvelope(msg, len, key);
+}
+
 void secFreePubSecKeySet(struct pubsec_keySet* k) { secFree(k); }
 
+void secFreeIpcKey(struct ipc_key* k) {
+  if (k == NULL) {
+    return;
+  }
+  secFree(k->key);
+  secFree(k);
+}
+
 struct pubsec_keySet* generatePubSecKeys() {
   struct pubsec_keySet* keys = secAlloc(sizeof(struct pubsec_keySet));
   crypto_kx_keypair(keys->pk, keys->sk);
@@ -83,16 +144,29 @@ unsigned char* generateIpcKey(const unsigned char* publicKey,
   return sharedKey;
 }
 
-list_t* encryptionKeys = NULL;
+static struct ipc_key* _newIpcKey(unsigned char* key, unsigned char binary) {
+  struct ipc_key* k = secAlloc(sizeof(struct ipc_key));
+  k->key            = key;
+  k->binary         = binary;
+  return k;
+}
 
-char* server_ipc_cryptRead(const int sock, const char* client_pk_base64) {
+/**
+ * @brief does the server side of the text key exchange and reads the request
+ * @param client_pk_base64 the base64 encoded public key sent by the client
+ * @param session_key is set to the session key of this request on success; it
+ * has to be used for the response and freed with @c secFreeIpcKey afterwards
+ * @return the decrypted request or @c NULL on failure
+ */
+char* server_ipc_cryptRead(const int sock, const char* client_pk_base64,
+                           struct ipc_key** session_key) {
   logger(DEBUG, "Doing encrypted ipc read");
   unsigned char client_pk[crypto_kx_PUBLICKEYBYTES];
   fromBase64(client_pk_base64, crypto_kx_PUBLICKEYBYTES, client_pk);
   struct pubsec_keySet* pubsec_keys = generatePubSecKeys();
   unsigned char*        ipc_key = generateIpcKey(client_pk, pubsec_keys->sk);
   if (ipc_key == NULL) {
-    secFree(ipc_key);
+    secFreePubSecKeySet(pubsec_keys);
     return NULL;
   }
   char* encrypted_request = communicatePublicKey(sock, (char*)pubsec_keys->pk);
@@ -105,21 +179,117 @@ char* server_ipc_cryptRead(const int sock, const char* client_pk_base64) {
   char* decryptedRequest = decryptForIpc(encrypted_request, ipc_key);
   secFree(encrypted_request);
   logger(DEBUG, "Decrypted request is '%s'", decryptedRequest);
-  if (decryptedRequest != NULL) {
-    if (encryptionKeys == NULL) {
-      encryptionKeys = list_new();
-    }
-    list_rpush(encryptionKeys, list_node_new(ipc_key));
-  } else {
+  if (decryptedRequest == NULL) {
     secFree(ipc_key);
+    return NULL;
   }
+  *session_key = _newIpcKey(ipc_key, 0);
   return decryptedRequest;
 }
 
+/**
+ * @brief does the server side of the binary key exchange and reads the
+ * request; the request may use either envelope format, the response will use
+ * the binary one. An unencrypted request is rejected, plain requests are only
+ * accepted without a key exchange.
+ * @param client_pk the raw public key from the client's hello
+ * @param session_key is set to the session key of this request on success; it
+ * has to be used for the response and freed with @c secFreeIpcKey afterwards
+ */
+char* server_ipc_cryptReadBinary(const int sock, const unsigned char* client_pk,
+                                 struct ipc_key** session_key) {
+  logger(DEBUG, "Doing binary encrypted ipc read");
+  struct pubsec_keySet* pubsec_keys = generatePubSecKeys();
+  unsigned char*        ipc_key = generateIpcKey(client_pk, pubsec_keys->sk);
+  if (ipc_key == NULL) {
+    secFreePubSecKeySet(pubsec_keys);
+    return NULL;
+  }
+  unsigned char hello[IPC_CRYPT_BINARY_HELLO_LEN];
+  ipcCryptWriteHello(hello, pubsec_keys->pk);
+  secFreePubSecKeySet(pubsec_keys);
+  if (ipc_writeBytes(sock, hello, sizeof(hello)) != OIDC_SUCCESS) {
+    secFree(ipc_key);
+    return NULL;
+  }
+  size_t len     = 0;
+  char*  request = ipc_readBytes(sock, &len);
+  if (request != NULL) {
+    request = _openEnvelope(request, len, ipc_key);
+  }
+  if (request == NULL) {
+    secFree(ipc_key);
+    return NULL;
+  }
+  *session_key = _newIpcKey(ipc_key, 1);
+  return request;
+}
+
+/**
+ * @brief checks if the agent answered the key exchange with a rejection of
+ * the connection; if so, the agent's error is set as @c oidc_errno
+ */
+static int _isRejection(const char* res) {
+  if (!isJSONObject(res)) {
+    return 0;
+  }
+  char* status = getJSONValueFromString(res, IPC_KEY_STATUS);
+  if (!strequal(status, STATUS_REJECTED)) {
+    secFree(status);
+    return 0;
+  }
+  secFree(status);
+  char* error = getJSONValueFromString(res, OIDC_KEY_ERROR);
+  oidc_seterror(error ?: "Connection rejected by agent");
+  oidc_errno = OIDC_EERROR;
+  secFree(error);
+  return 1;
+}
+
+/**
+ * @brief does the client side of the binary key exchange
+ * @return the shared key or @c NULL on failure; if the server does not support
+ * the binary envelope @c oidc_errno is set to @c OIDC_ENOBINIPC and the
+ * connection cannot be used anymore
+ */
+unsigned char* client_keyExchangeBinary(const int sock) {
+  struct pubsec_keySet* pubsec_keys = generatePubSecKeys();
+  unsigned char         hello[IPC_CRYPT_BINARY_HELLO_LEN];
+  ipcCryptWriteHello(hello, pubsec_keys->pk);
+  if (ipc_writeBytes(sock, hello, sizeof(hello)) != OIDC_SUCCESS) {
+    secFreePubSecKeySet(pubsec_keys);
+    return NULL;
+  }
+  size_t len = 0;
+  char*  res = ipc_readBytes(sock, &len);
+  if (res == NULL) {
+    secFreePubSecKeySet(pubsec_keys);
+    return NULL;
+  }
+  if (_isRejection(res)) {
+    secFree(res);
+    secFreePubSecKeySet(pubsec_keys);
+    return NULL;
+  }
+  const unsigned char* server_pk = ipcCryptHelloPublicKey(res, len);
+  if (server_pk == NULL) {
+    secFree(res);
+    secFreePubSecKeySet(pubsec_keys);
+    oidc_errno = OIDC_ENOBINIPC;
+    return NULL;
+  }
+  logger(DEBUG, "Received binary server public key");
+  unsigned char* ipc_key = generateIpcKey(server_pk, pubsec_keys->sk);
+  secFree(res);
+  secFreePubSecKeySet(pubsec_keys);
+  return ipc_key;
+}
+
 unsigned char* client_keyExchange(const int sock) {
   struct pubsec_keySet* pubsec_keys = generatePubSecKeys();
   char* server_pk_base64 = communicatePublicKey(sock, (char*)pubsec_keys->pk);
-  if (server_pk_base64 == NULL) {
+  if (server_pk_base64 == NULL || _isRejection(server_pk_base64)) {
+    secFree(server_pk_base64);
     secFreePubSecKeySet(pubsec_keys);
     return NULL;
   }
@@ -11,6 +11,15 @@ struct pubsec_keySet {
   unsigned char sk[crypto_kx_SECRETKEYBYTES];
 };
 
+/**
+ * the shared key of an encrypted ipc connection and the envelope format that
+ * is used for the response
+ */
+struct ipc_key {
+  unsigned char* key;
+  unsigned char  binary;
+};
+
 char*          communicatePublicKey(const int _sock, const char* publicKey);
 unsigned char* generateIpcKey(const unsigned char* publicKey,
                               const unsigned char* privateKey);
@@ -18,8 +27,16 @@ struct pubsec_keySet* generatePubSecKeys();
 oidc_error_t ipc_cryptWrite(const int, const unsigned char*, const char*, ...);
 oidc_error_t ipc_vcryptWrite(const int, const unsigned char*, const char*,
                              va_list);
+oidc_error_t ipc_vcryptWriteBinary(const int, const unsigned char*, const char*,
+                                   va_list);
+char*        ipc_cryptReadResponse(const int sock, const unsigned char* key);
 void         secFreePubSecKeySet(struct pubsec_keySet*);
-char*        server_ipc_cryptRead(const int, const char*);
+void         secFreeIpcKey(struct ipc_key*);
+char*        server_ipc_cryptRead(const int, const char*,
+                                  struct ipc_key** session_key);
+char* server_ipc_cryptReadBinary(const int, const unsigned char* client_pk,
+                                 struct ipc_key** session_key);
 unsigned char* client_keyExchange(const int sock);
+unsigned char* client_keyExchangeBinary(const int sock);
 
 #endif  // IPC_CRYPT_H
@@ -92,7 +92,7 @@ oidc_error_t ipc_client_init(struct connection* con, unsigned char remote) {
     char*          ip         = strtok(tmp_path, ":");
     char*          port_str   = strtok(NULL, ":");
     unsigned short port       = port_str == NULL ? 0 : strToUShort(port_str);
-    con->tcp_server->sin_port = htons(port ?: 42424);
+    con->tcp_server->sin_port = htons(port ?: REMOTE_DEFAULT_PORT);
     con->tcp_server->sin_addr.s_addr =
         inet_addr(isValidIP(ip) ? ip : hostnameToIP(ip));
     secFree(tmp_path);
@@ -137,6 +137,23 @@ int ipc_connect(struct connection con) {
  */
 char* ipc_read(const int _sock) { return ipc_readWithTimeout(_sock, 0); }
 
+static char* _ipc_readBytesWithTimeout(const int _sock, time_t death,
+                                       size_t* read_len);
+
+/**
+ * @brief reads from a socket; in contrast to @c ipc_read the read data might
+ * contain null bytes
+ * @param len is set to the number of bytes read
+ * @return a pointer to the read data; it is additionally nullterminated. Has to
+ * be freed after usage.
+ */
+char* ipc_readBytes(const int _sock, size_t* len) {
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_IPC);
+  char*                buf      = _ipc_readBytesWithTimeout(_sock, 0, len);
+  memory_leaveSubsystem(previous);
+  return buf;
+}
+
 struct timeval* initTimeout(time_t death) {
   if (death == 0) {
     oidc_errno = OIDC_SUCCESS;
@@ -163,6 +180,15 @@ struct timeval* initTimeout(time_t death) {
  * is set.
  */
 char* ipc_readWithTimeout(const int _sock, time_t death) {
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_IPC);
+  char*                buf =
+      _ipc_readBytesWithTimeout(_sock, death, NULL);
+  memory_leaveSubsystem(previous);
+  return buf;
+}
+
+static char* _ipc_readBytesWithTimeout(const int _sock, time_t death,
+                                       size_t* read_len) {
   logger(DEBUG, "ipc reading from socket %d\n", _sock);
   if (_sock < 0) {
     logger(ERROR, "invalid socket in ipc_read");
@@ -212,6 +238,9 @@ char* ipc_readWithTimeout(const int _sock, time_t death) {
     logger(DEBUG, "ipc did read %d bytes in total", read_bytes);
   }
   logger(DEBUG, "ipc read '%s'", buf);
+  if (read_len != NULL) {
+    *read_len = read_bytes;
+  }
   return buf;
 }
 
@@ -230,8 +259,10 @@ oidc_error_t ipc_write(int _sock, const char* fmt, ...) {
 }
 
 oidc_error_t ipc_vwrite(int _sock, const char* fmt, va_list args) {
-  char* msg = oidc_vsprintf(fmt, args);
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_IPC);
+  char*                msg      = oidc_vsprintf(fmt, args);
   if (msg == NULL) {
+    memory_leaveSubsystem(previous);
     return oidc_errno;
   }
   size_t msg_len = strlen(msg);
@@ -241,16 +272,29 @@ oidc_error_t ipc_vwrite(int _sock, const char* fmt, va_list args) {
     secFree(msg);
     msg = oidc_strcopy(" ");
   }
-  logger(DEBUG, "ipc writing %lu bytes to socket %d", msg_len, _sock);
+  memory_leaveSubsystem(previous);
   logger(DEBUG, "ipc write message '%s'", msg);
-  ssize_t written_bytes = write(_sock, msg, msg_len);
+  oidc_error_t e = ipc_writeBytes(_sock, msg, msg_len);
   secFree(msg);
+  return e;
+}
+
+/**
+ * @brief writes binary data to a socket
+ * @param _sock the socket to write to
+ * @param buf the data to be written
+ * @param len the number of bytes to be written
+ * @return @c 0 on success; on failure an error code is returned
+ */
+oidc_error_t ipc_writeBytes(int _sock, const void* buf, size_t len) {
+  logger(DEBUG, "ipc writing %lu bytes to socket %d", len, _sock);
+  ssize_t written_bytes = write(_sock, buf, len);
   if (written_bytes < 0) {
     logger(ALERT, "writing on stream socket: %m");
     oidc_errno = OIDC_EWRITE;
     return oidc_errno;
   }
-  if ((size_t)written_bytes < msg_len) {
+  if ((size_t)written_bytes < len) {
     oidc_errno = OIDC_EMSGSIZE;
     return oidc_errno;
   }
@@ -267,6 +311,16 @@ oidc_error_t ipc_writeOidcErrno(int sock) {
  */
 int ipc_close(int _sock) { return close(_sock); }
 
+/**
+ * @brief checks without blocking if the peer of a connected socket closed its
+ * end
+ * @return @c 1 if the peer closed the connection, @c 0 otherwise
+ */
+int ipc_peerClosed(int _sock) {
+  char c;
+  return recv(_sock, &c, sizeof(c), MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
 /**
  * @brief closes an ipc connection
  * @param con, a pointer to the connection struct
@@ -15,12 +15,15 @@ int ipc_connect(struct connection con);
 
 char* ipc_read(const int _sock);
 char* ipc_readWithTimeout(const int _sock, time_t timeout);
+char* ipc_readBytes(const int _sock, size_t* len);
 
 oidc_error_t ipc_write(int _sock, const char* msg, ...);
 oidc_error_t ipc_vwrite(int _sock, const char* msg, va_list args);
+oidc_error_t ipc_writeBytes(int _sock, const void* buf, size_t len);
 oidc_error_t ipc_writeOidcErrno(int sock);
 
 int          ipc_close(int _sock);
+int          ipc_peerClosed(int _sock);
 oidc_error_t ipc_closeConnection(struct connection* con);
 oidc_error_t ipc_closeAndUnlinkConnection(struct connection* con);
 
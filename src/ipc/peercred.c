@@ -0,0 +1,42 @@
+#ifndef __APPLE__
+#define _GNU_SOURCE
+#endif
+#include "peercred.h"
+#include "utils/logger.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief determines the credentials of the peer of a unix domain socket
+ * @param sock the connected socket
+ * @param cred a pointer to the struct where the credentials are stored; the
+ * pid is @c 0 if it cannot be determined on this platform
+ * @return @c OIDC_SUCCESS on success, an error code otherwise
+ */
+oidc_error_t ipc_getPeerCredentials(int sock, struct peer_cred* cred) {
+  if (cred == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+#ifdef __APPLE__
+  cred->pid = 0;
+  if (getpeereid(sock, &cred->uid, &cred->gid) != 0) {
+    logger(ERROR, "getpeereid: %m");
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+#else
+  struct ucred ucred;
+  socklen_t    len = sizeof(ucred);
+  if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &ucred, &len) != 0) {
+    logger(ERROR, "getsockopt SO_PEERCRED: %m");
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  cred->pid = ucred.pid;
+  cred->uid = ucred.uid;
+  cred->gid = ucred.gid;
+#endif
+  return OIDC_SUCCESS;
+}
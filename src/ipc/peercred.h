@@ -0,0 +1,20 @@
+#ifndef IPC_PEERCRED_H
+#define IPC_PEERCRED_H
+
+#include "utils/oidc_error.h"
+
+#include <sys/types.h>
+
+/**
+ * the credentials of the process on the other end of a unix domain socket, as
+ * determined by the kernel
+ */
+struct peer_cred {
+  pid_t pid;
+  uid_t uid;
+  gid_t gid;
+};
+
+oidc_error_t ipc_getPeerCredentials(int sock, struct peer_cred* cred);
+
+#endif  // IPC_PEERCRED_H
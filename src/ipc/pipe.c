@@ -2,13 +2,18 @@
 #include "pipe.h"
 #include "defines/ipc_values.h"
 #include "ipc/ipc.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
 #include "utils/oidc_error.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <sys/select.h>
 #include <unistd.h>
 
 void ipc_closePipes(struct ipcPipe p) {
+  shmRing_freeChannel(p.shm);
   close(p.rx);
   close(p.tx);
 }
@@ -22,7 +27,7 @@ struct pipeSet ipc_pipe_init() {
   if (pipe2(fd1, O_DIRECT) != 0) {
 #endif
     oidc_setErrnoError();
-    return (struct pipeSet){{-1, -1}, {-1, -1}};
+    return (struct pipeSet){{-1, -1, NULL}, {-1, -1, NULL}, NULL};
   }
 #ifdef __APPLE__
   if (pipe(fd2) != 0) {
@@ -30,11 +35,28 @@ struct pipeSet ipc_pipe_init() {
   if (pipe2(fd2, O_DIRECT) != 0) {
 #endif
     oidc_setErrnoError();
-    return (struct pipeSet){{-1, -1}, {-1, -1}};
+    return (struct pipeSet){{-1, -1, NULL}, {-1, -1, NULL}, NULL};
   }
-  struct ipcPipe pipe1 = {fd1[0], fd1[1]};
-  struct ipcPipe pipe2 = {fd2[0], fd2[1]};
-  return (struct pipeSet){pipe1, pipe2};
+  struct ipcPipe pipe1 = {fd1[0], fd1[1], NULL};
+  struct ipcPipe pipe2 = {fd2[0], fd2[1], NULL};
+  return (struct pipeSet){pipe1, pipe2, NULL};
+}
+
+/**
+ * @brief creates the pipes and additionally a pair of shared memory rings;
+ * if the rings cannot be created only the pipes are used
+ */
+struct pipeSet ipc_pipe_initWithShm() {
+  struct pipeSet pipes = ipc_pipe_init();
+  if (pipes.pipe1.rx == -1) {
+    return pipes;
+  }
+  pipes.shm = shmRing_newPair(SHM_RING_CAPACITY);
+  if (pipes.shm == NULL) {
+    logger(NOTICE, "Could not set up shared memory ipc, using pipes: %s",
+           oidc_serror());
+  }
+  return pipes;
 }
 
 struct ipcPipe toServerPipes(struct pipeSet pipes) {
@@ -42,7 +64,8 @@ struct ipcPipe toServerPipes(struct pipeSet pipes) {
   close(pipes.pipe1.tx);
   server.rx = pipes.pipe1.rx;
   close(pipes.pipe2.rx);
-  server.tx = pipes.pipe2.tx;
+  server.tx  = pipes.pipe2.tx;
+  server.shm = shmRing_toChannel(pipes.shm, 0, server.rx);
   return server;
 }
 
@@ -51,7 +74,8 @@ struct ipcPipe toClientPipes(struct pipeSet pipes) {
   close(pipes.pipe1.rx);
   client.tx = pipes.pipe1.tx;
   close(pipes.pipe2.tx);
-  client.rx = pipes.pipe2.rx;
+  client.rx  = pipes.pipe2.rx;
+  client.shm = shmRing_toChannel(pipes.shm, 1, client.rx);
   return client;
 }
 
@@ -65,6 +89,12 @@ oidc_error_t ipc_writeToPipe(struct ipcPipe pipes, const char* fmt, ...) {
 
 oidc_error_t ipc_vwriteToPipe(struct ipcPipe pipes, const char* fmt,
                               va_list args) {
+  if (pipes.shm) {
+    enum memorySubsystem previous = memory_enterSubsystem(MEMORY_IPC);
+    oidc_error_t         e        = shmChannel_vwrite(pipes.shm, fmt, args);
+    memory_leaveSubsystem(previous);
+    return e;
+  }
   return ipc_vwrite(pipes.tx, fmt, args);
 }
 
@@ -72,12 +102,63 @@ oidc_error_t ipc_writeOidcErrnoToPipe(struct ipcPipe pipes) {
   return ipc_writeToPipe(pipes, RESPONSE_ERROR, oidc_serror());
 }
 
-char* ipc_readFromPipe(struct ipcPipe pipes) { return ipc_read(pipes.rx); }
+char* ipc_readFromPipe(struct ipcPipe pipes) {
+  return ipc_readFromPipeWithTimeout(pipes, 0);
+}
 
 char* ipc_readFromPipeWithTimeout(struct ipcPipe pipes, time_t timeout) {
+  if (pipes.shm) {
+    enum memorySubsystem previous = memory_enterSubsystem(MEMORY_IPC);
+    char*                msg      = shmChannel_read(pipes.shm, timeout);
+    memory_leaveSubsystem(previous);
+    return msg;
+  }
   return ipc_readWithTimeout(pipes.rx, timeout);
 }
 
+/**
+ * @brief reads from the pipe like @c ipc_readFromPipe, but stops waiting when
+ * the peer of @p sock closes its end of the connection
+ * @param sock a connected socket whose peer waits for the message
+ * @return a pointer to the message. Has to be freed after usage. If the peer
+ * of @p sock hung up before the message arrived, @c NULL is returned and
+ * @c oidc_errno is set to @c OIDC_ECANCELED; the message still has to be read.
+ */
+char* ipc_readFromPipeUnlessHangup(struct ipcPipe pipes, int sock) {
+  if (pipes.shm) {  // the rings are only checked once per second
+    while (1) {
+      char* msg = shmChannel_read(pipes.shm, time(NULL) + 1);
+      if (msg != NULL || oidc_errno != OIDC_ETIMEOUT) {
+        return msg;
+      }
+      if (ipc_peerClosed(sock)) {
+        oidc_errno = OIDC_ECANCELED;
+        return NULL;
+      }
+    }
+  }
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(pipes.rx, &set);
+  FD_SET(sock, &set);
+  int maxfd = pipes.rx > sock ? pipes.rx : sock;
+  while (select(maxfd + 1, &set, NULL, NULL, NULL) < 0) {
+    if (errno != EINTR) {
+      logger(ALERT, "error select in %s: %m", __func__);
+      oidc_errno = OIDC_ESELECT;
+      return NULL;
+    }
+    FD_ZERO(&set);
+    FD_SET(pipes.rx, &set);
+    FD_SET(sock, &set);
+  }
+  if (!FD_ISSET(pipes.rx, &set) && ipc_peerClosed(sock)) {
+    oidc_errno = OIDC_ECANCELED;
+    return NULL;
+  }
+  return ipc_readFromPipe(pipes);
+}
+
 char* ipc_vcommunicateThroughPipe(struct ipcPipe pipes, const char* fmt,
                                   va_list args) {
   if (ipc_vwriteToPipe(pipes, fmt, args) != OIDC_SUCCESS) {
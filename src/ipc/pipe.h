@@ -1,23 +1,31 @@
 #ifndef OIDC_IPC_PIPE_H
 #define OIDC_IPC_PIPE_H
 
+#include "ipc/shmRing.h"
 #include "utils/oidc_error.h"
 
 #include <stdarg.h>
 #include <time.h>
 
+/**
+ * if @c shm is set, messages are exchanged through the shared memory rings
+ * and the pipes are only used to notice that the other process died
+ */
 struct ipcPipe {
-  int rx;
-  int tx;
+  int                rx;
+  int                tx;
+  struct shmChannel* shm;
 };
 
 struct pipeSet {
-  struct ipcPipe pipe1;
-  struct ipcPipe pipe2;
+  struct ipcPipe      pipe1;
+  struct ipcPipe      pipe2;
+  struct shmRingPair* shm;
 };
 
 void           ipc_closePipes(struct ipcPipe);
 struct pipeSet ipc_pipe_init();
+struct pipeSet ipc_pipe_initWithShm();
 struct ipcPipe toServerPipes(struct pipeSet);
 struct ipcPipe toClientPipes(struct pipeSet);
 
@@ -26,6 +34,7 @@ oidc_error_t ipc_vwriteToPipe(struct ipcPipe, const char*, va_list);
 oidc_error_t ipc_writeOidcErrnoToPipe(struct ipcPipe);
 char*        ipc_readFromPipe(struct ipcPipe);
 char*        ipc_readFromPipeWithTimeout(struct ipcPipe, time_t);
+char*        ipc_readFromPipeUnlessHangup(struct ipcPipe, int sock);
 char*        ipc_communicateThroughPipe(struct ipcPipe, const char*, ...);
 char*        ipc_vcommunicateThroughPipe(struct ipcPipe, const char*, va_list);
 
@@ -2,10 +2,13 @@
 #define _XOPEN_SOURCE 700
 #endif
 #include "serveripc.h"
+#include "admission.h"
 #include "cryptIpc.h"
 #include "defines/ipc_values.h"
 #include "ipc.h"
 #include "ipc/cryptCommunicator.h"
+#include "ipc/peercred.h"
+#include "utils/crypt/ipcCryptUtils.h"
 #include "utils/db/connection_db.h"
 #include "utils/file_io/fileUtils.h"
 #include "utils/json.h"
@@ -15,20 +18,39 @@
 #include "utils/stringUtils.h"
 #include "wrapper/list.h"
 
+#include <errno.h>
+#include <grp.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/fcntl.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <time.h>
 #include <unistd.h>
 
 #define SOCKET_DIR "/tmp/oidc-XXXXXX"
+/**
+ * the first file descriptor passed with the LISTEN_FDS protocol
+ */
+#define LISTEN_FDS_START 3
 
 static char* oidc_ipc_dir       = NULL;
 static char* server_socket_path = NULL;
 
+/**
+ * Once enabled with @c server_ipc_allowPlainPeers, unencrypted requests are
+ * only accepted from peers that the kernel reports to run as the agent user,
+ * in the agent group, or - for a multi-user agent - as any user. Otherwise
+ * unencrypted requests are accepted from every peer, as they always were.
+ */
+static unsigned char plain_allowed   = 0;
+static unsigned char plain_all_users = 0;
+static unsigned char plain_use_group = 0;
+static gid_t         plain_gid       = 0;
+
 /**
  * @brief generates the socket path and prints commands for setting env vars
  * @param env_var_name the name of the environment variable which will be set.
@@ -84,6 +106,92 @@ oidc_error_t ipc_server_init(struct connection* con, const char* group_name) {
   return OIDC_SUCCESS;
 }
 
+/**
+ * @brief initializes a server unix domain socket at a fixed path; used by the
+ * multi-user system agent. The parent directory is created if it does not
+ * exist.
+ * @param con, a pointer to the connection struct. The relevant fields will be
+ * initialized.
+ * @param socket_path the path of the socket
+ */
+oidc_error_t ipc_server_initWithSocketPath(struct connection* con,
+                                           const char*        socket_path) {
+  logger(DEBUG, "initializing server ipc at %s", socket_path);
+  if (strlen(socket_path) >= sizeof(con->server->sun_path)) {
+    oidc_errno = OIDC_ESOCKINV;
+    return oidc_errno;
+  }
+  if (initServerConnection(con) != OIDC_SUCCESS) {
+    return oidc_errno;
+  }
+  char* dir = oidc_strcopy(socket_path);
+  char* sep = strrchr(dir, '/');
+  if (sep != NULL && sep != dir) {
+    *sep = '\0';
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+      logger(ALERT, "mkdir %s: %m", dir);
+      secFree(dir);
+      oidc_setErrnoError();
+      return oidc_errno;
+    }
+  }
+  secFree(dir);
+  strcpy(con->server->sun_path, socket_path);
+  server_socket_path = con->server->sun_path;
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief initializes the server connection from a listening unix domain socket
+ * passed by a service manager through the LISTEN_FDS protocol (socket
+ * activation)
+ * @param con, a pointer to the connection struct. The relevant fields will be
+ * initialized.
+ * @return @c OIDC_SUCCESS if a socket was passed; @c OIDC_ENOLISTENFD if no
+ * socket was passed to this process; another error code if the passed socket
+ * cannot be used
+ * @note the socket is already bound and listening; @c ipc_bindAndListen must
+ * not be called for it
+ */
+oidc_error_t ipc_server_initFromListenFds(struct connection* con) {
+  const char* pid_str = getenv("LISTEN_PID");
+  const char* fds_str = getenv("LISTEN_FDS");
+  if (pid_str == NULL || fds_str == NULL ||
+      (pid_t)strToULong(pid_str) != getpid()) {
+    oidc_errno = OIDC_ENOLISTENFD;
+    return oidc_errno;
+  }
+  if (strToInt(fds_str) != 1) {
+    logger(ERROR, "Expected exactly one passed socket, but got %s", fds_str);
+    oidc_errno = OIDC_ESOCKINV;
+    return oidc_errno;
+  }
+  unsetenv("LISTEN_PID");
+  unsetenv("LISTEN_FDS");
+  unsetenv("LISTEN_FDNAMES");
+  logger(DEBUG, "initializing server ipc from passed socket");
+  con->server     = secAlloc(sizeof(struct sockaddr_un));
+  con->tcp_server = secAlloc(sizeof(struct sockaddr_in));
+  con->sock       = secAlloc(sizeof(int));
+  con->msgsock    = secAlloc(sizeof(int));
+  socklen_t len   = sizeof(struct sockaddr_un);
+  if (getsockname(LISTEN_FDS_START, (struct sockaddr*)con->server, &len) !=
+          0 ||
+      con->server->sun_family != AF_UNIX) {
+    logger(ERROR, "passed socket is not a unix domain socket");
+    oidc_errno = OIDC_ESOCKINV;
+    return oidc_errno;
+  }
+  *(con->sock) = LISTEN_FDS_START;
+  fcntl(*(con->sock), F_SETFD, FD_CLOEXEC);
+  int flags;
+  if (-1 == (flags = fcntl(*(con->sock), F_GETFL, 0)))
+    flags = 0;
+  fcntl(*(con->sock), F_SETFL, flags | O_NONBLOCK);
+  server_socket_path = con->server->sun_path;
+  return OIDC_SUCCESS;
+}
+
 /**
  * @brief initializes unix domain socket with the current server_socket_path
  * @param con, a pointer to the connection struct. The relevant fields will be
@@ -108,9 +216,10 @@ char* getServerSocketPath() { return server_socket_path; }
 /**
  * @brief binds the server socket and starts listening
  * @param con, a pointer to the connection struct
+ * @param backlog the maximum length of the queue of pending connections
  * @return @c 0 on success or an errorcode on failure
  */
-int ipc_bindAndListen(struct connection* con) {
+int ipc_bindAndListen(struct connection* con, int backlog) {
   logger(DEBUG, "binding ipc\n");
   unlink(con->server->sun_path);
   if (bind(*(con->sock), (struct sockaddr*)con->server,
@@ -125,55 +234,41 @@ int ipc_bindAndListen(struct connection* con) {
     flags = 0;
   fcntl(*(con->sock), F_SETFL, flags | O_NONBLOCK);
 
-  logger(DEBUG, "listen ipc\n");
-  return listen(*(con->sock), 5);
+  logger(DEBUG, "listen ipc with backlog %d\n", backlog);
+  return listen(*(con->sock), backlog);
 }
 
 int _determineMaxSockAndAddToReadSet(int sock_listencon, fd_set* readSet) {
-  int              maxSock = sock_listencon;
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(connectionDB_getList(), LIST_HEAD);
-  while ((node = list_iterator_next(it))) {
-    struct connection* con = node->val;
+  int             maxSock     = sock_listencon;
+  const vector_t* connections = connectionDB_getList();
+  vector_foreach(connections, i) {
+    struct connection* con = vector_at(connections, i);
+    if (con->pipelined) {  // would be readable until its request is handled
+      continue;
+    }
     FD_SET(*(con->msgsock), readSet);
     if (*(con->msgsock) > maxSock) {
       maxSock = *(con->msgsock);
     }
   }
-  list_iterator_destroy(it);
   return maxSock;
 }
 
 struct connection* _checkClientSocksForMsg(fd_set* readSet) {
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(connectionDB_getList(), LIST_TAIL);
-  while ((node = list_iterator_next(it))) {
-    struct connection* con = node->val;
+  const vector_t* connections = connectionDB_getList();
+  for (size_t i = connections ? connections->len : 0; i > 0; i--) {
+    struct connection* con = vector_at(connections, i - 1);
     logger(DEBUG, "Checking client %d", *(con->msgsock));
     if (FD_ISSET(*(con->msgsock), readSet)) {
       logger(DEBUG, "New message for read av");
-      list_iterator_destroy(it);
       return con;
     }
   }
-  list_iterator_destroy(it);
   return NULL;
 }
 
-/**
- * @brief handles asynchronous server read for multiple sockets
- *
- * listens for incoming connections on the listencon and for incoming messages
- * on multiple client sockets. If a new client connects it is added to the list
- * of current client connections.  If on any client socket is a message
- * available for reading, a pointer to this connection is returned.
- * @param listencon the connection struct for the socket accepting new client
- * connections. The list is updated if a new client connects.
- * @return A pointer to a client connection. On this connection is either a
- * message avaible for reading or the client disconnected.
- */
-struct connection* ipc_readAsyncFromMultipleConnectionsWithTimeout(
-    struct connection listencon, time_t death) {
+static struct connection* _readAsyncFromMultipleConnections(
+    struct connection listencon, time_t death, unsigned char noWait) {
   while (1) {
     fd_set readSockSet;
     FD_ZERO(&readSockSet);
@@ -181,14 +276,20 @@ struct connection* ipc_readAsyncFromMultipleConnectionsWithTimeout(
     int maxSock =
         _determineMaxSockAndAddToReadSet(*(listencon.sock), &readSockSet);
 
-    struct timeval* timeout = initTimeout(death);
-    if (oidc_errno != OIDC_SUCCESS) {  // death before now
-      return NULL;
+    struct timeval* timeout = NULL;
+    if (noWait) {
+      timeout = secAlloc(sizeof(struct timeval));
+    } else {
+      timeout = initTimeout(death);
+      if (oidc_errno != OIDC_SUCCESS) {  // death before now
+        return NULL;
+      }
     }
     logger(DEBUG, "Calling select with maxSock %d and timeout %lu", maxSock,
            timeout ? timeout->tv_sec : 0);
     // Waiting for incoming connections and messages
     int ret = select(maxSock + 1, &readSockSet, NULL, NULL, timeout);
+    secFree(timeout);
     if (ret > 0) {
       if (FD_ISSET(*(listencon.sock),
                    &readSockSet)) {  // if listensock read something it means a
@@ -197,12 +298,16 @@ struct connection* ipc_readAsyncFromMultipleConnectionsWithTimeout(
         struct connection* newClient = secAlloc(sizeof(struct connection));
         newClient->msgsock           = secAlloc(sizeof(int));
         *(newClient->msgsock)        = accept(*(listencon.sock), 0, 0);
-        if (*(newClient->msgsock) >= 0) {
+        if (*(newClient->msgsock) < 0) {
+          logger(ERROR, "%m");
+          secFreeConnection(newClient);
+        } else if (admission_admit(newClient) != OIDC_SUCCESS &&
+                   newClient->rejected == OIDC_SUCCESS) {
+          secFreeConnection(newClient);  // too many pending rejections
+        } else {
           logger(DEBUG, "accepted new client sock: %d", *(newClient->msgsock));
           connectionDB_addValue(newClient);
           logger(DEBUG, "updated client list");
-        } else {
-          logger(ERROR, "%m");
         }
       }
       struct connection* con = _checkClientSocksForMsg(&readSockSet);
@@ -220,6 +325,35 @@ struct connection* ipc_readAsyncFromMultipleConnectionsWithTimeout(
   return NULL;
 }
 
+/**
+ * @brief handles asynchronous server read for multiple sockets
+ *
+ * listens for incoming connections on the listencon and for incoming messages
+ * on multiple client sockets. If a new client connects it is added to the list
+ * of current client connections.  If on any client socket is a message
+ * available for reading, a pointer to this connection is returned.
+ * @param listencon the connection struct for the socket accepting new client
+ * connections. The list is updated if a new client connects.
+ * @return A pointer to a client connection. On this connection is either a
+ * message avaible for reading or the client disconnected.
+ */
+struct connection* ipc_readAsyncFromMultipleConnectionsWithTimeout(
+    struct connection listencon, time_t death) {
+  return _readAsyncFromMultipleConnections(listencon, death, 0);
+}
+
+/**
+ * @brief like @c ipc_readAsyncFromMultipleConnectionsWithTimeout, but does
+ * not wait; new clients are accepted and a connection is only returned if a
+ * message is already available on it (or the client disconnected)
+ * @return A pointer to a client connection or @c NULL with @c oidc_errno set
+ * to @c OIDC_ETIMEOUT
+ */
+struct connection* ipc_readAsyncFromMultipleConnectionsNoWait(
+    struct connection listencon) {
+  return _readAsyncFromMultipleConnections(listencon, 0, 1);
+}
+
 char* ipc_cryptCommunicateWithServerPath(const char* fmt, ...) {
   va_list args;
   va_start(args, fmt);
@@ -232,53 +366,125 @@ char* ipc_vcryptCommunicateWithServerPath(const char* fmt, va_list args) {
   return ipc_vcryptCommunicateWithPath(server_socket_path, fmt, args);
 }
 
-extern list_t* encryptionKeys;
-
-oidc_error_t server_ipc_write(const int sock, const char* fmt, ...) {
+/**
+ * @brief writes the response to a request read with @c server_ipc_read; the
+ * response is encrypted with the session key of the connection if the
+ * request was encrypted
+ */
+oidc_error_t server_ipc_write(struct connection* con, const char* fmt, ...) {
   va_list args;
   va_start(args, fmt);
-  if (encryptionKeys == NULL || encryptionKeys->len <= 0) {
+  const int       sock    = *(con->msgsock);
+  struct ipc_key* ipc_key = con->ipc_key;
+  if (ipc_key == NULL) {
     oidc_error_t ret = ipc_vwrite(sock, fmt, args);
     va_end(args);
     return ret;
   }
-  list_node_t*   node    = list_rpop(encryptionKeys);
-  unsigned char* ipc_key = node->val;
-  LIST_FREE(node);
-
-  oidc_error_t e = ipc_vcryptWrite(sock, ipc_key, fmt, args);
+  oidc_error_t e =
+      ipc_key->binary ? ipc_vcryptWriteBinary(sock, ipc_key->key, fmt, args)
+                      : ipc_vcryptWrite(sock, ipc_key->key, fmt, args);
   va_end(args);
-  secFree(ipc_key);
   if (e == OIDC_SUCCESS) {
     return OIDC_SUCCESS;
   }
   return ipc_writeOidcErrno(sock);
 }
 
-char* server_ipc_read(const int sock) {
-  char* msg = ipc_read(sock);
-  if (isJSONObject(msg)) {
-    return msg;
+/**
+ * @brief restricts unencrypted requests to trusted local peers
+ * @param group_name if not @c NULL, peers with this group are trusted in
+ * addition to peers running as the agent user
+ * @param all_users if set, all peers are trusted; used by a multi-user agent
+ * that separates users by their peer credentials anyway
+ */
+oidc_error_t server_ipc_allowPlainPeers(const char*   group_name,
+                                        unsigned char all_users) {
+  if (group_name != NULL) {
+    errno             = 0;
+    struct group* grp = getgrnam(group_name);
+    if (grp == NULL) {
+      if (errno == 0) {
+        oidc_errno = OIDC_EGROUPNF;
+      } else {
+        oidc_setErrnoError();
+      }
+      return oidc_errno;
+    }
+    plain_gid       = grp->gr_gid;
+    plain_use_group = 1;
   }
-  char* res = server_ipc_cryptRead(sock, msg);
-  secFree(msg);
-  return res;
+  plain_all_users = all_users;
+  plain_allowed   = 1;
+  return OIDC_SUCCESS;
 }
 
-void server_ipc_freeLastKey() {
-  if (encryptionKeys == NULL || encryptionKeys->len <= 0) {
-    return;
+static int _peerMaySendPlain(int sock) {
+  if (!plain_allowed) {
+    return 1;
   }
-  list_node_t*   node = list_rpop(encryptionKeys);
-  unsigned char* key  = node->val;
-  LIST_FREE(node);
-  secFree(key);
+  struct peer_cred cred;
+  if (ipc_getPeerCredentials(sock, &cred) != OIDC_SUCCESS) {
+    return 0;
+  }
+  return plain_all_users || cred.uid == geteuid() ||
+         (plain_use_group && cred.gid == plain_gid);
 }
 
-oidc_error_t server_ipc_writeOidcErrno(const int sock) {
-  return server_ipc_write(sock, RESPONSE_ERROR, oidc_serror());
+/**
+ * @brief reads a request from a client; the request is either encrypted or, for
+ * trusted local peers, plain json
+ * @param con the client connection; the session key of an encrypted request
+ * is stored in it and replaces the key of a previous request
+ * @return the decrypted request or @c NULL on failure; if a plain request was
+ * rejected @c oidc_errno is set to @c OIDC_EPLAINIPC
+ */
+char* server_ipc_read(struct connection* con) {
+  const int sock = *(con->msgsock);
+  secFreeIpcKey(con->ipc_key);
+  con->ipc_key = NULL;
+  size_t len   = 0;
+  char*  msg = ipc_readBytes(sock, &len);
+  if (msg == NULL) {
+    return NULL;
+  }
+  if (con->rejected != OIDC_SUCCESS) {  // not admitted, answered in plain
+    secFree(msg);
+    oidc_errno = con->rejected;
+    return NULL;
+  }
+  if (isJSONObject(msg)) {
+    if (_peerMaySendPlain(sock)) {
+      return msg;
+    }
+    logger(NOTICE, "Rejected unencrypted request from untrusted peer");
+    secFree(msg);
+    oidc_errno = OIDC_EPLAINIPC;
+    return NULL;
+  }
+  const unsigned char* client_pk = ipcCryptHelloPublicKey(msg, len);
+  char* res =
+      client_pk ? server_ipc_cryptReadBinary(sock, client_pk, &con->ipc_key)
+                : server_ipc_cryptRead(sock, msg, &con->ipc_key);
+  secFree(msg);
+  return res;
 }
 
-oidc_error_t server_ipc_writeOidcErrnoPlain(const int sock) {
+oidc_error_t server_ipc_writeOidcErrno(struct connection* con) {
+  return server_ipc_write(con, RESPONSE_ERROR, oidc_serror());
+}
+
+/**
+ * @brief writes the error of a failed @c server_ipc_read; the error is sent
+ * unencrypted, because no session key was established
+ */
+oidc_error_t server_ipc_writeOidcErrnoPlain(struct connection* con) {
+  const int sock = *(con->msgsock);
+  if (oidc_errno == OIDC_EPLAINIPC) {  // tell the client to fall back
+    return ipc_write(sock, RESPONSE_ENCRYPTIONREQUIRED);
+  }
+  if (con->rejected != OIDC_SUCCESS) {  // answered before the key exchange
+    return ipc_write(sock, RESPONSE_REJECTED, oidc_serror());
+  }
   return ipc_writeOidcErrno(sock);
 }
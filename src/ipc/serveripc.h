@@ -10,18 +10,24 @@
 oidc_error_t       initServerConnection(struct connection* con);
 struct connection* ipc_readAsyncFromMultipleConnectionsWithTimeout(
     struct connection, time_t);
+struct connection* ipc_readAsyncFromMultipleConnectionsNoWait(
+    struct connection);
 char* ipc_vcryptCommunicateWithServerPath(const char* fmt, va_list args);
 char* ipc_cryptCommunicateWithServerPath(const char* fmt, ...);
 char* getServerSocketPath();
 
 oidc_error_t ipc_server_init(struct connection* con, const char* group_name);
+oidc_error_t ipc_server_initWithSocketPath(struct connection* con,
+                                           const char*        socket_path);
+oidc_error_t ipc_server_initFromListenFds(struct connection* con);
 oidc_error_t ipc_initWithPath(struct connection* con);
-int          ipc_bindAndListen(struct connection* con);
+int          ipc_bindAndListen(struct connection* con, int backlog);
 
-void         server_ipc_freeLastKey();
-char*        server_ipc_read(const int);
-oidc_error_t server_ipc_write(const int, const char*, ...);
-oidc_error_t server_ipc_writeOidcErrno(const int);
-oidc_error_t server_ipc_writeOidcErrnoPlain(const int sock);
+oidc_error_t server_ipc_allowPlainPeers(const char*   group_name,
+                                        unsigned char all_users);
+char*        server_ipc_read(struct connection* con);
+oidc_error_t server_ipc_write(struct connection* con, const char*, ...);
+oidc_error_t server_ipc_writeOidcErrno(struct connection* con);
+oidc_error_t server_ipc_writeOidcErrnoPlain(struct connection* con);
 
 #endif  // IPC_SERVER_H
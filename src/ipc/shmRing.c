@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+#include "shmRing.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <unistd.h>
+#ifndef __APPLE__
+#include <sys/eventfd.h>
+#endif
+
+#define SHM_RING_CACHELINE 64
+
+/**
+ * a single producer single consumer byte ring in shared memory. @c head and
+ * @c tail count all bytes ever written and consumed; messages are framed by a
+ * 4 byte length. A side that has to wait sets its waiting flag and sleeps on
+ * the eventfd the other side signals; the eventfds are inherited through fork,
+ * so both processes use the same numbers.
+ */
+struct shmRing {
+  uint64_t      head __attribute__((aligned(SHM_RING_CACHELINE)));
+  uint32_t      consumer_waiting;
+  uint64_t      tail __attribute__((aligned(SHM_RING_CACHELINE)));
+  uint32_t      producer_waiting;
+  int           data_fd __attribute__((aligned(SHM_RING_CACHELINE)));
+  int           space_fd;
+  uint32_t      capacity;
+  unsigned char data[] __attribute__((aligned(SHM_RING_CACHELINE)));
+};
+
+struct shmRingPair {
+  void*  map;
+  size_t map_len;
+  size_t ring_len;
+};
+
+static struct shmRing* _pairRing(const struct shmRingPair* pair,
+                                 unsigned char             i) {
+  return (struct shmRing*)((unsigned char*)pair->map + i * pair->ring_len);
+}
+
+static void _closeRingFds(struct shmRing* r) {
+  if (r->data_fd >= 0) {
+    close(r->data_fd);
+  }
+  if (r->space_fd >= 0) {
+    close(r->space_fd);
+  }
+}
+
+/**
+ * @brief creates a pair of rings in a shared memory file; must be called
+ * before forking the process that uses the other end
+ * @param capacity the number of bytes each ring can buffer
+ * @return the ring pair or @c NULL on failure; the pair is turned into a
+ * channel in each process with @c shmRing_toChannel
+ */
+struct shmRingPair* shmRing_newPair(size_t capacity) {
+#ifdef __APPLE__
+  (void)capacity;
+  oidc_errno = OIDC_NOTIMPL;
+  return NULL;
+#else
+  if (capacity == 0 || capacity > UINT32_MAX) {
+    oidc_errno = OIDC_EMSGSIZE;
+    return NULL;
+  }
+  size_t ring_len = sizeof(struct shmRing) + capacity;
+  ring_len = (ring_len + SHM_RING_CACHELINE - 1) & ~(SHM_RING_CACHELINE - 1);
+  size_t map_len = 2 * ring_len;
+  int    fd      = memfd_create("oidc-agent-ipc", MFD_CLOEXEC);
+  if (fd < 0) {
+    logger(NOTICE, "memfd_create: %m");
+    oidc_setErrnoError();
+    return NULL;
+  }
+  if (ftruncate(fd, map_len) != 0) {
+    logger(NOTICE, "ftruncate: %m");
+    oidc_setErrnoError();
+    close(fd);
+    return NULL;
+  }
+  void* map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    logger(NOTICE, "mmap: %m");
+    oidc_setErrnoError();
+    return NULL;
+  }
+  struct shmRingPair* pair = secAlloc(sizeof(struct shmRingPair));
+  pair->map                = map;
+  pair->map_len            = map_len;
+  pair->ring_len           = ring_len;
+  for (unsigned char i = 0; i < 2; i++) {
+    struct shmRing* r = _pairRing(pair, i);
+    r->capacity       = capacity;
+    r->data_fd        = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    r->space_fd       = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (r->data_fd < 0 || r->space_fd < 0) {
+      logger(NOTICE, "eventfd: %m");
+      oidc_setErrnoError();
+      for (unsigned char j = 0; j <= i; j++) {
+        _closeRingFds(_pairRing(pair, j));
+      }
+      munmap(map, map_len);
+      secFree(pair);
+      return NULL;
+    }
+  }
+  return pair;
+#endif
+}
+
+/**
+ * @brief turns a ring pair into one end of the channel; side @c 0 reads from
+ * the first ring and writes to the second one, side @c 1 the other way round
+ * @param pair the pair; it is freed
+ * @param peer_fd the rx pipe of this end; used to detect that the peer died
+ */
+struct shmChannel* shmRing_toChannel(struct shmRingPair* pair,
+                                     unsigned char side, int peer_fd) {
+  if (pair == NULL) {
+    return NULL;
+  }
+  struct shmChannel* c = secAlloc(sizeof(struct shmChannel));
+  c->rx                = _pairRing(pair, side ? 1 : 0);
+  c->tx                = _pairRing(pair, side ? 0 : 1);
+  c->map               = pair->map;
+  c->map_len           = pair->map_len;
+  c->peer_fd           = peer_fd;
+  secFree(pair);
+  return c;
+}
+
+void shmRing_freeChannel(struct shmChannel* c) {
+  if (c == NULL) {
+    return;
+  }
+  _closeRingFds(c->rx);
+  _closeRingFds(c->tx);
+  munmap(c->map, c->map_len);
+  secFree(c);
+}
+
+static void _signal(int fd) {
+  uint64_t one = 1;
+  if (write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+    logger(ERROR, "eventfd write: %m");
+  }
+}
+
+/**
+ * @brief waits until @p fd is signalled
+ * @param death the point in time until which to wait; @c 0 for no timeout
+ * @return @c OIDC_SUCCESS if the caller should check the ring again;
+ * @c OIDC_EIPCDIS if the peer died; @c OIDC_EINTR if a signal arrived, so that
+ * the caller can check for termination
+ */
+static oidc_error_t _wait(int fd, int peer_fd, time_t death) {
+  struct timeval  tv;
+  struct timeval* timeout = NULL;
+  if (death) {
+    time_t now = time(NULL);
+    if (death <= now) {
+      return OIDC_ETIMEOUT;
+    }
+    tv      = (struct timeval){.tv_sec = death - now};
+    timeout = &tv;
+  }
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(fd, &set);
+  FD_SET(peer_fd, &set);
+  int rv = select((fd > peer_fd ? fd : peer_fd) + 1, &set, NULL, NULL, timeout);
+  if (rv == -1) {
+    if (errno == EINTR) {
+      return OIDC_EINTR;
+    }
+    logger(ALERT, "error select in %s: %m", __func__);
+    return OIDC_ESELECT;
+  }
+  if (rv == 0) {
+    return OIDC_ETIMEOUT;
+  }
+  if (FD_ISSET(peer_fd, &set) && !FD_ISSET(fd, &set)) {
+    logger(DEBUG, "Peer of shared memory ipc disconnected");
+    return OIDC_EIPCDIS;
+  }
+  uint64_t count;
+  if (read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    logger(ERROR, "eventfd read: %m");
+  }
+  return OIDC_SUCCESS;
+}
+
+static void _copyIn(struct shmRing* r, uint64_t pos, const unsigned char* src,
+                    size_t n) {
+  size_t off   = pos % r->capacity;
+  size_t first = r->capacity - off < n ? r->capacity - off : n;
+  memcpy(r->data + off, src, first);
+  memcpy(r->data, src + first, n - first);
+}
+
+/**
+ * @brief appends @p hdr followed by @p buf to the tx ring; both are published
+ * together if they fit, so that the reader is woken up only once
+ */
+static oidc_error_t _ringPut(struct shmChannel* c, const unsigned char* hdr,
+                             size_t hdr_len, const unsigned char* buf,
+                             size_t len) {
+  struct shmRing* r = c->tx;
+  while (hdr_len + len > 0) {
+    uint64_t head  = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    uint64_t tail  = __atomic_load_n(&r->tail, __ATOMIC_SEQ_CST);
+    size_t   space = r->capacity - (size_t)(head - tail);
+    if (space == 0) {  // backpressure: wait until the reader consumed data
+      __atomic_store_n(&r->producer_waiting, 1, __ATOMIC_SEQ_CST);
+      oidc_error_t e = OIDC_SUCCESS;
+      if (__atomic_load_n(&r->tail, __ATOMIC_SEQ_CST) == tail) {
+        e = _wait(r->space_fd, c->peer_fd, 0);
+      }
+      __atomic_store_n(&r->producer_waiting, 0, __ATOMIC_SEQ_CST);
+      // a partly written message cannot be taken back
+      if (e != OIDC_SUCCESS && e != OIDC_EINTR) {
+        oidc_errno = e == OIDC_EIPCDIS ? OIDC_EWRITE : e;
+        return oidc_errno;
+      }
+      continue;
+    }
+    size_t n_hdr = hdr_len < space ? hdr_len : space;
+    size_t n_buf = len < space - n_hdr ? len : space - n_hdr;
+    _copyIn(r, head, hdr, n_hdr);
+    _copyIn(r, head + n_hdr, buf, n_buf);
+    __atomic_store_n(&r->head, head + n_hdr + n_buf, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->consumer_waiting, __ATOMIC_SEQ_CST)) {
+      _signal(r->data_fd);
+    }
+    hdr += n_hdr;
+    hdr_len -= n_hdr;
+    buf += n_buf;
+    len -= n_buf;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief consumes @p len bytes from the rx ring; consumed bytes are wiped
+ * @param death only applies while no byte was received yet, so that a message
+ * is never left half read
+ * @param interruptible if a signal may interrupt the wait before the first
+ * byte was received
+ */
+static oidc_error_t _ringGet(struct shmChannel* c, unsigned char* buf,
+                             size_t len, time_t death,
+                             unsigned char interruptible) {
+  struct shmRing* r   = c->rx;
+  size_t          got = 0;
+  while (got < len) {
+    uint64_t tail      = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    uint64_t head      = __atomic_load_n(&r->head, __ATOMIC_SEQ_CST);
+    size_t   available = (size_t)(head - tail);
+    if (available == 0) {
+      __atomic_store_n(&r->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+      oidc_error_t e = OIDC_SUCCESS;
+      if (__atomic_load_n(&r->head, __ATOMIC_SEQ_CST) == head) {
+        e = _wait(r->data_fd, c->peer_fd, got ? 0 : death);
+      }
+      __atomic_store_n(&r->consumer_waiting, 0, __ATOMIC_SEQ_CST);
+      if (e == OIDC_EINTR && (got > 0 || !interruptible)) {
+        continue;
+      }
+      if (e != OIDC_SUCCESS) {
+        oidc_errno = e;
+        return oidc_errno;
+      }
+      continue;
+    }
+    size_t n     = len - got < available ? len - got : available;
+    size_t off   = tail % r->capacity;
+    size_t first = r->capacity - off < n ? r->capacity - off : n;
+    memcpy(buf + got, r->data + off, first);
+    memcpy(buf + got + first, r->data, n - first);
+    memset(r->data + off, 0, first);
+    memset(r->data, 0, n - first);
+    __atomic_store_n(&r->tail, tail + n, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->producer_waiting, __ATOMIC_SEQ_CST)) {
+      _signal(r->space_fd);
+    }
+    got += n;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief writes a message to the channel; blocks while the ring is full
+ * @return @c OIDC_SUCCESS or an error code; @c OIDC_EWRITE if the peer died
+ */
+oidc_error_t shmChannel_writeBytes(struct shmChannel* c, const char* msg,
+                                   size_t len) {
+  if (len > UINT32_MAX) {
+    oidc_errno = OIDC_EMSGSIZE;
+    return oidc_errno;
+  }
+  uint32_t frame_len = len;
+  return _ringPut(c, (const unsigned char*)&frame_len, sizeof(frame_len),
+                  (const unsigned char*)msg, len);
+}
+
+oidc_error_t shmChannel_vwrite(struct shmChannel* c, const char* fmt,
+                               va_list args) {
+  char* msg = oidc_vsprintf(fmt, args);
+  if (msg == NULL) {
+    return oidc_errno;
+  }
+  logger(DEBUG, "ipc write message '%s' to shared memory", msg);
+  oidc_error_t e = shmChannel_writeBytes(c, msg, strlen(msg));
+  secFree(msg);
+  return e;
+}
+
+/**
+ * @brief reads the next message from the channel
+ * @param death the point in time until which to wait; @c 0 for no timeout
+ * @return the message or @c NULL on failure; @c oidc_errno is set to
+ * @c OIDC_ETIMEOUT if @p death was reached, to @c OIDC_EIPCDIS if the peer
+ * died and to @c OIDC_EINTR if a signal arrived before the message. Has to be
+ * freed after usage.
+ */
+char* shmChannel_read(struct shmChannel* c, time_t death) {
+  uint32_t len;
+  if (_ringGet(c, (unsigned char*)&len, sizeof(len), death, 1) !=
+      OIDC_SUCCESS) {
+    return NULL;
+  }
+  char* msg = secAlloc(len + 1);
+  if (_ringGet(c, (unsigned char*)msg, len, 0, 0) != OIDC_SUCCESS) {
+    secFree(msg);
+    return NULL;
+  }
+  logger(DEBUG, "ipc read '%s' from shared memory", msg);
+  return msg;
+}
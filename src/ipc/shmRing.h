@@ -0,0 +1,44 @@
+#ifndef OIDC_IPC_SHMRING_H
+#define OIDC_IPC_SHMRING_H
+
+#include "utils/oidc_error.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+
+/**
+ * capacity of each ring direction; larger messages are streamed through the
+ * ring, the writer waits until the reader made space
+ */
+#define SHM_RING_CAPACITY (64 * 1024)
+
+struct shmRing;
+struct shmRingPair;
+
+/**
+ * one end of a shared memory ring pair; it is used like the two pipes of a
+ * @c struct @c ipcPipe. @c peer_fd is the rx pipe of the same end; nothing is
+ * sent over it while the rings are used, so it only becomes readable (EOF)
+ * when the other process died.
+ */
+struct shmChannel {
+  struct shmRing* rx;
+  struct shmRing* tx;
+  void*           map;
+  size_t          map_len;
+  int             peer_fd;
+};
+
+struct shmRingPair* shmRing_newPair(size_t capacity);
+struct shmChannel*  shmRing_toChannel(struct shmRingPair* pair,
+                                      unsigned char side, int peer_fd);
+void                shmRing_freeChannel(struct shmChannel* channel);
+
+oidc_error_t shmChannel_writeBytes(struct shmChannel* channel,
+                                   const char* msg, size_t len);
+oidc_error_t shmChannel_vwrite(struct shmChannel* channel, const char* fmt,
+                               va_list args);
+char*        shmChannel_read(struct shmChannel* channel, time_t death);
+
+#endif  // OIDC_IPC_SHMRING_H
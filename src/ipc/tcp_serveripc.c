@@ -5,22 +5,28 @@
 
 #include <arpa/inet.h>
 #include <sys/fcntl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 /**
  * @brief initializes a server tcp socket
  * @param con, a pointer to the connection struct. The relevant fields will be
  * initialized.
+ * @param address the IPv4 address to bind to
  */
-oidc_error_t ipc_tcp_server_init(struct connection* con, unsigned short port) {
+oidc_error_t ipc_tcp_server_init(struct connection* con, const char* address,
+                                 unsigned short port) {
   logger(DEBUG, "initializing server ipc");
   if (initConnectionWithoutPath(con, 1, 1) != OIDC_SUCCESS) {
     return oidc_errno;
   }
 
-  con->tcp_server->sin_port        = htons(port);
-  con->tcp_server->sin_addr.s_addr = INADDR_ANY;
-  // con->tcp_server->sin_addr.s_addr = inet_addr("127.0.0.1");
+  con->tcp_server->sin_port = htons(port);
+  if (inet_pton(AF_INET, address, &con->tcp_server->sin_addr) != 1) {
+    oidc_seterror("Invalid IPv4 address");
+    oidc_errno = OIDC_EERROR;
+    return oidc_errno;
+  }
 
   return OIDC_SUCCESS;
 }
@@ -32,6 +38,11 @@ oidc_error_t ipc_tcp_server_init(struct connection* con, unsigned short port) {
  */
 int ipc_tcp_bindAndListen(struct connection* con) {
   logger(DEBUG, "binding tcp ipc\n");
+  int reuse = 1;
+  if (setsockopt(*(con->sock), SOL_SOCKET, SO_REUSEADDR, &reuse,
+                 sizeof(reuse))) {
+    logger(WARNING, "setsockopt SO_REUSEADDR: %m");
+  }
   if (bind(*(con->sock), (struct sockaddr*)con->tcp_server,
            sizeof(struct sockaddr_in))) {
     logger(ALERT, "binding stream socket: %m");
@@ -44,7 +55,9 @@ int ipc_tcp_bindAndListen(struct connection* con) {
   if (-1 == (flags = fcntl(*(con->sock), F_GETFL, 0)))
     flags = 0;
   fcntl(*(con->sock), F_SETFL, flags | O_NONBLOCK);
+  fcntl(*(con->sock), F_SETFD, FD_CLOEXEC);
 
   logger(DEBUG, "listen ipc\n");
-  return listen(*(con->sock), 5);
+  // Many remote clients might connect at once, so use the maximum backlog
+  return listen(*(con->sock), SOMAXCONN);
 }
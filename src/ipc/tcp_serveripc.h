@@ -7,7 +7,8 @@
 #include <stdarg.h>
 #include <time.h>
 
-oidc_error_t ipc_tcp_server_init(struct connection* con, unsigned short port);
+oidc_error_t ipc_tcp_server_init(struct connection* con, const char* address,
+                                 unsigned short port);
 int          ipc_tcp_bindAndListen(struct connection* con);
 
 #endif  // IPC_TCP_SERVER_H
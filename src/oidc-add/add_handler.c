@@ -78,7 +78,9 @@ void add_handleRemove(const char* account, struct arguments* arguments) {
 }
 
 void add_handleRemoveAll(struct arguments* arguments) {
-  char* res = ipc_cryptCommunicate(arguments->remote, REQUEST_REMOVEALL);
+  char* res = ipc_cryptCommunicate(
+      arguments->remote,
+      arguments->revoke ? REQUEST_REMOVEALL_REVOKE : REQUEST_REMOVEALL);
   add_parseResponse(res);
 }
 
@@ -14,12 +14,17 @@
 #define OPT_PW_FILE 7
 #define OPT_REMOTE 8
 #define OPT_PW_ENV 9
+#define OPT_REVOKE 10
 
 static struct argp_option options[] = {
     {0, 0, 0, 0, "General:", 1},
     {"remove", 'r', 0, 0, "The account configuration is removed, not added", 1},
     {"remove-all", 'R', 0, 0,
      "Removes all account configurations currently loaded", 1},
+    {"revoke", OPT_REVOKE, 0, 0,
+     "Used with --remove-all: Also revokes the refresh tokens of the removed "
+     "account configurations",
+     1},
     {"list", 'l', 0, 0, "Lists all configured account configurations", 1},
     {"loaded", 'a', 0, 0, "Lists the currently loaded account configurations",
      1},
@@ -124,6 +129,7 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
       break;
     case OPT_SECCOMP: arguments->seccomp = 1; break;
     case OPT_REMOTE: arguments->remote = 1; break;
+    case OPT_REVOKE: arguments->revoke = 1; break;
     case 'h':
       argp_state_help(state, state->out_stream, ARGP_HELP_STD_HELP);
       break;
@@ -134,6 +140,9 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
       arguments->args[state->arg_num] = arg;
       break;
     case ARGP_KEY_END:
+      if (arguments->revoke && !arguments->removeAll) {
+        argp_usage(state);
+      }
       if (arguments->listConfigured || arguments->listLoaded ||
           arguments->lock || arguments->unlock || arguments->removeAll) {
         break;
@@ -177,6 +186,7 @@ void initArguments(struct arguments* arguments) {
   arguments->confirm                 = 0;
   arguments->always_allow_idtoken    = 0;
   arguments->remote                  = 0;
+  arguments->revoke                  = 0;
   arguments->pw_prompt_mode          = PROMPT_MODE_CLI;
   set_pw_prompt_mode(arguments->pw_prompt_mode);
 }
@@ -28,6 +28,7 @@ struct arguments {
   unsigned char always_allow_idtoken;
   unsigned char pw_prompt_mode;
   unsigned char remote;
+  unsigned char revoke;
 
   struct lifetimeArg pw_lifetime;
   struct lifetimeArg lifetime;
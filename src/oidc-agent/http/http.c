@@ -1,5 +1,6 @@
 #include "http.h"
 
+#include "http_errorHandler.h"
 #include "http_handler.h"
 #include "http_postHandler.h"
 #include "utils/agentLogger.h"
@@ -123,3 +124,118 @@ char* _httpsPOST(const char* url, const char* data, struct curl_slist* headers,
   agent_log(DEBUG, "Response: %s\n", s.ptr ? s.ptr : "(null)");
   return s.ptr;
 }
+
+static CURL* _addPOST(CURLM* multi, const struct http_postRequest* request,
+                      struct string* s, long timeout) {
+  CURL* curl = curl_easy_init();
+  if (curl == NULL) {
+    oidc_errno = OIDC_ECURLI;
+    return NULL;
+  }
+  setUrl(curl, request->url);
+  curl_easy_setopt(curl, CURLOPT_POST, 1L);
+  if (setWriteFunction(curl, s) != OIDC_SUCCESS) {
+    curl_easy_cleanup(curl);
+    return NULL;
+  }
+  setPostData(curl, request->data);
+  setSSLOpts(curl, request->cert_path);
+  if (request->username) {
+    setBasicAuth(curl, request->username, request->password ?: "");
+  }
+  if (timeout > 0) {
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
+  }
+  curl_easy_setopt(curl, CURLOPT_PRIVATE, s);
+  curl_multi_add_handle(multi, curl);
+  return curl;
+}
+
+/**
+ * @brief does https POST requests concurrently on a single curl multi handle;
+ * at most @p max_per_group transfers of the same group run at a time
+ * @param timeout the maximum duration of a single transfer in seconds; @c 0
+ * for no limit
+ * @param callback is called for each request as soon as it finished
+ */
+void _httpsPOSTBatch(const struct http_postRequest* requests, size_t n,
+                     size_t max_per_group, long timeout,
+                     http_batchCallback callback, void* arg) {
+  if (n == 0) {
+    return;
+  }
+  if (initGlobal() != OIDC_SUCCESS) {
+    for (size_t i = 0; i < n; i++) {
+      callback(i, oidc_errno, NULL, arg);
+    }
+    return;
+  }
+  CURLM*         multi     = curl_multi_init();
+  struct string* responses = secCalloc(n, sizeof(struct string));
+  size_t*        group     = secCalloc(n, sizeof(size_t));  // first request
+  size_t*        active    = secCalloc(n, sizeof(size_t));  // of the group
+  unsigned char* started   = secCalloc(n, sizeof(unsigned char));
+  for (size_t i = 0; i < n; i++) {
+    group[i] = i;
+    for (size_t j = 0; j < i; j++) {
+      if (strequal(requests[j].group, requests[i].group)) {
+        group[i] = j;
+        break;
+      }
+    }
+  }
+  size_t finished = 0;
+  while (finished < n) {
+    for (size_t i = 0; i < n; i++) {
+      if (started[i] || active[group[i]] >= max_per_group) {
+        continue;
+      }
+      started[i] = 1;
+      agent_log(DEBUG, "Https POST to: %s", requests[i].url);
+      if (_addPOST(multi, requests + i, responses + i, timeout) == NULL) {
+        finished++;
+        callback(i, oidc_errno, NULL, arg);
+        continue;
+      }
+      active[group[i]]++;
+    }
+    int running = 0;
+    curl_multi_perform(multi, &running);
+    CURLMsg* msg;
+    int      queued;
+    while ((msg = curl_multi_info_read(multi, &queued))) {
+      if (msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+      CURL*          curl = msg->easy_handle;
+      struct string* s    = NULL;
+      curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**)&s);
+      const size_t i   = s - responses;
+      oidc_error_t err = CURLTransferErrorHandling(msg->data.result, curl);
+      curl_multi_remove_handle(multi, curl);
+      curl_easy_cleanup(curl);
+      active[group[i]]--;
+      finished++;
+      if (err != OIDC_SUCCESS && err >= 200 && err < 600 && strValid(s->ptr)) {
+        err = OIDC_SUCCESS;  // the caller checks the error response
+      }
+      if (err != OIDC_SUCCESS) {
+        secFree(s->ptr);
+        s->ptr = NULL;
+      }
+      agent_log(DEBUG, "Response: %s\n", s->ptr ? s->ptr : "(null)");
+      callback(i, err, s->ptr, arg);
+      secFree(s->ptr);
+      s->ptr = NULL;
+    }
+    if (finished < n && running) {
+      curl_multi_wait(multi, NULL, 0, 1000, NULL);
+    }
+  }
+  curl_multi_cleanup(multi);
+  secFree(responses);
+  secFree(group);
+  secFree(active);
+  secFree(started);
+  cleanupGlobal();
+}
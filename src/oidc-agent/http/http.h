@@ -1,7 +1,30 @@
 #ifndef HTTP_H
 #define HTTP_H
 
+#include "utils/oidc_error.h"
+
 #include <curl/curl.h>
+#include <stddef.h>
+
+/**
+ * a POST request of a batch; requests with the same @c group (e.g. the
+ * issuer) share one limit of concurrent transfers
+ */
+struct http_postRequest {
+  const char* url;
+  const char* data;
+  const char* cert_path;
+  const char* username;
+  const char* password;
+  const char* group;
+};
+
+/**
+ * called for every finished request of a batch with the index of the request;
+ * @p response is @c NULL if the request failed and is freed afterwards
+ */
+typedef void (*http_batchCallback)(size_t i, oidc_error_t err,
+                                   const char* response, void* arg);
 
 char* _httpsGET(const char* url, struct curl_slist* list,
                 const char* cert_path);
@@ -10,4 +33,7 @@ char* _httpsPOST(const char* url, const char* data, struct curl_slist* headers,
                  const char* password);
 char* _httpsDELETE(const char* url, struct curl_slist* headers,
                    const char* cert_path, const char* bearer_token);
+void  _httpsPOSTBatch(const struct http_postRequest* requests, size_t n,
+                      size_t max_per_group, long timeout,
+                      http_batchCallback callback, void* arg);
 #endif
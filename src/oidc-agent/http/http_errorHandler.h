@@ -5,5 +5,6 @@
 #include "utils/oidc_error.h"
 
 oidc_error_t CURLErrorHandling(int res, CURL* curl);
+oidc_error_t CURLTransferErrorHandling(int res, CURL* curl);
 
 #endif  // HTTP_ERRORHANDLER_H
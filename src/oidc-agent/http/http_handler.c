@@ -23,22 +23,36 @@ static size_t write_callback(void* ptr, size_t size, size_t nmemb,
   return size * nmemb;
 }
 
+/** @fn oidc_error_t initGlobal()
+ * @brief initializes the global curl state; has to be balanced by a call to
+ * @c cleanupGlobal
+ * @return an oidc_error code
+ */
+oidc_error_t initGlobal() {
+  CURLcode res = curl_global_init_mem(CURL_GLOBAL_ALL, secAlloc, _secFree,
+                                      secRealloc, oidc_strcopy, secCalloc);
+  return CURLErrorHandling(res, NULL);
+}
+
+/** @fn void cleanupGlobal()
+ * @brief releases the global curl state
+ */
+void cleanupGlobal() { curl_global_cleanup(); }
+
 /** @fn CURL* init()
  * @brief initializes curl
  * @return a CURL pointer
  */
 CURL* init() {
-  CURLcode res = curl_global_init_mem(CURL_GLOBAL_ALL, secAlloc, _secFree,
-                                      secRealloc, oidc_strcopy, secCalloc);
-  if (CURLErrorHandling(res, NULL) != OIDC_SUCCESS) {
+  if (initGlobal() != OIDC_SUCCESS) {
     return NULL;
   }
 
   CURL* curl = curl_easy_init();
   if (!curl) {
     curl_global_cleanup();
-    agent_log(ALERT, "%s (%s:%d) Couldn't init curl. %s\n", __func__, __FILE__,
-              __LINE__, curl_easy_strerror(res));
+    agent_log(ALERT, "%s (%s:%d) Couldn't init curl.\n", __func__, __FILE__,
+              __LINE__);
     oidc_errno = OIDC_ECURLI;
     return NULL;
   }
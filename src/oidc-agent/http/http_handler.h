@@ -6,6 +6,8 @@
 
 #include <curl/curl.h>
 
+oidc_error_t initGlobal();
+void         cleanupGlobal();
 CURL*        init();
 void         setSSLOpts(CURL* curl, const char* cert_file);
 oidc_error_t setWriteFunction(CURL* curl, struct string* s);
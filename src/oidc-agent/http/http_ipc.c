@@ -1,9 +1,13 @@
+#define _XOPEN_SOURCE 500
 #include "http_ipc.h"
+#include "ipc/cancelPipe.h"
 #include "ipc/pipe.h"
 #include "utils/agentLogger.h"
 #include "utils/memory.h"
 #include "utils/oidc_error.h"
+#include "utils/stringUtils.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -11,8 +15,49 @@
 #include <sys/select.h>
 #include <unistd.h>
 
-char* _handleParent(struct ipcPipe pipes) {
-  char* e = ipc_readFromPipe(pipes);
+/**
+ * if set, http transfers are not aborted when oidcp cancels the request
+ */
+static unsigned char cancel_deferred = 0;
+
+/**
+ * @brief defers the cancellation of the current request while transfers
+ * whose response must not be lost are running, e.g. a refresh that can
+ * rotate the refresh token. A cancellation that arrives in the meantime
+ * aborts the next transfer instead.
+ */
+void http_deferCancel(unsigned char defer) { cancel_deferred = defer; }
+
+/**
+ * @brief reads the response of the http child; if oidcp cancels the request
+ * in the meantime, the child is killed instead
+ */
+static char* _readResponseUnlessCancelled(struct ipcPipe pipes, pid_t pid) {
+  const int cancel_fd = cancel_deferred ? -1 : cancelPipe_getFd();
+  if (cancel_fd >= 0) {
+    fd_set set;
+    int    rv;
+    do {
+      FD_ZERO(&set);
+      FD_SET(pipes.rx, &set);
+      FD_SET(cancel_fd, &set);
+      rv = select((pipes.rx > cancel_fd ? pipes.rx : cancel_fd) + 1, &set,
+                  NULL, NULL, NULL);
+    } while (rv == -1 && errno == EINTR);
+    if (rv > 0 && !FD_ISSET(pipes.rx, &set) && cancelPipe_consume()) {
+      agent_log(NOTICE, "Request cancelled, aborting http transfer");
+      kill(pid, SIGKILL);
+      oidc_errno = OIDC_ECANCELED;
+      return NULL;
+    }
+  }
+  return ipc_readFromPipe(pipes);
+}
+
+char* _handleParent(struct ipcPipe pipes, pid_t pid) {
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_HTTP);
+  char*                e        = _readResponseUnlessCancelled(pipes, pid);
+  memory_leaveSubsystem(previous);
   ipc_closePipes(pipes);
   if (e == NULL) {
     return NULL;
@@ -74,7 +119,7 @@ char* httpsGET(const char* url, struct curl_slist* headers,
   } else {  // parent
     signal(SIGCHLD, SIG_IGN);
     struct ipcPipe parentPipes = toServerPipes(pipes);
-    return _handleParent(parentPipes);
+    return _handleParent(parentPipes, pid);
   }
 }
 
@@ -106,7 +151,7 @@ char* httpsDELETE(const char* url, struct curl_slist* headers,
   } else {  // parent
     signal(SIGCHLD, SIG_IGN);
     struct ipcPipe parentPipes = toServerPipes(pipes);
-    return _handleParent(parentPipes);
+    return _handleParent(parentPipes, pid);
   }
 }
 
@@ -140,7 +185,7 @@ char* httpsPOST(const char* url, const char* data, struct curl_slist* headers,
     return NULL;
   } else {  // parent
     struct ipcPipe parentPipes = toServerPipes(pipes);
-    return _handleParent(parentPipes);
+    return _handleParent(parentPipes, pid);
   }
 }
 
@@ -154,3 +199,74 @@ char* sendPostDataWithoutBasicAuth(const char* endpoint, const char* data,
                                    const char* cert_path) {
   return httpsPOST(endpoint, data, NULL, cert_path, NULL, NULL);
 }
+
+static void _writeBatchResult(size_t i, oidc_error_t err, const char* response,
+                              void* arg) {
+  struct ipcPipe* pipes = arg;
+  if (response == NULL) {
+    oidc_errno = err;
+    agent_log(ERROR, "Batch request %lu failed: %s", i, oidc_serror());
+  }
+  // the parent might have stopped waiting; the request is still logged
+  ipc_writeToPipe(*pipes, "%lu %d %s", i, err, response ?: "");
+}
+
+/**
+ * @brief forks and does the https POST requests concurrently, see
+ * @c _httpsPOSTBatch
+ * @return the pipes from which the results are read with
+ * @c http_readBatchResult, one message per request in the order in which they
+ * finish. The child keeps running if the pipes are closed before all results
+ * were read. On failure @c rx is @c -1.
+ */
+struct ipcPipe httpsPOSTBatch(const struct http_postRequest* requests,
+                              size_t n, size_t max_per_group, long timeout) {
+  struct pipeSet pipes = ipc_pipe_init();
+  if (pipes.pipe1.rx == -1) {
+    return pipes.pipe1;
+  }
+  pid_t pid = fork();
+  if (pid == -1) {
+    agent_log(ALERT, "fork %m");
+    oidc_setErrnoError();
+    ipc_closePipes(toServerPipes(pipes));
+    return (struct ipcPipe){-1, -1, NULL};
+  }
+  if (pid == 0) {  // child
+    struct ipcPipe childPipes = toClientPipes(pipes);
+    logger_open("oidc-agent.http");
+    signal(SIGPIPE, SIG_IGN);
+    _httpsPOSTBatch(requests, n, max_per_group, timeout, _writeBatchResult,
+                    &childPipes);
+    ipc_closePipes(childPipes);
+    exit(EXIT_SUCCESS);
+  }
+  signal(SIGCHLD, SIG_IGN);
+  return toServerPipes(pipes);
+}
+
+/**
+ * @brief reads the next result of @c httpsPOSTBatch
+ * @param deadline the time until which is waited; @c 0 to wait without limit
+ * @param i is set to the index of the request
+ * @param err is set to the error of the request
+ * @param response is set to the response; @c NULL if the request failed.
+ * Has to be freed after usage.
+ * @return an oidc_error code whether a result could be read, e.g.
+ * @c OIDC_ETIMEOUT if none arrived until @p deadline
+ */
+oidc_error_t http_readBatchResult(struct ipcPipe pipes, time_t deadline,
+                                  size_t* i, oidc_error_t* err,
+                                  char** response) {
+  char* msg = ipc_readFromPipeWithTimeout(pipes, deadline);
+  if (msg == NULL) {
+    return oidc_errno;
+  }
+  char* end = NULL;
+  *i        = strtoul(msg, &end, 10);
+  *err      = strtol(end, &end, 10);
+  *response =
+      *err == OIDC_SUCCESS ? oidc_strcopy(*end ? end + 1 : end) : NULL;
+  secFree(msg);
+  return OIDC_SUCCESS;
+}
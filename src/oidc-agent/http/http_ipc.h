@@ -2,6 +2,9 @@
 #define HTTP_IPC_H
 
 #include "http.h"
+#include "ipc/pipe.h"
+
+#include <time.h>
 
 #define HTTP_HEADER_CONTENTTYPE_JSON "Content-Type: application/json"
 #define HTTP_HEADER_AUTHORIZATION_BEARER_FMT "Authorization: Bearer %s"
@@ -19,4 +22,12 @@ char* sendPostDataWithBasicAuth(const char* endpoint, const char* data,
 char* sendPostDataWithoutBasicAuth(const char* endpoint, const char* data,
                                    const char* cert_path);
 
+struct ipcPipe httpsPOSTBatch(const struct http_postRequest* requests,
+                              size_t n, size_t max_per_group, long timeout);
+oidc_error_t   http_readBatchResult(struct ipcPipe pipes, time_t deadline,
+                                    size_t* i, oidc_error_t* err,
+                                    char** response);
+
+void http_deferCancel(unsigned char defer);
+
 #endif  // HTTP_IPC_H
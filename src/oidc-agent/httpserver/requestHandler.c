@@ -1,6 +1,7 @@
 #define _XOPEN_SOURCE
 
 #include "requestHandler.h"
+#include "running_server.h"
 
 #include "defines/ipc_values.h"
 #include "ipc/serveripc.h"
@@ -10,7 +11,6 @@
 #include "utils/parseJson.h"
 #include "utils/stringUtils.h"
 
-#include <signal.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -71,7 +71,8 @@ static int makeResponseWrongState(struct MHD_Connection* connection) {
   return ret;
 }
 
-static int makeResponseError(struct MHD_Connection* connection) {
+static int makeResponseError(struct MHD_Connection* connection,
+                             struct running_server* server) {
   const char* error =
       MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "error");
   const char* error_description = MHD_lookup_connection_value(
@@ -85,7 +86,9 @@ static int makeResponseError(struct MHD_Connection* connection) {
     response = MHD_create_response_from_buffer(strlen(res), (void*)res,
                                                MHD_RESPMEM_MUST_COPY);
     secFree(res);
-    kill(getpid(), SIGTERM);
+    removeFlowFromServer(server,
+                         MHD_lookup_connection_value(
+                             connection, MHD_GET_ARGUMENT_KIND, "state"));
   } else {
     response = MHD_create_response_from_buffer(
         strlen(HTML_NO_CODE), (void*)HTML_NO_CODE, MHD_RESPMEM_PERSISTENT);
@@ -101,15 +104,17 @@ static int handleRequest(void* cls, struct MHD_Connection* connection) {
   const char* state =
       MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "state");
 
+  struct running_server* server = cls;
   if (code == NULL) {
-    return makeResponseError(connection);
+    return makeResponseError(connection, server);
   }
   agent_log(DEBUG, "HttpServer: Code is %s", code);
-  char** cr = (char**)cls;
-  if (!strequal(cr[1], state)) {
+  char* redirect_uri = getRedirectUriForState(server, state);
+  if (redirect_uri == NULL) {
     return makeResponseWrongState(connection);
   }
-  char* url = oidc_sprintf("%s?code=%s&state=%s", cr[0], code, state);
+  char* url = oidc_sprintf("%s?code=%s&state=%s", redirect_uri, code, state);
+  secFree(redirect_uri);
   char* res = ipc_cryptCommunicateWithServerPath(REQUEST_CODEEXCHANGE, url);
   int   ret;
   if (res == NULL) {
@@ -119,7 +124,7 @@ static int handleRequest(void* cls, struct MHD_Connection* connection) {
     ret = makeResponseFromIPCResponse(connection, res, url, state);
   }
   secFree(url);
-  secFreeArray(cr, 2);
+  removeFlowFromServer(server, state);
   return ret;
 }
 
@@ -4,41 +4,209 @@
 #include "utils/memory.h"
 #include "utils/stringUtils.h"
 
+#include <pthread.h>
 #include <string.h>
 
-static list_t* servers = NULL;
+/**
+ * @c servers and the flows of each server are accessed from the oidcd main
+ * thread and from the httpserver threads; all access is guarded by
+ * @c servers_lock. Servers are only started and stopped from the main thread.
+ */
+static list_t*         servers      = NULL;
+static pthread_mutex_t servers_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void _secFreePendingFlow(struct pending_flow* f) {
+  if (f == NULL) {
+    return;
+  }
+  secFree(f->state);
+  secFree(f->redirect_uri);
+  secFree(f);
+}
+
+int matchPendingFlow(const char* state, const struct pending_flow* f) {
+  return strequal(f->state, state);
+}
 
 void _secFreeRunningServer(struct running_server* s) {
-  secFree(s->state);
+  if (s == NULL) {
+    return;
+  }
+  secFreeList(s->flows);
   secFree(s);
 }
 
-int matchRunningServer(char* state, struct running_server* s) {
-  return strequal(s->state, state);
+int matchRunningServerByPort(const unsigned short*        port,
+                             const struct running_server* s) {
+  return s->port == *port;
 }
 
-void addServer(struct running_server* running_server) {
+struct running_server* newRunningServer(unsigned short port) {
+  struct running_server* s = secAlloc(sizeof(struct running_server));
+  s->port                  = port;
+  s->flows                 = list_new();
+  s->flows->free           = (freeFunction)_secFreePendingFlow;
+  s->flows->match          = (matchFunction)matchPendingFlow;
+  return s;
+}
+
+static void _initServers() {
   if (servers == NULL) {
     servers        = list_new();
-    servers->free  = (void (*)(void*)) & _secFreeRunningServer;
-    servers->match = (matchFunction)matchRunningServer;
+    servers->match = (matchFunction)matchRunningServerByPort;
   }
+}
+
+struct running_server* getRunningServer(unsigned short port) {
+  pthread_mutex_lock(&servers_lock);
+  _initServers();
+  list_node_t*           n = findInList(servers, &port);
+  struct running_server* s = n ? n->val : NULL;
+  pthread_mutex_unlock(&servers_lock);
+  return s;
+}
+
+void addServer(struct running_server* running_server) {
+  pthread_mutex_lock(&servers_lock);
+  _initServers();
   list_rpush(servers, list_node_new(running_server));
-  agent_log(DEBUG, "Added Server. Now %d server run", servers->len);
+  agent_log(DEBUG, "Added Server on port %hu. Now %d server run",
+            running_server->port, servers->len);
+  pthread_mutex_unlock(&servers_lock);
+}
+
+void addFlowToServer(struct running_server* s, const char* state,
+                     const char* redirect_uri) {
+  struct pending_flow* f = secAlloc(sizeof(struct pending_flow));
+  f->state               = oidc_strcopy(state);
+  f->redirect_uri        = oidc_strcopy(redirect_uri);
+  pthread_mutex_lock(&servers_lock);
+  list_rpush(s->flows, list_node_new(f));
+  s->idle_since = 0;
+  agent_log(DEBUG, "Server on port %hu now waits for %d flows", s->port,
+            s->flows->len);
+  pthread_mutex_unlock(&servers_lock);
 }
 
-pid_t removeServer(const char* state) {
+/**
+ * @brief returns a copy of the redirect uri registered for a pending flow
+ * @return the redirect uri or @c NULL if no flow with this state is pending on
+ * this server. Has to be freed after usage.
+ */
+char* getRedirectUriForState(struct running_server* s, const char* state) {
+  if (state == NULL) {
+    return NULL;
+  }
+  pthread_mutex_lock(&servers_lock);
+  list_node_t* n = findInList(s->flows, state);
+  char*        uri =
+      n ? oidc_strcopy(((struct pending_flow*)n->val)->redirect_uri) : NULL;
+  pthread_mutex_unlock(&servers_lock);
+  return uri;
+}
+
+static void _removeFlowFromServer(struct running_server* s,
+                                  const char*            state) {
+  list_node_t* n = findInList(s->flows, state);
+  if (n == NULL) {
+    return;
+  }
+  list_remove(s->flows, n);
+  agent_log(DEBUG, "Removed flow from server on port %hu. Now %d flows pending",
+            s->port, s->flows->len);
+  if (s->flows->len == 0) {
+    s->idle_since = time(NULL);
+  }
+}
+
+void removeFlowFromServer(struct running_server* s, const char* state) {
+  if (state == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&servers_lock);
+  _removeFlowFromServer(s, state);
+  pthread_mutex_unlock(&servers_lock);
+}
+
+void removeFlow(const char* state) {
+  if (state == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&servers_lock);
   if (servers == NULL) {
     agent_log(DEBUG, "No servers running");
-    return -1;
+    pthread_mutex_unlock(&servers_lock);
+    return;
   }
-  list_node_t* n = findInList(servers, (char*)state);
-  if (n == NULL) {
-    agent_log(DEBUG, "No server found for state %s", state);
-    return -1;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(servers, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    _removeFlowFromServer(node->val, state);
+  }
+  list_iterator_destroy(it);
+  pthread_mutex_unlock(&servers_lock);
+}
+
+static time_t _serverDeath(const struct running_server* s) {
+  if (s->flows->len > 0 || s->idle_since == 0) {
+    return 0;
+  }
+  return s->idle_since + HTTPSERVER_IDLE_GRACE;
+}
+
+time_t getMinServerDeath() {
+  pthread_mutex_lock(&servers_lock);
+  if (servers == NULL) {
+    pthread_mutex_unlock(&servers_lock);
+    return 0;
+  }
+  time_t           min = 0;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(servers, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    time_t death = _serverDeath(node->val);
+    if (death > 0 && (death < min || min == 0)) {
+      min = death;
+    }
+  }
+  list_iterator_destroy(it);
+  pthread_mutex_unlock(&servers_lock);
+  return min;
+}
+
+/**
+ * @brief stops all servers that are idle for longer than
+ * @c HTTPSERVER_IDLE_GRACE
+ * @note must only be called from the oidcd main thread, because stopping a
+ * server joins its threads.
+ */
+void removeDeathServers() {
+  list_t* dead = list_new();
+  dead->free   = (freeFunction)_secFreeRunningServer;
+  pthread_mutex_lock(&servers_lock);
+  if (servers != NULL) {
+    time_t           now = time(NULL);
+    list_node_t*     node;
+    list_iterator_t* it = list_iterator_new(servers, LIST_HEAD);
+    while ((node = list_iterator_next(it))) {
+      struct running_server* s     = node->val;
+      time_t                 death = _serverDeath(s);
+      if (death > 0 && death <= now) {
+        list_remove(servers, node);
+        list_rpush(dead, list_node_new(s));
+      }
+    }
+    list_iterator_destroy(it);
+  }
+  pthread_mutex_unlock(&servers_lock);
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(dead, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct running_server* s = node->val;
+    agent_log(DEBUG, "HttpServer: Stopping idle HttpServer on port %hu",
+              s->port);
+    MHD_stop_daemon(s->daemon);
   }
-  pid_t pid = ((struct running_server*)n->val)->pid;
-  list_remove(servers, n);
-  agent_log(DEBUG, "Removed Server. Now %d server run", servers->len);
-  return pid;
+  list_iterator_destroy(it);
+  secFreeList(dead);
 }
@@ -1,18 +1,51 @@
 #ifndef RUNNING_SERVER_H
 #define RUNNING_SERVER_H
 
-#include <sys/types.h>
+#include "wrapper/list.h"
 
-struct running_server {
-  pid_t pid;
+#include <microhttpd.h>
+#include <time.h>
+
+/**
+ * seconds an idle redirect listener is kept alive after its last pending flow
+ * finished, so that the browser still receives the final response
+ */
+#define HTTPSERVER_IDLE_GRACE 5
+
+/**
+ * a pending auth code flow waiting for its redirect on a running server
+ */
+struct pending_flow {
   char* state;
+  char* redirect_uri;
+};
+
+/**
+ * a redirect listener; one per port, shared by all pending flows on that port
+ */
+struct running_server {
+  struct MHD_Daemon* daemon;
+  unsigned short     port;
+  list_t*            flows;
+  time_t             idle_since;
 };
 
 void _secFreeRunningServer(struct running_server* s);
-int  matchRunningServer(char* state, struct running_server* s);
+void _secFreePendingFlow(struct pending_flow* f);
+int  matchRunningServerByPort(const unsigned short* port,
+                              const struct running_server* s);
+
+struct running_server* newRunningServer(unsigned short port);
+struct running_server* getRunningServer(unsigned short port);
+void                   addServer(struct running_server* running_server);
+void  addFlowToServer(struct running_server* s, const char* state,
+                      const char* redirect_uri);
+char* getRedirectUriForState(struct running_server* s, const char* state);
+void  removeFlowFromServer(struct running_server* s, const char* state);
+void  removeFlow(const char* state);
 
-void  addServer(struct running_server* running_server);
-pid_t removeServer(const char* state);
+time_t getMinServerDeath();
+void   removeDeathServers();
 
 #ifndef secFreeRunningServer
 #define secFreeRunningServer(ptr) \
@@ -2,6 +2,7 @@
 #include "lock_state.h"
 
 #include "agent_state.h"
+#include "oidc-agent/oidcd/state_snapshot.h"
 #include "utils/agentLogger.h"
 #include "utils/crypt/crypt.h"
 #include "utils/crypt/dbCryptUtils.h"
@@ -55,6 +56,9 @@ oidc_error_t lock(const char* password) {
     return oidc_errno;
   }
   agent_state.lock_state.hash = s256(password);
+  // sealed accounts are not covered by lockEncrypt and the key to unseal them
+  // must not outlive the lock
+  snapshot_unsealAll();
   if (lockEncrypt(password) != OIDC_SUCCESS) {
     return oidc_errno;
   }
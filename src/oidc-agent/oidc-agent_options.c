@@ -1,4 +1,6 @@
 #include "oidc-agent_options.h"
+#include "defines/settings.h"
+#include "ipc/admission.h"
 #include "utils/agentLogger.h"
 #include "utils/stringUtils.h"
 
@@ -15,6 +17,21 @@
 #define OPT_STATUS 9
 #define OPT_JSON 10
 #define OPT_QUIET 11
+#define OPT_STATE_SNAPSHOT 12
+#define OPT_LAZY_START 13
+#define OPT_REMOTE 14
+#define OPT_REMOTE_CLIENT_LIMIT 15
+#define OPT_MULTI_USER 16
+#define OPT_FAST_IPC 17
+#define OPT_SHM_IPC 18
+#define OPT_LISTEN_BACKLOG 19
+#define OPT_MAX_CONNECTIONS 20
+#define OPT_PEER_MAX_CONNECTIONS 21
+#define OPT_PEER_RATE_LIMIT 22
+#define OPT_USERINFO_TTL 23
+#define OPT_MEMORY_STATS 24
+#define OPT_MAX_LOADED_ACCOUNTS 25
+#define OPT_REMOTE_BIND 26
 
 void initArguments(struct arguments* arguments) {
   arguments->kill_flag               = 0;
@@ -34,6 +51,22 @@ void initArguments(struct arguments* arguments) {
   arguments->status                  = 0;
   arguments->json                    = 0;
   arguments->quiet                   = 0;
+  arguments->state_snapshot          = 0;
+  arguments->snapshot_interval       = 0;
+  arguments->lazy_start              = 0;
+  arguments->remote_port             = 0;
+  arguments->remote_client_limit     = REMOTE_DEFAULT_CLIENT_LIMIT;
+  arguments->remote_bind             = REMOTE_DEFAULT_BIND_ADDRESS;
+  arguments->multi_user              = 0;
+  arguments->fast_ipc                = 0;
+  arguments->shm_ipc                 = 0;
+  arguments->listen_backlog          = ADMISSION_DEFAULT_BACKLOG;
+  arguments->max_connections         = ADMISSION_DEFAULT_MAX_CONNECTIONS;
+  arguments->peer_max_connections    = 0;
+  arguments->peer_rate_limit         = 0;
+  arguments->userinfo_ttl            = 0;
+  arguments->max_loaded_accounts     = 0;
+  arguments->memory_stats            = 0;
 }
 
 static struct argp_option options[] = {
@@ -82,6 +115,86 @@ static struct argp_option options[] = {
      "running the agent have to be in the specified group. If no GROUP_NAME is "
      "specified the default is 'oidc-agent'.",
      1},
+#ifndef __APPLE__
+    {"state-snapshot", OPT_STATE_SNAPSHOT, "TIME", OPTION_ARG_OPTIONAL,
+     "Keeps an encrypted snapshot of the loaded account configurations and "
+     "access tokens, so that a restarted agent can use them without loading "
+     "them again. The snapshot is written when the agent exits and, if TIME is "
+     "given, additionally every TIME seconds. The snapshot key is stored in "
+     "the system keyring.",
+     1},
+#endif
+    {"lazy-start", OPT_LAZY_START, 0, 0,
+     "Only starts the part of the agent that manages the account "
+     "configurations when the first request is received. Useful for sessions "
+     "that might not need the agent at all.",
+     1},
+    {"remote", OPT_REMOTE, "PORT", OPTION_ARG_OPTIONAL,
+     "Additionally serves access token requests of remote clients on the "
+     "given TCP port. Remote clients use this agent by setting "
+     "OIDC_REMOTE_SOCK to 'host:PORT'. Only access token requests are allowed "
+     "remotely. Default value for PORT: 42424",
+     1},
+    {"remote-bind", OPT_REMOTE_BIND, "ADDRESS", 0,
+     "Binds the remote token server to the given IPv4 address. By default it "
+     "only listens on the loopback interface; to serve other hosts, the "
+     "address of a network interface or 0.0.0.0 has to be given. Default "
+     "value for ADDRESS: 127.0.0.1",
+     1},
+    {"remote-client-limit", OPT_REMOTE_CLIENT_LIMIT, "N", 0,
+     "Limits the number of concurrent remote connections from a single host "
+     "to N. Default value for N: 16",
+     1},
+    {"multi-user", OPT_MULTI_USER, 0, 0,
+     "Runs a system agent that serves all users of this host on the socket "
+     "/run/oidc-agent/oidc-agent.sock. The accounts, passwords and lock state "
+     "of each user are only accessible by that user. Implies --no-autoload "
+     "and --no-webserver.",
+     1},
+    {"fast-ipc", OPT_FAST_IPC, 0, 0,
+     "Accepts unencrypted requests from local clients that run as the same "
+     "user (or in the group given with --with-group), as verified by the "
+     "kernel. Such clients skip the key exchange and encryption. Clients use "
+     "this if OIDC_FAST_IPC is set.",
+     1},
+    {"shm-ipc", OPT_SHM_IPC, 0, 0,
+     "Exchanges messages between the agent's internal processes through "
+     "shared memory instead of pipes. Only supported on Linux; if it cannot "
+     "be set up, pipes are used.",
+     1},
+    {"listen-backlog", OPT_LISTEN_BACKLOG, "N", 0,
+     "Sets the length of the queue of local connections that were not yet "
+     "accepted by the agent. Default value for N: 128",
+     1},
+    {"max-connections", OPT_MAX_CONNECTIONS, "N", 0,
+     "Limits the number of concurrent local connections to N. Further "
+     "connections are answered with an error right away. Use 0 for no limit. "
+     "Default value for N: 256",
+     1},
+    {"peer-max-connections", OPT_PEER_MAX_CONNECTIONS, "N", 0,
+     "Limits the number of concurrent local connections of a single user to "
+     "N. By default there is no limit.",
+     1},
+    {"peer-rate-limit", OPT_PEER_RATE_LIMIT, "N", 0,
+     "Limits the number of local connections of a single user to N per "
+     "second; short bursts of up to N connections are allowed. By default "
+     "there is no limit.",
+     1},
+    {"userinfo-ttl", OPT_USERINFO_TTL, "TIME", 0,
+     "Caches userinfo responses for at most TIME seconds. By default a "
+     "userinfo response is cached until the access token used to retrieve it "
+     "expires.",
+     1},
+    {"memory-stats", OPT_MEMORY_STATS, 0, 0,
+     "Accounts the memory allocated by the agent to its subsystems (ipc, "
+     "crypt, json, http, db). The numbers are shown in the agent status.",
+     1},
+    {"max-loaded-accounts", OPT_MAX_LOADED_ACCOUNTS, "N", 0,
+     "Keeps at most N account configurations in memory. If more are loaded, "
+     "the least recently used ones are sealed, written to disk and loaded "
+     "again without a password prompt when they are used. By default there is "
+     "no limit.",
+     1},
     {"always-allow-idtoken", OPT_ALWAYS_ALLOW_IDTOKEN, 0, 0,
      "Always allow id-token requests without manual approval by the user.", 1},
     {"json", OPT_JSON, 0, 0,
@@ -136,6 +249,64 @@ static error_t parse_opt(int key, char* arg __attribute__((unused)),
       break;
     case OPT_JSON: arguments->json = 1; break;
     case OPT_QUIET: arguments->quiet = 1; break;
+    case OPT_LAZY_START: arguments->lazy_start = 1; break;
+    case OPT_MULTI_USER: arguments->multi_user = 1; break;
+    case OPT_FAST_IPC: arguments->fast_ipc = 1; break;
+    case OPT_SHM_IPC: arguments->shm_ipc = 1; break;
+    case OPT_MEMORY_STATS: arguments->memory_stats = 1; break;
+    case OPT_REMOTE:
+      arguments->remote_port = arg ? strToUShort(arg) : REMOTE_DEFAULT_PORT;
+      if (arguments->remote_port == 0) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      break;
+    case OPT_REMOTE_BIND: arguments->remote_bind = arg; break;
+    case OPT_REMOTE_CLIENT_LIMIT:
+      arguments->remote_client_limit = strToULong(arg);
+      if (arguments->remote_client_limit == 0) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      break;
+    case OPT_LISTEN_BACKLOG:
+      arguments->listen_backlog = strToInt(arg);
+      if (arguments->listen_backlog <= 0) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      break;
+    case OPT_MAX_CONNECTIONS:
+      if (!isdigit(*arg)) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      arguments->max_connections = strToULong(arg);
+      break;
+    case OPT_PEER_MAX_CONNECTIONS:
+      if (!isdigit(*arg)) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      arguments->peer_max_connections = strToULong(arg);
+      break;
+    case OPT_PEER_RATE_LIMIT:
+      if (!isdigit(*arg)) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      arguments->peer_rate_limit = strToULong(arg);
+      break;
+    case OPT_USERINFO_TTL:
+      if (!isdigit(*arg)) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      arguments->userinfo_ttl = strToULong(arg);
+      break;
+    case OPT_MAX_LOADED_ACCOUNTS:
+      if (!isdigit(*arg)) {
+        return ARGP_ERR_UNKNOWN;
+      }
+      arguments->max_loaded_accounts = strToULong(arg);
+      break;
+    case OPT_STATE_SNAPSHOT:
+      arguments->state_snapshot    = 1;
+      arguments->snapshot_interval = arg ? strToULong(arg) : 0;
+      break;
     case 'h':
       argp_state_help(state, state->out_stream, ARGP_HELP_STD_HELP);
       break;
@@ -4,6 +4,7 @@
 #include "utils/lifetimeArg.h"
 
 #include <argp.h>
+#include <stddef.h>
 
 struct arguments {
   unsigned char kill_flag;
@@ -19,11 +20,27 @@ struct arguments {
   unsigned char status;
   unsigned char json;
   unsigned char quiet;
+  unsigned char state_snapshot;
+  unsigned char lazy_start;
+  unsigned char multi_user;
+  unsigned char fast_ipc;
+  unsigned char shm_ipc;
+  unsigned char memory_stats;
 
   time_t             lifetime;
   struct lifetimeArg pw_lifetime;
-
-  char* group;
+  time_t             snapshot_interval;
+  unsigned short     remote_port;
+  size_t             remote_client_limit;
+  int                listen_backlog;
+  size_t             max_connections;
+  size_t             peer_max_connections;
+  size_t             peer_rate_limit;
+  time_t             userinfo_ttl;
+  size_t             max_loaded_accounts;
+
+  char*       group;
+  const char* remote_bind;
 };
 
 void initArguments(struct arguments* arguments);
@@ -10,6 +10,7 @@
 #include "utils/json.h"
 #include "utils/listUtils.h"
 #include "utils/stringUtils.h"
+#include "utils/vector.h"
 
 char* tryRefreshFlow(struct oidc_account* p, const char* scope,
                      const char* audience, struct ipcPipe pipes) {
@@ -119,21 +120,20 @@ struct flow_order {
   unsigned char device;
 };
 
-list_t* parseFlow(const char* flow) {
-  list_t* flows = list_new();
-  flows->match  = (matchFunction)strequal;
+vector_t* parseFlow(const char* flow) {
   if (flow == NULL) {  // Using default order
-    list_rpush(flows, list_node_new(FLOW_VALUE_REFRESH));
-    list_rpush(flows, list_node_new(FLOW_VALUE_PASSWORD));
-    list_rpush(flows, list_node_new(FLOW_VALUE_CODE));
-    list_rpush(flows, list_node_new(FLOW_VALUE_DEVICE));
-    return flows;
+    return createVector(LIST_CREATE_DONT_COPY_VALUES, FLOW_VALUE_REFRESH,
+                        FLOW_VALUE_PASSWORD, FLOW_VALUE_CODE, FLOW_VALUE_DEVICE,
+                        NULL);
   }
-  flows->free = (void (*)(void*)) & _secFree;
   if (flow[0] != '[') {
-    list_rpush(flows, list_node_new(oidc_sprintf("%s", flow)));
-    return flows;
+    return createVector(LIST_CREATE_COPY_VALUES, (char*)flow, NULL);
   }
-  secFreeList(flows);
-  return JSONArrayStringToList(flow);
+  cJSON* cj = stringToJson(flow);
+  if (cj == NULL) {
+    return NULL;
+  }
+  vector_t* flows = JSONArrayToVector(cj);
+  secFreeJson(cj);
+  return flows;
 }
@@ -4,6 +4,7 @@
 #include "account/account.h"
 #include "ipc/pipe.h"
 #include "utils/oidc_error.h"
+#include "utils/vector.h"
 #include "wrapper/list.h"
 
 #include <time.h>
@@ -26,5 +27,5 @@ oidc_error_t getAccessTokenUsingDeviceFlow(struct oidc_account* account,
                                            const char*          device_code,
                                            struct ipcPipe       pipes);
 
-list_t* parseFlow(const char* flow);
+vector_t* parseFlow(const char* flow);
 #endif  // FLOW_HANDLER_H
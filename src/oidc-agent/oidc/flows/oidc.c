@@ -9,9 +9,11 @@
 #include "utils/memory.h"
 #include "utils/oidc_error.h"
 #include "utils/stringUtils.h"
+#include "utils/vector.h"
 
 #include <stdarg.h>
 #include <stddef.h>
+#include <string.h>
 #include <time.h>
 
 /**
@@ -20,34 +22,44 @@
 char* generatePostData(char* k1, char* v1, ...) {
   va_list args;
   va_start(args, v1);
-  list_t* list = list_new();
-  list_rpush(list, list_node_new(k1));
-  list_rpush(list, list_node_new(v1));
+  vector_t* vec = vector_new();
+  vector_push(vec, k1);
+  vector_push(vec, v1);
   char* s;
-  while ((s = va_arg(args, char*)) != NULL) {
-    list_rpush(list, list_node_new(s));
-  }
+  while ((s = va_arg(args, char*)) != NULL) { vector_push(vec, s); }
   va_end(args);
-  char* data = generatePostDataFromList(list);
-  list_destroy(list);
+  char* data = generatePostDataFromVector(vec);
+  secFreeVector(vec);
   return data;
 }
 
-char* generatePostDataFromList(list_t* list) {
-  if (list == NULL || list->len < 2) {
+/**
+ * @brief builds the post data from a vector of alternating keys and values
+ * @return the post data @c k1=v1&k2=v2...; it has to be freed after usage
+ */
+char* generatePostDataFromVector(const vector_t* vec) {
+  if (vec == NULL || vec->len < 2) {
     oidc_setArgNullFuncError(__func__);
     return NULL;
   }
-  char* data = oidc_sprintf("%s=%s", (char*)list_at(list, 0)->val,
-                            (char*)list_at(list, 1)->val);
-  for (size_t i = 2; i < list->len - 1; i += 2) {
-    char* tmp = oidc_sprintf("%s&%s=%s", data, (char*)list_at(list, i)->val,
-                             (char*)list_at(list, i + 1)->val);
-    if (tmp == NULL) {
-      return NULL;
+  const size_t pairs = vec->len / 2;
+  size_t       len   = 2 * pairs - 1;  // '=' and '&'
+  for (size_t i = 0; i < 2 * pairs; i++) {
+    len += strlen(vector_at(vec, i));
+  }
+  char* data = secAlloc(len + 1);
+  if (data == NULL) {
+    return NULL;
+  }
+  char* p = data;
+  for (size_t i = 0; i < 2 * pairs; i++) {
+    if (i) {
+      *p++ = i % 2 ? '=' : '&';
     }
-    secFree(data);
-    data = tmp;
+    const char* s = vector_at(vec, i);
+    size_t      l = strlen(s);
+    memcpy(p, s, l);
+    p += l;
   }
   return data;
 }
@@ -3,6 +3,7 @@
 
 #include "account/account.h"
 #include "ipc/pipe.h"
+#include "utils/vector.h"
 
 #define TOKENPARSEMODE_SAVE_AT 0x01
 #define TOKENPARSEMODE_SAVE_AT_IF(X) ((X) ? 0x01 : 0)
@@ -10,7 +11,7 @@
 #define TOKENPARSEMODE_RETURN_ID 0x04
 
 char* generatePostData(char* k1, char* v1, ...);
-char* generatePostDataFromList(list_t* list);
+char* generatePostDataFromVector(const vector_t* vec);
 char* parseTokenResponse(const unsigned char mode, const char* res,
                          struct oidc_account* a, struct ipcPipe pipes,
                          const unsigned char refreshFlow);
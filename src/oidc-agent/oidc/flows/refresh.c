@@ -28,25 +28,25 @@ char* generateRefreshPostData(const struct oidc_account* a, const char* scope,
                                  // only needed if including audience changes
                                  // not only the audience of the new AT, but
                                  // also of the RT and therefore of future ATs.
-  list_t* postDataList = list_new();
-  // list_rpush(postDataList, list_node_new(OIDC_KEY_CLIENTID));
-  // list_rpush(postDataList, list_node_new(account_getClientId(a)));
-  // list_rpush(postDataList, list_node_new(OIDC_KEY_CLIENTSECRET));
-  // list_rpush(postDataList, list_node_new(account_getClientSecret(a)));
-  list_rpush(postDataList, list_node_new(OIDC_KEY_GRANTTYPE));
-  list_rpush(postDataList, list_node_new(OIDC_GRANTTYPE_REFRESH));
-  list_rpush(postDataList, list_node_new(OIDC_KEY_REFRESHTOKEN));
-  list_rpush(postDataList, list_node_new(refresh_token));
+  vector_t* postDataList = vector_new();
+  // vector_push(postDataList, OIDC_KEY_CLIENTID);
+  // vector_push(postDataList, account_getClientId(a));
+  // vector_push(postDataList, OIDC_KEY_CLIENTSECRET);
+  // vector_push(postDataList, account_getClientSecret(a));
+  vector_push(postDataList, OIDC_KEY_GRANTTYPE);
+  vector_push(postDataList, OIDC_GRANTTYPE_REFRESH);
+  vector_push(postDataList, OIDC_KEY_REFRESHTOKEN);
+  vector_push(postDataList, refresh_token);
   if (strValid(scope_tmp)) {
-    list_rpush(postDataList, list_node_new(OIDC_KEY_SCOPE));
-    list_rpush(postDataList, list_node_new(scope_tmp));
+    vector_push(postDataList, OIDC_KEY_SCOPE);
+    vector_push(postDataList, scope_tmp);
   }
   if (strValid(aud_tmp)) {
-    list_rpush(postDataList, list_node_new(OIDC_KEY_AUDIENCE));
-    list_rpush(postDataList, list_node_new(aud_tmp));
+    vector_push(postDataList, OIDC_KEY_AUDIENCE);
+    vector_push(postDataList, aud_tmp);
   }
-  char* str = generatePostDataFromList(postDataList);
-  list_destroy(postDataList);
+  char* str = generatePostDataFromVector(postDataList);
+  secFreeVector(postDataList);
   secFree(aud_tmp);
   secFree(scope_tmp);
   return str;
@@ -62,9 +62,12 @@ char* refreshFlow(unsigned char return_mode, struct oidc_account* p,
     ;
   }
   agent_log(DEBUG, "Data to send: %s", data);
+  // The response may contain a rotated refresh token and must not be lost
+  http_deferCancel(1);
   char* res = sendPostDataWithBasicAuth(
       account_getTokenEndpoint(p), data, account_getCertPath(p),
       account_getClientId(p), account_getClientSecret(p));
+  http_deferCancel(0);
   secFree(data);
   if (NULL == res) {
     return NULL;
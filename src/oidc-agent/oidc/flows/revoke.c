@@ -6,9 +6,54 @@
 #include "oidc-agent/oidc/parse_oidp.h"
 #include "oidc.h"
 #include "utils/agentLogger.h"
+#include "utils/listUtils.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
 #include "utils/parseJson.h"
 #include "utils/stringUtils.h"
 
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief checks the response of a revocation request; an empty response is
+ * a success
+ * @param res the response or @c NULL if the request failed. Is freed.
+ * @return an oidc_error code
+ */
+static oidc_error_t _checkRevocationResponse(char* res) {
+  if (res == NULL) {
+    if (oidc_errno == OIDC_EHTTP0) {
+      oidc_errno = OIDC_SUCCESS;
+      agent_log(
+          INFO,
+          "Ignored http0 error - empty response allowed for token revocation");
+    }
+    return oidc_errno;
+  }
+  if (!strValid(res)) {
+    secFree(res);
+    oidc_errno = OIDC_SUCCESS;
+    return oidc_errno;
+  }
+  char* error = parseForError(res);
+  if (error) {
+    oidc_errno = OIDC_EOIDC;
+    oidc_seterror(error);
+    secFree(error);
+    return oidc_errno;
+  }
+  oidc_errno = OIDC_SUCCESS;
+  return oidc_errno;
+}
+
+static char* _revocationData(const struct oidc_account* account) {
+  return generatePostData(OIDC_KEY_TOKENTYPE_HINT, OIDC_TOKENTYPE_REFRESH,
+                          OIDC_KEY_TOKEN, account_getRefreshToken(account),
+                          NULL);
+}
+
 oidc_error_t revokeToken(struct oidc_account* account) {
   agent_log(DEBUG, "Performing Token revocation flow");
   if (!strValid(account_getRevocationEndpoint(account))) {
@@ -16,9 +61,7 @@ oidc_error_t revokeToken(struct oidc_account* account) {
     agent_log(NOTICE, "%s", oidc_serror());
     return oidc_errno;
   }
-  char* refresh_token = account_getRefreshToken(account);
-  char* data = generatePostData(OIDC_KEY_TOKENTYPE_HINT, OIDC_TOKENTYPE_REFRESH,
-                                OIDC_KEY_TOKEN, refresh_token, NULL);
+  char* data = _revocationData(account);
   if (data == NULL) {
     return oidc_errno;
   }
@@ -28,24 +71,161 @@ oidc_error_t revokeToken(struct oidc_account* account) {
                                         account_getClientId(account),
                                         account_getClientSecret(account));
   secFree(data);
-  if (res == NULL) {
-    if (oidc_errno == OIDC_EHTTP0) {
-      account_setRefreshToken(account, NULL);
-      oidc_errno = OIDC_SUCCESS;
-      agent_log(
-          INFO,
-          "Ignored http0 error - empty response allowed for token revocation");
-    }
-    return oidc_errno;
-  }
-  char* error = parseForError(res);
-  if (error) {
-    oidc_errno = OIDC_EOIDC;
-    oidc_seterror(error);
-    secFree(error);
+  if (_checkRevocationResponse(res) != OIDC_SUCCESS) {
     return oidc_errno;
   }
   account_setRefreshToken(account, NULL);
-  oidc_errno = OIDC_SUCCESS;
   return oidc_errno;
 }
+
+struct revocation_batch {
+  struct ipcPipe pipes;
+  oidc_error_t   error;
+  char**         names;
+  size_t         n;
+  list_t*        results;
+};
+
+static void _addResult(struct revocation_batch* batch, const char* shortname,
+                       oidc_error_t err) {
+  oidc_errno = err;
+  char* line = err == OIDC_SUCCESS
+                   ? oidc_sprintf("%s: revoked", shortname)
+                   : oidc_sprintf("%s: %s", shortname, oidc_serror());
+  list_rpush(batch->results, list_node_new(line));
+}
+
+/**
+ * @brief revokes the refresh tokens of the passed accounts concurrently in
+ * the background; at most @c REVOCATION_MAX_PER_ISSUER requests per issuer
+ * are sent at a time
+ * @param accounts the decrypted accounts; they are not needed anymore after
+ * this function returned
+ * @return the batch to be passed to @c revocationBatch_detach
+ */
+struct revocation_batch* revokeTokensInBackground(const vector_t* accounts) {
+  struct revocation_batch* batch = secAlloc(sizeof(struct revocation_batch));
+  batch->results                 = list_new();
+  batch->results->free           = (void (*)(void*))_secFree;
+  batch->names   = secCalloc(accounts->len ?: 1, sizeof(char*));
+  batch->pipes   = (struct ipcPipe){-1, -1, NULL};
+  struct http_postRequest* requests =
+      secCalloc(accounts->len ?: 1, sizeof(struct http_postRequest));
+  vector_foreach(accounts, i) {
+    const struct oidc_account* account = vector_at(accounts, i);
+    if (!strValid(account_getRefreshToken(account))) {
+      continue;
+    }
+    if (!strValid(account_getRevocationEndpoint(account))) {
+      _addResult(batch, account_getName(account), OIDC_ENOSUPREV);
+      continue;
+    }
+    char* data = _revocationData(account);
+    if (data == NULL) {
+      _addResult(batch, account_getName(account), oidc_errno);
+      continue;
+    }
+    requests[batch->n] = (struct http_postRequest){
+        .url       = account_getRevocationEndpoint(account),
+        .data      = data,
+        .cert_path = account_getCertPath(account),
+        .username  = account_getClientId(account),
+        .password  = account_getClientSecret(account),
+        .group     = account_getIssuerUrl(account)};
+    batch->names[batch->n++] = oidc_strcopy(account_getName(account));
+  }
+  if (batch->n > 0) {
+    agent_log(DEBUG, "Revoking %lu refresh tokens", batch->n);
+    batch->pipes = httpsPOSTBatch(
+        requests, batch->n, REVOCATION_MAX_PER_ISSUER, REVOCATION_TIMEOUT);
+    batch->error = batch->pipes.rx == -1 ? oidc_errno : OIDC_SUCCESS;
+  }
+  for (size_t i = 0; i < batch->n; i++) {
+    _secFree((char*)requests[i].data);
+  }
+  secFree(requests);
+  return batch;
+}
+
+/**
+ * @brief collects the results of a revocation batch and frees it
+ * @return a list with one line per account. Has to be freed after usage.
+ */
+static list_t* _collectResults(struct revocation_batch* batch) {
+  for (size_t received = 0;
+       batch->error == OIDC_SUCCESS && received < batch->n; received++) {
+    size_t       i;
+    oidc_error_t err;
+    char*        res = NULL;
+    batch->error     = http_readBatchResult(batch->pipes, 0, &i, &err, &res);
+    if (batch->error != OIDC_SUCCESS || i >= batch->n ||
+        batch->names[i] == NULL) {
+      secFree(res);
+      break;
+    }
+    if (err == OIDC_SUCCESS) {
+      err = _checkRevocationResponse(res);
+    }
+    _addResult(batch, batch->names[i], err);
+    secFree(batch->names[i]);
+    batch->names[i] = NULL;
+  }
+  if (batch->pipes.rx != -1) {
+    ipc_closePipes(batch->pipes);
+  }
+  for (size_t i = 0; i < batch->n; i++) {
+    if (batch->names[i] == NULL) {
+      continue;
+    }
+    _addResult(batch, batch->names[i], batch->error);
+    secFree(batch->names[i]);
+  }
+  list_t* results = batch->results;
+  secFree(batch->names);
+  secFree(batch);
+  return results;
+}
+
+/**
+ * @brief hands the revocations of a batch over to a background process that
+ * logs their results, so that the caller does not wait for the provider
+ * @return a list with one line per account: the result if it is already
+ * known (e.g. the issuer does not support revocation), otherwise that the
+ * revocation is in progress. Has to be freed after usage.
+ */
+list_t* revocationBatch_detach(struct revocation_batch* batch) {
+  if (batch->error != OIDC_SUCCESS || batch->n == 0) {
+    return _collectResults(batch);
+  }
+  pid_t pid = fork();
+  if (pid == -1) {
+    agent_log(ALERT, "fork %m");
+    oidc_setErrnoError();
+    batch->error = oidc_errno;
+    return _collectResults(batch);
+  }
+  if (pid == 0) {  // child
+    logger_open("oidc-agent.revoke");
+    list_t*          results = _collectResults(batch);
+    list_node_t*     node;
+    list_iterator_t* it      = list_iterator_new(results, LIST_HEAD);
+    while ((node = list_iterator_next(it))) {
+      agent_log(NOTICE, "Token revocation: %s", (char*)node->val);
+    }
+    list_iterator_destroy(it);
+    secFreeList(results);
+    exit(EXIT_SUCCESS);
+  }
+  signal(SIGCHLD, SIG_IGN);
+  ipc_closePipes(batch->pipes);
+  for (size_t i = 0; i < batch->n; i++) {
+    list_rpush(batch->results,
+               list_node_new(oidc_sprintf("%s: revocation in progress",
+                                          batch->names[i])));
+    secFree(batch->names[i]);
+  }
+  list_t* results = batch->results;
+  secFree(batch->names);
+  secFree(batch);
+  return results;
+}
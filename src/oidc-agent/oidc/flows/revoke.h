@@ -3,7 +3,20 @@
 
 #include "account/account.h"
 #include "utils/oidc_error.h"
+#include "utils/vector.h"
+#include "wrapper/list.h"
 
-oidc_error_t revokeToken(struct oidc_account* account);
+#include <time.h>
+
+// concurrent revocation requests per issuer
+#define REVOCATION_MAX_PER_ISSUER 4
+// seconds after which a single revocation request is aborted
+#define REVOCATION_TIMEOUT 60
+
+struct revocation_batch;
+
+oidc_error_t             revokeToken(struct oidc_account* account);
+struct revocation_batch* revokeTokensInBackground(const vector_t* accounts);
+list_t*                  revocationBatch_detach(struct revocation_batch* batch);
 
 #endif  // OIDC_REVOKE_H
@@ -0,0 +1,237 @@
+#include "token_exchange.h"
+
+#include "access_token_handler.h"
+#include "account/setandget.h"
+#include "defines/agent_values.h"
+#include "defines/oidc_values.h"
+#include "oidc-agent/http/http_ipc.h"
+#include "oidc.h"
+#include "utils/agentLogger.h"
+#include "utils/errorUtils.h"
+#include "utils/key_value.h"
+#include "utils/json.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+#include "utils/vector.h"
+
+#include <curl/curl.h>
+
+/**
+ * minimum number of seconds the access token used as subject token has to be
+ * valid
+ */
+#define TOKEN_EXCHANGE_MIN_SUBJECT_VALIDITY 10
+
+static void _secFreeExchangedToken(struct exchanged_token* t) {
+  if (t == NULL) {
+    return;
+  }
+  secFree(t->audience);
+  secFree(t->resource);
+  secFree(t->scope);
+  secFree(t->access_token);
+  secFree(t);
+}
+
+static int _matches(const struct exchanged_token* t, const char* audience,
+                    const char* resource, const char* scope) {
+  return strequal(t->audience, audience) && strequal(t->resource, resource) &&
+         strequal(t->scope, scope);
+}
+
+/**
+ * @brief looks up the cached exchanged token; expired tokens are dropped
+ */
+static const struct exchanged_token* _findCached(vector_t*   cache,
+                                                 const char* audience,
+                                                 const char* resource,
+                                                 const char* scope,
+                                                 time_t      min_valid_period) {
+  const time_t                  now   = time(NULL);
+  const struct exchanged_token* found = NULL;
+  for (size_t i = 0; cache != NULL && i < cache->len;) {
+    const struct exchanged_token* t = vector_at(cache, i);
+    if (t->expires_at <= (unsigned long)now) {
+      vector_removeAt(cache, i);
+      continue;
+    }
+    if (_matches(t, audience, resource, scope) &&
+        min_valid_period != FORCE_NEW_TOKEN &&
+        t->expires_at - now > (unsigned long)min_valid_period) {
+      found = t;
+    }
+    i++;
+  }
+  return found;
+}
+
+/**
+ * @brief adds an exchanged token to the account's cache; a token for the same
+ * audience, resource and scope is replaced and if the cache is full the token
+ * that expires first is dropped
+ */
+static void _cache(struct oidc_account* account, struct exchanged_token* t) {
+  vector_t* cache = account_getExchangedTokens(account);
+  if (cache == NULL) {
+    cache       = vector_new();
+    cache->free = (freeFunction)_secFreeExchangedToken;
+    account_setExchangedTokens(account, cache);
+  }
+  size_t first = VECTOR_NOT_FOUND;
+  vector_foreach(cache, i) {
+    const struct exchanged_token* c = vector_at(cache, i);
+    if (_matches(c, t->audience, t->resource, t->scope)) {
+      first = i;
+      break;
+    }
+    if (first == VECTOR_NOT_FOUND ||
+        c->expires_at <
+            ((struct exchanged_token*)vector_at(cache, first))->expires_at) {
+      first = i;
+    }
+  }
+  if (first != VECTOR_NOT_FOUND &&
+      (cache->len >= TOKEN_EXCHANGE_CACHE_SIZE ||
+       _matches(vector_at(cache, first), t->audience, t->resource,
+                t->scope))) {
+    vector_removeAt(cache, first);
+  }
+  vector_push(cache, t);
+}
+
+static char* _urlEncode(const char* s) {
+  return strValid(s) ? curl_easy_escape(NULL, s, 0) : NULL;
+}
+
+/**
+ * @brief generates the post data of a token exchange request; audience,
+ * resource and scope are passed through by the user and therefore
+ * url-encoded
+ */
+static char* _generateTokenExchangePostData(const char* subject_token,
+                                            const char* audience,
+                                            const char* resource,
+                                            const char* scope) {
+  char*     enc_audience = _urlEncode(audience);
+  char*     enc_resource = _urlEncode(resource);
+  char*     enc_scope    = _urlEncode(scope);
+  vector_t* postDataList = createVector(
+      LIST_CREATE_DONT_COPY_VALUES, OIDC_KEY_GRANTTYPE,
+      OIDC_GRANTTYPE_TOKENEXCHANGE, OIDC_KEY_SUBJECT_TOKEN, subject_token,
+      OIDC_KEY_SUBJECT_TOKEN_TYPE, OIDC_TOKENTYPE_URN_ACCESS,
+      OIDC_KEY_REQUESTED_TOKEN_TYPE, OIDC_TOKENTYPE_URN_ACCESS, NULL);
+  if (enc_audience) {
+    vector_push(postDataList, OIDC_KEY_AUDIENCE);
+    vector_push(postDataList, enc_audience);
+  }
+  if (enc_resource) {
+    vector_push(postDataList, OIDC_KEY_RESOURCE);
+    vector_push(postDataList, enc_resource);
+  }
+  if (enc_scope) {
+    vector_push(postDataList, OIDC_KEY_SCOPE);
+    vector_push(postDataList, enc_scope);
+  }
+  char* data = generatePostDataFromVector(postDataList);
+  secFreeVector(postDataList);
+  curl_free(enc_audience);
+  curl_free(enc_resource);
+  curl_free(enc_scope);
+  return data;
+}
+
+/**
+ * @brief parses a token exchange response; a refresh token in the response is
+ * ignored, the account keeps its own
+ * @return the exchanged token or @c NULL on failure
+ */
+static struct exchanged_token* _parseTokenExchangeResponse(
+    const char* res, unsigned long subject_expires_at) {
+  INIT_KEY_VALUE(OIDC_KEY_ACCESSTOKEN, OIDC_KEY_EXPIRESIN, OIDC_KEY_ERROR,
+                 OIDC_KEY_ERROR_DESCRIPTION);
+  if (CALL_GETJSONVALUES(res) < 0) {
+    agent_log(ERROR, "Error while parsing json\n");
+    SEC_FREE_KEY_VALUES();
+    return NULL;
+  }
+  KEY_VALUE_VARS(access_token, expires_in, error, error_description);
+  if (_error || _error_description || !strValid(_access_token)) {
+    char* error_str = _error || _error_description
+                          ? combineError(_error, _error_description)
+                          : oidc_strcopy("No access token in token exchange "
+                                         "response");
+    oidc_seterror(error_str);
+    oidc_errno = OIDC_EOIDC;
+    agent_log(ERROR, "%s", error_str);
+    secFree(error_str);
+    SEC_FREE_KEY_VALUES();
+    return NULL;
+  }
+  struct exchanged_token* t = secAlloc(sizeof(struct exchanged_token));
+  t->access_token           = _access_token;
+  // without expires_in the exchanged token is only cached as long as the
+  // token it was exchanged for
+  t->expires_at = _expires_in ? time(NULL) + strToULong(_expires_in)
+                              : subject_expires_at;
+  secFree(_expires_in);
+  return t;
+}
+
+/**
+ * @brief exchanges the account's access token for a token for another
+ * audience or resource (RFC 8693)
+ *
+ * Exchanged tokens are cached in the account per audience, resource and scope
+ * until they expire, so that repeated requests do not reach the provider.
+ * @param account the account; it must be decrypted
+ * @param min_valid_period the number of seconds a cached token must at least
+ * be valid; @c FORCE_NEW_TOKEN to always exchange a new one
+ * @return the exchanged token; it is owned by the account. On failure @c NULL
+ * is returned and @c oidc_errno is set.
+ */
+const struct exchanged_token* exchangeToken(struct oidc_account* account,
+                                            const char*          audience,
+                                            const char*          resource,
+                                            const char*          scope,
+                                            time_t         min_valid_period,
+                                            struct ipcPipe pipes) {
+  audience = strValid(audience) ? audience : NULL;
+  resource = strValid(resource) ? resource : NULL;
+  scope    = strValid(scope) ? scope : NULL;
+  const struct exchanged_token* cached =
+      _findCached(account_getExchangedTokens(account), audience, resource,
+                  scope, min_valid_period);
+  if (cached != NULL) {
+    agent_log(DEBUG, "Using cached exchanged token");
+    return cached;
+  }
+  const char* subject_token = getAccessTokenUsingRefreshFlow(
+      account, TOKEN_EXCHANGE_MIN_SUBJECT_VALIDITY, NULL, NULL, pipes);
+  if (subject_token == NULL) {
+    return NULL;
+  }
+  agent_log(DEBUG, "Doing token exchange");
+  char* data =
+      _generateTokenExchangePostData(subject_token, audience, resource, scope);
+  if (data == NULL) {
+    return NULL;
+  }
+  char* res = sendPostDataWithBasicAuth(
+      account_getTokenEndpoint(account), data, account_getCertPath(account),
+      account_getClientId(account), account_getClientSecret(account));
+  secFree(data);
+  if (res == NULL) {
+    return NULL;
+  }
+  struct exchanged_token* t =
+      _parseTokenExchangeResponse(res, account_getTokenExpiresAt(account));
+  secFree(res);
+  if (t == NULL) {
+    return NULL;
+  }
+  t->audience = oidc_strcopy(audience);
+  t->resource = oidc_strcopy(resource);
+  t->scope    = oidc_strcopy(scope);
+  _cache(account, t);
+  return t;
+}
@@ -0,0 +1,19 @@
+#ifndef OIDC_TOKEN_EXCHANGE_H
+#define OIDC_TOKEN_EXCHANGE_H
+
+#include "account/account.h"
+#include "ipc/pipe.h"
+
+#include <time.h>
+
+// maximum number of exchanged tokens cached per account
+#define TOKEN_EXCHANGE_CACHE_SIZE 64
+
+const struct exchanged_token* exchangeToken(struct oidc_account* account,
+                                            const char*          audience,
+                                            const char*          resource,
+                                            const char*          scope,
+                                            time_t         min_valid_period,
+                                            struct ipcPipe pipes);
+
+#endif  // OIDC_TOKEN_EXCHANGE_H
@@ -0,0 +1,97 @@
+#include "userinfo.h"
+
+#include "access_token_handler.h"
+#include "account/account.h"
+#include "defines/oidc_values.h"
+#include "oidc-agent/http/http_ipc.h"
+#include "openid_config.h"
+#include "utils/agentLogger.h"
+#include "utils/json.h"
+#include "utils/parseJson.h"
+#include "utils/stringUtils.h"
+
+/**
+ * minimum number of seconds the access token used for a userinfo request has
+ * to be valid
+ */
+#define USERINFO_MIN_TOKEN_VALIDITY 10
+
+static char* _requestUserinfo(struct oidc_account* account,
+                              const char*          access_token) {
+  char* auth_header =
+      oidc_sprintf(HTTP_HEADER_AUTHORIZATION_BEARER_FMT, access_token);
+  struct curl_slist* headers = curl_slist_append(NULL, auth_header);
+  secFree(auth_header);
+  char* res = httpsGET(account_getUserinfoEndpoint(account), headers,
+                       account_getCertPath(account));
+  curl_slist_free_all(headers);
+  if (res == NULL) {
+    return NULL;
+  }
+  if (!isJSONObject(res)) {
+    agent_log(ERROR, "Userinfo response is not a json object: %s", res);
+    secFree(res);
+    oidc_seterror("Received no JSON formatted userinfo response.");
+    oidc_errno = OIDC_EERROR;
+    return NULL;
+  }
+  char* error = getJSONValueFromString(res, OIDC_KEY_ERROR);
+  if (error != NULL) {
+    secFree(error);
+    error = parseForError(res);  // frees res
+    oidc_seterror(error);
+    oidc_errno = OIDC_EOIDC;
+    secFree(error);
+    return NULL;
+  }
+  return res;
+}
+
+/**
+ * @brief returns the userinfo of an account
+ *
+ * The userinfo is requested with the account's current access token (which is
+ * refreshed if necessary) and cached in the account until that token expires
+ * or, if @p ttl is set, for at most @p ttl seconds.
+ * @param account the account; it must be decrypted
+ * @param ttl the maximum number of seconds a userinfo response is cached;
+ * @c 0 to cache it until the access token expires
+ * @return a pointer to the json encoded userinfo. Has to be freed after usage.
+ * On failure @c NULL is returned and @c oidc_errno is set.
+ */
+char* getUserinfo(struct oidc_account* account, time_t ttl,
+                  struct ipcPipe pipes) {
+  time_t now = time(NULL);
+  if (account_getUserinfo(account) != NULL &&
+      account_getUserinfoExpiresAt(account) > (unsigned long)now) {
+    agent_log(DEBUG, "Using cached userinfo");
+    return oidc_strcopy(account_getUserinfo(account));
+  }
+  if (!strValid(account_getUserinfoEndpoint(account))) {
+    // the issuer config of restored accounts might not be retrieved yet
+    if (getIssuerConfig(account) != OIDC_SUCCESS) {
+      return NULL;
+    }
+    if (!strValid(account_getUserinfoEndpoint(account))) {
+      oidc_errno = OIDC_ENOSUPUSERINFO;
+      agent_log(NOTICE, "%s", oidc_serror());
+      return NULL;
+    }
+  }
+  const char* access_token = getAccessTokenUsingRefreshFlow(
+      account, USERINFO_MIN_TOKEN_VALIDITY, NULL, NULL, pipes);
+  if (access_token == NULL) {
+    return NULL;
+  }
+  agent_log(DEBUG, "Requesting userinfo");
+  char* userinfo = _requestUserinfo(account, access_token);
+  if (userinfo == NULL) {
+    return NULL;
+  }
+  unsigned long expires_at = account_getTokenExpiresAt(account);
+  if (ttl > 0 && (expires_at == 0 || (unsigned long)(now + ttl) < expires_at)) {
+    expires_at = now + ttl;
+  }
+  account_setUserinfo(account, oidc_strcopy(userinfo), expires_at);
+  return userinfo;
+}
@@ -0,0 +1,12 @@
+#ifndef OIDC_USERINFO_H
+#define OIDC_USERINFO_H
+
+#include "account/account.h"
+#include "ipc/pipe.h"
+
+#include <time.h>
+
+char* getUserinfo(struct oidc_account* account, time_t ttl,
+                  struct ipcPipe pipes);
+
+#endif  // OIDC_USERINFO_H
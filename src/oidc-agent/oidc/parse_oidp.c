@@ -30,7 +30,8 @@ oidc_error_t parseOpenidConfiguration(char* res, struct oidc_account* account) {
   INIT_KEY_VALUE(OIDC_KEY_TOKEN_ENDPOINT, OIDC_KEY_AUTHORIZATION_ENDPOINT,
                  OIDC_KEY_REGISTRATION_ENDPOINT, OIDC_KEY_REVOCATION_ENDPOINT,
                  OIDC_KEY_DEVICE_AUTHORIZATION_ENDPOINT,
-                 OIDC_KEY_SCOPES_SUPPORTED, OIDC_KEY_GRANT_TYPES_SUPPORTED,
+                 OIDC_KEY_USERINFO_ENDPOINT, OIDC_KEY_SCOPES_SUPPORTED,
+                 OIDC_KEY_GRANT_TYPES_SUPPORTED,
                  OIDC_KEY_RESPONSE_TYPES_SUPPORTED,
                  OIDC_KEY_CODE_CHALLENGE_METHODS_SUPPORTED);
   if (CALL_GETJSONVALUES(res) < 0) {
@@ -40,7 +41,7 @@ oidc_error_t parseOpenidConfiguration(char* res, struct oidc_account* account) {
   secFree(res);
   KEY_VALUE_VARS(token_endpoint, authorization_endpoint, registration_endpoint,
                  revocation_endpoint, device_authorization_endpoint,
-                 scopes_supported, grant_types_supported,
+                 userinfo_endpoint, scopes_supported, grant_types_supported,
                  response_types_supported, code_challenge_method_supported);
   if (_token_endpoint == NULL) {
     agent_log(ERROR, "Could not get token endpoint");
@@ -69,6 +70,9 @@ oidc_error_t parseOpenidConfiguration(char* res, struct oidc_account* account) {
     issuer_setDeviceAuthorizationEndpoint(issuer,
                                           _device_authorization_endpoint, 0);
   }
+  if (_userinfo_endpoint) {
+    issuer_setUserinfoEndpoint(issuer, _userinfo_endpoint);
+  }
   if (_grant_types_supported == NULL) {
     const char* defaultValue = OIDC_PROVIDER_DEFAULT_GRANTTYPES;
     _grant_types_supported   = oidc_sprintf("%s", defaultValue);
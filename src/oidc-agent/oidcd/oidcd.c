@@ -1,15 +1,21 @@
+#define _XOPEN_SOURCE 500
 #include "oidcd.h"
 #include "account/account.h"
 #include "defines/ipc_values.h"
+#include "ipc/cancelPipe.h"
 #include "oidc-agent/agent_state.h"
+#include "oidc-agent/httpserver/running_server.h"
 #include "oidc-agent/oidcd/codeExchangeEntry.h"
 #include "oidc-agent/oidcd/oidcd_handler.h"
+#include "oidc-agent/oidcd/state_snapshot.h"
+#include "oidc-agent/oidcd/user_context.h"
 #include "utils/accountUtils.h"
 #include "utils/agentLogger.h"
 #include "utils/crypt/crypt.h"
 #include "utils/crypt/memoryCrypt.h"
 #include "utils/db/account_db.h"
 #include "utils/db/codeVerifier_db.h"
+#include "utils/db/db.h"
 #include "utils/db/file_db.h"
 #include "utils/json.h"
 #include "utils/listUtils.h"
@@ -17,8 +23,38 @@
 #include "utils/oidc_error.h"
 #include "utils/stringUtils.h"
 
+#include <signal.h>
+
+static volatile sig_atomic_t terminate = 0;
+
+static void handleTermSignal(int signo __attribute__((unused))) {
+  terminate = 1;
+}
+
+static time_t _earliest(time_t a, time_t b) {
+  if (a == 0 || (b > 0 && b < a)) {
+    return b;
+  }
+  return a;
+}
+
+static void _minAccountDeathOfScope(unsigned long scope __attribute__((unused)),
+                                    void*         arg) {
+  *(time_t*)arg = _earliest(*(time_t*)arg, getMinAccountDeath());
+}
+
+static void _removeDeathAccountsOfScope(
+    unsigned long scope __attribute__((unused)),
+    void*         arg __attribute__((unused))) {
+  struct oidc_account* death = NULL;
+  while ((death = getDeathAccount()) != NULL) {
+    accountDB_removeIfFound(death);
+  }
+}
+
 int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
   logger_open("oidc-agent.d");
+  memory_enableAccounting(arguments->memory_stats);
   initCrypt();
   initMemoryCrypt();
 
@@ -32,21 +68,41 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
 
   fileDB_new();
 
+  if (snapshot_isEnabled()) {
+    struct sigaction sa = {0};
+    sa.sa_handler       = handleTermSignal;
+    sigaction(SIGTERM, &sa, NULL);
+    snapshot_restore();
+  }
+
   time_t minDeath = 0;
 
   while (1) {
-    minDeath = getMinAccountDeath();
+    if (terminate) {
+      snapshot_write();
+      exit(EXIT_SUCCESS);
+    }
+    const time_t nextSnapshot =
+        snapshot_getNextWrite(arguments->snapshot_interval);
+    minDeath = getMinServerDeath();
+    db_forEachScope(_minAccountDeathOfScope, &minDeath);
+    minDeath = _earliest(minDeath, nextSnapshot);
     char* q  = ipc_readFromPipeWithTimeout(pipes, minDeath);
     if (q == NULL) {
+      if (terminate || oidc_errno == OIDC_EINTR) {
+        continue;
+      }
       if (oidc_errno == OIDC_ETIMEOUT) {
-        struct oidc_account* death = NULL;
-        while ((death = getDeathAccount()) != NULL) {
-          accountDB_removeIfFound(death);
+        removeDeathServers();
+        db_forEachScope(_removeDeathAccountsOfScope, NULL);
+        if (nextSnapshot > 0 && nextSnapshot <= time(NULL)) {
+          snapshot_write();
         }
         continue;
       }  // A real error and no timeout
       agent_log(ERROR, "%s", oidc_serror());
       if (oidc_errno == OIDC_EIPCDIS) {
+        snapshot_write();
         exit(EXIT_FAILURE);
       }
       if (ipc_writeOidcErrnoToPipe(pipes) ==
@@ -55,6 +111,8 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
       }
       exit(EXIT_FAILURE);
     }
+    // A cancel sent by oidcp after the previous request was answered is stale
+    cancelPipe_consume();
     INIT_KEY_VALUE(IPC_KEY_REQUEST, IPC_KEY_SHORTNAME, IPC_KEY_MINVALID,
                    IPC_KEY_CONFIG, IPC_KEY_FLOW, IPC_KEY_USECUSTOMSCHEMEURL,
                    IPC_KEY_REDIRECTEDURI, OIDC_KEY_STATE, IPC_KEY_AUTHORIZATION,
@@ -64,7 +122,9 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
                    IPC_KEY_CERTPATH, IPC_KEY_AUDIENCE, IPC_KEY_ALWAYSALLOWID,
                    IPC_KEY_FILENAME, IPC_KEY_DATA,
                    OIDC_KEY_REGISTRATION_CLIENT_URI,
-                   OIDC_KEY_REGISTRATION_ACCESS_TOKEN, IPC_KEY_ONLYAT);
+                   OIDC_KEY_REGISTRATION_ACCESS_TOKEN, IPC_KEY_ONLYAT,
+                   INT_IPC_KEY_PEERUID, INT_IPC_KEY_ADMISSION,
+                   INT_IPC_KEY_SCHEDULER, IPC_KEY_REVOKE, IPC_KEY_RESOURCE);
     if (getJSONValuesFromString(q, pairs, sizeof(pairs) / sizeof(*pairs)) < 0) {
       ipc_writeToPipe(pipes, RESPONSE_BADREQUEST, oidc_serror());
       secFreeKeyValuePairs(pairs, sizeof(pairs) / sizeof(*pairs));
@@ -77,13 +137,22 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
                    lifetime, password, applicationHint, confirm, issuer,
                    noscheme, cert_path, audience, alwaysallowid, filename, data,
                    registration_client_uri, registration_access_token,
-                   only_at);  // Gives variables for key_value values;
-                              // e.g. _request=pairs[0].value
+                   only_at, peer_uid, admission, scheduler, revoke,
+                   resource);  // Gives variables for key_value
+                               // values; e.g. _request=pairs[0].value
     if (_request == NULL) {
       ipc_writeToPipe(pipes, RESPONSE_BADREQUEST, "No request type.");
       secFreeKeyValuePairs(pairs, sizeof(pairs) / sizeof(*pairs));
       continue;
     }
+    if (arguments->multi_user) {  // Each user only sees their own state
+      if (_peer_uid == NULL) {
+        ipc_writeToPipe(pipes, RESPONSE_BADREQUEST, "Unknown user.");
+        secFreeKeyValuePairs(pairs, sizeof(pairs) / sizeof(*pairs));
+        continue;
+      }
+      userContext_switch(strToULong(_peer_uid));
+    }
 
     if (strequal(_request, REQUEST_VALUE_CHECK)) {  // Allow check in all cases
       ipc_writeToPipe(pipes, RESPONSE_SUCCESS);
@@ -114,16 +183,17 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
     } else if (strequal(_request, REQUEST_VALUE_REMOVE)) {
       oidcd_handleRm(pipes, _shortname);
     } else if (strequal(_request, REQUEST_VALUE_REMOVEALL)) {
-      oidcd_handleRemoveAll(pipes);
+      oidcd_handleRemoveAll(pipes, _revoke);
     } else if (strequal(_request, REQUEST_VALUE_DELETE)) {
       oidcd_handleDelete(pipes, _config);
     } else if (strequal(_request, REQUEST_VALUE_DELETECLIENT)) {
       oidcd_handleDeleteClient(pipes, _registration_client_uri,
                                _registration_access_token, _cert_path);
     } else if (strequal(_request, REQUEST_VALUE_STATUS)) {
-      oidcd_handleAgentStatus(pipes, arguments);
+      oidcd_handleAgentStatus(pipes, arguments, _admission, _scheduler);
     } else if (strequal(_request, REQUEST_VALUE_STATUS_JSON)) {
-      oidcd_handleAgentStatusJSON(pipes, arguments);
+      oidcd_handleAgentStatusJSON(pipes, arguments, _admission,
+                                  _scheduler);
     } else if (strequal(_request, REQUEST_VALUE_ACCESSTOKEN)) {
       if (_shortname) {
         oidcd_handleToken(pipes, _shortname, _minvalid, _scope,
@@ -145,6 +215,23 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
         oidc_errno = OIDC_NOTIMPL;  // TODO
         ipc_writeOidcErrnoToPipe(pipes);
       }
+    } else if (strequal(_request, REQUEST_VALUE_USERINFO)) {
+      if (_shortname || _issuer) {
+        oidcd_handleUserinfo(pipes, _shortname, _issuer, _applicationHint,
+                             arguments);
+      } else {
+        ipc_writeToPipe(pipes, RESPONSE_BADREQUEST,
+                        "shortname or issuer required");
+      }
+    } else if (strequal(_request, REQUEST_VALUE_TOKENEXCHANGE)) {
+      if (_shortname || _issuer) {
+        oidcd_handleTokenExchange(pipes, _shortname, _issuer, _minvalid,
+                                  _audience, _resource, _scope,
+                                  _applicationHint, arguments);
+      } else {
+        ipc_writeToPipe(pipes, RESPONSE_BADREQUEST,
+                        "shortname or issuer required");
+      }
     } else if (strequal(_request, REQUEST_VALUE_REGISTER)) {
       oidcd_handleRegister(pipes, _config, _flow, _authorization);
     } else if (strequal(_request, REQUEST_VALUE_TERMHTTP)) {
@@ -168,6 +255,7 @@ int oidcd_main(struct ipcPipe pipes, const struct arguments* arguments) {
       ipc_writeToPipe(pipes, RESPONSE_BADREQUEST, "Unknown request type.");
     }
     secFreeKeyValuePairs(pairs, sizeof(pairs) / sizeof(*pairs));
+    snapshot_unloadIdleAccounts(arguments->max_loaded_accounts);
   }
   return EXIT_FAILURE;
 }
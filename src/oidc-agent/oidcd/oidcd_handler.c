@@ -3,7 +3,9 @@
 #include "defines/agent_values.h"
 #include "defines/ipc_values.h"
 #include "defines/oidc_values.h"
+#include "defines/settings.h"
 #include "defines/version.h"
+#include "ipc/admission.h"
 #include "ipc/pipe.h"
 #include "ipc/serveripc.h"
 #include "oidc-agent/agent_state.h"
@@ -17,8 +19,11 @@
 #include "oidc-agent/oidc/flows/openid_config.h"
 #include "oidc-agent/oidc/flows/registration.h"
 #include "oidc-agent/oidc/flows/revoke.h"
+#include "oidc-agent/oidc/flows/token_exchange.h"
+#include "oidc-agent/oidc/flows/userinfo.h"
 #include "oidc-agent/oidcd/codeExchangeEntry.h"
 #include "oidc-agent/oidcd/parse_internal.h"
+#include "oidc-agent/oidcd/state_snapshot.h"
 #include "utils/accountUtils.h"
 #include "utils/agentLogger.h"
 #include "utils/crypt/crypt.h"
@@ -28,6 +33,7 @@
 #include "utils/db/file_db.h"
 #include "utils/json.h"
 #include "utils/listUtils.h"
+#include "utils/memory.h"
 #include "utils/parseJson.h"
 #include "utils/stringUtils.h"
 #include "utils/uriUtils.h"
@@ -119,12 +125,11 @@ void oidcd_handleGen(struct ipcPipe pipes, const char* account_json,
                                       OIDC_SCOPE_OFFLINE_ACCESS)
                         : NULL;
 
-  int              success = 0;
-  list_t*          flows   = parseFlow(flow);
-  list_node_t*     current_flow;
-  list_iterator_t* it = list_iterator_new(flows, LIST_HEAD);
-  while ((current_flow = list_iterator_next(it))) {
-    if (strcaseequal(current_flow->val, FLOW_VALUE_REFRESH)) {
+  int       success = 0;
+  vector_t* flows   = parseFlow(flow);
+  vector_foreach(flows, i) {
+    const char* current_flow = vector_at(flows, i);
+    if (strcaseequal(current_flow, FLOW_VALUE_REFRESH)) {
       char* at = NULL;
       if ((at = getAccessTokenUsingRefreshFlow(account, FORCE_NEW_TOKEN, scope,
                                                account_getAudience(account),
@@ -141,43 +146,39 @@ void oidcd_handleGen(struct ipcPipe pipes, const char* account_json,
         break;
       } else if (flows->len == 1) {
         ipc_writeOidcErrnoToPipe(pipes);
-        list_iterator_destroy(it);
-        secFreeList(flows);
+          secFreeVector(flows);
         secFreeAccount(account);
         secFree(scope);
         return;
       }
-    } else if (strcaseequal(current_flow->val, FLOW_VALUE_PASSWORD)) {
+    } else if (strcaseequal(current_flow, FLOW_VALUE_PASSWORD)) {
       if (getAccessTokenUsingPasswordFlow(account, pipes, scope) ==
           OIDC_SUCCESS) {
         success = 1;
         break;
       } else if (flows->len == 1) {
         ipc_writeOidcErrnoToPipe(pipes);
-        list_iterator_destroy(it);
-        secFreeList(flows);
+          secFreeVector(flows);
         secFreeAccount(account);
         secFree(scope);
         return;
       }
-    } else if (strcaseequal(current_flow->val, FLOW_VALUE_CODE) &&
+    } else if (strcaseequal(current_flow, FLOW_VALUE_CODE) &&
                hasRedirectUris(account)) {
       initAuthCodeFlow(account, pipes, NULL, nowebserver_str, noscheme_str,
                        only_at, arguments);
-      list_iterator_destroy(it);
-      secFreeList(flows);
+      secFreeVector(flows);
       // secFreeAccount(account); //don't free it -> it is stored
       secFree(scope);
       return;
-    } else if (strcaseequal(current_flow->val, FLOW_VALUE_DEVICE)) {
+    } else if (strcaseequal(current_flow, FLOW_VALUE_DEVICE)) {
       if (scope) {
         account_setScopeExact(account, oidc_strcopy(scope));
       }
       struct oidc_device_code* dc = initDeviceFlow(account);
       if (dc == NULL) {
         ipc_writeOidcErrnoToPipe(pipes);
-        list_iterator_destroy(it);
-        secFreeList(flows);
+          secFreeVector(flows);
         secFreeAccount(account);
         secFree(scope);
         return;
@@ -186,32 +187,29 @@ void oidcd_handleGen(struct ipcPipe pipes, const char* account_json,
       ipc_writeToPipe(pipes, RESPONSE_ACCEPTED_DEVICE, json, account_json);
       secFree(json);
       secFreeDeviceCode(dc);
-      list_iterator_destroy(it);
-      secFreeList(flows);
+      secFreeVector(flows);
       secFreeAccount(account);
       secFree(scope);
       return;
     } else {  // UNKNOWN FLOW
       char* msg;
-      if (strcaseequal(current_flow->val, FLOW_VALUE_CODE) &&
+      if (strcaseequal(current_flow, FLOW_VALUE_CODE) &&
           !hasRedirectUris(account)) {
         msg = oidc_sprintf("Only '%s' flow specified, but no redirect uris",
                            FLOW_VALUE_CODE);
       } else {
-        msg = oidc_sprintf("Unknown flow '%s'", (char*)current_flow->val);
+        msg = oidc_sprintf("Unknown flow '%s'", current_flow);
       }
       ipc_writeToPipe(pipes, RESPONSE_ERROR, msg);
       secFree(msg);
-      list_iterator_destroy(it);
-      secFreeList(flows);
+      secFreeVector(flows);
       secFreeAccount(account);
       secFree(scope);
       return;
     }
   }
 
-  list_iterator_destroy(it);
-  secFreeList(flows);
+  secFreeVector(flows);
   secFree(scope);
 
   account_setUsername(account, NULL);
@@ -255,6 +253,7 @@ oidc_error_t addAccount(struct ipcPipe pipes, struct oidc_account* account) {
                                      pipes) == NULL) {
     return oidc_errno;
   }
+  account_setLoadedAt(account, time(NULL));
   db_addAccountEncrypted(account);
   return OIDC_SUCCESS;
 }
@@ -277,6 +276,7 @@ void oidcd_handleAdd(struct ipcPipe pipes, const char* account_json,
   if (strToInt(alwaysallowid)) {
     account_setAlwaysAllowId(account);
   }
+  snapshot_unsealAccount(account_getName(account));
   struct oidc_account* found = NULL;
   if ((found = db_getAccountDecrypted(account)) != NULL) {
     if (account_getDeath(found) != account_getDeath(account)) {
@@ -340,6 +340,7 @@ void oidcd_handleDelete(struct ipcPipe pipes, const char* account_json) {
     secFree(error);
     return;
   }
+  snapshot_forget(account_getName(account));
   accountDB_removeIfFound(account);
   secFreeAccount(account);
   ipc_writeToPipe(pipes, RESPONSE_STATUS_SUCCESS);
@@ -354,8 +355,9 @@ void oidcd_handleRm(struct ipcPipe pipes, char* account_name) {
     return;
   }
   agent_log(DEBUG, "Handle Remove request for config '%s'", account_name);
-  struct oidc_account key = {.shortname = account_name};
-  if (accountDB_findValue(&key) == NULL) {
+  struct oidc_account key         = {.shortname = account_name};
+  const int           wasRestored = snapshot_forget(account_name);
+  if (accountDB_findValue(&key) == NULL && !wasRestored) {
     ipc_writeToPipe(pipes, RESPONSE_ERROR, ACCOUNT_NOT_LOADED);
     return;
   }
@@ -363,9 +365,36 @@ void oidcd_handleRm(struct ipcPipe pipes, char* account_name) {
   ipc_writeToPipe(pipes, RESPONSE_STATUS_SUCCESS);
 }
 
-void oidcd_handleRemoveAll(struct ipcPipe pipes) {
+void oidcd_handleRemoveAll(struct ipcPipe pipes, const char* revoke_str) {
+  if (!strToInt(revoke_str)) {
+    accountDB_reset();
+    snapshot_forgetAll();
+    ipc_writeToPipe(pipes, RESPONSE_STATUS_SUCCESS);
+    return;
+  }
+  agent_log(DEBUG, "Handle RemoveAll request with token revocation");
+  snapshot_unsealAll();
+  const vector_t* accounts = accountDB_getList();
+  vector_foreach(accounts, i) {
+    _db_decryptFoundAccount(vector_at(accounts, i));
+  }
+  struct revocation_batch* batch = revokeTokensInBackground(accounts);
+  // The accounts are removed before the revocations finish
   accountDB_reset();
-  ipc_writeToPipe(pipes, RESPONSE_STATUS_SUCCESS);
+  snapshot_forgetAll();
+  // the results of the revocations that are still running are logged
+  list_t* results = revocationBatch_detach(batch);
+  if (results->len == 0) {
+    ipc_writeToPipe(pipes, RESPONSE_STATUS_SUCCESS);
+    secFreeList(results);
+    return;
+  }
+  char* lines = listToDelimitedString(results, "\n");
+  secFreeList(results);
+  char* info = oidc_sprintf("Token revocation:\n%s", lines);
+  secFree(lines);
+  ipc_writeToPipe(pipes, RESPONSE_SUCCESS_INFO, info);
+  secFree(info);
 }
 
 oidc_error_t oidcd_autoload(struct ipcPipe pipes, const char* short_name,
@@ -460,7 +489,11 @@ struct oidc_account* _getLoadedUnencryptedAccount(
     struct ipcPipe pipes, const char* short_name, const char* application_hint,
     const struct arguments* arguments) {
   struct oidc_account* account = db_getAccountDecryptedByShortname(short_name);
+  if (account == NULL && snapshot_unsealAccount(short_name) == OIDC_SUCCESS) {
+    account = db_getAccountDecryptedByShortname(short_name);
+  }
   if (account) {
+    account_recordUse(account);
     return account;
   }
   if (arguments->no_autoload) {
@@ -474,7 +507,9 @@ struct oidc_account* _getLoadedUnencryptedAccount(
       account = db_getAccountDecryptedByShortname(short_name);
       if (account == NULL) {
         ipc_writeOidcErrnoToPipe(pipes);
+        return NULL;
       }
+      account_recordUse(account);
       return account;
     case OIDC_EUSRPWCNCL:
       ipc_writeToPipe(pipes, RESPONSE_ERROR, ACCOUNT_NOT_LOADED);
@@ -486,8 +521,9 @@ struct oidc_account* _getLoadedUnencryptedAccount(
 struct oidc_account* _getLoadedUnencryptedAccountForIssuer(
     struct ipcPipe pipes, const char* issuer, const char* application_hint,
     const struct arguments* arguments) {
+  snapshot_unsealAccountsForIssuer(issuer);
   struct oidc_account* account  = NULL;
-  list_t*              accounts = db_findAccountsByIssuerUrl(issuer);
+  vector_t*            accounts = db_findAccountsByIssuerUrl(issuer);
   if (accounts == NULL) {  // no accounts loaded for this issuer
     if (arguments->no_autoload) {
       ipc_writeToPipe(pipes, RESPONSE_ERROR, ACCOUNT_NOT_LOADED);
@@ -504,6 +540,9 @@ struct oidc_account* _getLoadedUnencryptedAccountForIssuer(
       case OIDC_SUCCESS:
         account = db_getAccountDecryptedByShortname(defaultAccount);
         secFree(defaultAccount);
+        if (account) {
+          account_recordUse(account);
+        }
         return account;
       case OIDC_EUSRPWCNCL:
         ipc_writeToPipe(pipes, RESPONSE_ERROR, ACCOUNT_NOT_LOADED);
@@ -516,17 +555,16 @@ struct oidc_account* _getLoadedUnencryptedAccountForIssuer(
     }
   } else if (accounts->len ==
              1) {  // only one account loaded for this issuer -> use this one
-    account = _db_decryptFoundAccount(list_at(accounts, 0)->val);
-    secFreeList(accounts);
+    account = _db_decryptFoundAccount(vector_at(accounts, 0));
+    secFreeVector(accounts);
   } else {  // more than 1 account loaded for this issuer
     char* defaultAccount = oidcd_queryDefaultAccountIssuer(pipes, issuer);
     account              = db_getAccountDecryptedByShortname(defaultAccount);
     if (account == NULL) {
       account = _db_decryptFoundAccount(
-          list_at(accounts, accounts->len - 1)
-              ->val);  // use the account that was loaded last
+          vector_last(accounts));  // use the account that was loaded last
     }
-    secFreeList(accounts);
+    secFreeVector(accounts);
   }
 
   if (account == NULL) {
@@ -541,6 +579,7 @@ struct oidc_account* _getLoadedUnencryptedAccountForIssuer(
       return NULL;
     }
   }
+  account_recordUse(account);
   return account;
 }
 
@@ -647,6 +686,95 @@ void oidcd_handleIdToken(struct ipcPipe pipes, const char* short_name,
   secFree(id_token);
 }
 
+void oidcd_handleUserinfo(struct ipcPipe pipes, const char* short_name,
+                          const char*             issuer,
+                          const char*             application_hint,
+                          const struct arguments* arguments) {
+  agent_log(DEBUG, "Handle Userinfo request from %s", application_hint);
+  struct oidc_account* account = NULL;
+  if (short_name != NULL) {
+    account = _getLoadedUnencryptedAccount(pipes, short_name, application_hint,
+                                           arguments);
+    if (account == NULL) {
+      return;
+    }
+    if (arguments->confirm || account_getConfirmationRequired(account)) {
+      if (oidcd_getConfirmation(pipes, short_name, NULL, application_hint) !=
+          OIDC_SUCCESS) {
+        db_addAccountEncrypted(account);  // reencrypting
+        ipc_writeOidcErrnoToPipe(pipes);
+        return;
+      }
+    }
+  } else {  // confirmation is handled when the account is selected
+    account = _getLoadedUnencryptedAccountForIssuer(
+        pipes, issuer, application_hint, arguments);
+    if (account == NULL) {
+      return;
+    }
+  }
+  char* userinfo = getUserinfo(account, arguments->userinfo_ttl, pipes);
+  db_addAccountEncrypted(account);  // reencrypting
+  if (userinfo == NULL) {
+    ipc_writeOidcErrnoToPipe(pipes);
+    return;
+  }
+  ipc_writeToPipe(pipes, RESPONSE_STATUS_USERINFO, STATUS_SUCCESS, userinfo,
+                  account_getIssuerUrl(account));
+  secFree(userinfo);
+}
+
+void oidcd_handleTokenExchange(struct ipcPipe pipes, const char* short_name,
+                               const char*             issuer,
+                               const char*             min_valid_period_str,
+                               const char*             audience,
+                               const char*             resource,
+                               const char*             scope,
+                               const char*             application_hint,
+                               const struct arguments* arguments) {
+  agent_log(DEBUG, "Handle Token Exchange request from %s", application_hint);
+  if (!strValid(audience) && !strValid(resource)) {
+    ipc_writeToPipe(pipes, RESPONSE_ERROR,
+                    "Bad request. Token exchange requires '" IPC_KEY_AUDIENCE
+                    "' or '" IPC_KEY_RESOURCE "'.");
+    return;
+  }
+  time_t min_valid_period =
+      min_valid_period_str != NULL ? strToInt(min_valid_period_str) : 0;
+  struct oidc_account* account = NULL;
+  if (short_name != NULL) {
+    account = _getLoadedUnencryptedAccount(pipes, short_name, application_hint,
+                                           arguments);
+    if (account == NULL) {
+      return;
+    }
+    if (arguments->confirm || account_getConfirmationRequired(account)) {
+      if (oidcd_getConfirmation(pipes, short_name, NULL, application_hint) !=
+          OIDC_SUCCESS) {
+        db_addAccountEncrypted(account);  // reencrypting
+        ipc_writeOidcErrnoToPipe(pipes);
+        return;
+      }
+    }
+  } else {  // confirmation is handled when the account is selected
+    account = _getLoadedUnencryptedAccountForIssuer(
+        pipes, issuer, application_hint, arguments);
+    if (account == NULL) {
+      return;
+    }
+  }
+  const struct exchanged_token* token = exchangeToken(
+      account, audience, resource, scope, min_valid_period, pipes);
+  db_addAccountEncrypted(account);  // reencrypting
+  if (token == NULL) {
+    ipc_writeOidcErrnoToPipe(pipes);
+    return;
+  }
+  ipc_writeToPipe(pipes, RESPONSE_STATUS_ACCESS, STATUS_SUCCESS,
+                  token->access_token, account_getIssuerUrl(account),
+                  token->expires_at);
+}
+
 void oidcd_handleRegister(struct ipcPipe pipes, const char* account_json,
                           const char* flows_json_str,
                           const char* access_token) {
@@ -941,15 +1069,13 @@ void oidcd_handleScopes(struct ipcPipe pipes, const char* issuer_url,
 }
 
 list_t* _getNameListLoadedAccounts() {
-  list_t*          accounts = accountDB_getList();
-  list_t*          names    = list_new();
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(accounts, LIST_HEAD);
-  while ((node = list_iterator_next(it))) {
-    char* name = account_getName(node->val);
+  const vector_t* accounts = accountDB_getList();
+  list_t*         names    = list_new();
+  vector_foreach(accounts, i) {
+    char* name = account_getName(vector_at(accounts, i));
     list_rpush(names, list_node_new(name));
   }
-  list_iterator_destroy(it);
+  snapshot_addPendingNames(names);
   return names;
 }
 
@@ -973,7 +1099,17 @@ char* _argumentsToOptionsText(const struct arguments* arguments) {
                           "Seccomp:\t\t%s\n"
                           "Daemon:\t\t\t%s\n"
                           "Log Debug:\t\t%s\n"
-                          "Log to stderr:\t\t%s\n";
+                          "Log to stderr:\t\t%s\n"
+                          "State snapshot:\t\t%s\n"
+                          "Lazy start:\t\t%s\n"
+                          "Remote:\t\t\t%s\n"
+                          "Multi-user:\t\t%s\n"
+                          "Fast IPC:\t\t%s\n"
+                          "Shared memory IPC:\t%s\n"
+                          "Admission:\t\t%s\n"
+                          "Userinfo cache:\t\t%s\n"
+                          "Memory stats:\t\t%s\n"
+                          "Loaded accounts:\t%s\n";
   char* lifetime = arguments->lifetime
                        ? oidc_sprintf("%lu seconds", arguments->lifetime)
                        : oidc_strcopy("Forever");
@@ -987,6 +1123,45 @@ char* _argumentsToOptionsText(const struct arguments* arguments) {
                        ? oidc_sprintf("true - %s", pw_lifetime)
                        : oidc_strcopy("false");
   secFree(pw_lifetime);
+  char* snapshot =
+      arguments->state_snapshot
+          ? arguments->snapshot_interval
+                ? oidc_sprintf("true - every %lu seconds",
+                               arguments->snapshot_interval)
+                : oidc_strcopy("true - on exit")
+          : oidc_strcopy("false");
+  char* remote =
+      arguments->remote_port
+          ? oidc_sprintf("true - %s:%hu, %lu connections per host",
+                         arguments->remote_bind, arguments->remote_port,
+                         arguments->remote_client_limit)
+          : oidc_strcopy("false");
+  char* peer_connections =
+      arguments->peer_max_connections
+          ? oidc_sprintf(", %lu per user", arguments->peer_max_connections)
+          : oidc_strcopy("");
+  char* peer_rate = arguments->peer_rate_limit
+                        ? oidc_sprintf(", %lu per second per user",
+                                       arguments->peer_rate_limit)
+                        : oidc_strcopy("");
+  char* max_connections =
+      arguments->max_connections
+          ? oidc_sprintf("%lu connections", arguments->max_connections)
+          : oidc_strcopy("unlimited connections");
+  char* admission =
+      oidc_sprintf("backlog %d, %s%s%s", arguments->listen_backlog,
+                   max_connections, peer_connections, peer_rate);
+  secFree(max_connections);
+  secFree(peer_connections);
+  secFree(peer_rate);
+  char* userinfo =
+      arguments->userinfo_ttl
+          ? oidc_sprintf("at most %lu seconds", arguments->userinfo_ttl)
+          : oidc_strcopy("until token expiry");
+  char* max_loaded =
+      arguments->max_loaded_accounts
+          ? oidc_sprintf("at most %lu", arguments->max_loaded_accounts)
+          : oidc_strcopy("unlimited");
   char* options =
       oidc_sprintf(fmt, lifetime, arguments->confirm ? "true" : "false",
                    arguments->no_autoload ? "false" : "true",
@@ -997,9 +1172,19 @@ char* _argumentsToOptionsText(const struct arguments* arguments) {
                    arguments->seccomp ? "true" : "false",
                    arguments->console ? "false" : "true",
                    arguments->debug ? "true" : "false",
-                   arguments->log_console ? "true" : "false");
+                   arguments->log_console ? "true" : "false", snapshot,
+                   arguments->lazy_start ? "true" : "false", remote,
+                   arguments->multi_user ? "true" : "false",
+                   arguments->fast_ipc ? "true" : "false",
+                   arguments->shm_ipc ? "true" : "false", admission, userinfo,
+                   arguments->memory_stats ? "true" : "false", max_loaded);
   secFree(lifetime);
+  secFree(max_loaded);
+  secFree(admission);
+  secFree(userinfo);
   secFree(store_pw);
+  secFree(snapshot);
+  secFree(remote);
   return options;
 }
 
@@ -1055,19 +1240,359 @@ char* _argumentsToCommandLineOptions(const struct arguments* arguments) {
   if (arguments->log_console) {
     list_rpush(options, list_node_new(oidc_strcopy("--log-stderr")));
   }
+  if (arguments->lazy_start) {
+    list_rpush(options, list_node_new(oidc_strcopy("--lazy-start")));
+  }
+  if (arguments->state_snapshot) {
+    if (arguments->snapshot_interval) {
+      list_rpush(options,
+                 list_node_new(oidc_sprintf("--state-snapshot=%ld",
+                                            arguments->snapshot_interval)));
+    } else {
+      list_rpush(options, list_node_new(oidc_strcopy("--state-snapshot")));
+    }
+  }
+  if (arguments->remote_port) {
+    list_rpush(options, list_node_new(oidc_sprintf("--remote=%hu",
+                                                   arguments->remote_port)));
+    if (!strequal(arguments->remote_bind, REMOTE_DEFAULT_BIND_ADDRESS)) {
+      list_rpush(options,
+                 list_node_new(oidc_sprintf("--remote-bind=%s",
+                                            arguments->remote_bind)));
+    }
+    if (arguments->remote_client_limit != REMOTE_DEFAULT_CLIENT_LIMIT) {
+      list_rpush(options,
+                 list_node_new(oidc_sprintf("--remote-client-limit=%lu",
+                                            arguments->remote_client_limit)));
+    }
+  }
+  if (arguments->multi_user) {
+    list_rpush(options, list_node_new(oidc_strcopy("--multi-user")));
+  }
+  if (arguments->fast_ipc) {
+    list_rpush(options, list_node_new(oidc_strcopy("--fast-ipc")));
+  }
+  if (arguments->shm_ipc) {
+    list_rpush(options, list_node_new(oidc_strcopy("--shm-ipc")));
+  }
+  if (arguments->memory_stats) {
+    list_rpush(options, list_node_new(oidc_strcopy("--memory-stats")));
+  }
+  if (arguments->listen_backlog != ADMISSION_DEFAULT_BACKLOG) {
+    list_rpush(options, list_node_new(oidc_sprintf(
+                            "--listen-backlog=%d", arguments->listen_backlog)));
+  }
+  if (arguments->max_connections != ADMISSION_DEFAULT_MAX_CONNECTIONS) {
+    list_rpush(options,
+               list_node_new(oidc_sprintf("--max-connections=%lu",
+                                          arguments->max_connections)));
+  }
+  if (arguments->peer_max_connections) {
+    list_rpush(options,
+               list_node_new(oidc_sprintf("--peer-max-connections=%lu",
+                                          arguments->peer_max_connections)));
+  }
+  if (arguments->peer_rate_limit) {
+    list_rpush(options,
+               list_node_new(oidc_sprintf("--peer-rate-limit=%lu",
+                                          arguments->peer_rate_limit)));
+  }
+  if (arguments->userinfo_ttl) {
+    list_rpush(options, list_node_new(oidc_sprintf("--userinfo-ttl=%ld",
+                                                   arguments->userinfo_ttl)));
+  }
+  if (arguments->max_loaded_accounts) {
+    list_rpush(options,
+               list_node_new(oidc_sprintf("--max-loaded-accounts=%lu",
+                                          arguments->max_loaded_accounts)));
+  }
   char* opts = listToDelimitedString(options, " ");
   secFreeList(options);
   return opts;
 }
 
+/**
+ * @brief formats the admission counters that oidcp added to a status request
+ */
+static char* _admissionStatsToText(const char* admission_json) {
+  if (admission_json == NULL) {
+    return oidc_strcopy("");
+  }
+  INIT_KEY_VALUE("open", "peak", "accepted", "rejected_max_connections",
+                 "rejected_peer_quota", "rejected_rate_limit");
+  if (CALL_GETJSONVALUES(admission_json) < 0) {
+    SEC_FREE_KEY_VALUES();
+    return oidc_strcopy("");
+  }
+  KEY_VALUE_VARS(open, peak, accepted, rejected_maxcons, rejected_quota,
+                 rejected_rate);
+  char* text = oidc_sprintf(
+      "Connections: %s open (peak %s), %s accepted; rejected: %s over the "
+      "connection limit, %s over the per-user limit, %s over the rate "
+      "limit\n\n",
+      _open, _peak, _accepted, _rejected_maxcons, _rejected_quota,
+      _rejected_rate);
+  SEC_FREE_KEY_VALUES();
+  return text;
+}
+
+/**
+ * @brief formats the request queue statistics of one request class
+ */
+static char* _schedulerClassToText(const char* name, const char* class_json) {
+  INIT_KEY_VALUE("depth", "max_depth", "served", "avg_wait_ms",
+                 "max_wait_ms");
+  if (class_json == NULL || CALL_GETJSONVALUES(class_json) < 0) {
+    SEC_FREE_KEY_VALUES();
+    return NULL;
+  }
+  KEY_VALUE_VARS(depth, max_depth, served, avg_wait, max_wait);
+  char* text = oidc_sprintf(
+      "%s: %s queued (max %s), %s served, waited %s ms on average (max %s ms)",
+      name, _depth, _max_depth, _served, _avg_wait, _max_wait);
+  SEC_FREE_KEY_VALUES();
+  return text;
+}
+
+/**
+ * @brief formats the request queue statistics that oidcp added to a status
+ * request
+ */
+static char* _schedulerStatsToText(const char* scheduler_json) {
+  if (scheduler_json == NULL) {
+    return oidc_strcopy("");
+  }
+  INIT_KEY_VALUE("latency", "bulk");
+  if (CALL_GETJSONVALUES(scheduler_json) < 0) {
+    SEC_FREE_KEY_VALUES();
+    return oidc_strcopy("");
+  }
+  KEY_VALUE_VARS(latency, bulk);
+  char* latency = _schedulerClassToText("latency-sensitive", _latency);
+  char* bulk    = _schedulerClassToText("bulk", _bulk);
+  SEC_FREE_KEY_VALUES();
+  char* text = oidc_sprintf("Requests:\n  %s\n  %s\n\n", latency ?: "",
+                            bulk ?: "");
+  secFree(latency);
+  secFree(bulk);
+  return text;
+}
+
+/**
+ * @brief formats the allocations of one subsystem by size class
+ */
+static char* _memorySizeClassesToText(const struct memorySubsystemStats* s) {
+  list_t* classes = list_new();
+  classes->free   = (void (*)(void*))_secFree;
+  for (int c = 0; c < MEMORY_SIZE_CLASSES; c++) {
+    size_t limit = memory_sizeClassLimit(c);
+    list_rpush(classes,
+               list_node_new(
+                   limit ? oidc_sprintf("<=%lu: %lu", limit, s->size_classes[c])
+                         : oidc_sprintf(">%lu: %lu",
+                                        memory_sizeClassLimit(c - 1),
+                                        s->size_classes[c])));
+  }
+  char* text = listToDelimitedString(classes, ", ");
+  secFreeList(classes);
+  return text;
+}
+
+/**
+ * @brief formats the memory accounting of oidcd; empty if it is not enabled
+ */
+static char* _memoryStatsToText() {
+  if (!memory_accountingEnabled()) {
+    return oidc_strcopy("");
+  }
+  struct memoryStats stats;
+  memory_getStats(&stats);
+  list_t* lines = list_new();
+  lines->free   = (void (*)(void*))_secFree;
+  list_rpush(lines, list_node_new(oidc_sprintf(
+                        "Memory: %lu bytes live (peak %lu bytes)",
+                        stats.live_bytes, stats.peak_bytes)));
+  for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+    const struct memorySubsystemStats* s = &stats.subsystems[i];
+    if (s->allocations == 0) {
+      continue;
+    }
+    char* classes = _memorySizeClassesToText(s);
+    list_rpush(lines,
+               list_node_new(oidc_sprintf(
+                   "%s: %lu bytes live (peak %lu bytes), %lu allocations, %lu "
+                   "frees; by size: %s",
+                   memory_subsystemName(i), s->live_bytes, s->peak_bytes,
+                   s->allocations, s->frees, classes)));
+    secFree(classes);
+  }
+  list_rpush(lines, list_node_new(oidc_sprintf(
+                        "db entries: %lu accounts, %lu code verifiers, %lu "
+                        "files",
+                        db_getSize(OIDC_DB_ACCOUNTS),
+                        db_getSize(OIDC_DB_CODEVERIFIERS),
+                        db_getSize(OIDC_DB_FILES))));
+  char* joined = listToDelimitedString(lines, "\n  ");
+  secFreeList(lines);
+  char* text = oidc_sprintf("%s\n\n", joined);
+  secFree(joined);
+  return text;
+}
+
+/**
+ * @brief returns the memory accounting of oidcd as a json object string or
+ * @c NULL if it is not enabled
+ */
+static char* _memoryStatsToJSON() {
+  if (!memory_accountingEnabled()) {
+    return NULL;
+  }
+  struct memoryStats stats;
+  memory_getStats(&stats);
+  list_t* subsystems = list_new();
+  subsystems->free   = (void (*)(void*))_secFree;
+  for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+    const struct memorySubsystemStats* s       = &stats.subsystems[i];
+    list_t*                            classes = list_new();
+    classes->free = (void (*)(void*))_secFree;
+    for (int c = 0; c < MEMORY_SIZE_CLASSES; c++) {
+      list_rpush(classes,
+                 list_node_new(oidc_sprintf("%lu", s->size_classes[c])));
+    }
+    char* classes_str = listToDelimitedString(classes, ",");
+    secFreeList(classes);
+    list_rpush(subsystems,
+               list_node_new(oidc_sprintf(
+                   "\"%s\":{\"live_bytes\":%lu,\"peak_bytes\":%lu,"
+                   "\"allocations\":%lu,\"frees\":%lu,"
+                   "\"size_classes\":[%s]}",
+                   memory_subsystemName(i), s->live_bytes, s->peak_bytes,
+                   s->allocations, s->frees, classes_str)));
+    secFree(classes_str);
+  }
+  char* subsystems_str = listToDelimitedString(subsystems, ",");
+  secFreeList(subsystems);
+  char* json = oidc_sprintf(
+      "{\"live_bytes\":%lu,\"peak_bytes\":%lu,\"subsystems\":{%s},"
+      "\"db_entries\":{\"accounts\":%lu,\"code_verifiers\":%lu,"
+      "\"files\":%lu}}",
+      stats.live_bytes, stats.peak_bytes, subsystems_str,
+      db_getSize(OIDC_DB_ACCOUNTS), db_getSize(OIDC_DB_CODEVERIFIERS),
+      db_getSize(OIDC_DB_FILES));
+  secFree(subsystems_str);
+  return json;
+}
+
+/**
+ * @brief looks up the usage of a loaded account
+ * @return the state of the account: "loaded", "unloaded" if it was unloaded
+ * because of the account limit, or "restored" if it was restored from the
+ * state snapshot and not used yet; @c NULL if there is no such account
+ */
+static const char* _getAccountUsage(const char*           name,
+                                    struct account_usage* usage) {
+  struct oidc_account        key     = {.shortname = (char*)name};
+  const struct oidc_account* account = accountDB_findValue(&key);
+  if (account != NULL) {
+    usage->loaded_at = account_getLoadedAt(account);
+    usage->last_used = account_getLastUsed(account);
+    usage->requests  = account_getRequestCount(account);
+    return "loaded";
+  }
+  if (!snapshot_getPendingUsage(name, usage)) {
+    return NULL;
+  }
+  if (usage->last_used == 0) {
+    usage->last_used = usage->loaded_at;
+  }
+  return usage->loaded_at ? "unloaded" : "restored";
+}
+
+static double _requestsPerHour(const struct account_usage* usage, time_t now) {
+  time_t elapsed = now - usage->loaded_at;
+  return usage->requests * 3600.0 / (elapsed > 60 ? elapsed : 60);
+}
+
+/**
+ * @brief formats the usage of all loaded accounts
+ */
+static char* _accountUsageToText(list_t* names) {
+  if (names == NULL || names->len == 0) {
+    return oidc_strcopy("");
+  }
+  const time_t now   = time(NULL);
+  list_t*      lines = list_new();
+  lines->free        = (void (*)(void*))_secFree;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(names, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct account_usage usage = {0};
+    const char*          state = _getAccountUsage(node->val, &usage);
+    if (state == NULL) {
+      continue;
+    }
+    if (strequal(state, "restored")) {
+      list_rpush(lines,
+                 list_node_new(oidc_sprintf(
+                     "%s: restored from state snapshot, not used yet",
+                     (char*)node->val)));
+      continue;
+    }
+    list_rpush(lines,
+               list_node_new(oidc_sprintf(
+                   "%s: %s%lu requests (%.1f per hour), last used %lu seconds "
+                   "ago",
+                   (char*)node->val,
+                   strequal(state, "unloaded") ? "unloaded, " : "",
+                   usage.requests, _requestsPerHour(&usage, now),
+                   now - usage.last_used)));
+  }
+  list_iterator_destroy(it);
+  char* joined = listToDelimitedString(lines, "\n  ");
+  secFreeList(lines);
+  char* text = oidc_sprintf("Account usage:\n  %s\n\n", joined);
+  secFree(joined);
+  return text;
+}
+
+/**
+ * @brief returns the usage of all loaded accounts as a json object, keyed by
+ * account name
+ */
+static cJSON* _accountUsageToJSON(list_t* names) {
+  const time_t now  = time(NULL);
+  cJSON*       json = stringToJson("{}");
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(names, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct account_usage usage = {0};
+    const char*          state = _getAccountUsage(node->val, &usage);
+    if (state == NULL) {
+      continue;
+    }
+    cJSON* entry = generateJSONObject("state", cJSON_String, state, NULL);
+    jsonAddNumberValue(entry, "loaded_at", usage.loaded_at);
+    jsonAddNumberValue(entry, "last_used", usage.last_used);
+    jsonAddNumberValue(entry, "requests", usage.requests);
+    jsonAddNumberValue(entry, "requests_per_hour",
+                       usage.loaded_at ? _requestsPerHour(&usage, now) : 0);
+    jsonAddJSON(json, node->val, entry);
+  }
+  list_iterator_destroy(it);
+  return json;
+}
+
 void oidcd_handleAgentStatus(struct ipcPipe          pipes,
-                             const struct arguments* arguments) {
+                             const struct arguments* arguments,
+                             const char*             admission_json,
+                             const char*             scheduler_json) {
   const char* fmt =
       "####################################\n"
       "##       oidc-agent status        ##\n"
       "####################################\n"
       "\nThis agent is running version %s.\n\nThis agent was started with the "
-      "following options:\n%s\nCurrently there are %d accounts loaded: %s\n\n";
+      "following options:\n%s\nCurrently there are %d accounts loaded: %s\n\n"
+      "%s%s%s%s";
   list_t* names      = _getNameListLoadedAccounts();
   int     num_loaded = 0;
   char*   names_str  = NULL;
@@ -1075,10 +1600,19 @@ void oidcd_handleAgentStatus(struct ipcPipe          pipes,
     num_loaded = names->len;
     names_str  = listToDelimitedString(names, ", ");
   }
-  char* options = _argumentsToOptionsText(arguments);
+  char* options   = _argumentsToOptionsText(arguments);
+  char* usage     = _accountUsageToText(names);
+  char* admission = _admissionStatsToText(admission_json);
+  char* scheduler = _schedulerStatsToText(scheduler_json);
+  char* memory    = _memoryStatsToText();
   char* status =
-      oidc_sprintf(fmt, VERSION, options, num_loaded, names_str ?: "");
+      oidc_sprintf(fmt, VERSION, options, num_loaded, names_str ?: "", usage,
+                   admission, scheduler, memory);
   secFree(options);
+  secFree(usage);
+  secFree(admission);
+  secFree(scheduler);
+  secFree(memory);
   secFree(names_str);
   ipc_writeToPipe(pipes, RESPONSE_SUCCESS_INFO, status);
   secFreeList(names);
@@ -1086,9 +1620,12 @@ void oidcd_handleAgentStatus(struct ipcPipe          pipes,
 }
 
 void oidcd_handleAgentStatusJSON(struct ipcPipe          pipes,
-                                 const struct arguments* arguments) {
+                                 const struct arguments* arguments,
+                                 const char*             admission_json,
+                                 const char*             scheduler_json) {
   list_t* names   = _getNameListLoadedAccounts();
   cJSON*  names_j = listToJSONArray(names);
+  cJSON*  usage   = _accountUsageToJSON(names);
   secFreeList(names);
   char*  options = _argumentsToCommandLineOptions(arguments);
   cJSON* json =
@@ -1097,6 +1634,18 @@ void oidcd_handleAgentStatusJSON(struct ipcPipe          pipes,
   secFree(options);
   cJSON_AddItemToObject(json, "loaded_accounts",
                         names_j);  // names_j will freed with json
+  jsonAddJSON(json, "account_usage", usage);
+  if (admission_json != NULL) {
+    jsonAddObjectValue(json, INT_IPC_KEY_ADMISSION, admission_json);
+  }
+  if (scheduler_json != NULL) {
+    jsonAddObjectValue(json, INT_IPC_KEY_SCHEDULER, scheduler_json);
+  }
+  char* memory = _memoryStatsToJSON();
+  if (memory != NULL) {
+    jsonAddObjectValue(json, "memory", memory);
+    secFree(memory);
+  }
   char* info = jsonToString(json);
   secFreeJson(json);
   ipc_writeToPipe(pipes, RESPONSE_SUCCESS_INFO_OBJECT, info);
@@ -17,7 +17,7 @@ void oidcd_handleDeleteClient(struct ipcPipe pipes, const char* client_uri,
                               const char* registration_access_token,
                               const char* cert_path);
 void oidcd_handleRm(struct ipcPipe, char* account_name);
-void oidcd_handleRemoveAll(struct ipcPipe);
+void oidcd_handleRemoveAll(struct ipcPipe, const char* revoke_str);
 void oidcd_handleToken(struct ipcPipe, char* short_name,
                        const char* min_valid_period_str, const char* scope,
                        const char* application_hint, const char* audience,
@@ -31,6 +31,18 @@ void oidcd_handleIdToken(struct ipcPipe pipes, const char* short_name,
                          const char* issuer, const char* scope,
                          const char*             application_hint,
                          const struct arguments* arguments);
+void oidcd_handleUserinfo(struct ipcPipe pipes, const char* short_name,
+                          const char*             issuer,
+                          const char*             application_hint,
+                          const struct arguments* arguments);
+void oidcd_handleTokenExchange(struct ipcPipe pipes, const char* short_name,
+                               const char*             issuer,
+                               const char*             min_valid_period_str,
+                               const char*             audience,
+                               const char*             resource,
+                               const char*             scope,
+                               const char*             application_hint,
+                               const struct arguments* arguments);
 void oidcd_handleRegister(struct ipcPipe, const char* account_json,
                           const char* json_str, const char* access_token);
 void oidcd_handleCodeExchange(struct ipcPipe pipes, const char* redirected_uri,
@@ -44,9 +56,13 @@ void oidcd_handleListLoadedAccounts(struct ipcPipe pipes);
 void oidcd_handleTermHttp(struct ipcPipe, const char* state);
 void oidcd_handleLock(struct ipcPipe, const char* password, int _lock);
 void oidcd_handleAgentStatus(struct ipcPipe          pipes,
-                             const struct arguments* arguments);
+                             const struct arguments* arguments,
+                             const char*             admission_json,
+                             const char*             scheduler_json);
 void oidcd_handleAgentStatusJSON(struct ipcPipe          pipes,
-                                 const struct arguments* arguments);
+                                 const struct arguments* arguments,
+                                 const char*             admission_json,
+                             const char*             scheduler_json);
 void oidcd_handleFileRemove(struct ipcPipe pipes, const char* filename);
 void oidcd_handleFileRead(struct ipcPipe pipes, const char* filename);
 void oidcd_handleFileWrite(struct ipcPipe pipes, const char* filename,
@@ -0,0 +1,623 @@
+#define _XOPEN_SOURCE 700
+#include "state_snapshot.h"
+
+#include "account/account.h"
+#include "account/account_binary.h"
+#include "defines/agent_values.h"
+#include "defines/oidc_values.h"
+#include "defines/settings.h"
+#include "oidc-agent/agent_state.h"
+#include "utils/accountUtils.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/base64.h"
+#include "utils/crypt/crypt.h"
+#include "utils/crypt/dbCryptUtils.h"
+#include "utils/crypt/ipcCryptUtils.h"
+#include "utils/db/account_db.h"
+#include "utils/file_io/oidc_file_io.h"
+#include "utils/listUtils.h"
+#include "utils/matcher.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <fcntl.h>
+#include <sodium.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * A snapshot file starts with a header line
+ * "<STATE_SNAPSHOT_MAGIC> <STATE_SNAPSHOT_VERSION>"
+ * followed by one line per account:
+ * "<shortname>\t<issuer_url>\t<death>\t<sealed account>"
+ * The sealed account is the binary encoding of the account (see
+ * account_binary.h), which includes the current access token and the issuer
+ * metadata, in a binary ipc envelope encrypted with the snapshot key and
+ * base64 encoded.
+ * Entries are only unsealed when the account is used for the first time.
+ *
+ * If more accounts are loaded than allowed, the least recently used ones are
+ * unloaded: they are sealed the same way, appended to the unloaded file
+ * (STATE_UNLOADED_FILENAME) and only their index is kept in memory. They are
+ * read back and unsealed on their next use like restored entries. Without a
+ * snapshot key they are sealed with a random key that never leaves this
+ * process and is wiped once no entry is sealed with it, e.g. when the agent is
+ * locked; the unloaded file is removed at the same time.
+ */
+
+struct snapshot_entry {
+  char*                shortname;
+  char*                issuer_url;
+  time_t               death;
+  const char*          sealed;  // points into the mapped file; NULL if unloaded
+  size_t               sealed_len;
+  off_t                offset;  // offset in the unloaded file if unloaded
+  struct account_usage usage;   // only known for unloaded accounts
+};
+
+static unsigned char* snapshot_key     = NULL;
+static unsigned char* cold_key         = NULL;
+static list_t*        pending          = NULL;
+static void*          mapped           = NULL;
+static size_t         mapped_len       = 0;
+static size_t         mapped_entries   = 0;
+static time_t         last_write       = 0;
+static int            unloaded_fd      = -1;
+static off_t          unloaded_len     = 0;
+static size_t         unloaded_entries = 0;
+
+static void _secFreeSnapshotEntry(struct snapshot_entry* e) {
+  if (e == NULL) {
+    return;
+  }
+  if (e->sealed != NULL) {
+    mapped_entries--;
+  } else {
+    unloaded_entries--;
+  }
+  secFree(e->shortname);
+  secFree(e->issuer_url);
+  secFree(e);
+}
+
+static int _matchSnapshotEntryByName(const char*                  shortname,
+                                     const struct snapshot_entry* e) {
+  return strequal(e->shortname, shortname);
+}
+
+static void _initPending() {
+  if (pending != NULL) {
+    return;
+  }
+  pending        = list_new();
+  pending->free  = (freeFunction)_secFreeSnapshotEntry;
+  pending->match = (matchFunction)_matchSnapshotEntryByName;
+}
+
+void snapshot_setKey(const char* key_base64) {
+  snapshot_clearKey();
+  if (key_base64 == NULL) {
+    return;
+  }
+  snapshot_key = secAlloc(crypto_secretbox_KEYBYTES);
+  if (fromBase64(key_base64, crypto_secretbox_KEYBYTES, snapshot_key) != 0) {
+    agent_log(ERROR, "Invalid state snapshot key");
+    secFree(snapshot_key);
+  }
+}
+
+void snapshot_clearKey() { secFree(snapshot_key); }
+
+int snapshot_isEnabled() { return snapshot_key != NULL; }
+
+static const unsigned char* _sealKey() {
+  if (snapshot_key != NULL) {
+    return snapshot_key;
+  }
+  if (cold_key == NULL) {
+    cold_key = secAlloc(crypto_secretbox_KEYBYTES);
+    crypto_secretbox_keygen(cold_key);
+  }
+  return cold_key;
+}
+
+static void _unmapIfUnused() {
+  if (unloaded_fd >= 0 && unloaded_entries == 0) {
+    close(unloaded_fd);
+    unloaded_fd  = -1;
+    unloaded_len = 0;
+    removeOidcFile(STATE_UNLOADED_FILENAME);
+  }
+  if (mapped == NULL || mapped_entries > 0) {
+    return;
+  }
+  munmap(mapped, mapped_len);
+  mapped     = NULL;
+  mapped_len = 0;
+}
+
+/**
+ * @brief appends a sealed account to the unloaded file
+ * @param sealed the base64 encoded sealed account
+ * @param len the length of @p sealed
+ * @return the offset of the sealed account in the file or @c -1 on failure
+ */
+static off_t _writeUnloaded(const char* sealed, size_t len) {
+  if (unloaded_fd < 0) {
+    char* path  = concatToOidcDir(STATE_UNLOADED_FILENAME);
+    unloaded_fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                       S_IRUSR | S_IWUSR);
+    if (unloaded_fd < 0) {
+      agent_log(ERROR, "Could not open '%s': %m", path);
+      secFree(path);
+      oidc_setErrnoError();
+      return -1;
+    }
+    secFree(path);
+    unloaded_len = 0;
+  }
+  if (pwrite(unloaded_fd, sealed, len, unloaded_len) != (ssize_t)len) {
+    agent_log(ERROR, "Could not write unloaded account: %m");
+    oidc_setErrnoError();
+    return -1;
+  }
+  off_t offset = unloaded_len;
+  unloaded_len += len;
+  return offset;
+}
+
+/**
+ * @brief returns the sealed account of an entry
+ * @return a pointer into the mapped snapshot or, for unloaded accounts, a
+ * buffer read from the unloaded file that has to be freed
+ */
+static char* _readSealed(const struct snapshot_entry* e) {
+  if (e->sealed != NULL) {
+    return (char*)e->sealed;
+  }
+  char* sealed = secAlloc(e->sealed_len + 1);
+  if (pread(unloaded_fd, sealed, e->sealed_len, e->offset) !=
+      (ssize_t)e->sealed_len) {
+    agent_log(ERROR, "Could not read unloaded account: %m");
+    oidc_setErrnoError();
+    secFree(sealed);
+    return NULL;
+  }
+  return sealed;
+}
+
+static char* _sealAccount(const struct oidc_account* account) {
+  size_t         bin_len = 0;
+  unsigned char* bin     = accountToBinary(account, &bin_len);
+  if (bin == NULL) {
+    return NULL;
+  }
+  size_t         sealed_len = 0;
+  unsigned char* sealed =
+      ipcCryptSealBinary((char*)bin, bin_len, _sealKey(), &sealed_len);
+  secFree(bin);
+  if (sealed == NULL) {
+    return NULL;
+  }
+  char* sealed_base64 = toBase64((char*)sealed, sealed_len);
+  secFree(sealed);
+  return sealed_base64;
+}
+
+static struct oidc_account* _unsealAccount(const struct snapshot_entry* e) {
+  char* sealed_base64 = _readSealed(e);
+  if (sealed_base64 == NULL) {
+    return NULL;
+  }
+  const size_t   max_len      = e->sealed_len / 4 * 3;
+  unsigned char* sealed       = secAlloc(max_len + 1);
+  size_t         sealed_len   = 0;
+  int            decode_error = base64_decode(sealed, max_len, sealed_base64,
+                                              e->sealed_len, &sealed_len,
+                                              sodium_base64_VARIANT_ORIGINAL);
+  if (sealed_base64 != e->sealed) {
+    secFree(sealed_base64);
+  }
+  if (decode_error != 0 || sealed_len < ipcCryptBinaryLength(0)) {
+    secFree(sealed);
+    oidc_errno = OIDC_ECRYPMIPC;
+    return NULL;
+  }
+  char* bin = ipcCryptOpenBinary((char*)sealed, sealed_len, _sealKey());
+  secFree(sealed);
+  if (bin == NULL) {
+    return NULL;
+  }
+  struct oidc_account* account = getAccountFromBinary(
+      (unsigned char*)bin, sealed_len - ipcCryptBinaryLength(0));
+  secFree(bin);
+  if (account == NULL) {
+    return NULL;
+  }
+  account_setDeath(account, e->death);
+  if (account_getLoadedAt(account) == 0) {
+    account_setLoadedAt(account, time(NULL));
+  }
+  return account;
+}
+
+/**
+ * @brief writes the current state of oidcd to the snapshot file
+ * Loaded accounts are sealed with the snapshot key; entries that were restored
+ * but not yet used are written as they are. If the agent is locked, the
+ * snapshot is removed instead, since the accounts cannot be sealed.
+ * @return an oidc_error code
+ */
+oidc_error_t snapshot_write() {
+  if (!snapshot_isEnabled()) {
+    return OIDC_SUCCESS;
+  }
+  last_write = time(NULL);
+  if (agent_state.lock_state.locked) {
+    agent_log(NOTICE, "Agent is locked; removing state snapshot");
+    removeOidcFile(STATE_SNAPSHOT_FILENAME);
+    return OIDC_SUCCESS;
+  }
+  char* oidc_dir = getOidcDir();
+  if (oidc_dir == NULL) {
+    return oidc_errno;
+  }
+  char* path     = oidc_strcat(oidc_dir, STATE_SNAPSHOT_FILENAME);
+  char* tmp_path = oidc_strcat(path, ".tmp");
+  secFree(oidc_dir);
+  int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    agent_log(ERROR, "Could not open '%s': %m", tmp_path);
+    secFree(tmp_path);
+    secFree(path);
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  dprintf(fd, "%s %d\n", STATE_SNAPSHOT_MAGIC, STATE_SNAPSHOT_VERSION);
+  size_t          count    = 0;
+  const vector_t* accounts = accountDB_getList();
+  vector_foreach(accounts, i) {
+    struct oidc_account* account =
+        _db_decryptFoundAccount(vector_at(accounts, i));
+    char*                sealed  = _sealAccount(account);
+    if (sealed != NULL) {
+      dprintf(fd, "%s\t%s\t%lu\t%s\n", account_getName(account),
+              account_getIssuerUrl(account) ?: "", account_getDeath(account),
+              sealed);
+      count++;
+    }
+    secFree(sealed);
+    db_addAccountEncrypted(account);  // reencrypting
+  }
+  if (pending != NULL) {
+    time_t           now = time(NULL);
+    list_node_t*     node;
+    list_iterator_t* it = list_iterator_new(pending, LIST_HEAD);
+    while ((node = list_iterator_next(it))) {
+      struct snapshot_entry* e = node->val;
+      if (e->death && e->death < now) {
+        continue;
+      }
+      char* sealed = _readSealed(e);
+      if (sealed == NULL) {
+        continue;
+      }
+      dprintf(fd, "%s\t%s\t%lu\t%.*s\n", e->shortname, e->issuer_url, e->death,
+              (int)e->sealed_len, sealed);
+      if (sealed != e->sealed) {
+        secFree(sealed);
+      }
+      count++;
+    }
+    list_iterator_destroy(it);
+  }
+  fsync(fd);
+  close(fd);
+  if (rename(tmp_path, path) != 0) {
+    agent_log(ERROR, "Could not write state snapshot '%s': %m", path);
+    unlink(tmp_path);
+    secFree(tmp_path);
+    secFree(path);
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  agent_log(DEBUG, "Wrote state snapshot with %lu accounts", count);
+  secFree(tmp_path);
+  secFree(path);
+  return OIDC_SUCCESS;
+}
+
+static struct snapshot_entry* _parseEntry(const char* line, size_t len) {
+  const char* end   = line + len;
+  const char* field = line;
+  const char* tabs[3];
+  for (int i = 0; i < 3; i++) {
+    tabs[i] = memchr(field, '\t', end - field);
+    if (tabs[i] == NULL) {
+      return NULL;
+    }
+    field = tabs[i] + 1;
+  }
+  struct snapshot_entry* e = secAlloc(sizeof(struct snapshot_entry));
+  e->shortname             = oidc_strncopy(line, tabs[0] - line);
+  e->issuer_url            = oidc_strncopy(tabs[0] + 1, tabs[1] - tabs[0] - 1);
+  char* death              = oidc_strncopy(tabs[1] + 1, tabs[2] - tabs[1] - 1);
+  e->death                 = strToULong(death);
+  secFree(death);
+  e->sealed     = tabs[2] + 1;
+  e->sealed_len = end - e->sealed;
+  mapped_entries++;
+  return e;
+}
+
+/**
+ * @brief restores the state of a previous agent from the snapshot file
+ * The file is mapped into memory and only the index is parsed; accounts are
+ * unsealed on first use.
+ * @return an oidc_error code
+ */
+oidc_error_t snapshot_restore() {
+  if (!snapshot_isEnabled()) {
+    return OIDC_SUCCESS;
+  }
+  char* path = concatToOidcDir(STATE_SNAPSHOT_FILENAME);
+  int   fd   = open(path, O_RDONLY);
+  secFree(path);
+  if (fd < 0) {
+    agent_log(DEBUG, "No state snapshot found");
+    return OIDC_SUCCESS;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return OIDC_SUCCESS;
+  }
+  void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    agent_log(ERROR, "Could not map state snapshot: %m");
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  const char* data = addr;
+  const char* end  = data + st.st_size;
+  const char* nl   = memchr(data, '\n', end - data);
+  char*       header =
+      oidc_sprintf("%s %d", STATE_SNAPSHOT_MAGIC, STATE_SNAPSHOT_VERSION);
+  int valid = nl != NULL && (size_t)(nl - data) == strlen(header) &&
+              strncmp(data, header, nl - data) == 0;
+  secFree(header);
+  if (!valid) {
+    agent_log(NOTICE, "Ignoring state snapshot with unknown format");
+    munmap(addr, st.st_size);
+    return OIDC_SUCCESS;
+  }
+  snapshot_forgetAll();
+  mapped     = addr;
+  mapped_len = st.st_size;
+  _initPending();
+  time_t now = time(NULL);
+  for (const char* line = nl + 1; line < end; line = nl + 1) {
+    nl = memchr(line, '\n', end - line);
+    if (nl == NULL) {
+      break;
+    }
+    struct snapshot_entry* e = _parseEntry(line, nl - line);
+    if (e == NULL) {
+      continue;
+    }
+    if (e->death && e->death < now) {
+      _secFreeSnapshotEntry(e);
+      continue;
+    }
+    list_rpush(pending, list_node_new(e));
+  }
+  agent_log(DEBUG, "Restored state snapshot with %d accounts", pending->len);
+  _unmapIfUnused();
+  return OIDC_SUCCESS;
+}
+
+static oidc_error_t _unsealNode(list_node_t* node) {
+  struct snapshot_entry* e = node->val;
+  if (e->death && e->death < time(NULL)) {
+    list_remove(pending, node);
+    oidc_errno = OIDC_ENOACCOUNT;
+    return oidc_errno;
+  }
+  agent_log(DEBUG, "Unsealing '%s' from state snapshot", e->shortname);
+  struct oidc_account* account = _unsealAccount(e);
+  list_remove(pending, node);
+  if (account == NULL) {
+    agent_log(ERROR, "Could not unseal account from state snapshot: %s",
+              oidc_serror());
+    return oidc_errno;
+  }
+  db_addAccountEncrypted(account);
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief unseals a restored account and adds it to the loaded accounts
+ * @param shortname the shortname of the account
+ * @return an oidc_error code; @c OIDC_ENOACCOUNT if no such account is pending
+ */
+oidc_error_t snapshot_unsealAccount(const char* shortname) {
+  list_node_t* node = pending ? findInList(pending, shortname) : NULL;
+  if (node == NULL) {
+    oidc_errno = OIDC_ENOACCOUNT;
+    return oidc_errno;
+  }
+  oidc_error_t ret = _unsealNode(node);
+  _unmapIfUnused();
+  return ret;
+}
+
+void snapshot_unsealAccountsForIssuer(const char* issuer_url) {
+  if (pending == NULL) {
+    return;
+  }
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(pending, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct snapshot_entry* e = node->val;
+    if (matchUrls(e->issuer_url, issuer_url)) {
+      _unsealNode(node);
+    }
+  }
+  list_iterator_destroy(it);
+  _unmapIfUnused();
+}
+
+/**
+ * @brief unseals all restored and unloaded accounts, e.g. before every
+ * loaded account has to be looked at
+ */
+void snapshot_unsealAll() {
+  if (pending == NULL) {
+    return;
+  }
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(pending, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    _unsealNode(node);
+  }
+  list_iterator_destroy(it);
+  _unmapIfUnused();
+  secFree(cold_key);  // nothing is sealed with it anymore
+}
+
+/**
+ * @brief drops a restored account that was not yet unsealed
+ * @return @c 1 if such an account was pending, @c 0 otherwise
+ */
+int snapshot_forget(const char* shortname) {
+  list_node_t* node = pending ? findInList(pending, shortname) : NULL;
+  if (node == NULL) {
+    return 0;
+  }
+  list_remove(pending, node);
+  _unmapIfUnused();
+  return 1;
+}
+
+void snapshot_forgetAll() {
+  secFreeList(pending);
+  pending = NULL;
+  _unmapIfUnused();
+}
+
+/**
+ * @brief adds the names of all restored but not yet unsealed accounts to the
+ * passed list
+ */
+void snapshot_addPendingNames(list_t* names) {
+  if (pending == NULL || names == NULL) {
+    return;
+  }
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(pending, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    list_rpush(names,
+               list_node_new(((struct snapshot_entry*)node->val)->shortname));
+  }
+  list_iterator_destroy(it);
+}
+
+/**
+ * @brief returns the time when the next periodic snapshot is due
+ * @param interval the snapshot interval in seconds
+ * @return the time of the next snapshot or @c 0 if no periodic snapshots are
+ * written
+ */
+time_t snapshot_getNextWrite(time_t interval) {
+  if (!snapshot_isEnabled() || interval == 0) {
+    return 0;
+  }
+  if (last_write == 0) {
+    last_write = time(NULL);
+  }
+  return last_write + interval;
+}
+
+/**
+ * @brief unloads an account into the unloaded file
+ * @param account the account as found in the account db; it is removed from
+ * the db
+ * @return an oidc_error code
+ */
+static oidc_error_t _unloadAccount(struct oidc_account* account) {
+  _db_decryptFoundAccount(account);
+  char* sealed = _sealAccount(account);
+  if (sealed == NULL) {
+    db_addAccountEncrypted(account);  // reencrypting
+    return oidc_errno;
+  }
+  const size_t sealed_len = strlen(sealed);
+  const off_t  offset     = _writeUnloaded(sealed, sealed_len);
+  secFree(sealed);
+  if (offset < 0) {
+    db_addAccountEncrypted(account);  // reencrypting
+    return oidc_errno;
+  }
+  struct snapshot_entry* e = secAlloc(sizeof(struct snapshot_entry));
+  e->shortname             = oidc_strcopy(account_getName(account));
+  e->issuer_url            = oidc_strcopy(account_getIssuerUrl(account) ?: "");
+  e->death                 = account_getDeath(account);
+  e->sealed_len            = sealed_len;
+  e->offset                = offset;
+  e->usage                 = account->usage;
+  unloaded_entries++;
+  _initPending();
+  list_rpush(pending, list_node_new(e));
+  accountDB_removeIfFound(account);
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief unloads the least recently used accounts until at most
+ * @p max_loaded accounts are loaded
+ * Unloaded accounts are written sealed to the unloaded file and their memory
+ * is freed; they are loaded again on their next use without asking for the
+ * encryption password.
+ * @param max_loaded the maximum number of loaded accounts; @c 0 for no limit
+ */
+void snapshot_unloadIdleAccounts(size_t max_loaded) {
+  if (max_loaded == 0 || agent_state.lock_state.locked) {
+    return;
+  }
+  while (accountDB_getSize() > max_loaded) {
+    const vector_t*      accounts = accountDB_getList();
+    struct oidc_account* idle     = NULL;
+    vector_foreach(accounts, i) {
+      struct oidc_account* account = vector_at(accounts, i);
+      if (idle == NULL ||
+          account_getLastUsed(account) < account_getLastUsed(idle)) {
+        idle = account;
+      }
+    }
+    agent_log(DEBUG, "Unloading idle account '%s'", account_getName(idle));
+    if (_unloadAccount(idle) != OIDC_SUCCESS) {
+      agent_log(ERROR, "Could not unload account: %s", oidc_serror());
+      return;
+    }
+  }
+}
+
+/**
+ * @brief looks up an account that is not unsealed yet
+ * @param usage is set to the usage of the account if it was unloaded; it is
+ * zeroed for accounts restored from a snapshot
+ * @return @c 1 if such an account is pending, @c 0 otherwise
+ */
+int snapshot_getPendingUsage(const char* shortname,
+                             struct account_usage* usage) {
+  list_node_t* node = pending ? findInList(pending, shortname) : NULL;
+  if (node == NULL) {
+    return 0;
+  }
+  *usage = ((struct snapshot_entry*)node->val)->usage;
+  return 1;
+}
@@ -0,0 +1,29 @@
+#ifndef OIDCD_STATE_SNAPSHOT_H
+#define OIDCD_STATE_SNAPSHOT_H
+
+#include "account/account.h"
+#include "utils/oidc_error.h"
+#include "wrapper/list.h"
+
+#include <time.h>
+
+#define STATE_SNAPSHOT_MAGIC "OIDC-AGENT-STATE"
+#define STATE_SNAPSHOT_VERSION 2
+
+void         snapshot_setKey(const char* key_base64);
+void         snapshot_clearKey();
+int          snapshot_isEnabled();
+oidc_error_t snapshot_write();
+oidc_error_t snapshot_restore();
+oidc_error_t snapshot_unsealAccount(const char* shortname);
+void         snapshot_unsealAccountsForIssuer(const char* issuer_url);
+void         snapshot_unsealAll();
+int          snapshot_forget(const char* shortname);
+void         snapshot_forgetAll();
+void         snapshot_addPendingNames(list_t* names);
+time_t       snapshot_getNextWrite(time_t interval);
+void         snapshot_unloadIdleAccounts(size_t max_loaded);
+int          snapshot_getPendingUsage(const char*           shortname,
+                                      struct account_usage* usage);
+
+#endif  // OIDCD_STATE_SNAPSHOT_H
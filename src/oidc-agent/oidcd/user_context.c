@@ -0,0 +1,62 @@
+#include "user_context.h"
+#include "oidc-agent/agent_state.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/memoryCrypt.h"
+#include "utils/db/db.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "wrapper/list.h"
+
+/**
+ * All user contexts; the current one is @c current. The lock state of the
+ * current user is kept in @c agent_state, so that the existing lock handling
+ * works unchanged; it is saved in the context when switching away.
+ */
+static list_t*              contexts = NULL;
+static struct user_context* current  = NULL;
+
+extern uint64_t _getMemoryPass();
+
+static int matchUserContext(const unsigned long*       uid,
+                            const struct user_context* c) {
+  return c->uid == *uid;
+}
+
+static void _initContexts() {
+  if (contexts != NULL) {
+    return;
+  }
+  contexts        = list_new();
+  contexts->match = (matchFunction)matchUserContext;
+  contexts->free  = (freeFunction)_secFree;
+  // The default context is the one oidcd was started with
+  current              = secAlloc(sizeof(struct user_context));
+  current->uid         = db_getScope();
+  current->memory_pass = _getMemoryPass();
+  list_rpush(contexts, list_node_new(current));
+}
+
+/**
+ * @brief switches to the context of the user @p uid; all following requests
+ * only see the accounts and the lock state of this user. A new context with
+ * its own memory encryption pass is created on first use.
+ */
+void userContext_switch(unsigned long uid) {
+  _initContexts();
+  if (current->uid == uid) {
+    return;
+  }
+  current->lock_state = agent_state.lock_state;
+  list_node_t* node   = findInList(contexts, &uid);
+  if (node == NULL) {
+    struct user_context* c = secAlloc(sizeof(struct user_context));
+    c->uid                 = uid;
+    c->memory_pass         = memoryCrypt_generatePass();
+    node                   = list_rpush(contexts, list_node_new(c));
+    agent_log(DEBUG, "Created context for user %lu", uid);
+  }
+  current                = node->val;
+  agent_state.lock_state = current->lock_state;
+  memoryCrypt_setPass(current->memory_pass);
+  db_setScope(uid);
+}
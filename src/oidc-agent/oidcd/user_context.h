@@ -0,0 +1,20 @@
+#ifndef OIDCD_USER_CONTEXT_H
+#define OIDCD_USER_CONTEXT_H
+
+#include "oidc-agent/lock_state.h"
+
+#include <stdint.h>
+
+/**
+ * the per-user state of a multi-user agent. The DBs of a user are kept in the
+ * db scope with the same id.
+ */
+struct user_context {
+  unsigned long     uid;
+  uint64_t          memory_pass;
+  struct lock_state lock_state;
+};
+
+void userContext_switch(unsigned long uid);
+
+#endif  // OIDCD_USER_CONTEXT_H
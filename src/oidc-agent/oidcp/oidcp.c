@@ -4,17 +4,28 @@
 #include "defines/ipc_values.h"
 #include "defines/oidc_values.h"
 #include "defines/settings.h"
+#include "ipc/admission.h"
+#include "ipc/cancelPipe.h"
 #include "ipc/cryptCommunicator.h"
 #include "ipc/cryptIpc.h"
+#include "ipc/ipc.h"
+#include "ipc/peercred.h"
 #include "ipc/pipe.h"
 #include "ipc/serveripc.h"
+#include "ipc/tcp_serveripc.h"
 #include "oidc-agent/agent_state.h"
 #include "oidc-agent/daemonize.h"
 #include "oidc-agent/oidcd/parse_internal.h"
+#include "oidc-agent/oidcd/state_snapshot.h"
+#include "oidc-agent/oidcr/start_oidcr.h"
 #include "oidc-agent/oidcp/passwords/askpass.h"
+#ifndef __APPLE__
+#include "oidc-agent/oidcp/passwords/keyring.h"
+#endif
 #include "oidc-agent/oidcp/passwords/password_handler.h"
 #include "oidc-agent/oidcp/passwords/password_store.h"
 #include "oidc-agent/oidcp/proxy_handler.h"
+#include "oidc-agent/oidcp/request_queue.h"
 #include "oidc-agent/oidcp/start_oidcd.h"
 #ifndef __APPLE__
 #include "privileges/agent_privileges.h"
@@ -22,6 +33,7 @@
 #include "utils/agentLogger.h"
 #include "utils/crypt/crypt.h"
 #include "utils/db/connection_db.h"
+#include "utils/db/db.h"
 #include "utils/disableTracing.h"
 #include "utils/json.h"
 #include "utils/listUtils.h"
@@ -35,9 +47,16 @@
 #ifndef __APPLE__
 #include <sys/prctl.h>
 #endif
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 
+/**
+ * set for a multi-user system agent; internal requests that would act on
+ * behalf of the agent user instead of the requesting user are refused
+ */
+static unsigned char multi_user = 0;
+
 int main(int argc, char** argv) {
   platform_disable_tracing();
   agent_openlog("oidc-agent.p");
@@ -52,6 +71,15 @@ int main(int argc, char** argv) {
   if (arguments.debug) {
     logger_setloglevel(DEBUG);
   }
+  if (arguments.multi_user) {
+    // The agent user's config files and keyring must not be used on behalf
+    // of other users
+    arguments.no_autoload    = 1;
+    arguments.no_webserver   = 1;
+    arguments.state_snapshot = 0;
+    // Unloaded accounts are not kept per user
+    arguments.max_loaded_accounts = 0;
+  }
 #ifndef __APPLE__
   if (arguments.seccomp) {
     initOidcAgentPrivileges(&arguments);
@@ -100,28 +128,87 @@ int main(int argc, char** argv) {
 
   struct connection* listencon = secAlloc(sizeof(struct connection));
   signal(SIGPIPE, SIG_IGN);
-  if (ipc_server_init(listencon, arguments.group) != OIDC_SUCCESS) {
+  oidc_error_t activation = ipc_server_initFromListenFds(listencon);
+  if (activation != OIDC_SUCCESS && activation != OIDC_ENOLISTENFD) {
     printError("%s\n", oidc_serror());
     exit(EXIT_FAILURE);
   }
+  const unsigned char socketActivated = activation == OIDC_SUCCESS;
+  if (!socketActivated &&
+      (arguments.multi_user
+           ? ipc_server_initWithSocketPath(listencon, MULTI_USER_SOCKET_PATH)
+           : ipc_server_init(listencon, arguments.group)) != OIDC_SUCCESS) {
+    printError("%s\n", oidc_serror());
+    exit(EXIT_FAILURE);
+  }
+
+  admission_setLimits((struct admission_limits){
+      .max_connections      = arguments.max_connections,
+      .peer_max_connections = arguments.peer_max_connections,
+      .peer_rate            = arguments.peer_rate_limit});
 
-  if (!arguments.console) {
+  if (arguments.fast_ipc &&
+      server_ipc_allowPlainPeers(arguments.group, arguments.multi_user) !=
+          OIDC_SUCCESS) {
+    printError("%s\n", oidc_serror());
+    exit(EXIT_FAILURE);
+  }
+
+  struct connection* remotecon = NULL;
+  if (arguments.remote_port) {
+    remotecon = secAlloc(sizeof(struct connection));
+    if (ipc_tcp_server_init(remotecon, arguments.remote_bind,
+                            arguments.remote_port) != OIDC_SUCCESS ||
+        ipc_tcp_bindAndListen(remotecon) != 0) {
+      printError("Could not listen on %s:%hu: %s\n", arguments.remote_bind,
+                 arguments.remote_port, oidc_serror());
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // A socket activated agent is supervised by the service manager and must not
+  // daemonize
+  if (!arguments.console && !socketActivated) {
     pid_t daemon_pid = daemonize();
     if (daemon_pid > 0) {
       // Export PID of new daemon
       printEnvs(listencon->server->sun_path, daemon_pid, arguments.quiet,
-                arguments.json);
+                arguments.json, arguments.fast_ipc);
       exit(EXIT_SUCCESS);
     }
   } else {
     printEnvs(listencon->server->sun_path, getpid(), arguments.quiet,
-              arguments.json);
+              arguments.json, arguments.fast_ipc);
   }
 
   agent_state.defaultTimeout = arguments.lifetime;
-  struct ipcPipe pipes       = startOidcd(&arguments);
+  if (remotecon != NULL) {
+    startOidcr(remotecon, listencon->server->sun_path, &arguments);
+    secFreeConnection(remotecon);
+  }
+#ifndef __APPLE__
+  if (arguments.state_snapshot) {
+    char* key = keyring_getStateSnapshotKey();
+    if (key == NULL) {
+      agent_log(ERROR, "Disabling state snapshot: %s", oidc_serror());
+      arguments.state_snapshot = 0;
+    }
+    snapshot_setKey(key);
+    secFree(key);
+  }
+#endif
+  struct ipcPipe pipes = {.rx = -1, .tx = -1};
+  if (!arguments.lazy_start) {
+    pipes = startOidcdWithState(&arguments);
+  }
 
-  if (ipc_bindAndListen(listencon) != 0) {
+  if (!socketActivated &&
+      ipc_bindAndListen(listencon, arguments.listen_backlog) != 0) {
+    exit(EXIT_FAILURE);
+  }
+  if (arguments.multi_user && !socketActivated &&
+      chmod(listencon->server->sun_path, 0666) != 0) {
+    agent_log(ERROR, "Could not make socket accessible to all users: %m");
     exit(EXIT_FAILURE);
   }
 
@@ -130,76 +217,269 @@ int main(int argc, char** argv) {
   return EXIT_FAILURE;
 }
 
+/**
+ * @brief forks oidcd; the state snapshot key is only kept in oidcd
+ */
+struct ipcPipe startOidcdWithState(const struct arguments* arguments) {
+  struct ipcPipe pipes = startOidcd(arguments);
+  snapshot_clearKey();
+  return pipes;
+}
+
+static void _minPasswordDeathOfScope(
+    unsigned long scope __attribute__((unused)), void* arg) {
+  time_t* min   = arg;
+  time_t  death = getMinPasswordDeath();
+  if (death > 0 && (*min == 0 || death < *min)) {
+    *min = death;
+  }
+}
+
+static void _removeDeathPasswordsOfScope(
+    unsigned long scope __attribute__((unused)),
+    void*         arg __attribute__((unused))) {
+  removeDeathPasswords();
+}
+
+/**
+ * @brief switches to the password store of the user on the other end of
+ * @p sock and adds the user's uid to the request, so that oidcd can switch to
+ * the user's context. A uid already contained in the request is overwritten.
+ * @return the request for oidcd or @c NULL on failure. Has to be freed after
+ * usage.
+ */
+static char* _scopeRequestToPeer(int sock, const char* q) {
+  struct peer_cred cred;
+  if (ipc_getPeerCredentials(sock, &cred) != OIDC_SUCCESS) {
+    return NULL;
+  }
+  cJSON* json = stringToJson(q);
+  if (json == NULL) {
+    return NULL;
+  }
+  char* uid = oidc_sprintf("%lu", (unsigned long)cred.uid);
+  setJSONValue(json, INT_IPC_KEY_PEERUID, uid);
+  secFree(uid);
+  char* scoped = jsonToStringUnformatted(json);
+  secFreeJson(json);
+  db_setScope(cred.uid);
+  agent_log(DEBUG, "Handling request of user %lu", (unsigned long)cred.uid);
+  return scoped;
+}
+
+/**
+ * @brief adds the admission counters and the request queue statistics of
+ * oidcp to a status request, so that oidcd can include them in the status. A
+ * multi-user agent only includes the per-user counters of the requesting user.
+ * @return the request for oidcd. Has to be freed after usage.
+ */
+static char* _addProxyStats(const struct connection* con, const char* q) {
+  struct peer_cred cred;
+  const uid_t*     only_uid = NULL;
+  if (multi_user) {
+    if (ipc_getPeerCredentials(*(con->msgsock), &cred) != OIDC_SUCCESS) {
+      return oidc_strcopy(q);
+    }
+    only_uid = &cred.uid;
+  }
+  cJSON* json = stringToJson(q);
+  if (json == NULL) {
+    return oidc_strcopy(q);
+  }
+  char* stats = admission_getStatsJSON(only_uid);
+  setJSONValue(json, INT_IPC_KEY_ADMISSION, stats);
+  secFree(stats);
+  stats = requestQueue_getStatsJSON();
+  setJSONValue(json, INT_IPC_KEY_SCHEDULER, stats);
+  secFree(stats);
+  char* request = jsonToStringUnformatted(json);
+  secFreeJson(json);
+  return request;
+}
+
+static void _removeConnection(struct connection* con) {
+  agent_log(DEBUG, "Remove con from pool");
+  connectionDB_removeIfFound(con);
+  agent_log(DEBUG, "Currently there are %lu connections",
+            connectionDB_getSize());
+}
+
+/**
+ * @brief reads the request of a client connection that became readable and
+ * queues it. Rejected and unreadable requests are answered right away. If a
+ * request of the connection is already queued, either the client hung up and
+ * the request is dropped, or the client sent more data, which is left unread.
+ */
+static void _queueClientRequest(struct connection* con) {
+  if (requestQueue_contains(con)) {
+    if (!ipc_peerClosed(*(con->msgsock))) {
+      agent_log(DEBUG, "Client sent more data while its request was queued");
+      con->pipelined = 1;
+      return;
+    }
+    agent_log(DEBUG, "Client disconnected while its request was queued");
+    requestQueue_removeConnection(con);
+    _removeConnection(con);
+    return;
+  }
+  char* q = server_ipc_read(con);
+  if (q == NULL) {
+    server_ipc_writeOidcErrnoPlain(con);
+    _removeConnection(con);
+    return;
+  }
+  requestQueue_push(con, q);
+}
+
+/**
+ * @brief handles one queued client request and removes its connection
+ */
+static struct ipcPipe _handleClientRequest(struct connection* con, char* q,
+                                           struct ipcPipe          pipes,
+                                           const struct arguments* arguments) {
+  if (multi_user) {
+    char* scoped = _scopeRequestToPeer(*(con->msgsock), q);
+    secFree(q);
+    q = scoped;
+  }
+  if (q == NULL) {
+    server_ipc_writeOidcErrnoPlain(con);
+  } else {  // NULL != q
+    INIT_KEY_VALUE(IPC_KEY_REQUEST, IPC_KEY_PASSWORDENTRY, IPC_KEY_SHORTNAME);
+    if (CALL_GETJSONVALUES(q) < 0) {
+      server_ipc_write(con, RESPONSE_BADREQUEST, oidc_serror());
+    } else {
+      KEY_VALUE_VARS(request, passwordentry, shortname);
+      if (_request) {
+        if (strequal(_request, REQUEST_VALUE_ADD) ||
+            strequal(_request, REQUEST_VALUE_GEN)) {
+          pw_handleSave(_passwordentry, arguments->pw_lifetime);
+        } else if (strequal(_request, REQUEST_VALUE_REMOVE)) {
+          removePasswordFor(_shortname);
+        } else if (strequal(_request, REQUEST_VALUE_REMOVEALL)) {
+          removeAllPasswords();
+        }
+        if (pipes.rx < 0) {  // lazy start: oidcd is started on first use
+          agent_log(DEBUG, "Starting oidcd on first request");
+          pipes = startOidcdWithState(arguments);
+        }
+        if (strequal(_request, REQUEST_VALUE_STATUS) ||
+            strequal(_request, REQUEST_VALUE_STATUS_JSON)) {
+          char* with_stats = _addProxyStats(con, q);
+          secFree(q);
+          q = with_stats;
+        }
+        handleOidcdComm(pipes, con, q);
+      } else {  //  no request type
+        server_ipc_write(con, RESPONSE_BADREQUEST, "No request type.");
+      }
+    }
+    SEC_FREE_KEY_VALUES();
+    secFree(q);
+  }
+  _removeConnection(con);
+  return pipes;
+}
+
+/**
+ * @brief the main loop of oidcp
+ *
+ * Requests of all client connections that are readable are queued before one
+ * request is passed to oidcd, so that latency-sensitive requests can be served
+ * before bulk requests that arrived earlier (see @c requestQueue_pop).
+ */
 void handleClientComm(struct connection* listencon, struct ipcPipe pipes,
                       const struct arguments* arguments) {
   connectionDB_new();
   connectionDB_setFreeFunction((void (*)(void*)) & _secFreeConnection);
   connectionDB_setMatchFunction((matchFunction)connection_comparator);
+  multi_user = arguments->multi_user;
 
   time_t minDeath = 0;
   while (1) {
-    minDeath = getMinPasswordDeath();
-    struct connection* con =
-        ipc_readAsyncFromMultipleConnectionsWithTimeout(*listencon, minDeath);
-    if (con == NULL) {  // timeout reached
-      removeDeathPasswords();
-      continue;
-    }
-    char* q = server_ipc_read(*(con->msgsock));
-    if (q == NULL) {
-      server_ipc_writeOidcErrnoPlain(*(con->msgsock));
-    } else {  // NULL != q
-      INIT_KEY_VALUE(IPC_KEY_REQUEST, IPC_KEY_PASSWORDENTRY, IPC_KEY_SHORTNAME);
-      if (CALL_GETJSONVALUES(q) < 0) {
-        server_ipc_write(*(con->msgsock), RESPONSE_BADREQUEST, oidc_serror());
-      } else {
-        KEY_VALUE_VARS(request, passwordentry, shortname);
-        if (_request) {
-          if (strequal(_request, REQUEST_VALUE_ADD) ||
-              strequal(_request, REQUEST_VALUE_GEN)) {
-            pw_handleSave(_passwordentry, arguments->pw_lifetime);
-          } else if (strequal(_request, REQUEST_VALUE_REMOVE)) {
-            removePasswordFor(_shortname);
-          } else if (strequal(_request, REQUEST_VALUE_REMOVEALL)) {
-            removeAllPasswords();
-          }
-          handleOidcdComm(pipes, *(con->msgsock), q);
-        } else {  //  no request type
-          server_ipc_write(*(con->msgsock), RESPONSE_BADREQUEST,
-                           "No request type.");
-        }
+    struct connection* con = NULL;
+    if (requestQueue_isEmpty()) {
+      minDeath = 0;
+      db_forEachScope(_minPasswordDeathOfScope, &minDeath);
+      con =
+          ipc_readAsyncFromMultipleConnectionsWithTimeout(*listencon, minDeath);
+      if (con == NULL) {  // timeout reached
+        db_forEachScope(_removeDeathPasswordsOfScope, NULL);
+        continue;
       }
-      SEC_FREE_KEY_VALUES();
-      secFree(q);
+      _queueClientRequest(con);
+    }
+    // queue everything that is already waiting, without blocking
+    while ((con = ipc_readAsyncFromMultipleConnectionsNoWait(*listencon)) !=
+           NULL) {
+      _queueClientRequest(con);
+    }
+    char* q = requestQueue_pop(&con);
+    if (q != NULL) {
+      pipes = _handleClientRequest(con, q, pipes, arguments);
+    }
+  }
+}
+
+/**
+ * @brief tells oidcd to cancel the current request if the client hung up
+ * @return @c 1 if the request is cancelled, @c 0 otherwise
+ */
+static int _cancelIfClientGone(const struct connection* con,
+                               unsigned char*           cancelled) {
+  if (!*cancelled && ipc_peerClosed(*(con->msgsock))) {
+    agent_log(NOTICE, "Client disconnected, cancelling its request");
+    *cancelled = 1;
+    cancelPipe_send();
+  }
+  return *cancelled;
+}
+
+/**
+ * @brief sends a message to oidcd and reads the response; while waiting, the
+ * client socket is watched. If the client hangs up, oidcd is told to cancel
+ * the request. The response is read anyway, so that the pipes stay in sync.
+ */
+static char* _communicateWithOidcd(struct ipcPipe           pipes,
+                                   const struct connection* con,
+                                   const char*              send,
+                                   unsigned char*           cancelled) {
+  if (ipc_writeToPipe(pipes, "%s", send) != OIDC_SUCCESS) {
+    return NULL;
+  }
+  if (!*cancelled) {
+    char* res = ipc_readFromPipeUnlessHangup(pipes, *(con->msgsock));
+    if (res != NULL || oidc_errno != OIDC_ECANCELED) {
+      return res;
     }
-    agent_log(DEBUG, "Remove con from pool");
-    connectionDB_removeIfFound(con);
-    agent_log(DEBUG, "Currently there are %lu connections",
-              connectionDB_getSize());
+    _cancelIfClientGone(con, cancelled);
   }
+  return ipc_readFromPipe(pipes);
 }
 
-void handleOidcdComm(struct ipcPipe pipes, int sock, const char* msg) {
+void handleOidcdComm(struct ipcPipe pipes, struct connection* con,
+                     const char* msg) {
   char* send = oidc_strcopy(msg);
   INIT_KEY_VALUE(IPC_KEY_REQUEST, OIDC_KEY_REFRESHTOKEN, IPC_KEY_SHORTNAME,
                  IPC_KEY_APPLICATIONHINT, IPC_KEY_ISSUERURL);
+  unsigned char cancelled = 0;
   while (1) {
     // RESET_KEY_VALUE_VALUES_TO_NULL();
-    char* oidcd_res = ipc_communicateThroughPipe(pipes, send);
+    char* oidcd_res = _communicateWithOidcd(pipes, con, send, &cancelled);
     secFree(send);
     if (oidcd_res == NULL) {
       if (oidc_errno == OIDC_EIPCDIS || oidc_errno == OIDC_EWRITE) {
         agent_log(ERROR, "oidcd died");
-        server_ipc_write(sock, RESPONSE_ERROR, "oidcd died");
+        server_ipc_write(con, RESPONSE_ERROR, "oidcd died");
         exit(EXIT_FAILURE);
       }
       agent_log(ERROR, "no response from oidcd");
-      server_ipc_writeOidcErrno(sock);
+      server_ipc_writeOidcErrno(con);
       return;
     }  // oidcd_res!=NULL
        // check response, it might be an internal request
     if (CALL_GETJSONVALUES(oidcd_res) < 0) {
-      server_ipc_write(sock, RESPONSE_BADREQUEST, oidc_serror());
+      server_ipc_write(con, RESPONSE_BADREQUEST, oidc_serror());
       secFree(oidcd_res);
       SEC_FREE_KEY_VALUES();
       return;
@@ -207,13 +487,34 @@ void handleOidcdComm(struct ipcPipe pipes, int sock, const char* msg) {
     KEY_VALUE_VARS(request, refresh_token, shortname, application_hint, issuer);
     if (_request == NULL) {  // if the response is the final response, forward
                              // it to the client
-      server_ipc_write(sock,
-                       oidcd_res);  // Forward oidcd response to client
+      if (cancelled) {
+        agent_log(DEBUG, "Dropping response for disconnected client");
+      } else {
+        server_ipc_write(con, oidcd_res);  // Forward oidcd response to client
+      }
       secFree(oidcd_res);
       SEC_FREE_KEY_VALUES();
       return;
     }
     secFree(oidcd_res);
+    if (multi_user && !strequal(_request, INT_REQUEST_VALUE_QUERY_ACCDEFAULT)) {
+      // These requests would use the agent user's files and display
+      oidc_errno = OIDC_EMULTIUSER;
+      send       = strequal(_request, INT_REQUEST_VALUE_UPD_REFRESH)
+                       ? oidc_sprintf(RESPONSE_ERROR, oidc_serror())
+                       : oidc_sprintf(INT_RESPONSE_ERROR, oidc_errno);
+      SEC_FREE_KEY_VALUES();
+      continue;
+    }
+    if ((strequal(_request, INT_REQUEST_VALUE_AUTOLOAD) ||
+         strequal(_request, INT_REQUEST_VALUE_CONFIRM) ||
+         strequal(_request, INT_REQUEST_VALUE_CONFIRMIDTOKEN)) &&
+        _cancelIfClientGone(con, &cancelled)) {
+      // Nobody is waiting for the result, so the user is not prompted
+      send = oidc_sprintf(INT_RESPONSE_ERROR, OIDC_ECANCELED);
+      SEC_FREE_KEY_VALUES();
+      continue;
+    }
     if (strequal(_request, INT_REQUEST_VALUE_UPD_REFRESH)) {
       oidc_error_t e = updateRefreshToken(_shortname, _refresh_token);
       send           = e == OIDC_SUCCESS ? oidc_strcopy(RESPONSE_SUCCESS)
@@ -248,7 +549,9 @@ void handleOidcdComm(struct ipcPipe pipes, int sock, const char* msg) {
       continue;
     } else if (strequal(_request, INT_REQUEST_VALUE_QUERY_ACCDEFAULT)) {
       char* account = NULL;
-      if (strValid(_issuer)) {  // default for this issuer
+      if (multi_user) {  // only the requesting user knows their default
+        oidc_errno = OIDC_EMULTIUSER;
+      } else if (strValid(_issuer)) {  // default for this issuer
         account = getDefaultAccountConfigForIssuer(_issuer);
       } else {                      // global default
         oidc_errno = OIDC_NOTIMPL;  // TODO
@@ -259,7 +562,7 @@ void handleOidcdComm(struct ipcPipe pipes, int sock, const char* msg) {
       continue;
     } else {
       server_ipc_write(
-          sock, "Internal communication error: unknown internal request");
+          con, "Internal communication error: unknown internal request");
       SEC_FREE_KEY_VALUES();
       return;
     }
@@ -10,8 +10,11 @@ const char* argp_program_version = AGENT_VERSION;
 
 const char* argp_program_bug_address = BUG_ADDRESS;
 
-void handleOidcdComm(struct ipcPipe pipes, int sock, const char* msg);
-void handleClientComm(struct connection* listencon, struct ipcPipe pipes,
-                      const struct arguments* arguments);
+struct ipcPipe startOidcdWithState(const struct arguments* arguments);
+void           handleOidcdComm(struct ipcPipe pipes, struct connection* con,
+                               const char* msg);
+void           handleClientComm(struct connection*      listencon,
+                                struct ipcPipe          pipes,
+                                const struct arguments* arguments);
 
 #endif  // OIDC_PROXY_DAEMON_H
@@ -1,20 +1,44 @@
 #include "agent_prompt.h"
+#include "prompt_broker.h"
+#include "utils/memory.h"
 #include "utils/prompt.h"
+#include "utils/stringUtils.h"
 
 #include <signal.h>
 
 typedef void (*sighandler_t)(int);
 
+#define AGENT_PROMPT_TITLE "oidc-agent prompt"
+#define AGENT_PROMPT_CONFIRM_TITLE "oidc-agent prompt confirm"
+
 char* agent_promptPassword(const char* text, const char* label,
                            const char* init) {
-  // _promptPasswordGUI might raise SIGINT (if user cancels), oidcp should not
-  // crash then
+  int   status = 0;
+  char* ret    = promptBroker_prompt("password", AGENT_PROMPT_TITLE, text,
+                                     label, init, &status);
+  if (ret != NULL) {
+    if (status != 0 || !strValid(ret)) {  // Cancel
+      secFree(ret);
+    }
+    return ret;
+  }
+  // oidc-prompt without broker support; _promptPasswordGUI might raise SIGINT
+  // (if user cancels), oidcp should not crash then
   sighandler_t old = signal(SIGINT, SIG_IGN);
-  char*        ret = _promptPasswordGUI(text, label, init);
+  ret              = _promptPasswordGUI(text, label, init);
   signal(SIGINT, old);
   return ret;
 }
 
 int agent_promptConsentDefaultYes(const char* text) {
-  return _promptConsentGUIDefaultYes(text);
+  int   status = 0;
+  char* out    = promptBroker_prompt("confirm-default-yes",
+                                     AGENT_PROMPT_CONFIRM_TITLE, text, NULL,
+                                     NULL, &status);
+  if (out == NULL) {  // oidc-prompt without broker support
+    return _promptConsentGUIDefaultYes(text);
+  }
+  int ret = status == 0 && strcaseequal(out, "yes") ? 1 : 0;
+  secFree(out);
+  return ret;
 }
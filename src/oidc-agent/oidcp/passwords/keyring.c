@@ -1,10 +1,12 @@
 #ifndef __APPLE__
 #include "keyring.h"
 #include "utils/agentLogger.h"
+#include "utils/crypt/crypt.h"
 #include "utils/oidc_error.h"
 #include "utils/stringUtils.h"
 
 #include <libsecret/secret.h>
+#include <sodium.h>
 
 const SecretSchema* agent_get_schema(void) G_GNUC_CONST;
 
@@ -30,6 +32,30 @@ const SecretSchema* agent_get_schema(void) {
   return &the_schema;
 }
 
+const SecretSchema* agent_get_snapshot_schema(void) G_GNUC_CONST;
+
+#define AGENT_SNAPSHOT_SCHEMA agent_get_snapshot_schema()
+
+const SecretSchema* agent_get_snapshot_schema(void) {
+  static const SecretSchema the_schema = {
+      "edu.kit.oidc-agent.StateSnapshotKey",
+      SECRET_SCHEMA_NONE,
+      {
+          {"purpose", SECRET_SCHEMA_ATTRIBUTE_STRING},
+          {"NULL", 0},
+      },
+      // These are just reserved variables
+      0,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL};
+  return &the_schema;
+}
+
 void oidc_setGerror(GError* error) {
   if (error == NULL) {
     return;
@@ -106,4 +132,44 @@ oidc_error_t keyring_removePasswordFor(const char* shortname) {
   }
   return OIDC_SUCCESS;
 }
+
+/**
+ * @brief returns the key used to encrypt the agent state snapshot
+ * If no key is stored in the keyring yet, a new random key is generated and
+ * stored.
+ * @return the base64 encoded key or @c NULL on failure. Has to be freed after
+ * usage.
+ */
+char* keyring_getStateSnapshotKey() {
+  agent_log(DEBUG, "Looking up state snapshot key in keyring");
+  GError* error = NULL;
+  gchar*  key   = secret_password_lookup_sync(AGENT_SNAPSHOT_SCHEMA, NULL,
+                                           &error, "purpose", "state-snapshot",
+                                           NULL);
+  if (error != NULL) {
+    oidc_setGerror(error);
+    g_error_free(error);
+    return NULL;
+  }
+  if (key != NULL) {
+    char* ret = oidc_strcopy(key);
+    secret_password_free(key);
+    return ret;
+  }
+  agent_log(DEBUG, "Generating new state snapshot key");
+  unsigned char bin[crypto_secretbox_KEYBYTES];
+  crypto_secretbox_keygen(bin);
+  char* ret = toBase64((char*)bin, crypto_secretbox_KEYBYTES);
+  sodium_memzero(bin, crypto_secretbox_KEYBYTES);
+  secret_password_store_sync(AGENT_SNAPSHOT_SCHEMA, SECRET_COLLECTION_DEFAULT,
+                             "oidc-agent state snapshot key", ret, NULL, &error,
+                             "purpose", "state-snapshot", NULL);
+  if (error != NULL) {
+    oidc_setGerror(error);
+    g_error_free(error);
+    secFree(ret);
+    return NULL;
+  }
+  return ret;
+}
 #endif
@@ -7,5 +7,6 @@ oidc_error_t keyring_savePasswordFor(const char* shortname,
                                      const char* password);
 char*        keyring_getPasswordFor(const char* shortname);
 oidc_error_t keyring_removePasswordFor(const char* shortname);
+char*        keyring_getStateSnapshotKey();
 
 #endif  // OIDCAGENT_KEYRING_INTEGRATION_H
@@ -0,0 +1,216 @@
+#define _XOPEN_SOURCE 700
+#include "prompt_broker.h"
+
+#include "utils/agentLogger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define PROMPT_BROKER_BUFFER_SIZE 256
+
+static pid_t broker_pid = -1;
+static int   broker_tx  = -1;  // requests to the broker
+static int   broker_rx  = -1;  // responses from the broker
+// set if an oidc-prompt without broker support is installed
+static unsigned char broker_unsupported = 0;
+static unsigned long broker_answers     = 0;
+
+/**
+ * @brief cleans up after a broker that closed its end of the pipes
+ */
+static void _stopBroker() {
+  if (broker_pid <= 0) {
+    return;
+  }
+  close(broker_tx);
+  close(broker_rx);
+  broker_tx = -1;
+  broker_rx = -1;
+  waitpid(broker_pid, NULL, 0);
+  broker_pid = -1;
+}
+
+static oidc_error_t _startBroker() {
+  int req[2];
+  int res[2];
+  if (pipe(req) != 0) {
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  if (pipe(res) != 0) {
+    oidc_setErrnoError();
+    close(req[0]);
+    close(req[1]);
+    return oidc_errno;
+  }
+  pid_t pid = fork();
+  if (pid == -1) {
+    oidc_setErrnoError();
+    close(req[0]);
+    close(req[1]);
+    close(res[0]);
+    close(res[1]);
+    return oidc_errno;
+  }
+  if (pid == 0) {  // child
+    dup2(req[0], STDIN_FILENO);
+    dup2(res[1], STDOUT_FILENO);
+    close(req[0]);
+    close(req[1]);
+    close(res[0]);
+    close(res[1]);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGPIPE, SIG_DFL);
+    execlp(PROMPT_BROKER_COMMAND, PROMPT_BROKER_COMMAND, PROMPT_BROKER_ARG,
+           (char*)NULL);
+    _exit(EXIT_FAILURE);
+  }
+  close(req[0]);
+  close(res[1]);
+  fcntl(req[1], F_SETFD, FD_CLOEXEC);
+  fcntl(res[0], F_SETFD, FD_CLOEXEC);
+  broker_pid = pid;
+  broker_tx  = req[1];
+  broker_rx  = res[0];
+  agent_log(DEBUG, "Started prompt broker with pid %d", pid);
+  return OIDC_SUCCESS;
+}
+
+static oidc_error_t _writeAll(int fd, const char* buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, buf, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      oidc_setErrnoError();
+      return oidc_errno;
+    }
+    buf += n;
+    len -= n;
+  }
+  return OIDC_SUCCESS;
+}
+
+static oidc_error_t _sendRequest(const char* const* fields, size_t n) {
+  char   count[16];
+  size_t len = snprintf(count, sizeof(count), "%lu", n) + 1;
+  for (size_t i = 0; i < n; i++) {
+    len += strlen(fields[i] ?: "") + 1;
+  }
+  char*  buf = secAlloc(len);
+  size_t pos = strlen(count) + 1;
+  memcpy(buf, count, pos);
+  for (size_t i = 0; i < n; i++) {
+    const char*  field     = fields[i] ?: "";
+    const size_t field_len = strlen(field) + 1;
+    memcpy(buf + pos, field, field_len);
+    pos += field_len;
+  }
+  oidc_error_t e = _writeAll(broker_tx, buf, len);
+  secFree(buf);
+  return e;
+}
+
+/**
+ * @brief reads a response (exit status and output, both null terminated) from
+ * the broker
+ * @return the output or @c NULL if the broker did not answer
+ */
+static char* _readResponse(int* status) {
+  size_t cap   = PROMPT_BROKER_BUFFER_SIZE;
+  size_t len   = 0;
+  size_t nulls = 0;
+  char*  buf   = secAlloc(cap);
+  while (nulls < 2) {
+    if (len == cap) {
+      char* tmp = secRealloc(buf, cap * 2);
+      if (tmp == NULL) {
+        secFree(buf);
+        return NULL;
+      }
+      buf = tmp;
+      cap *= 2;
+    }
+    // a single byte at a time, so that nothing of a later response is consumed
+    ssize_t n = read(broker_rx, buf + len, 1);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      if (n < 0) {
+        oidc_setErrnoError();
+      } else {
+        oidc_errno = OIDC_EEOF;
+      }
+      secFree(buf);
+      return NULL;
+    }
+    if (buf[len] == '\0') {
+      nulls++;
+    }
+    len++;
+  }
+  *status   = strToInt(buf);
+  char* out = oidc_strcopy(buf + strlen(buf) + 1);
+  secFree(buf);
+  return out;
+}
+
+/**
+ * @brief shows a prompt through the prompt broker, starting it if it is not
+ * running
+ * @param type the @c oidc-prompt prompt type, e.g. @c password
+ * @param status is set to the exit status of the dialog; non-zero if the user
+ * canceled it
+ * @return the output of the dialog. Has to be freed after usage. If the broker
+ * is not available or did not answer, @c NULL is returned and @c oidc_errno is
+ * set.
+ */
+char* promptBroker_prompt(const char* type, const char* title,
+                          const char* text, const char* label,
+                          const char* init, int* status) {
+  if (broker_unsupported) {
+    oidc_errno = OIDC_NOTIMPL;
+    return NULL;
+  }
+  const char* const fields[] = {type, title, text, label, init};
+  const size_t      n        = sizeof(fields) / sizeof(*fields);
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (broker_pid <= 0) {
+      if (_startBroker() != OIDC_SUCCESS) {
+        agent_log(ERROR, "Could not start prompt broker: %s", oidc_serror());
+        return NULL;
+      }
+      broker_answers = 0;
+    }
+    if (_sendRequest(fields, n) != OIDC_SUCCESS) {
+      // the broker exited since the last prompt; start a new one
+      _stopBroker();
+      continue;
+    }
+    char* out = _readResponse(status);
+    if (out == NULL) {
+      if (broker_answers == 0) {
+        // the installed oidc-prompt does not know --serve
+        broker_unsupported = 1;
+      }
+      agent_log(ERROR, "Prompt broker did not answer: %s", oidc_serror());
+      _stopBroker();
+      return NULL;
+    }
+    broker_answers++;
+    return out;
+  }
+  // a freshly started broker exited before reading the request
+  broker_unsupported = 1;
+  return NULL;
+}
@@ -0,0 +1,24 @@
+#ifndef OIDCP_PROMPT_BROKER_H
+#define OIDCP_PROMPT_BROKER_H
+
+#include "utils/oidc_error.h"
+
+/**
+ * The prompt broker is a long-lived @c oidc-prompt process (started with
+ * @c --serve) that oidcp sends its prompts to, instead of running the
+ * @c oidc-prompt script through a shell for every prompt. A request is the
+ * number of fields followed by the fields (prompt type, title, text, label,
+ * init, ...), a response is the exit status of the dialog followed by its
+ * output; every value is terminated by a null byte, so no quoting is involved.
+ * The broker is started on first use, restarted if it exits, and answers
+ * prompts in the order they were sent. Closing the request pipe (e.g. because
+ * oidcp exits) terminates it.
+ */
+#define PROMPT_BROKER_COMMAND "oidc-prompt"
+#define PROMPT_BROKER_ARG "--serve"
+
+char* promptBroker_prompt(const char* type, const char* title,
+                          const char* text, const char* label,
+                          const char* init, int* status);
+
+#endif  // OIDCP_PROMPT_BROKER_H
@@ -4,7 +4,9 @@
 #include "oidc-agent/oidcp/passwords/askpass.h"
 #include "oidc-agent/oidcp/passwords/password_store.h"
 #include "utils/crypt/cryptUtils.h"
+#include "utils/file_io/configCache.h"
 #include "utils/file_io/cryptFileUtils.h"
+#include "utils/file_io/keystore.h"
 #include "utils/file_io/oidc_file_io.h"
 #include "utils/listUtils.h"
 #include "utils/stringUtils.h"
@@ -57,25 +59,18 @@ char* getDefaultAccountConfigForIssuer(const char* issuer_url) {
     oidc_setArgNullFuncError(__func__);
     return NULL;
   }
-  list_t* issuers = getLinesFromOidcFile(ISSUER_CONFIG_FILENAME);
-  if (issuers == NULL) {
-    return NULL;
+  // lines have the format "<issuer_url> <shortname>"
+  char* line      = configCache_getLine(CONFIG_CACHE_ISSUERS, issuer_url);
+  char* shortname = NULL;
+  char* acc       = line ? strchr(line, ' ') : NULL;
+  if (acc && acc[1] != '\0' && acc[1] != ' ') {
+    acc++;
+    char* acc_end = strchr(acc, ' ');
+    shortname = acc_end ? oidc_strncopy(acc, acc_end - acc) : oidc_strcopy(acc);
   }
-  char*            shortname = NULL;
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(issuers, LIST_HEAD);
-  while ((node = list_iterator_next(it))) {
-    char* line = node->val;
-    char* iss  = strtok(line, " ");
-    char* acc  = strtok(NULL, " ");
-    if (compIssuerUrls(issuer_url, iss)) {
-      if (strValid(acc)) {
-        shortname = oidc_strcopy(acc);
-      }
-      break;
-    }
+  secFree(line);
+  if (shortname == NULL) {  // the keystore index also knows the issuers
+    shortname = keystore_getNameForIssuer(issuer_url);
   }
-  list_iterator_destroy(it);
-  secFreeList(issuers);
   return shortname;
 }
@@ -0,0 +1,236 @@
+#ifndef __APPLE__
+#define _XOPEN_SOURCE 700
+#endif
+#include "request_queue.h"
+#include "defines/ipc_values.h"
+#include "utils/json.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+#include "wrapper/list.h"
+
+#include <time.h>
+
+/**
+ * a client request that was read by oidcp but not yet passed to oidcd
+ */
+struct queued_request {
+  struct connection* con;
+  char*              request;
+  double             enqueued;
+};
+
+/**
+ * per-class FIFO of queued requests and its counters; wait times are in
+ * seconds
+ */
+struct request_class_queue {
+  list_t*       requests;
+  size_t        max_depth;
+  unsigned long served;
+  double        total_wait;
+  double        max_wait;
+};
+
+static struct request_class_queue queues[2] = {{NULL, 0, 0, 0, 0},
+                                               {NULL, 0, 0, 0, 0}};
+
+static unsigned int latency_burst = 0;
+
+static const char* const latency_requests[] = {
+    REQUEST_VALUE_ACCESSTOKEN,    REQUEST_VALUE_IDTOKEN,
+    REQUEST_VALUE_CHECK,          REQUEST_VALUE_STATUS,
+    REQUEST_VALUE_STATUS_JSON,    REQUEST_VALUE_LOADEDACCOUNTS,
+    REQUEST_VALUE_LOCK,           REQUEST_VALUE_UNLOCK,
+    REQUEST_VALUE_ADD,            REQUEST_VALUE_REMOVE,
+    REQUEST_VALUE_REMOVEALL,      REQUEST_VALUE_FILEWRITE,
+    REQUEST_VALUE_FILEREAD,       REQUEST_VALUE_FILEREMOVE,
+    REQUEST_VALUE_STATELOOKUP,    REQUEST_VALUE_TERMHTTP,
+    REQUEST_VALUE_USERINFO,       REQUEST_VALUE_TOKENEXCHANGE,
+};
+
+static double _now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _secFreeQueuedRequest(struct queued_request* queued) {
+  if (queued == NULL) {
+    return;
+  }
+  secFree(queued->request);
+  secFree(queued);
+}
+
+static list_t* _getQueue(enum request_class class) {
+  if (queues[class].requests == NULL) {
+    queues[class].requests = list_new();
+    queues[class].requests->free =
+        (void (*)(void*)) & _secFreeQueuedRequest;
+  }
+  return queues[class].requests;
+}
+
+/**
+ * @brief determines the scheduling class of a request type
+ *
+ * Requests that are answered from the agent's state (or usually only need a
+ * token refresh) are latency-sensitive; requests that involve a longer
+ * running flow (account generation, client registration, revocation, code
+ * exchange) and unknown request types are bulk requests.
+ */
+enum request_class requestQueue_classify(const char* request_type) {
+  if (request_type == NULL) {
+    return REQUEST_CLASS_BULK;
+  }
+  for (size_t i = 0;
+       i < sizeof(latency_requests) / sizeof(*latency_requests); i++) {
+    if (strequal(request_type, latency_requests[i])) {
+      return REQUEST_CLASS_LATENCY;
+    }
+  }
+  return REQUEST_CLASS_BULK;
+}
+
+/**
+ * @brief queues the request of a client connection
+ * @param con the client connection the request was read from
+ * @param request the request; it is owned by the queue afterwards
+ */
+void requestQueue_push(struct connection* con, char* request) {
+  char* type = getJSONValueFromString(request, IPC_KEY_REQUEST);
+  enum request_class class = requestQueue_classify(type);
+  secFree(type);
+  struct queued_request* queued = secAlloc(sizeof(struct queued_request));
+  queued->con                   = con;
+  queued->request               = request;
+  queued->enqueued              = _now();
+  list_t* queue                 = _getQueue(class);
+  list_rpush(queue, list_node_new(queued));
+  if (queue->len > queues[class].max_depth) {
+    queues[class].max_depth = queue->len;
+  }
+  logger(DEBUG, "Queued %s request",
+         class == REQUEST_CLASS_LATENCY ? "latency-sensitive" : "bulk");
+}
+
+/**
+ * @brief takes the next request from the queue
+ *
+ * Latency-sensitive requests are served before bulk requests; after
+ * @c REQUEST_QUEUE_MAX_LATENCY_BURST latency-sensitive requests in a row one
+ * waiting bulk request is served, so bulk requests are not starved. Within a
+ * class requests are served in arrival order.
+ * @param con is set to the client connection of the request
+ * @return the request or @c NULL if the queue is empty. Has to be freed after
+ * usage.
+ */
+char* requestQueue_pop(struct connection** con) {
+  list_t* latency = _getQueue(REQUEST_CLASS_LATENCY);
+  list_t* bulk    = _getQueue(REQUEST_CLASS_BULK);
+  enum request_class class;
+  if (latency->len > 0 &&
+      (bulk->len == 0 || latency_burst < REQUEST_QUEUE_MAX_LATENCY_BURST)) {
+    class         = REQUEST_CLASS_LATENCY;
+    latency_burst = bulk->len > 0 ? latency_burst + 1 : 0;
+  } else if (bulk->len > 0) {
+    class         = REQUEST_CLASS_BULK;
+    latency_burst = 0;
+  } else {
+    return NULL;
+  }
+  list_node_t*           node   = list_lpop(queues[class].requests);
+  struct queued_request* queued = node->val;
+  LIST_FREE(node);
+  double wait = _now() - queued->enqueued;
+  queues[class].served++;
+  queues[class].total_wait += wait;
+  if (wait > queues[class].max_wait) {
+    queues[class].max_wait = wait;
+  }
+  *con          = queued->con;
+  char* request = queued->request;
+  secFree(queued);
+  return request;
+}
+
+int requestQueue_isEmpty() {
+  return (queues[REQUEST_CLASS_LATENCY].requests == NULL ||
+          queues[REQUEST_CLASS_LATENCY].requests->len == 0) &&
+         (queues[REQUEST_CLASS_BULK].requests == NULL ||
+          queues[REQUEST_CLASS_BULK].requests->len == 0);
+}
+
+static list_node_t* _findConnection(list_t* queue,
+                                    const struct connection* con) {
+  if (queue == NULL) {
+    return NULL;
+  }
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(queue, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    if (((struct queued_request*)node->val)->con == con) {
+      break;
+    }
+  }
+  list_iterator_destroy(it);
+  return node;
+}
+
+/**
+ * @brief checks if a request of @p con is queued
+ */
+int requestQueue_contains(const struct connection* con) {
+  return _findConnection(queues[REQUEST_CLASS_LATENCY].requests, con) !=
+             NULL ||
+         _findConnection(queues[REQUEST_CLASS_BULK].requests, con) != NULL;
+}
+
+/**
+ * @brief drops the queued request of @p con, e.g. because the client
+ * disconnected before the request was served
+ */
+void requestQueue_removeConnection(const struct connection* con) {
+  for (int class = REQUEST_CLASS_LATENCY; class <= REQUEST_CLASS_BULK;
+       class++) {
+    list_node_t* node = _findConnection(queues[class].requests, con);
+    if (node != NULL) {
+      list_remove(queues[class].requests, node);
+    }
+  }
+}
+
+static char* _queueToJSON(enum request_class class) {
+  const struct request_class_queue* queue = &queues[class];
+  unsigned long depth = queue->requests ? queue->requests->len : 0;
+  unsigned long avg_wait_ms =
+      queue->served ? queue->total_wait * 1000 / queue->served : 0;
+  cJSON* json = stringToJson("{}");
+  jsonAddNumberValue(json, "depth", depth);
+  jsonAddNumberValue(json, "max_depth", queue->max_depth);
+  jsonAddNumberValue(json, "served", queue->served);
+  jsonAddNumberValue(json, "avg_wait_ms", avg_wait_ms);
+  jsonAddNumberValue(json, "max_wait_ms",
+                     (unsigned long)(queue->max_wait * 1000));
+  char* str = jsonToStringUnformatted(json);
+  secFreeJson(json);
+  return str;
+}
+
+/**
+ * @brief returns the per-class queue depths and wait times as a json object
+ * string
+ * @return a pointer to the json string. Has to be freed after usage.
+ */
+char* requestQueue_getStatsJSON() {
+  char*  latency = _queueToJSON(REQUEST_CLASS_LATENCY);
+  char*  bulk    = _queueToJSON(REQUEST_CLASS_BULK);
+  cJSON* json = generateJSONObject("latency", cJSON_Object, latency, "bulk",
+                                   cJSON_Object, bulk, NULL);
+  secFree(latency);
+  secFree(bulk);
+  char* stats = jsonToStringUnformatted(json);
+  secFreeJson(json);
+  return stats;
+}
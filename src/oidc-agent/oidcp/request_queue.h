@@ -0,0 +1,25 @@
+#ifndef OIDCP_REQUEST_QUEUE_H
+#define OIDCP_REQUEST_QUEUE_H
+
+#include "ipc/connection.h"
+
+/**
+ * number of latency-sensitive requests that are served in a row while bulk
+ * requests are waiting; afterwards one bulk request is served
+ */
+#define REQUEST_QUEUE_MAX_LATENCY_BURST 4
+
+enum request_class {
+  REQUEST_CLASS_LATENCY,
+  REQUEST_CLASS_BULK,
+};
+
+enum request_class requestQueue_classify(const char* request_type);
+void   requestQueue_push(struct connection* con, char* request);
+char*  requestQueue_pop(struct connection** con);
+int    requestQueue_isEmpty();
+int    requestQueue_contains(const struct connection* con);
+void   requestQueue_removeConnection(const struct connection* con);
+char*  requestQueue_getStatsJSON();
+
+#endif  // OIDCP_REQUEST_QUEUE_H
@@ -1,6 +1,7 @@
 #define _XOPEN_SOURCE 500
 #include "start_oidcd.h"
 
+#include "ipc/cancelPipe.h"
 #include "ipc/pipe.h"
 #include "oidc-agent/oidcd/oidcd.h"
 #include "utils/agentLogger.h"
@@ -13,11 +14,15 @@
 #include <unistd.h>
 
 struct ipcPipe startOidcd(const struct arguments* arguments) {
-  struct pipeSet pipes = ipc_pipe_init();
+  struct pipeSet pipes =
+      arguments->shm_ipc ? ipc_pipe_initWithShm() : ipc_pipe_init();
   if (pipes.pipe1.rx == -1) {
     agent_log(ERROR, "could not create pipes");
     exit(EXIT_FAILURE);
   }
+  if (cancelPipe_init() != OIDC_SUCCESS) {
+    agent_log(NOTICE, "Could not create cancel pipe: %s", oidc_serror());
+  }
   pid_t ppid_before_fork = getpid();
   pid_t pid              = fork();
   if (pid == -1) {
@@ -39,10 +44,12 @@ struct ipcPipe startOidcd(const struct arguments* arguments) {
       exit(EXIT_FAILURE);
     }
     struct ipcPipe childPipes = toClientPipes(pipes);
+    cancelPipe_closeSender();
     oidcd_main(childPipes, arguments);
     exit(EXIT_FAILURE);
   } else {  // parent
     struct ipcPipe parentPipes = toServerPipes(pipes);
+    cancelPipe_closeReceiver();
     return parentPipes;
   }
 }
@@ -0,0 +1,187 @@
+#include "oidcr.h"
+#include "defines/settings.h"
+#include "oidc-agent/oidcr/oidcr_worker.h"
+#include "oidc-agent/oidcr/remote_session.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/crypt.h"
+#include "utils/memory.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * The remote token server answers access token requests of remote clients
+ * (OIDC_REMOTE_SOCK) using the same encrypted protocol as the local agent
+ * socket. A single event loop accepts connections and collects the messages of
+ * all sessions; complete messages are handled by a pool of workers.
+ */
+static struct remote_session* sessions[REMOTE_MAX_CONNECTIONS];
+static size_t                 nsessions = 0;
+
+static size_t _sessionsFromHost(struct in_addr peer) {
+  size_t n = 0;
+  for (size_t i = 0; i < nsessions; i++) {
+    if (sessions[i]->peer.s_addr == peer.s_addr) {
+      n++;
+    }
+  }
+  return n;
+}
+
+static void _closeSession(size_t i) {
+  agent_log(DEBUG, "Closing remote session with %s",
+            inet_ntoa(sessions[i]->peer));
+  secFreeRemoteSession(sessions[i]);
+  sessions[i] = sessions[--nsessions];
+}
+
+static void _acceptClients(int listen_sock, size_t client_limit) {
+  while (1) {
+    struct sockaddr_in addr;
+    socklen_t          addr_len = sizeof(addr);
+    int                sock =
+        accept(listen_sock, (struct sockaddr*)&addr, &addr_len);
+    if (sock < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        agent_log(ERROR, "accept: %m");
+      }
+      return;
+    }
+    if (nsessions >= REMOTE_MAX_CONNECTIONS ||
+        _sessionsFromHost(addr.sin_addr) >= client_limit) {
+      agent_log(NOTICE,
+                "Rejecting remote connection from %s: too many connections",
+                inet_ntoa(addr.sin_addr));
+      close(sock);
+      continue;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(sock, F_SETFD, FD_CLOEXEC);
+    sessions[nsessions++] = remoteSession_new(sock, addr.sin_addr);
+    agent_log(DEBUG, "Accepted remote connection from %s; %lu sessions",
+              inet_ntoa(addr.sin_addr), nsessions);
+  }
+}
+
+/**
+ * @brief hands the next complete message of a session to the worker pool;
+ * nothing is handed over until the previous response was sent
+ * @return @c 0 if the session is still usable, @c -1 if it has to be closed
+ */
+static int _dispatch(struct remote_session* s) {
+  if (s->closing) {
+    return -1;
+  }
+  if (s->out_len > 0) {
+    return 0;
+  }
+  ssize_t len = remoteSession_nextMessageLength(s);
+  if (len < 0) {
+    agent_log(NOTICE, "Invalid message from remote client %s",
+              inet_ntoa(s->peer));
+    return -1;
+  }
+  if (len > 0) {
+    workerPool_submit(s, remoteSession_popMessage(s, len), len);
+  }
+  return 0;
+}
+
+static void _handOverFinishedSessions(int notify_rx) {
+  struct remote_session* s;
+  while (read(notify_rx, &s, sizeof(s)) == sizeof(s)) {
+    s->busy = 0;
+    // a pipelined request might already be waiting in the buffer
+    if (remoteSession_flush(s) != OIDC_SUCCESS || _dispatch(s) != 0) {
+      s->closing = 1;
+    }
+  }
+}
+
+static void _raiseFileLimit() {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+int oidcr_main(int listen_sock, const char* agent_socket_path,
+               const struct arguments* arguments) {
+  logger_open("oidc-agent.r");
+  initCrypt();
+  _raiseFileLimit();
+  int notify[2];
+  if (pipe(notify) != 0) {
+    agent_log(ERROR, "pipe: %m");
+    exit(EXIT_FAILURE);
+  }
+  fcntl(notify[0], F_SETFL, fcntl(notify[0], F_GETFL, 0) | O_NONBLOCK);
+  // Cached responses bypass the confirmation prompt of the local agent
+  workerPool_start(REMOTE_WORKER_POOL_SIZE, agent_socket_path, notify[1],
+                   !arguments->confirm);
+  agent_log(NOTICE, "Remote token server listening on %s:%hu",
+            arguments->remote_bind, arguments->remote_port);
+
+  struct pollfd* pfds = secAlloc(sizeof(struct pollfd) *
+                                 (REMOTE_MAX_CONNECTIONS + 2));
+  while (1) {
+    pfds[0] = (struct pollfd){.fd = notify[0], .events = POLLIN};
+    pfds[1] = (struct pollfd){.fd = listen_sock, .events = POLLIN};
+    for (size_t i = 0; i < nsessions; i++) {
+      // busy sessions are not polled until their worker hands them back
+      struct remote_session* s = sessions[i];
+      pfds[i + 2]              = (struct pollfd){
+          .fd     = s->busy ? -1 : s->sock,
+          .events = POLLIN | (s->out_len > 0 ? POLLOUT : 0)};
+    }
+    const size_t polled = nsessions;
+    if (poll(pfds, polled + 2, 1000) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      agent_log(ERROR, "poll: %m");
+      exit(EXIT_FAILURE);
+    }
+    if (pfds[0].revents & POLLIN) {
+      _handOverFinishedSessions(notify[0]);
+    }
+    const time_t now = time(NULL);
+    // iterate backwards, so closing a session does not skip another one
+    for (size_t i = polled; i-- > 0;) {
+      struct remote_session* s = sessions[i];
+      if (s->busy) {
+        continue;
+      }
+      const short revents = pfds[i + 2].revents;
+      int         done    = s->closing;
+      if (!done && (revents & POLLOUT)) {
+        done = remoteSession_flush(s) != OIDC_SUCCESS;
+      }
+      if (!done && (revents & ~POLLOUT)) {
+        done = remoteSession_read(s) != OIDC_SUCCESS;
+      }
+      if (!done && revents) {
+        done = _dispatch(s) != 0;
+      }
+      if (!done && !s->busy &&
+          s->last_active + REMOTE_SESSION_IDLE_TIMEOUT < now) {
+        done = 1;
+      }
+      if (done) {
+        _closeSession(i);
+      }
+    }
+    if (pfds[1].revents & POLLIN) {
+      _acceptClients(listen_sock, arguments->remote_client_limit);
+    }
+  }
+  return EXIT_FAILURE;
+}
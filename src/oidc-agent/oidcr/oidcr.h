@@ -0,0 +1,9 @@
+#ifndef OIDCR_H
+#define OIDCR_H
+
+#include "oidc-agent/oidc-agent_options.h"
+
+int oidcr_main(int listen_sock, const char* agent_socket_path,
+               const struct arguments* arguments);
+
+#endif  // OIDCR_H
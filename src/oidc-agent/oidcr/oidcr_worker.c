@@ -0,0 +1,234 @@
+#include "oidcr_worker.h"
+#include "defines/ipc_values.h"
+#include "ipc/cryptCommunicator.h"
+#include "ipc/cryptIpc.h"
+#include "oidc-agent/oidcr/token_cache.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/crypt.h"
+#include "utils/crypt/ipcCryptUtils.h"
+#include "utils/json.h"
+#include "utils/key_value.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+#include "wrapper/list.h"
+
+#include <pthread.h>
+#include <sodium.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * a received message of a remote session that has to be handled by a worker
+ */
+struct job {
+  struct remote_session* session;
+  char*                  msg;
+  size_t                 msg_len;
+};
+
+static list_t*         jobs       = NULL;
+static pthread_mutex_t jobs_lock  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  jobs_cond  = PTHREAD_COND_INITIALIZER;
+/**
+ * requests that cannot be answered from the token cache are forwarded to the
+ * local agent one at a time; this also ensures that concurrent requests for
+ * the same account only result in a single request to the local agent
+ */
+static pthread_mutex_t agent_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char*   agent_socket = NULL;
+static int           notify       = -1;
+static unsigned char cache_tokens = 0;
+
+static void _handleKeyExchange(struct remote_session* s, const char* msg,
+                               size_t len) {
+  const unsigned char* hello_pk = ipcCryptHelloPublicKey(msg, len);
+  unsigned char        client_pk[crypto_kx_PUBLICKEYBYTES];
+  if (hello_pk != NULL) {
+    memcpy(client_pk, hello_pk, crypto_kx_PUBLICKEYBYTES);
+  } else if (fromBase64(msg, crypto_kx_PUBLICKEYBYTES, client_pk) != 0) {
+    agent_log(NOTICE, "Invalid public key from remote client");
+    s->closing = 1;
+    return;
+  }
+  s->binary                  = hello_pk != NULL;
+  struct pubsec_keySet* keys = generatePubSecKeys();
+  s->ipc_key                 = generateIpcKey(client_pk, keys->sk);
+  oidc_error_t e             = OIDC_SUCCESS;
+  if (s->binary) {
+    unsigned char hello[IPC_CRYPT_BINARY_HELLO_LEN];
+    ipcCryptWriteHello(hello, keys->pk);
+    e = remoteSession_writeBytes(s, hello, sizeof(hello));
+  } else {
+    char* server_pk_base64 =
+        toBase64((char*)keys->pk, crypto_kx_PUBLICKEYBYTES);
+    e = remoteSession_write(s, server_pk_base64);
+    secFree(server_pk_base64);
+  }
+  secFreePubSecKeySet(keys);
+  if (s->ipc_key == NULL || e != OIDC_SUCCESS) {
+    s->closing = 1;
+  }
+  s->state = REMOTE_SESSION_ESTABLISHED;
+}
+
+static char* _forwardToAgent(const char* request) {
+  char* response = ipc_cryptCommunicateWithPath(agent_socket, "%s", request);
+  if (response == NULL) {
+    return oidc_sprintf(RESPONSE_ERROR, oidc_serror());
+  }
+  return response;
+}
+
+static char* _tokenResponse(const char* request) {
+  if (!cache_tokens) {
+    pthread_mutex_lock(&agent_lock);
+    char* response = _forwardToAgent(request);
+    pthread_mutex_unlock(&agent_lock);
+    return response;
+  }
+  INIT_KEY_VALUE(IPC_KEY_MINVALID);
+  CALL_GETJSONVALUES(request);
+  KEY_VALUE_VARS(min_valid_period);
+  const time_t min_valid =
+      _min_valid_period ? strToULong(_min_valid_period) : 0;
+  SEC_FREE_KEY_VALUES();
+  char* key      = tokenCache_keyForRequest(request);
+  char* response = tokenCache_get(key, min_valid);
+  if (response == NULL) {
+    pthread_mutex_lock(&agent_lock);
+    // another worker might have fetched the token while we waited
+    response = tokenCache_get(key, min_valid);
+    if (response == NULL) {
+      response = _forwardToAgent(request);
+      tokenCache_put(key, response);
+    }
+    pthread_mutex_unlock(&agent_lock);
+  }
+  secFree(key);
+  return response;
+}
+
+static oidc_error_t _writeResponse(struct remote_session* s,
+                                   const char*            response) {
+  if (s->binary) {
+    size_t         len    = 0;
+    unsigned char* sealed =
+        ipcCryptSealBinary(response, strlen(response), s->ipc_key, &len);
+    if (sealed == NULL) {
+      return oidc_errno;
+    }
+    oidc_error_t e = remoteSession_writeBytes(s, sealed, len);
+    secFree(sealed);
+    return e;
+  }
+  char* encryptedResponse = encryptForIpc(response, s->ipc_key);
+  if (encryptedResponse == NULL) {
+    return oidc_errno;
+  }
+  oidc_error_t e = remoteSession_write(s, encryptedResponse);
+  secFree(encryptedResponse);
+  return e;
+}
+
+static void _handleRequest(struct remote_session* s, const char* encrypted,
+                           size_t len) {
+  char* request = ipcCryptIsBinary(encrypted, len)
+                      ? ipcCryptOpenBinary(encrypted, len, s->ipc_key)
+                      : decryptForIpc(encrypted, s->ipc_key);
+  if (request == NULL) {
+    agent_log(NOTICE, "Could not decrypt request of remote client");
+    s->closing = 1;
+    return;
+  }
+  INIT_KEY_VALUE(IPC_KEY_REQUEST);
+  CALL_GETJSONVALUES(request);
+  KEY_VALUE_VARS(request);
+  char* response = NULL;
+  if (strequal(_request, REQUEST_VALUE_ACCESSTOKEN)) {
+    response = _tokenResponse(request);
+  } else {
+    agent_log(NOTICE, "Remote client sent forbidden request '%s'",
+              _request ?: "");
+    response = oidc_sprintf(RESPONSE_ERROR,
+                            "Only access token requests are allowed remotely");
+  }
+  SEC_FREE_KEY_VALUES();
+  secFree(request);
+  if (_writeResponse(s, response) != OIDC_SUCCESS) {
+    s->closing = 1;
+  }
+  secFree(response);
+}
+
+static void _handleJob(struct job* job) {
+  struct remote_session* s = job->session;
+  if (s->state == REMOTE_SESSION_KEYEXCHANGE) {
+    _handleKeyExchange(s, job->msg, job->msg_len);
+  } else {
+    _handleRequest(s, job->msg, job->msg_len);
+  }
+  // hand the session back to the event loop
+  if (write(notify, &s, sizeof(s)) != sizeof(s)) {
+    agent_log(ERROR, "Could not notify remote server loop: %m");
+  }
+}
+
+static void* _worker(void* arg __attribute__((unused))) {
+  while (1) {
+    pthread_mutex_lock(&jobs_lock);
+    while (jobs->len == 0) { pthread_cond_wait(&jobs_cond, &jobs_lock); }
+    list_node_t* node = list_lpop(jobs);
+    pthread_mutex_unlock(&jobs_lock);
+    struct job* job = node->val;
+    LIST_FREE(node);
+    _handleJob(job);
+    secFree(job->msg);
+    secFree(job);
+  }
+  return NULL;
+}
+
+/**
+ * @brief starts the worker threads of the remote token server
+ * @param size the number of worker threads
+ * @param agent_socket_path the socket of the local agent; requests that cannot
+ * be answered from the token cache are forwarded to it
+ * @param notify_fd sessions are written to this fd after a worker finished
+ * handling a message
+ * @param use_cache if access token responses may be cached
+ */
+void workerPool_start(size_t size, const char* agent_socket_path,
+                      int notify_fd, unsigned char use_cache) {
+  agent_socket = agent_socket_path;
+  notify       = notify_fd;
+  cache_tokens = use_cache;
+  jobs         = list_new();
+  for (size_t i = 0; i < size; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, _worker, NULL) != 0) {
+      agent_log(ERROR, "Could not create remote server worker: %m");
+      exit(EXIT_FAILURE);
+    }
+    pthread_detach(thread);
+  }
+  agent_log(DEBUG, "Started %lu remote server workers", size);
+}
+
+/**
+ * @brief queues a message of a session for handling by a worker; takes
+ * ownership of @p msg. The session must not be touched until the worker
+ * handed it back.
+ */
+void workerPool_submit(struct remote_session* s, char* msg, size_t msg_len) {
+  struct job* job = secAlloc(sizeof(struct job));
+  job->session    = s;
+  job->msg        = msg;
+  job->msg_len    = msg_len;
+  s->busy         = 1;
+  pthread_mutex_lock(&jobs_lock);
+  list_rpush(jobs, list_node_new(job));
+  pthread_cond_signal(&jobs_cond);
+  pthread_mutex_unlock(&jobs_lock);
+}
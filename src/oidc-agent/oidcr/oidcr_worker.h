@@ -0,0 +1,12 @@
+#ifndef OIDCR_WORKER_H
+#define OIDCR_WORKER_H
+
+#include "oidc-agent/oidcr/remote_session.h"
+
+#include <stddef.h>
+
+void workerPool_start(size_t size, const char* agent_socket_path,
+                      int notify_fd, unsigned char use_cache);
+void workerPool_submit(struct remote_session* s, char* msg, size_t msg_len);
+
+#endif  // OIDCR_WORKER_H
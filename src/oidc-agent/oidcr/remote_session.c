@@ -0,0 +1,161 @@
+#include "remote_session.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/ipcCryptUtils.h"
+#include "utils/memory.h"
+
+#include <errno.h>
+#include <sodium.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL  // SIGPIPE is ignored by the agent anyway
+#define MSG_NOSIGNAL 0
+#endif
+
+#define REMOTE_PUBKEY_BASE64_LEN                        \
+  (sodium_base64_ENCODED_LEN(crypto_kx_PUBLICKEYBYTES, \
+                             sodium_base64_VARIANT_ORIGINAL) - 1)
+
+struct remote_session* remoteSession_new(int sock, struct in_addr peer) {
+  struct remote_session* s = secAlloc(sizeof(struct remote_session));
+  s->sock                  = sock;
+  s->peer                  = peer;
+  s->state                 = REMOTE_SESSION_KEYEXCHANGE;
+  s->buf                   = secAlloc(REMOTE_SESSION_BUFFER_SIZE);
+  s->last_active           = time(NULL);
+  return s;
+}
+
+void _secFreeRemoteSession(struct remote_session* s) {
+  if (s == NULL) {
+    return;
+  }
+  close(s->sock);
+  secFree(s->ipc_key);
+  secFree(s->buf);
+  secFree(s->out);
+  secFree(s);
+}
+
+/**
+ * @brief reads all data that is currently available on the session socket
+ * @return @c OIDC_SUCCESS if the session is still usable; @c OIDC_EIPCDIS if
+ * the client disconnected; @c OIDC_EMSGSIZE if the client sent more than a
+ * single request can hold
+ */
+oidc_error_t remoteSession_read(struct remote_session* s) {
+  while (1) {
+    if (s->buf_len >= REMOTE_SESSION_BUFFER_SIZE) {
+      oidc_errno = OIDC_EMSGSIZE;
+      return oidc_errno;
+    }
+    ssize_t r = recv(s->sock, s->buf + s->buf_len,
+                     REMOTE_SESSION_BUFFER_SIZE - s->buf_len, 0);
+    if (r > 0) {
+      s->buf_len += r;
+      s->last_active = time(NULL);
+      continue;
+    }
+    if (r == 0) {
+      oidc_errno = OIDC_EIPCDIS;
+      return oidc_errno;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return OIDC_SUCCESS;
+    }
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+}
+
+/**
+ * @brief determines if a complete message was received
+ * @return the length of the next message, @c 0 if it is not yet completely
+ * received, or @c -1 if the received data is not a valid message
+ */
+ssize_t remoteSession_nextMessageLength(const struct remote_session* s) {
+  if (s->state == REMOTE_SESSION_KEYEXCHANGE) {
+    const size_t pk_len = ipcCryptIsBinary(s->buf, s->buf_len)
+                              ? IPC_CRYPT_BINARY_HELLO_LEN
+                              : REMOTE_PUBKEY_BASE64_LEN;
+    return s->buf_len >= pk_len ? (ssize_t)pk_len : 0;
+  }
+  return ipcCryptMessageLength(s->buf, s->buf_len, REMOTE_MAX_REQUEST_LEN);
+}
+
+/**
+ * @brief removes the first @p len bytes from the session buffer
+ * @return the removed bytes as a nullterminated string. Has to be freed after
+ * usage.
+ */
+char* remoteSession_popMessage(struct remote_session* s, size_t len) {
+  char* msg = secAlloc(len + 1);
+  memcpy(msg, s->buf, len);
+  memmove(s->buf, s->buf + len, s->buf_len - len);
+  s->buf_len -= len;
+  memset(s->buf + s->buf_len, 0, len);
+  return msg;
+}
+
+oidc_error_t remoteSession_write(struct remote_session* s, const char* msg) {
+  return remoteSession_writeBytes(s, msg, strlen(msg));
+}
+
+/**
+ * @brief queues data for the client; it is sent by the event loop with
+ * @c remoteSession_flush, so that a slow client cannot block a worker
+ */
+oidc_error_t remoteSession_writeBytes(struct remote_session* s,
+                                      const void* buf, size_t len) {
+  char* out = secRealloc(s->out, s->out_len + len);
+  if (out == NULL) {
+    return oidc_errno;
+  }
+  memcpy(out + s->out_len, buf, len);
+  s->out = out;
+  s->out_len += len;
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief sends as much of the queued data as the (non-blocking) session socket
+ * accepts
+ * @return @c OIDC_SUCCESS if the session is still usable, even if data is left
+ * in the queue; @c OIDC_EWRITE if the client cannot be written to
+ */
+oidc_error_t remoteSession_flush(struct remote_session* s) {
+  size_t written = 0;
+  while (written < s->out_len) {
+    ssize_t w =
+        send(s->sock, s->out + written, s->out_len - written, MSG_NOSIGNAL);
+    if (w >= 0) {
+      written += w;
+      continue;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    }
+    agent_log(NOTICE, "writing to remote client: %m");
+    oidc_errno = OIDC_EWRITE;
+    return oidc_errno;
+  }
+  if (written == 0) {
+    return OIDC_SUCCESS;
+  }
+  s->last_active = time(NULL);
+  if (written == s->out_len) {
+    secFree(s->out);
+    s->out_len = 0;
+    return OIDC_SUCCESS;
+  }
+  memmove(s->out, s->out + written, s->out_len - written);
+  s->out_len -= written;
+  return OIDC_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#ifndef OIDCR_REMOTE_SESSION_H
+#define OIDCR_REMOTE_SESSION_H
+
+#include "defines/settings.h"
+#include "utils/oidc_error.h"
+
+#include <netinet/in.h>
+#include <sys/types.h>
+#include <time.h>
+
+#define REMOTE_SESSION_BUFFER_SIZE (2 * REMOTE_MAX_REQUEST_LEN + 256)
+
+enum remote_session_state {
+  REMOTE_SESSION_KEYEXCHANGE,
+  REMOTE_SESSION_ESTABLISHED
+};
+
+/**
+ * a connection of a remote client; after the key exchange the client may send
+ * any number of encrypted requests over the same session (keep-alive).
+ * Responses are queued in @c out by the workers and sent by the event loop.
+ */
+struct remote_session {
+  int                       sock;
+  struct in_addr            peer;
+  enum remote_session_state state;
+  unsigned char*            ipc_key;
+  unsigned char             binary;
+  char*                     buf;
+  size_t                    buf_len;
+  char*                     out;
+  size_t                    out_len;
+  unsigned char             busy;
+  unsigned char             closing;
+  time_t                    last_active;
+};
+
+struct remote_session* remoteSession_new(int sock, struct in_addr peer);
+void                   _secFreeRemoteSession(struct remote_session* s);
+oidc_error_t           remoteSession_read(struct remote_session* s);
+ssize_t remoteSession_nextMessageLength(const struct remote_session* s);
+char*   remoteSession_popMessage(struct remote_session* s, size_t len);
+oidc_error_t remoteSession_write(struct remote_session* s, const char* msg);
+oidc_error_t remoteSession_writeBytes(struct remote_session* s,
+                                      const void* buf, size_t len);
+oidc_error_t remoteSession_flush(struct remote_session* s);
+
+#ifndef secFreeRemoteSession
+#define secFreeRemoteSession(ptr) \
+  do {                            \
+    _secFreeRemoteSession((ptr)); \
+    (ptr) = NULL;                 \
+  } while (0)
+#endif  // secFreeRemoteSession
+
+#endif  // OIDCR_REMOTE_SESSION_H
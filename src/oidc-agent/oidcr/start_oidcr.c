@@ -0,0 +1,47 @@
+#define _XOPEN_SOURCE 500
+#include "start_oidcr.h"
+
+#include "ipc/ipc.h"
+#include "oidc-agent/oidcr/oidcr.h"
+#include "utils/agentLogger.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#ifndef __APPLE__
+#include <sys/prctl.h>
+#endif
+#include <unistd.h>
+
+/**
+ * @brief forks the remote token server; the listening tcp socket is only kept
+ * open in the child
+ * @param remotecon the bound and listening tcp connection
+ * @param agent_socket_path the socket path of the local agent
+ */
+void startOidcr(struct connection* remotecon, const char* agent_socket_path,
+                const struct arguments* arguments) {
+  pid_t ppid_before_fork = getpid();
+  pid_t pid              = fork();
+  if (pid == -1) {
+    agent_log(ERROR, "fork %m");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {  // child
+#ifndef __APPLE__
+    // init child so that it exists if parent (oidcp) is killed.
+    int r = prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (r == -1) {
+      agent_log(ERROR, "prctl %m");
+      exit(EXIT_FAILURE);
+    }
+#endif
+    // test in case the original parent exited just before the prctl() call
+    if (getppid() != ppid_before_fork) {
+      agent_log(ERROR, "Parent died shortly after fork");
+      exit(EXIT_FAILURE);
+    }
+    oidcr_main(*(remotecon->sock), agent_socket_path, arguments);
+    exit(EXIT_FAILURE);
+  }
+  ipc_closeConnection(remotecon);
+}
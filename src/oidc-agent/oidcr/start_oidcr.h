@@ -0,0 +1,11 @@
+#ifndef START_OIDCR_H
+#define START_OIDCR_H
+
+#include "ipc/connection.h"
+#include "oidc-agent/oidc-agent_options.h"
+
+void startOidcr(struct connection*      remotecon,
+                const char*             agent_socket_path,
+                const struct arguments* arguments);
+
+#endif  // START_OIDCR_H
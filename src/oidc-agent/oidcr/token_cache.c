@@ -0,0 +1,145 @@
+#include "token_cache.h"
+#include "defines/agent_values.h"
+#include "defines/ipc_values.h"
+#include "defines/oidc_values.h"
+#include "defines/settings.h"
+#include "utils/agentLogger.h"
+#include "utils/json.h"
+#include "utils/key_value.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+#include "wrapper/list.h"
+
+#include <pthread.h>
+
+/**
+ * access token responses of the local agent, shared by all workers of the
+ * remote token server; all access is guarded by @c cache_lock
+ */
+struct cached_token {
+  char*  key;
+  char*  response;
+  time_t expires_at;
+};
+
+static list_t*         cache      = NULL;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _secFreeCachedToken(struct cached_token* t) {
+  if (t == NULL) {
+    return;
+  }
+  secFree(t->key);
+  secFree(t->response);
+  secFree(t);
+}
+
+static int matchCachedToken(const char* key, const struct cached_token* t) {
+  return strequal(t->key, key);
+}
+
+static void _initCache() {
+  if (cache == NULL) {
+    cache        = list_new();
+    cache->free  = (freeFunction)_secFreeCachedToken;
+    cache->match = (matchFunction)matchCachedToken;
+  }
+}
+
+/**
+ * @brief builds the cache key for an access token request
+ * @return the cache key or @c NULL if the request is not an access token
+ * request. Has to be freed after usage.
+ */
+char* tokenCache_keyForRequest(const char* request) {
+  INIT_KEY_VALUE(IPC_KEY_REQUEST, IPC_KEY_SHORTNAME, IPC_KEY_ISSUERURL,
+                 OIDC_KEY_SCOPE, IPC_KEY_AUDIENCE);
+  if (CALL_GETJSONVALUES(request) < 0) {
+    SEC_FREE_KEY_VALUES();
+    return NULL;
+  }
+  KEY_VALUE_VARS(request, shortname, issuer, scope, audience);
+  char* key = NULL;
+  if (strequal(_request, REQUEST_VALUE_ACCESSTOKEN)) {
+    key = oidc_sprintf("%s\n%s\n%s\n%s", _shortname ?: "", _issuer ?: "",
+                       _scope ?: "", _audience ?: "");
+  }
+  SEC_FREE_KEY_VALUES();
+  return key;
+}
+
+static void _removeExpired(time_t now) {
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(cache, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    if (((struct cached_token*)node->val)->expires_at <= now) {
+      list_remove(cache, node);
+    }
+  }
+  list_iterator_destroy(it);
+}
+
+/**
+ * @brief looks up a cached access token response
+ * @param key the cache key as returned by @c tokenCache_keyForRequest
+ * @param min_valid_period the minimum number of seconds the access token has
+ * to be valid
+ * @return a copy of the cached response or @c NULL if there is no response
+ * that satisfies @p min_valid_period. Has to be freed after usage.
+ */
+char* tokenCache_get(const char* key, time_t min_valid_period) {
+  if (key == NULL) {
+    return NULL;
+  }
+  pthread_mutex_lock(&cache_lock);
+  _initCache();
+  list_node_t*         n        = findInList(cache, key);
+  struct cached_token* t        = n ? n->val : NULL;
+  char*                response = NULL;
+  if (t != NULL && t->expires_at - min_valid_period > time(NULL)) {
+    response = oidc_strcopy(t->response);
+  }
+  pthread_mutex_unlock(&cache_lock);
+  return response;
+}
+
+/**
+ * @brief caches a successful access token response of the local agent;
+ * responses without an expiration time are not cached
+ */
+void tokenCache_put(const char* key, const char* response) {
+  if (key == NULL || response == NULL) {
+    return;
+  }
+  INIT_KEY_VALUE(IPC_KEY_STATUS, AGENT_KEY_EXPIRESAT);
+  if (CALL_GETJSONVALUES(response) < 0) {
+    SEC_FREE_KEY_VALUES();
+    return;
+  }
+  KEY_VALUE_VARS(status, expires_at);
+  const time_t expires_at = _expires_at ? strToULong(_expires_at) : 0;
+  const int    cacheable  = strequal(_status, STATUS_SUCCESS) && expires_at > 0;
+  SEC_FREE_KEY_VALUES();
+  if (!cacheable) {
+    return;
+  }
+  struct cached_token* t = secAlloc(sizeof(struct cached_token));
+  t->key                 = oidc_strcopy(key);
+  t->response            = oidc_strcopy(response);
+  t->expires_at          = expires_at;
+  pthread_mutex_lock(&cache_lock);
+  _initCache();
+  list_node_t* old = findInList(cache, key);
+  if (old != NULL) {
+    list_remove(cache, old);
+  }
+  _removeExpired(time(NULL));
+  while (cache->len >= REMOTE_TOKEN_CACHE_SIZE) {
+    list_remove(cache, cache->head);
+  }
+  list_rpush(cache, list_node_new(t));
+  agent_log(DEBUG, "Cached access token response; %d cached responses",
+            cache->len);
+  pthread_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,10 @@
+#ifndef OIDCR_TOKEN_CACHE_H
+#define OIDCR_TOKEN_CACHE_H
+
+#include <time.h>
+
+char* tokenCache_keyForRequest(const char* request);
+char* tokenCache_get(const char* key, time_t min_valid_period);
+void  tokenCache_put(const char* key, const char* response);
+
+#endif  // OIDCR_TOKEN_CACHE_H
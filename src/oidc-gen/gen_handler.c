@@ -16,10 +16,12 @@
 #include "utils/accountUtils.h"
 #include "utils/crypt/crypt.h"
 #include "utils/crypt/cryptUtils.h"
+#include "utils/crypt/kdf.h"
 #include "utils/errorUtils.h"
 #include "utils/file_io/cryptFileUtils.h"
 #include "utils/file_io/fileUtils.h"
 #include "utils/file_io/file_io.h"
+#include "utils/file_io/keystore.h"
 #include "utils/file_io/oidc_file_io.h"
 #include "utils/json.h"
 #include "utils/listUtils.h"
@@ -231,6 +233,118 @@ void gen_handleRename(const char*             shortname,
   secFree(hint);
 }
 
+/**
+ * @brief returns the issuer url of an account configuration that is moved
+ * into the keystore; an encrypted one is decrypted for this
+ */
+static char* _getIssuerForKeystore(const char* shortname, const char* content,
+                                   void* arg) {
+  if (isJSONObject(content)) {
+    return getJSONValueFromString(content, AGENT_KEY_ISSUERURL);
+  }
+  const struct arguments*             arguments = arg;
+  struct resultWithEncryptionPassword result =
+      _getDecryptedTextAndPasswordWithPromptFor(
+          content, shortname, decryptFileContent, 1, arguments->pw_cmd,
+          arguments->pw_file, arguments->pw_env);
+  secFree(result.password);
+  if (result.result == NULL) {
+    printError("Could not decrypt '%s': %s\n", shortname, oidc_serror());
+    return NULL;
+  }
+  char* issuer_url = getJSONValueFromString(result.result, AGENT_KEY_ISSUERURL);
+  secFree(result.result);
+  return issuer_url;
+}
+
+void gen_handleKeystore(const struct arguments* arguments) {
+  int moved =
+      keystore_importAccountFiles(_getIssuerForKeystore, (void*)arguments);
+  if (moved < 0) {
+    oidc_perror();
+    exit(EXIT_FAILURE);
+  }
+  printStdout("Moved %d account configuration%s into the keystore\n", moved,
+              moved == 1 ? "" : "s");
+}
+
+void gen_handleKdfBenchmark(unsigned long target_ms) {
+  printStdout("Measuring the key derivation for a target of %lu ms ...\n",
+              target_ms);
+  struct kdfCalibration calibration = kdf_calibrate(target_ms);
+  if (calibration.measured_ms == 0) {
+    oidc_perror();
+    exit(EXIT_FAILURE);
+  }
+  printStdout("Chose %d passes over %d MiB; deriving a key takes %lu ms\n",
+              calibration.params.hash_ops_limit,
+              calibration.params.hash_mem_limit / (1024 * 1024),
+              calibration.measured_ms);
+  if (kdf_saveDefaultParameters(&calibration) != OIDC_SUCCESS) {
+    oidc_perror();
+    exit(EXIT_FAILURE);
+  }
+  printStdout("These parameters are used for all account configurations "
+              "encrypted from now on. Use --reencrypt to migrate existing "
+              "ones.\n");
+}
+
+void gen_handleReencrypt(const struct arguments* arguments) {
+  list_t* accounts = getAccountConfigFileList();
+  if (accounts == NULL) {
+    oidc_perror();
+    exit(EXIT_FAILURE);
+  }
+  size_t           updated = 0, current = 0, failed = 0;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(accounts, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    const char* shortname = node->val;
+    char*       content   = readOidcFile(shortname);
+    if (content == NULL || isJSONObject(content)) {
+      // unencrypted files are only encrypted on explicit request (--update)
+      secFree(content);
+      continue;
+    }
+    if (kdf_usesDefaultParameters(content)) {
+      secFree(content);
+      current++;
+      continue;
+    }
+    struct resultWithEncryptionPassword result =
+        _getDecryptedTextAndPasswordWithPromptFor(
+            content, shortname, decryptFileContent, 1, arguments->pw_cmd,
+            arguments->pw_file, arguments->pw_env);
+    secFree(content);
+    if (result.result == NULL) {
+      printError("Could not decrypt '%s': %s\n", shortname, oidc_serror());
+      secFree(result.password);
+      failed++;
+      continue;
+    }
+    oidc_error_t e =
+        encryptAndWriteToOidcFile(result.result, shortname, result.password);
+    secFree(result.result);
+    secFree(result.password);
+    if (e != OIDC_SUCCESS) {
+      printError("Could not reencrypt '%s': %s\n", shortname, oidc_serror());
+      failed++;
+      continue;
+    }
+    updated++;
+  }
+  list_iterator_destroy(it);
+  secFreeList(accounts);
+  printStdout("Reencrypted %lu account configuration%s, %lu already up to "
+              "date\n",
+              updated, updated == 1 ? "" : "s", current);
+  if (failed) {
+    printError("Could not reencrypt %lu account configuration%s\n", failed,
+               failed == 1 ? "" : "s");
+    exit(EXIT_FAILURE);
+  }
+}
+
 char* _adjustUriSlash(const char* uri, unsigned char uri_needs_slash) {
   if (uri == NULL) {
     oidc_setArgNullFuncError(__func__);
@@ -34,6 +34,9 @@ void         gen_handleUpdateConfigFile(const char*             file,
                                         const struct arguments* arguments);
 char* gen_handleScopeLookup(const char* issuer_url, const char* cert_path);
 void gen_handleRename(const char* shortname, const struct arguments* arguments);
+void gen_handleKeystore(const struct arguments* arguments);
+void gen_handleKdfBenchmark(unsigned long target_ms);
+void gen_handleReencrypt(const struct arguments* arguments);
 
 void  removeFileFromAgent(const char* filename);
 void  writeFileToAgent(const char* filename, const char* data);
@@ -49,6 +49,18 @@ int main(int argc, char** argv) {
     gen_handleRename(arguments.args[0], &arguments);
     exit(EXIT_SUCCESS);
   }
+  if (arguments.keystore) {
+    gen_handleKeystore(&arguments);
+    exit(EXIT_SUCCESS);
+  }
+  if (arguments.kdf_benchmark) {
+    gen_handleKdfBenchmark(arguments.kdf_benchmark);
+    exit(EXIT_SUCCESS);
+  }
+  if (arguments.reencrypt) {
+    gen_handleReencrypt(&arguments);
+    exit(EXIT_SUCCESS);
+  }
   if (arguments.codeExchange) {
     handleCodeExchange(&arguments);
     exit(EXIT_SUCCESS);
@@ -3,6 +3,7 @@
 #include "defines/agent_values.h"
 #include "defines/settings.h"
 #include "utils/commonFeatures.h"
+#include "utils/crypt/kdf.h"
 #include "utils/listUtils.h"
 #include "utils/memory.h"
 #include "utils/portUtils.h"
@@ -42,6 +43,9 @@
 #define OPT_USERNAME 28
 #define OPT_PASSWORD 29
 #define OPT_PW_FILE 30
+#define OPT_KEYSTORE 31
+#define OPT_KDF_BENCHMARK 32
+#define OPT_REENCRYPT 33
 // Leave space for Ascii characters
 #define OPT_CONFIRM_YES 128
 #define OPT_CONFIRM_NO 129
@@ -75,6 +79,22 @@ static struct argp_option options[] = {
      "configuration short name).",
      1},
     {"delete", 'd', 0, 0, "Delete configuration for the given account", 1},
+    {"keystore", OPT_KEYSTORE, 0, 0,
+     "Moves all account configuration files into a single indexed keystore "
+     "file in the oidc-dir. Account configurations created afterwards are "
+     "also stored there.",
+     1},
+    {"kdf-benchmark", OPT_KDF_BENCHMARK, "MS", OPTION_ARG_OPTIONAL,
+     "Measures the key derivation on this host and chooses parameters, so that "
+     "decrypting an account configuration takes about MS milliseconds "
+     "(default: " KDF_DEFAULT_TARGET_MS_STR "). The parameters are used for "
+     "all account configurations encrypted afterwards.",
+     1},
+    {"reencrypt", OPT_REENCRYPT, 0, 0,
+     "Decrypts and reencrypts all account configurations that are not "
+     "encrypted with the current key derivation parameters (see "
+     "--kdf-benchmark).",
+     1},
 
     {0, 0, 0, 0, "Generating a new account configuration:", 2},
     {"file", 'f', "FILE", 0,
@@ -287,6 +307,9 @@ void initArguments(struct arguments* arguments) {
   arguments->confirm_default = 0;
   arguments->only_at         = 0;
   arguments->noSave          = 0;
+  arguments->keystore        = 0;
+  arguments->reencrypt       = 0;
+  arguments->kdf_benchmark   = 0;
 
   arguments->pw_prompt_mode = 0;
   set_pw_prompt_mode(arguments->pw_prompt_mode);
@@ -313,6 +336,8 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
     case 'v': arguments->verbose = 1; break;
     case 'm': arguments->manual = 1; break;
     case OPT_REAUTHENTICATE: arguments->reauthenticate = 1; break;
+    case OPT_KEYSTORE: arguments->keystore = 1; break;
+    case OPT_REENCRYPT: arguments->reencrypt = 1; break;
     case OPT_PUBLICCLIENT: arguments->usePublicClient = 1; break;
     case 'l': arguments->listAccounts = 1; break;
     case OPT_SECCOMP: arguments->seccomp = 1; break;
@@ -344,6 +369,13 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
       arguments->updateConfigFile = arg;
       break;
     case 'p': arguments->print = arg; break;
+    case OPT_KDF_BENCHMARK:
+      arguments->kdf_benchmark = arg ? strToULong(arg) : KDF_DEFAULT_TARGET_MS;
+      if (arguments->kdf_benchmark == 0) {
+        printError("MS must be a positive number of milliseconds\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
     case OPT_PW_ENV: arguments->pw_env = arg ?: OIDC_PASSWORD_ENV_NAME; break;
     case OPT_PW_CMD: arguments->pw_cmd = arg; break;
     case OPT_PW_FILE: arguments->pw_file = arg; break;
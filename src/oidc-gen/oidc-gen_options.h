@@ -71,6 +71,10 @@ struct arguments {
   unsigned char confirm_default;
   unsigned char only_at;
   unsigned char noSave;
+  unsigned char keystore;
+  unsigned char reencrypt;
+
+  unsigned long kdf_benchmark;
 };
 
 void initArguments(struct arguments* arguments);
@@ -196,6 +196,93 @@ char* getAccessTokenForIssuer3(const char* issuer_url, time_t min_valid_period,
   return response.token;
 }
 
+char* _getUserinfoFromRequest(unsigned char remote, const char* fmt,
+                              const char* name, const char* application_hint) {
+  char* response = communicate(remote, fmt, name,
+                               strValid(application_hint) ? application_hint
+                                                          : "");
+  return parseForUserinfo(response);
+}
+
+char* getUserinfo(const char* accountname, const char* application_hint) {
+  START_APILOGLEVEL
+  char* ret = _getUserinfoFromRequest(LOCAL_COMM, REQUEST_USERINFO_ACCOUNT,
+                                      accountname, application_hint);
+  END_APILOGLEVEL
+  return ret;
+}
+
+char* getUserinfoForIssuer(const char* issuer_url,
+                           const char* application_hint) {
+  START_APILOGLEVEL
+  char* ret = _getUserinfoFromRequest(LOCAL_COMM, REQUEST_USERINFO_ISSUER,
+                                      issuer_url, application_hint);
+  END_APILOGLEVEL
+  return ret;
+}
+
+char* _getTokenExchangeRequest(const char* accountname, const char* issuer,
+                               time_t min_valid_period, const char* audience,
+                               const char* resource, const char* scope,
+                               const char* hint) {
+  START_APILOGLEVEL
+  cJSON* json = generateJSONObject(IPC_KEY_REQUEST, cJSON_String,
+                                   REQUEST_VALUE_TOKENEXCHANGE,
+                                   IPC_KEY_MINVALID, cJSON_Number,
+                                   min_valid_period, NULL);
+  if (strValid(accountname)) {
+    jsonAddStringValue(json, IPC_KEY_SHORTNAME, accountname);
+  } else if (strValid(issuer)) {
+    jsonAddStringValue(json, IPC_KEY_ISSUERURL, issuer);
+  }
+  if (strValid(audience)) {
+    jsonAddStringValue(json, IPC_KEY_AUDIENCE, audience);
+  }
+  if (strValid(resource)) {
+    jsonAddStringValue(json, IPC_KEY_RESOURCE, resource);
+  }
+  if (strValid(scope)) {
+    jsonAddStringValue(json, OIDC_KEY_SCOPE, scope);
+  }
+  if (strValid(hint)) {
+    jsonAddStringValue(json, IPC_KEY_APPLICATIONHINT, hint);
+  }
+  char* ret = jsonToStringUnformatted(json);
+  secFreeJson(json);
+  logger(DEBUG, "%s", ret);
+  END_APILOGLEVEL
+  return ret;
+}
+
+struct token_response getExchangedTokenResponse(const char* accountname,
+                                                time_t      min_valid_period,
+                                                const char* audience,
+                                                const char* resource,
+                                                const char* scope,
+                                                const char* application_hint) {
+  START_APILOGLEVEL
+  char* request =
+      _getTokenExchangeRequest(accountname, NULL, min_valid_period, audience,
+                               resource, scope, application_hint);
+  struct token_response ret = _getTokenResponseFromRequest(LOCAL_COMM, request);
+  secFree(request);
+  END_APILOGLEVEL
+  return ret;
+}
+
+struct token_response getExchangedTokenResponseForIssuer(
+    const char* issuer_url, time_t min_valid_period, const char* audience,
+    const char* resource, const char* scope, const char* application_hint) {
+  START_APILOGLEVEL
+  char* request =
+      _getTokenExchangeRequest(NULL, issuer_url, min_valid_period, audience,
+                               resource, scope, application_hint);
+  struct token_response ret = _getTokenResponseFromRequest(LOCAL_COMM, request);
+  secFree(request);
+  END_APILOGLEVEL
+  return ret;
+}
+
 char* oidcagent_serror() { return oidc_serror(); }
 
 void oidcagent_perror() { oidc_perror(); }
@@ -214,6 +214,86 @@ LIB_PUBLIC struct token_response getTokenResponseForIssuer3(
     const char* issuer_url, time_t min_valid_period, const char* scope,
     const char* application_hint, const char* audience);
 
+/**
+ * @brief gets the userinfo for an account config
+ * @param accountname the short name of the account config for which the
+ * userinfo should be returned
+ * @param application_hint a hint about the requesting application. This
+ * might be displayed to the user on authorization prompts.
+ * @return a pointer to the json encoded userinfo. Has to be freed after usage
+ * using @c secFree function. On failure @c NULL is returned and @c oidc_errno
+ * is set.
+ * @note the agent caches the userinfo until the access token used to retrieve
+ * it expires
+ */
+LIB_PUBLIC char* getUserinfo(const char* accountname,
+                             const char* application_hint);
+
+/**
+ * @brief gets the userinfo for the provider with the given issuer url
+ * @param issuer_url the issuer url of the provider for which the userinfo
+ * should be returned
+ * @param application_hint a hint about the requesting application. This
+ * might be displayed to the user on authorization prompts.
+ * @return a pointer to the json encoded userinfo. Has to be freed after usage
+ * using @c secFree function. On failure @c NULL is returned and @c oidc_errno
+ * is set.
+ */
+LIB_PUBLIC char* getUserinfoForIssuer(const char* issuer_url,
+                                      const char* application_hint);
+
+/**
+ * @brief exchanges an access token of an account config for an access token for
+ * another audience or resource (OAuth 2.0 Token Exchange)
+ * @param accountname the short name of the account config whose access token
+ * should be exchanged
+ * @param min_valid_period the minium period of time the exchanged token has to
+ * be valid in seconds
+ * @param audience the audience the exchanged token is requested for. Can be a
+ * space separated list. At least one of @p audience and @p resource must be
+ * given.
+ * @param resource the uri of the resource the exchanged token is requested
+ * for. @c NULL if only an audience should be requested.
+ * @param scope a space delimited list of scope values for the exchanged token.
+ * @c NULL if the provider's default should be used.
+ * @param application_hint a hint indicating what application requests the
+ * access token. This string might be displayed to the user.
+ * @return a token_response struct containing the exchanged token, issuer_url,
+ * and expiration time.
+ * Has to be freed after usage using the @c secFreeTokenResponse function. On
+ * failure a zeroed struct is returned and @c oidc_errno is set.
+ * @note the agent caches exchanged tokens per audience, resource, and scope
+ * until they expire
+ */
+LIB_PUBLIC struct token_response getExchangedTokenResponse(
+    const char* accountname, time_t min_valid_period, const char* audience,
+    const char* resource, const char* scope, const char* application_hint);
+
+/**
+ * @brief exchanges an access token for the provider with the given issuer url
+ * for an access token for another audience or resource
+ * @param issuer_url the issuer url of the provider whose access token should be
+ * exchanged
+ * @param min_valid_period the minium period of time the exchanged token has to
+ * be valid in seconds
+ * @param audience the audience the exchanged token is requested for. Can be a
+ * space separated list. At least one of @p audience and @p resource must be
+ * given.
+ * @param resource the uri of the resource the exchanged token is requested
+ * for. @c NULL if only an audience should be requested.
+ * @param scope a space delimited list of scope values for the exchanged token.
+ * @c NULL if the provider's default should be used.
+ * @param application_hint a hint indicating what application requests the
+ * access token. This string might be displayed to the user.
+ * @return a token_response struct containing the exchanged token, issuer_url,
+ * and expiration time.
+ * Has to be freed after usage using the @c secFreeTokenResponse function. On
+ * failure a zeroed struct is returned and @c oidc_errno is set.
+ */
+LIB_PUBLIC struct token_response getExchangedTokenResponseForIssuer(
+    const char* issuer_url, time_t min_valid_period, const char* audience,
+    const char* resource, const char* scope, const char* application_hint);
+
 /**
  * @brief gets an error string detailing the last occurred error
  * @return the error string. MUST NOT be freed.
@@ -36,17 +36,34 @@ int main(int argc, char** argv) {
     token_handleIdToken(useIssuerInsteadOfShortname, arguments.args[0]);
     exit(EXIT_SUCCESS);
   }
+  if (arguments.userinfo) {
+    token_handleUserinfo(useIssuerInsteadOfShortname, arguments.args[0],
+                         strValid(arguments.application_name)
+                             ? arguments.application_name
+                             : "oidc-token");
+    exit(EXIT_SUCCESS);
+  }
   if (useIssuerInsteadOfShortname) {
     getTokenResponseFnc = getTokenResponseForIssuer3;
   }
-  struct token_response response = getTokenResponseFnc(
-      arguments.args[0],
-      arguments.forceNewToken ? FORCE_NEW_TOKEN : arguments.min_valid_period,
-      scope_str,
-      strValid(arguments.application_name) ? arguments.application_name
-                                           : "oidc-token",
-      arguments.audience);  // for getting a valid access token just call the
-                            // api
+  const time_t min_valid_period =
+      arguments.forceNewToken ? FORCE_NEW_TOKEN : arguments.min_valid_period;
+  const char* application_hint = strValid(arguments.application_name)
+                                     ? arguments.application_name
+                                     : "oidc-token";
+  struct token_response response;
+  if (arguments.tokenExchange) {
+    response = (useIssuerInsteadOfShortname
+                    ? getExchangedTokenResponseForIssuer
+                    : getExchangedTokenResponse)(
+        arguments.args[0], min_valid_period, arguments.audience,
+        arguments.resource, scope_str, application_hint);
+  } else {
+    response = getTokenResponseFnc(
+        arguments.args[0], min_valid_period, scope_str, application_hint,
+        arguments.audience);  // for getting a valid access token just call
+                              // the api
+  }
   secFree(scope_str);
 
   if (response.token == NULL) {
@@ -9,6 +9,9 @@
 #define OPT_NAME 2
 #define OPT_AUDIENCE 3
 #define OPT_IDTOKEN 4
+#define OPT_USERINFO 5
+#define OPT_TOKEN_EXCHANGE 6
+#define OPT_RESOURCE 7
 
 static struct argp_option options[] = {
     {0, 0, 0, 0, "General:", 1},
@@ -76,6 +79,19 @@ static struct argp_option options[] = {
      "development tool. ID-tokens should not be passed as authorization to "
      "resources.",
      2},
+    {"userinfo", OPT_USERINFO, 0, 0,
+     "Returns the userinfo of the account as JSON instead of an access token. "
+     "The userinfo is cached by the agent.",
+     2},
+    {"token-exchange", OPT_TOKEN_EXCHANGE, 0, 0,
+     "Exchanges the account's access token for an access token for the "
+     "audience given with --aud or the resource given with --resource. "
+     "Exchanged tokens are cached by the agent until they expire.",
+     2},
+    {"resource", OPT_RESOURCE, "RESOURCE", 0,
+     "Uri of the resource an exchanged access token is requested for. "
+     "Implies --token-exchange.",
+     2},
 
     {0, 0, 0, 0, "Help:", -1},
     {0, 'h', 0, OPTION_HIDDEN, 0, -1},
@@ -100,8 +116,14 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
       break;
     case OPT_SECCOMP: arguments->seccomp = 1; break;
     case OPT_IDTOKEN: arguments->idtoken = 1; break;
+    case OPT_USERINFO: arguments->userinfo = 1; break;
     case OPT_NAME: arguments->application_name = arg; break;
     case OPT_AUDIENCE: arguments->audience = arg; break;
+    case OPT_TOKEN_EXCHANGE: arguments->tokenExchange = 1; break;
+    case OPT_RESOURCE:
+      arguments->resource      = arg;
+      arguments->tokenExchange = 1;
+      break;
     case 'i':
       arguments->issuer_env.str   = arg;
       arguments->issuer_env.useIt = 1;
@@ -134,6 +156,10 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
       if (state->arg_num < 1) {
         argp_usage(state);
       }
+      if (arguments->tokenExchange && arguments->audience == NULL &&
+          arguments->resource == NULL) {
+        argp_error(state, "--token-exchange requires --aud or --resource");
+      }
       break;
     default: return ARGP_ERR_UNKNOWN;
   }
@@ -153,6 +179,7 @@ void initArguments(struct arguments* arguments) {
   arguments->scopes               = NULL;
   arguments->application_name     = NULL;
   arguments->audience             = NULL;
+  arguments->resource             = NULL;
   arguments->seccomp              = 0;
   arguments->expiration_env.str   = NULL;
   arguments->expiration_env.useIt = 0;
@@ -162,5 +189,7 @@ void initArguments(struct arguments* arguments) {
   arguments->issuer_env.useIt     = 0;
   arguments->printAll             = 0;
   arguments->idtoken              = 0;
+  arguments->userinfo             = 0;
+  arguments->tokenExchange        = 0;
   arguments->forceNewToken        = 0;
 }
@@ -22,6 +22,7 @@ struct arguments {
 
   char* application_name;
   char* audience;
+  char* resource;
 
   struct optional_arg issuer_env;
   struct optional_arg expiration_env;
@@ -30,6 +31,8 @@ struct arguments {
   unsigned char seccomp;
   unsigned char printAll;
   unsigned char idtoken;
+  unsigned char userinfo;
+  unsigned char tokenExchange;
   unsigned char forceNewToken;
 
   time_t min_valid_period;
@@ -34,3 +34,27 @@ struct token_response parseForTokenResponse(char* response) {
     return (struct token_response){_access_token, _issuer, expires_at};
   }
 }
+
+char* parseForUserinfo(char* response) {
+  if (response == NULL) {
+    return NULL;
+  }
+  INIT_KEY_VALUE(IPC_KEY_STATUS, OIDC_KEY_ERROR, IPC_KEY_USERINFO);
+  if (CALL_GETJSONVALUES(response) < 0) {
+    printError("Read malformed data. Please hand in bug report.\n");
+    secFree(response);
+    SEC_FREE_KEY_VALUES();
+    return NULL;
+  }
+  secFree(response);
+  KEY_VALUE_VARS(status, error, userinfo);
+  secFree(_status);
+  if (_error) {  // error
+    oidc_errno = OIDC_EERROR;
+    oidc_seterror(_error);
+    SEC_FREE_KEY_VALUES();
+    return NULL;
+  }
+  oidc_errno = OIDC_SUCCESS;
+  return _userinfo;
+}
@@ -4,5 +4,6 @@
 #include "api.h"
 
 struct token_response parseForTokenResponse(char* response);
+char*                 parseForUserinfo(char* response);
 
 #endif /* OIDC_TOKEN_PARSE_H */
@@ -1,6 +1,7 @@
 #include "token_handler.h"
 
 #include "defines/ipc_values.h"
+#include "api.h"
 #include "ipc/cryptCommunicator.h"
 #include "utils/file_io/oidc_file_io.h"
 #include "utils/json.h"
@@ -41,3 +42,16 @@ void token_handleIdToken(const unsigned char useIssuerInsteadOfShortname,
   printStdout("%s\n", _id_token);
   SEC_FREE_KEY_VALUES();
 }
+
+void token_handleUserinfo(const unsigned char useIssuerInsteadOfShortname,
+                          const char* name, const char* application_hint) {
+  char* userinfo = useIssuerInsteadOfShortname
+                       ? getUserinfoForIssuer(name, application_hint)
+                       : getUserinfo(name, application_hint);
+  if (userinfo == NULL) {
+    oidcagent_perror();
+    exit(EXIT_FAILURE);
+  }
+  printStdout("%s\n", userinfo);
+  secFree(userinfo);
+}
@@ -5,5 +5,7 @@
 
 void token_handleIdToken(const unsigned char useIssuerInsteadOfShortname,
                          const char*         name);
+void token_handleUserinfo(const unsigned char useIssuerInsteadOfShortname,
+                          const char* name, const char* application_hint);
 
 #endif /* OIDC_TOKEN_HANDLER_H */
@@ -21,6 +21,7 @@ void initOidcAddPrivileges(struct arguments* arguments) {
   addSocketSysCalls(ctx);
   if (!(arguments->lock || arguments->unlock)) {
     addFileReadSysCalls(ctx);
+    addKeystoreReadSysCalls(ctx);  // account lookup in the keystore
   }
 
   rc = seccomp_load(ctx);
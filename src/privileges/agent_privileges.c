@@ -27,6 +27,27 @@ void initOidcAgentPrivileges(struct arguments* arguments) {
   addDaemonSysCalls(ctx);
   addHttpSysCalls(ctx);
   addHttpServerSysCalls(ctx);
+  addKeystoreSysCalls(ctx);
+  addConfigWatchSysCalls(ctx);
+  if (arguments->state_snapshot) {
+    addStateSnapshotSysCalls(ctx);
+  }
+  if (arguments->max_loaded_accounts) {
+    addUnloadedAccountsSysCalls(ctx);
+  }
+  if (arguments->remote_port) {
+    addRemoteServerSysCalls(ctx);
+  }
+  if (arguments->multi_user) {
+    addMultiUserSysCalls(ctx);
+  }
+  if (arguments->fast_ipc || arguments->peer_max_connections ||
+      arguments->peer_rate_limit) {
+    addPeerCredSysCalls(ctx);
+  }
+  if (arguments->shm_ipc) {
+    addShmIpcSysCalls(ctx);
+  }
 
   rc = seccomp_load(ctx);
   seccomp_release(ctx);
@@ -21,6 +21,8 @@ void initOidcGenPrivileges(
   addPromptingSysCalls(ctx);
   addSocketSysCalls(ctx);
   addFileWriteSysCalls(ctx);
+  addKeystoreSysCalls(ctx);
+  addConfigWatchSysCalls(ctx);
   addCryptSysCalls(ctx);
   addSignalHandlingSysCalls(
       ctx);  // needed if auth code flow is executed -> not needed if flow!=code
@@ -86,6 +86,60 @@ void addHttpServerSysCalls(scmp_filter_ctx ctx) {
   secFree(path);
 }
 
+void addRemoteServerSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "remote");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addMultiUserSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "multiuser");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addPeerCredSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "peercred");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addShmIpcSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "shmipc");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addStateSnapshotSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "snapshot");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addUnloadedAccountsSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "unloaded");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addKeystoreSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "keystore");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addKeystoreReadSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "keystoreRead");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
+void addConfigWatchSysCalls(scmp_filter_ctx ctx) {
+  char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "configwatch");
+  addSysCallsFromConfigFile(ctx, path);
+  secFree(path);
+}
+
 void addFileWriteSysCalls(scmp_filter_ctx ctx) {
   addFileReadSysCalls(ctx);
   char* path = oidc_sprintf("%s/%s.priv", PRIVILEGES_PATH, "write");
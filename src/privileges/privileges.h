@@ -35,6 +35,15 @@ void addDaemonSysCalls(scmp_filter_ctx ctx);
 void addAgentIpcSysCalls(scmp_filter_ctx ctx);
 void addHttpSysCalls(scmp_filter_ctx ctx);
 void addHttpServerSysCalls(scmp_filter_ctx ctx);
+void addRemoteServerSysCalls(scmp_filter_ctx ctx);
+void addMultiUserSysCalls(scmp_filter_ctx ctx);
+void addPeerCredSysCalls(scmp_filter_ctx ctx);
+void addShmIpcSysCalls(scmp_filter_ctx ctx);
+void addStateSnapshotSysCalls(scmp_filter_ctx ctx);
+void addUnloadedAccountsSysCalls(scmp_filter_ctx ctx);
+void addKeystoreSysCalls(scmp_filter_ctx ctx);
+void addKeystoreReadSysCalls(scmp_filter_ctx ctx);
+void addConfigWatchSysCalls(scmp_filter_ctx ctx);
 void addKillSysCall(scmp_filter_ctx ctx);
 void addSignalHandlingSysCalls(scmp_filter_ctx ctx);
 void addSleepSysCalls(scmp_filter_ctx ctx);
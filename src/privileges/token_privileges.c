@@ -19,6 +19,8 @@ void initOidcTokenPrivileges(
   addGeneralSysCalls(ctx);
   addLoggingSysCalls(ctx);
   addSocketSysCalls(ctx);
+  addFileReadSysCalls(ctx);
+  addKeystoreReadSysCalls(ctx);  // account lookup in the keystore
 
   rc = seccomp_load(ctx);
   seccomp_release(ctx);
@@ -191,7 +191,7 @@ struct oidc_account* db_findAccountByShortname(const char* shortname) {
   return account;
 }
 
-list_t* db_findAccountsByIssuerUrl(const char* issuer_url) {
+vector_t* db_findAccountsByIssuerUrl(const char* issuer_url) {
   if (issuer_url == NULL) {
     return NULL;
   }
@@ -200,7 +200,7 @@ list_t* db_findAccountsByIssuerUrl(const char* issuer_url) {
   char*               tmp      = oidc_strcopy(issuer_url);
   struct oidc_issuer  iss      = {.issuer_url = tmp};
   struct oidc_account key      = {.issuer = &iss};
-  list_t*             accounts = accountDB_findAllValues(&key);
+  vector_t*           accounts = accountDB_findAllValues(&key);
   secFree(tmp);
   accountDB_setMatchFunction(oldMatch);
   return accounts;
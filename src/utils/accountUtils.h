@@ -2,6 +2,7 @@
 #define ACCOUNT_UTILS_H
 
 #include "account/account.h"
+#include "utils/vector.h"
 
 #include <time.h>
 
@@ -31,6 +32,6 @@ struct resultWithEncryptionPassword
                                                                           const char* pw_file,
                                                                           const char* pw_env);
 struct oidc_account* db_findAccountByShortname(const char* shortname);
-list_t*              db_findAccountsByIssuerUrl(const char* issuer_url);
+vector_t*            db_findAccountsByIssuerUrl(const char* issuer_url);
 
 #endif  // ACCOUNT_UTILS_H
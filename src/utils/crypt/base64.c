@@ -0,0 +1,410 @@
+#include "base64.h"
+
+#include <errno.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define BASE64_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The codec does not use lookup tables indexed by secret data. The scalar code
+ * maps between bytes and characters with branch free range comparisons (like
+ * libsodium), the vector code with in-register shuffles. Only the position of
+ * the first invalid character can be observed, because decoding stops there.
+ */
+#define EQ(x, y) \
+  ((((0U - ((unsigned int)(x) ^ (unsigned int)(y))) >> 8) & 0xFF) ^ 0xFF)
+#define GT(x, y) ((((unsigned int)(y) - (unsigned int)(x)) >> 8) & 0xFF)
+#define GE(x, y) (GT(y, x) ^ 0xFF)
+#define LT(x, y) GT(y, x)
+#define LE(x, y) GE(y, x)
+
+#define BASE64_INVALID 0xFF
+
+static int _isUrlSafe(int variant) {
+  return ((unsigned int)variant & BASE64_VARIANT_URLSAFE_MASK) != 0;
+}
+
+static int _isPadded(int variant) {
+  return ((unsigned int)variant & BASE64_VARIANT_NO_PADDING_MASK) == 0;
+}
+
+static char _byteToChar(unsigned int x, int urlsafe) {
+  const unsigned int c62 = urlsafe ? '-' : '+';
+  const unsigned int c63 = urlsafe ? '_' : '/';
+  return (char)((LT(x, 26) & (x + 'A')) |
+                (GE(x, 26) & LT(x, 52) & (x + ('a' - 26))) |
+                (GE(x, 52) & LT(x, 62) & (x + ('0' - 52))) |
+                (EQ(x, 62) & c62) | (EQ(x, 63) & c63));
+}
+
+static unsigned int _charToByte(unsigned int c, int urlsafe) {
+  const unsigned int c62 = urlsafe ? '-' : '+';
+  const unsigned int c63 = urlsafe ? '_' : '/';
+  const unsigned int x   = (GE(c, 'A') & LE(c, 'Z') & (c - 'A')) |
+                         (GE(c, 'a') & LE(c, 'z') & (c - ('a' - 26))) |
+                         (GE(c, '0') & LE(c, '9') & (c - ('0' - 52))) |
+                         (EQ(c, c62) & 62) | (EQ(c, c63) & 63);
+  return x | (EQ(x, 0) & (EQ(c, 'A') ^ 0xFF));
+}
+
+/**
+ * Block functions encode a prefix of the input that is a multiple of 3 bytes
+ * (decode a prefix that is a multiple of 4 characters) and return the number
+ * of bytes (characters) consumed. The rest is done by the scalar code.
+ */
+typedef size_t (*encodeBlocksFunction)(char*, const unsigned char*, size_t,
+                                       int);
+typedef size_t (*decodeBlocksFunction)(unsigned char*, size_t, const char*,
+                                       size_t, int);
+
+static size_t _encodeBlocksScalar(char* b64, const unsigned char* bin,
+                                  size_t bin_len, int urlsafe) {
+  (void)b64;
+  (void)bin;
+  (void)bin_len;
+  (void)urlsafe;
+  return 0;
+}
+
+static size_t _decodeBlocksScalar(unsigned char* bin, size_t bin_maxlen,
+                                  const char* b64, size_t b64_len,
+                                  int urlsafe) {
+  (void)bin;
+  (void)bin_maxlen;
+  (void)b64;
+  (void)b64_len;
+  (void)urlsafe;
+  return 0;
+}
+
+#ifdef BASE64_X86
+
+/**
+ * Per lane constants of the vector code (the shuffles of SSE and AVX2 work
+ * within 16 byte lanes). The encoder splits 12 bytes into 16 6 bit indices and
+ * maps them to characters with an offset per index range. The decoder checks
+ * the characters with a bit mask of the allowed high nibbles per low nibble,
+ * adds an offset per high nibble and packs 16 6 bit values into 12 bytes.
+ */
+#define B64_ENC_SPLIT 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+#define B64_ENC_OFFSETS(urlsafe)                                              \
+  'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,       \
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, (urlsafe) ? '-' - 62 : '+' - 62, \
+      (urlsafe) ? '_' - 63 : '/' - 63, 'A', 0, 0
+#define B64_F8 (char)0xf8
+#define B64_DEC_ALLOWED(urlsafe)                                          \
+  (char)0xa8, B64_F8, B64_F8, B64_F8, B64_F8, B64_F8, B64_F8, B64_F8,     \
+      B64_F8, B64_F8, (char)0xf0, (urlsafe) ? 0x50 : 0x54, 0x50,          \
+      (urlsafe) ? 0x54 : 0x50, 0x50, (urlsafe) ? 0x70 : 0x54
+#define B64_DEC_BITPOS \
+  0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0
+#define B64_DEC_OFFSETS(urlsafe) \
+  0, 0, (urlsafe) ? 17 : 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+// the one character that does not share the offset of its high nibble
+#define B64_DEC_SPECIAL_CHAR(urlsafe) ((urlsafe) ? '_' : '/')
+#define B64_DEC_SPECIAL_OFFSET(urlsafe) ((urlsafe) ? -32 : 16)
+#define B64_DEC_PACK 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+__attribute__((target("sse4.1"))) static size_t _encodeBlocksSSE41(
+    char* b64, const unsigned char* bin, size_t bin_len, int urlsafe) {
+  const __m128i split   = _mm_setr_epi8(B64_ENC_SPLIT);
+  const __m128i offsets = _mm_setr_epi8(B64_ENC_OFFSETS(urlsafe));
+  size_t        i       = 0;
+  // 16 bytes are loaded, 12 of them are encoded
+  for (; i + 16 <= bin_len; i += 12) {
+    const __m128i in =
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bin + i)), split);
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+    __m128i       range   = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less    = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+    _mm_storeu_si128((__m128i*)(b64 + i / 3 * 4),
+                     _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices));
+  }
+  return i;
+}
+
+__attribute__((target("sse4.1"))) static size_t _decodeBlocksSSE41(
+    unsigned char* bin, size_t bin_maxlen, const char* b64, size_t b64_len,
+    int urlsafe) {
+  const __m128i allowed = _mm_setr_epi8(B64_DEC_ALLOWED(urlsafe));
+  const __m128i bitpos  = _mm_setr_epi8(B64_DEC_BITPOS);
+  const __m128i offsets = _mm_setr_epi8(B64_DEC_OFFSETS(urlsafe));
+  const __m128i special = _mm_set1_epi8(B64_DEC_SPECIAL_CHAR(urlsafe));
+  const __m128i special_offset =
+      _mm_set1_epi8(B64_DEC_SPECIAL_OFFSET(urlsafe));
+  const __m128i pack = _mm_setr_epi8(B64_DEC_PACK);
+  size_t        i    = 0;
+  // 16 bytes are stored, 12 of them are decoded
+  for (; i + 16 <= b64_len && i / 4 * 3 + 16 <= bin_maxlen; i += 16) {
+    const __m128i in = _mm_loadu_si128((const __m128i*)(b64 + i));
+    const __m128i hi =
+        _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+    const __m128i lo    = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+    const __m128i match = _mm_and_si128(_mm_shuffle_epi8(allowed, lo),
+                                        _mm_shuffle_epi8(bitpos, hi));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(match, _mm_setzero_si128()))) {
+      break;
+    }
+    const __m128i shift =
+        _mm_blendv_epi8(_mm_shuffle_epi8(offsets, hi), special_offset,
+                        _mm_cmpeq_epi8(in, special));
+    const __m128i values = _mm_add_epi8(in, shift);
+    const __m128i merged =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128((__m128i*)(bin + i / 4 * 3),
+                     _mm_shuffle_epi8(packed, pack));
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t _encodeBlocksAVX2(
+    char* b64, const unsigned char* bin, size_t bin_len, int urlsafe) {
+  const __m256i split   = _mm256_setr_epi8(B64_ENC_SPLIT, B64_ENC_SPLIT);
+  const __m256i offsets = _mm256_setr_epi8(B64_ENC_OFFSETS(urlsafe),
+                                           B64_ENC_OFFSETS(urlsafe));
+  size_t        i       = 0;
+  // 28 bytes are loaded, 24 of them are encoded
+  for (; i + 28 <= bin_len; i += 24) {
+    const __m256i in = _mm256_shuffle_epi8(
+        _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(bin + i))),
+            _mm_loadu_si128((const __m128i*)(bin + i + 12)), 1),
+        split);
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+    __m256i       range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less  = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range =
+        _mm256_or_si256(range, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    _mm256_storeu_si256(
+        (__m256i*)(b64 + i / 3 * 4),
+        _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices));
+  }
+  // avoid the penalty of mixing avx and sse code
+  _mm256_zeroupper();
+  return i + _encodeBlocksSSE41(b64 + i / 3 * 4, bin + i, bin_len - i, urlsafe);
+}
+
+__attribute__((target("avx2"))) static size_t _decodeBlocksAVX2(
+    unsigned char* bin, size_t bin_maxlen, const char* b64, size_t b64_len,
+    int urlsafe) {
+  const __m256i allowed = _mm256_setr_epi8(B64_DEC_ALLOWED(urlsafe),
+                                           B64_DEC_ALLOWED(urlsafe));
+  const __m256i bitpos  = _mm256_setr_epi8(B64_DEC_BITPOS, B64_DEC_BITPOS);
+  const __m256i offsets = _mm256_setr_epi8(B64_DEC_OFFSETS(urlsafe),
+                                           B64_DEC_OFFSETS(urlsafe));
+  const __m256i special = _mm256_set1_epi8(B64_DEC_SPECIAL_CHAR(urlsafe));
+  const __m256i special_offset =
+      _mm256_set1_epi8(B64_DEC_SPECIAL_OFFSET(urlsafe));
+  const __m256i pack = _mm256_setr_epi8(B64_DEC_PACK, B64_DEC_PACK);
+  // moves the 12 decoded bytes of both lanes together
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+  size_t        i     = 0;
+  // 32 bytes are stored, 24 of them are decoded
+  for (; i + 32 <= b64_len && i / 4 * 3 + 32 <= bin_maxlen; i += 32) {
+    const __m256i in = _mm256_loadu_si256((const __m256i*)(b64 + i));
+    const __m256i hi =
+        _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+    const __m256i lo    = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+    const __m256i match = _mm256_and_si256(_mm256_shuffle_epi8(allowed, lo),
+                                           _mm256_shuffle_epi8(bitpos, hi));
+    if (_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(match, _mm256_setzero_si256()))) {
+      break;
+    }
+    const __m256i shift =
+        _mm256_blendv_epi8(_mm256_shuffle_epi8(offsets, hi), special_offset,
+                           _mm256_cmpeq_epi8(in, special));
+    const __m256i values = _mm256_add_epi8(in, shift);
+    const __m256i merged =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i packed =
+        _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    _mm256_storeu_si256(
+        (__m256i*)(bin + i / 4 * 3),
+        _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, pack), lanes));
+  }
+  _mm256_zeroupper();
+  return i + _decodeBlocksSSE41(bin + i / 4 * 3, bin_maxlen - i / 4 * 3,
+                                b64 + i, b64_len - i, urlsafe);
+}
+
+#endif  // BASE64_X86
+
+static enum base64_implementation implementation = BASE64_IMPL_AUTO;
+
+static enum base64_implementation _detectImplementation() {
+#ifdef BASE64_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return BASE64_IMPL_AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return BASE64_IMPL_SSE41;
+  }
+#endif
+  return BASE64_IMPL_SCALAR;
+}
+
+static enum base64_implementation _getImplementation() {
+  if (implementation == BASE64_IMPL_AUTO) {
+    implementation = _detectImplementation();
+  }
+  return implementation;
+}
+
+/**
+ * @brief selects the implementation used by the codec
+ * @param impl the implementation; @c BASE64_IMPL_AUTO selects the fastest one
+ * supported by the cpu
+ * @return @c 1 on success, @c 0 if @p impl is not supported by the cpu
+ */
+int base64_useImplementation(enum base64_implementation impl) {
+  const enum base64_implementation best = _detectImplementation();
+  if (impl == BASE64_IMPL_AUTO) {
+    implementation = best;
+    return 1;
+  }
+  if (impl > best) {
+    return 0;
+  }
+  implementation = impl;
+  return 1;
+}
+
+const char* base64_implementationName() {
+  switch (_getImplementation()) {
+    case BASE64_IMPL_AVX2: return "avx2";
+    case BASE64_IMPL_SSE41: return "sse4.1";
+    default: return "scalar";
+  }
+}
+
+static encodeBlocksFunction _encodeBlocks() {
+#ifdef BASE64_X86
+  switch (_getImplementation()) {
+    case BASE64_IMPL_AVX2: return _encodeBlocksAVX2;
+    case BASE64_IMPL_SSE41: return _encodeBlocksSSE41;
+    default: break;
+  }
+#endif
+  return _encodeBlocksScalar;
+}
+
+static decodeBlocksFunction _decodeBlocks() {
+#ifdef BASE64_X86
+  switch (_getImplementation()) {
+    case BASE64_IMPL_AVX2: return _decodeBlocksAVX2;
+    case BASE64_IMPL_SSE41: return _decodeBlocksSSE41;
+    default: break;
+  }
+#endif
+  return _decodeBlocksScalar;
+}
+
+/**
+ * @brief base64 encodes @p bin_len bytes of @p bin
+ * @param b64 the output buffer; it must hold at least
+ * @c sodium_base64_ENCODED_LEN(bin_len, variant) characters
+ * @param variant a libsodium base64 variant
+ * @return the length of the encoded string; @p b64 is nullterminated
+ */
+size_t base64_encode(char* b64, const unsigned char* bin, size_t bin_len,
+                     int variant) {
+  const int urlsafe = _isUrlSafe(variant);
+  size_t    i       = _encodeBlocks()(b64, bin, bin_len, urlsafe);
+  size_t    pos     = i / 3 * 4;
+  for (; i + 3 <= bin_len; i += 3) {
+    const unsigned int acc = (bin[i] << 16) | (bin[i + 1] << 8) | bin[i + 2];
+    b64[pos++]             = _byteToChar((acc >> 18) & 0x3F, urlsafe);
+    b64[pos++]             = _byteToChar((acc >> 12) & 0x3F, urlsafe);
+    b64[pos++]             = _byteToChar((acc >> 6) & 0x3F, urlsafe);
+    b64[pos++]             = _byteToChar(acc & 0x3F, urlsafe);
+  }
+  const size_t rest = bin_len - i;
+  if (rest > 0) {
+    const unsigned int acc =
+        (bin[i] << 16) | (rest == 2 ? (bin[i + 1] << 8) : 0);
+    b64[pos++] = _byteToChar((acc >> 18) & 0x3F, urlsafe);
+    b64[pos++] = _byteToChar((acc >> 12) & 0x3F, urlsafe);
+    if (rest == 2) {
+      b64[pos++] = _byteToChar((acc >> 6) & 0x3F, urlsafe);
+    }
+    if (_isPadded(variant)) {
+      for (size_t p = rest; p < 3; p++) { b64[pos++] = '='; }
+    }
+  }
+  b64[pos] = '\0';
+  return pos;
+}
+
+/**
+ * @brief decodes @p b64_len characters of @p b64; behaves like
+ * @c sodium_base642bin without ignored characters and without @c b64_end
+ * @param bin the output buffer
+ * @param bin_maxlen the size of @p bin
+ * @param bin_len if not @c NULL, the number of decoded bytes is stored here
+ * @param variant a libsodium base64 variant
+ * @return @c 0 on success, @c -1 if @p b64 is not valid or @p bin is too small
+ */
+int base64_decode(unsigned char* bin, size_t bin_maxlen, const char* b64,
+                  size_t b64_len, size_t* bin_len, int variant) {
+  const int    urlsafe = _isUrlSafe(variant);
+  size_t       pos =
+      _decodeBlocks()(bin, bin_maxlen, b64, b64_len, urlsafe);
+  size_t       bin_pos = pos / 4 * 3;
+  unsigned int acc     = 0;
+  size_t       acc_len = 0;
+  int          ret     = 0;
+  for (; pos < b64_len; pos++) {
+    const unsigned int d = _charToByte((unsigned char)b64[pos], urlsafe);
+    if (d == BASE64_INVALID) {
+      break;
+    }
+    acc = (acc << 6) + d;
+    acc_len += 6;
+    if (acc_len >= 8) {
+      acc_len -= 8;
+      if (bin_pos >= bin_maxlen) {
+        errno = ERANGE;
+        ret   = -1;
+        break;
+      }
+      bin[bin_pos++] = (acc >> acc_len) & 0xFF;
+    }
+  }
+  if (acc_len > 4 || (acc & ((1U << acc_len) - 1U)) != 0) {
+    ret = -1;
+  } else if (ret == 0 && _isPadded(variant)) {
+    for (size_t padding = acc_len / 2; padding > 0; padding--, pos++) {
+      if (pos >= b64_len || b64[pos] != '=') {
+        ret = -1;
+        break;
+      }
+    }
+  }
+  if (ret != 0) {
+    bin_pos = 0;
+  } else if (pos != b64_len) {
+    errno = EINVAL;
+    ret   = -1;
+  }
+  if (bin_len != NULL) {
+    *bin_len = bin_pos;
+  }
+  return ret;
+}
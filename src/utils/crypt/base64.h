@@ -0,0 +1,28 @@
+#ifndef OIDC_BASE64_H
+#define OIDC_BASE64_H
+
+#include <stddef.h>
+
+/**
+ * The base64 variants are the ones of libsodium (@c sodium_base64_VARIANT_*),
+ * so both can be used interchangeably.
+ */
+#define BASE64_VARIANT_NO_PADDING_MASK 2U
+#define BASE64_VARIANT_URLSAFE_MASK 4U
+
+enum base64_implementation {
+  BASE64_IMPL_AUTO,
+  BASE64_IMPL_SCALAR,
+  BASE64_IMPL_SSE41,
+  BASE64_IMPL_AVX2,
+};
+
+size_t base64_encode(char* b64, const unsigned char* bin, size_t bin_len,
+                     int variant);
+int    base64_decode(unsigned char* bin, size_t bin_maxlen, const char* b64,
+                     size_t b64_len, size_t* bin_len, int variant);
+
+int         base64_useImplementation(enum base64_implementation impl);
+const char* base64_implementationName();
+
+#endif  // OIDC_BASE64_H
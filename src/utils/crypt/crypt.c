@@ -1,4 +1,5 @@
 #include "crypt.h"
+#include "base64.h"
 #include "utils/listUtils.h"
 #include "utils/logger.h"
 #include "utils/memory.h"
@@ -38,11 +39,13 @@ struct cryptParameter newCryptParameters() {
  * @brief encrypts a given text with the given password.
  * @param text the nullterminated text
  * @param password the nullterminated password, used for encryption
+ * @param cryptParams the parameters to be used for the key derivation
  * @return a pointer to an encryptionInfo struct; Has to be freed after usage.
  * usage using @c secFreeEncryptionInfo
  */
-struct encryptionInfo* _crypt_encrypt(const unsigned char* text,
-                                      const char*          password) {
+struct encryptionInfo* _crypt_encrypt(const unsigned char*  text,
+                                      const char*           password,
+                                      struct cryptParameter cryptParams) {
   if (text == NULL || password == NULL) {
     oidc_setArgNullFuncError(__func__);
     return NULL;
@@ -52,8 +55,7 @@ struct encryptionInfo* _crypt_encrypt(const unsigned char* text,
       secAlloc(sodium_base64_ENCODED_LEN(SODIUM_SALT_LEN,
                                          sodium_base64_VARIANT_ORIGINAL) +
                1);
-  struct cryptParameter cryptParams = newCryptParameters();
-  struct key_set        keys =
+  struct key_set keys =
       crypt_keyDerivation_base64(password, salt_base64, 1, &cryptParams);
   if (keys.encryption_key == NULL) {
     secFree(salt_base64);
@@ -115,8 +117,30 @@ struct encryptionInfo* crypt_encryptWithKey(const unsigned char* text,
  * @note before version 2.1.0 this function used hex encoding
  */
 char* crypt_encrypt(const char* text, const char* password) {
-  struct encryptionInfo* cry = _crypt_encrypt((unsigned char*)text, password);
+  return crypt_encryptWithParameters(text, password, newCryptParameters());
+}
+
+/**
+ * @brief encrypts a given text with the given password using the given key
+ * derivation parameters
+ * @param text the nullterminated text
+ * @param password the nullterminated password, used for encryption
+ * @param cryptParams the crypt parameters; only the key derivation parameters
+ * (@c hash_ops_limit, @c hash_mem_limit, @c hash_alg) may differ from
+ * @c newCryptParameters
+ * @return a string in the same format as returned by @c crypt_encrypt
+ */
+char* crypt_encryptWithParameters(const char* text, const char* password,
+                                  struct cryptParameter cryptParams) {
+  if (!crypt_kdfParametersValid(&cryptParams)) {
+    oidc_errno = OIDC_ECRYPM;
+    return NULL;
+  }
+  enum memorySubsystem   previous = memory_enterSubsystem(MEMORY_CRYPT);
+  struct encryptionInfo* cry =
+      _crypt_encrypt((unsigned char*)text, password, cryptParams);
   if (cry == NULL || cry->encrypted_base64 == NULL) {
+    memory_leaveSubsystem(previous);
     return NULL;
   }
   // Current config file format:
@@ -137,6 +161,7 @@ char* crypt_encrypt(const char* text, const char* password) {
       cry->cryptParameter.hash_mem_limit, cry->cryptParameter.hash_alg,
       cry->encrypted_base64, cry->hash_key_base64);
   secFreeEncryptionInfo(cry);
+  memory_leaveSubsystem(previous);
   return ret;
 }
 
@@ -238,6 +263,7 @@ char* crypt_decryptFromList(list_t* lines, const char* password) {
     return NULL;
   }
   logger(DEBUG, "Decrypt using base64 encoding");
+  enum memorySubsystem   previous   = memory_enterSubsystem(MEMORY_CRYPT);
   struct encryptionInfo* crypt      = secAlloc(sizeof(struct encryptionInfo));
   size_t                 cipher_len = 0;
   sscanf(list_at(lines, 0)->val, "%lu", &cipher_len);
@@ -255,6 +281,7 @@ char* crypt_decryptFromList(list_t* lines, const char* password) {
          &crypt->cryptParameter.hash_alg);
   char* ret = (char*)crypt_decrypt_base64(crypt, cipher_len, password);
   secFreeEncryptionInfo(crypt);
+  memory_leaveSubsystem(previous);
   return ret;
 }
 
@@ -306,7 +333,7 @@ char* toBase64WithVariant(const char* bin, size_t len, int variant) {
     oidc_errno = OIDC_EALLOC;
     return NULL;
   }
-  sodium_bin2base64(base64, base64len, (const unsigned char*)bin, len, variant);
+  base64_encode(base64, (const unsigned char*)bin, len, variant);
   return base64;
 }
 
@@ -343,6 +370,19 @@ char* toBase64UrlSafe(const char* bin, size_t len) {
                              sodium_base64_VARIANT_URLSAFE_NO_PADDING);
 }
 
+/**
+ * @brief decodes the nullterminated base64 encoded string @p base64; it must
+ * not be longer than the encoding of @p bin_len bytes
+ */
+static int _fromBase64WithVariant(const char* base64, size_t bin_len,
+                                  unsigned char* bin, int variant) {
+  // one character more than the encoding, so that longer strings are rejected
+  const size_t max_len = sodium_base64_ENCODED_LEN(bin_len, variant);
+  const char*  end     = memchr(base64, '\0', max_len);
+  const size_t len     = end ? (size_t)(end - base64) : max_len;
+  return base64_decode(bin, bin_len, base64, len, NULL, variant);
+}
+
 /**
  * @brief decodes a base64 encoded string an places it in bin
  * @param base64 the nullterminated base64 encoded string
@@ -355,10 +395,8 @@ int fromBase64(const char* base64, size_t bin_len, unsigned char* bin) {
     oidc_setArgNullFuncError(__func__);
     return oidc_errno;
   }
-  return sodium_base642bin(
-      bin, bin_len, base64,
-      sodium_base64_ENCODED_LEN(bin_len, sodium_base64_VARIANT_ORIGINAL), NULL,
-      NULL, NULL, sodium_base64_VARIANT_ORIGINAL);
+  return _fromBase64WithVariant(base64, bin_len, bin,
+                                sodium_base64_VARIANT_ORIGINAL);
 }
 
 /**
@@ -373,11 +411,8 @@ int fromBase64UrlSafe(const char* base64, size_t bin_len, unsigned char* bin) {
     oidc_setArgNullFuncError(__func__);
     return oidc_errno;
   }
-  return sodium_base642bin(
-      bin, bin_len, base64,
-      sodium_base64_ENCODED_LEN(bin_len,
-                                sodium_base64_VARIANT_URLSAFE_NO_PADDING),
-      NULL, NULL, NULL, sodium_base64_VARIANT_URLSAFE_NO_PADDING);
+  return _fromBase64WithVariant(base64, bin_len, bin,
+                                sodium_base64_VARIANT_URLSAFE_NO_PADDING);
 }
 
 /**
@@ -420,6 +455,32 @@ char* s256(const char* str) {
   return s;
 }
 
+/**
+ * @brief checks if the key derivation parameters of @p cryptParams can be
+ * used
+ * The parameters are read from encrypted files, so they are bounded to keep a
+ * corrupted file from requesting an unreasonable amount of memory.
+ * @return @c 1 if the parameters are valid, @c 0 if not
+ */
+int crypt_kdfParametersValid(const struct cryptParameter* cryptParams) {
+  if (cryptParams == NULL) {
+    return 0;
+  }
+  if (cryptParams->hash_alg != crypto_pwhash_ALG_ARGON2ID13 &&
+      cryptParams->hash_alg != crypto_pwhash_ALG_ARGON2I13) {
+    return 0;
+  }
+  unsigned long long ops_min =
+      cryptParams->hash_alg == crypto_pwhash_ALG_ARGON2I13
+          ? crypto_pwhash_argon2i_OPSLIMIT_MIN
+          : crypto_pwhash_argon2id_OPSLIMIT_MIN;
+  return cryptParams->hash_ops_limit >= 0 &&
+         (unsigned long long)cryptParams->hash_ops_limit >= ops_min &&
+         cryptParams->hash_ops_limit <= KDF_MAX_OPSLIMIT &&
+         cryptParams->hash_mem_limit >= KDF_MIN_MEMLIMIT &&
+         cryptParams->hash_mem_limit <= KDF_MAX_MEMLIMIT;
+}
+
 /**
  * @brief derivates two keys from the given password
  * @param password the password to be used for key derivation
@@ -446,19 +507,19 @@ struct key_set crypt_keyDerivation_base64(const char* password,
   if (generateNewSalt) {
     /* Choose a random salt */
     randombytes_buf(salt, cryptParams->salt_len);
-    sodium_bin2base64(
-        salt_base64,
-        sodium_base64_ENCODED_LEN(cryptParams->salt_len,
-                                  sodium_base64_VARIANT_ORIGINAL) +
-            1,
-        salt, cryptParams->salt_len, sodium_base64_VARIANT_ORIGINAL);
+    base64_encode(salt_base64, salt, cryptParams->salt_len,
+                  sodium_base64_VARIANT_ORIGINAL);
   } else {
     fromBase64(salt_base64, cryptParams->salt_len, salt);
   }
+  if (!crypt_kdfParametersValid(cryptParams)) {
+    secFree(key);
+    oidc_errno = OIDC_ECRYPM;
+    return (struct key_set){NULL, NULL};
+  }
   if (crypto_pwhash((unsigned char*)key, 2 * cryptParams->key_len, password,
-                    strlen(password), salt, crypto_pwhash_OPSLIMIT_INTERACTIVE,
-                    crypto_pwhash_MEMLIMIT_INTERACTIVE,
-                    crypto_pwhash_ALG_DEFAULT) != 0) {
+                    strlen(password), salt, cryptParams->hash_ops_limit,
+                    cryptParams->hash_mem_limit, cryptParams->hash_alg) != 0) {
     secFree(key);
     logger(ALERT,
            "Could not derivate key. Probably because system out of memory.\n");
@@ -486,10 +547,8 @@ void randomFillBase64UrlSafe(char buffer[], size_t buffer_size) {
   randombytes_buf(bin, buffer_size);
   char base64[sodium_base64_ENCODED_LEN(
       buffer_size, sodium_base64_VARIANT_URLSAFE_NO_PADDING)];
-  sodium_bin2base64(base64,
-                    sodium_base64_ENCODED_LEN(
-                        buffer_size, sodium_base64_VARIANT_URLSAFE_NO_PADDING),
-                    bin, buffer_size, sodium_base64_VARIANT_URLSAFE_NO_PADDING);
+  base64_encode(base64, bin, buffer_size,
+                sodium_base64_VARIANT_URLSAFE_NO_PADDING);
   strncpy(buffer, base64, buffer_size);
   sodium_memzero(base64,
                  sodium_base64_ENCODED_LEN(
@@ -6,6 +6,9 @@
 
 void                   initCrypt();
 char*                  crypt_encrypt(const char* text, const char* password);
+char* crypt_encryptWithParameters(const char* text, const char* password,
+                                  struct cryptParameter cryptParams);
+int   crypt_kdfParametersValid(const struct cryptParameter* cryptParams);
 struct encryptionInfo* crypt_encryptWithKey(const unsigned char* text,
                                             const unsigned char* key);
 char*          crypt_decrypt(const char* crypt_str, const char* password);
@@ -23,6 +26,7 @@ char*          toBase64UrlSafe(const char* bin, size_t len);
 int   fromBase64(const char* base64, size_t bin_len, unsigned char* bin);
 int   fromBase64UrlSafe(const char* base64, size_t bin_len, unsigned char* bin);
 void  randomFillBase64UrlSafe(char buffer[], size_t buffer_size);
+char* sha256(const char* str);
 char* s256(const char* str);
 struct cryptParameter newCryptParameters();
 
@@ -5,6 +5,14 @@
 
 #include <stddef.h>
 
+/**
+ * bounds for the key derivation parameters; parameters outside of these are
+ * neither used for new encryptions nor accepted from encrypted files
+ */
+#define KDF_MIN_MEMLIMIT 8388608     // 8 MiB
+#define KDF_MAX_MEMLIMIT 1073741824  // 1 GiB
+#define KDF_MAX_OPSLIMIT 32
+
 struct key_set {
   char* encryption_key;
   char* hash_key;
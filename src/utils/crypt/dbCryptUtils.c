@@ -11,16 +11,18 @@
 /**
  * @brief encrypts sensitive information when the agent is locked.
  * encrypts all loaded access_token, additional encryption (on top of already in
- * place xor) for refresh_token, client_id, client_secret
+ * place xor) for refresh_token, client_id, client_secret; cached userinfo and
+ * exchanged tokens are dropped
  * @param loaded the list of currently loaded accounts
  * @param password the lock password that will be used for encryption
  * @return an oidc_error code
  */
 oidc_error_t lockEncrypt(const char* password) {
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(accountDB_getList(), LIST_HEAD);
-  while ((node = list_iterator_next(it))) {
-    struct oidc_account* acc = node->val;
+  const vector_t* accounts = accountDB_getList();
+  vector_foreach(accounts, i) {
+    struct oidc_account* acc = vector_at(accounts, i);
+    account_setUserinfo(acc, NULL, 0);
+    account_setExchangedTokens(acc, NULL);
     char* tmp = encryptText(account_getAccessToken(acc), password);
     if (tmp == NULL) {
       return oidc_errno;
@@ -44,7 +46,6 @@ oidc_error_t lockEncrypt(const char* password) {
       account_setClientSecret(acc, tmp);
     }
   }
-  list_iterator_destroy(it);
   return OIDC_SUCCESS;
 }
 
@@ -57,10 +58,9 @@ oidc_error_t lockEncrypt(const char* password) {
  * @return an oidc_error code
  */
 oidc_error_t lockDecrypt(const char* password) {
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(accountDB_getList(), LIST_HEAD);
-  while ((node = list_iterator_next(it))) {
-    struct oidc_account* acc = node->val;
+  const vector_t* accounts = accountDB_getList();
+  vector_foreach(accounts, i) {
+    struct oidc_account* acc = vector_at(accounts, i);
     char* tmp = crypt_decrypt(account_getAccessToken(acc), password);
     if (tmp == NULL) {
       return oidc_errno;
@@ -82,7 +82,6 @@ oidc_error_t lockDecrypt(const char* password) {
     }
     account_setClientSecret(acc, tmp);
   }
-  list_iterator_destroy(it);
   return OIDC_SUCCESS;
 }
 
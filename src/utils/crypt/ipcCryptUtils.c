@@ -5,6 +5,9 @@
 #include "utils/oidc_error.h"
 #include "utils/stringUtils.h"
 
+#include <ctype.h>
+#include <sodium.h>
+#include <stdint.h>
 #include <string.h>
 
 char* encryptForIpc(const char* msg, const unsigned char* key) {
@@ -45,3 +48,208 @@ char* decryptForIpc(const char* msg, const unsigned char* key) {
   secFree(msg_tmp);
   return (char*)decryptedMsg;
 }
+
+#define IPC_CRYPT_MAX_LEN_DIGITS 20
+#define IPC_CRYPT_BINARY_LEN_OFFSET 3
+#define IPC_CRYPT_BINARY_NONCE_OFFSET 7
+
+static void _writeUint32(unsigned char* out, uint32_t v) {
+  out[0] = (v >> 24) & 0xFF;
+  out[1] = (v >> 16) & 0xFF;
+  out[2] = (v >> 8) & 0xFF;
+  out[3] = v & 0xFF;
+}
+
+static uint32_t _readUint32(const unsigned char* in) {
+  return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) |
+         ((uint32_t)in[2] << 8) | (uint32_t)in[3];
+}
+
+static int _hasBinaryHeader(const char* buf, size_t len, unsigned char type) {
+  const unsigned char* b = (const unsigned char*)buf;
+  return buf != NULL && len >= 3 && b[0] == IPC_CRYPT_BINARY_MAGIC &&
+         b[1] == IPC_CRYPT_BINARY_VERSION && b[2] == type;
+}
+
+/**
+ * @brief checks if @p buf starts with a binary ipc envelope; the text envelope,
+ * base64 public keys and plain json never start with the binary magic
+ */
+int ipcCryptIsBinary(const char* buf, size_t len) {
+  return buf != NULL && len > 0 &&
+         (unsigned char)buf[0] == IPC_CRYPT_BINARY_MAGIC;
+}
+
+/**
+ * @brief returns the length of the binary envelope for a plaintext of
+ * @p msg_len bytes
+ */
+size_t ipcCryptBinaryLength(size_t msg_len) {
+  return IPC_CRYPT_BINARY_HEADER_LEN + crypto_secretbox_MACBYTES + msg_len;
+}
+
+/**
+ * @brief encrypts a message into a binary ipc envelope; the ciphertext is
+ * written directly into the returned buffer, which can be sent as is
+ * @param out_len is set to the length of the returned buffer
+ * @return the binary envelope or @c NULL on failure. Has to be freed after
+ * usage.
+ */
+unsigned char* ipcCryptSealBinary(const char* msg, size_t msg_len,
+                                  const unsigned char* key, size_t* out_len) {
+  if (msg == NULL || key == NULL || out_len == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  if (msg_len > UINT32_MAX) {
+    oidc_errno = OIDC_EMSGSIZE;
+    return NULL;
+  }
+  const size_t   len   = ipcCryptBinaryLength(msg_len);
+  unsigned char* out   = secAlloc(len);
+  unsigned char* nonce = out + IPC_CRYPT_BINARY_NONCE_OFFSET;
+  out[0]               = IPC_CRYPT_BINARY_MAGIC;
+  out[1]               = IPC_CRYPT_BINARY_VERSION;
+  out[2]               = IPC_CRYPT_BINARY_TYPE_MESSAGE;
+  _writeUint32(out + IPC_CRYPT_BINARY_LEN_OFFSET, msg_len);
+  randombytes_buf(nonce, crypto_secretbox_NONCEBYTES);
+  if (crypto_secretbox_easy(out + IPC_CRYPT_BINARY_HEADER_LEN,
+                            (const unsigned char*)msg, msg_len, nonce,
+                            key) != 0) {
+    secFree(out);
+    oidc_errno = OIDC_EENCRYPT;
+    return NULL;
+  }
+  *out_len = len;
+  return out;
+}
+
+/**
+ * @brief decrypts a binary ipc envelope
+ * @param buf the received data
+ * @param len the number of bytes in @p buf; must be exactly one envelope
+ * @return the nullterminated plaintext or @c NULL on failure. Has to be freed
+ * after usage.
+ */
+char* ipcCryptOpenBinary(const char* buf, size_t len,
+                         const unsigned char* key) {
+  if (buf == NULL || key == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  if (!_hasBinaryHeader(buf, len, IPC_CRYPT_BINARY_TYPE_MESSAGE) ||
+      len < IPC_CRYPT_BINARY_HEADER_LEN) {
+    oidc_errno = OIDC_ECRYPMIPC;
+    return NULL;
+  }
+  const unsigned char* b       = (const unsigned char*)buf;
+  const size_t         msg_len = _readUint32(b + IPC_CRYPT_BINARY_LEN_OFFSET);
+  if (len != ipcCryptBinaryLength(msg_len)) {
+    oidc_errno = OIDC_ECRYPMIPC;
+    return NULL;
+  }
+  char* msg = secAlloc(msg_len + 1);
+  if (crypto_secretbox_open_easy((unsigned char*)msg,
+                                 b + IPC_CRYPT_BINARY_HEADER_LEN,
+                                 msg_len + crypto_secretbox_MACBYTES,
+                                 b + IPC_CRYPT_BINARY_NONCE_OFFSET,
+                                 key) != 0) {
+    secFree(msg);
+    oidc_errno = OIDC_EDECRYPT;
+    return NULL;
+  }
+  return msg;
+}
+
+/**
+ * @brief writes a binary hello with the given public key
+ * @param out a buffer of at least @c IPC_CRYPT_BINARY_HELLO_LEN bytes
+ */
+void ipcCryptWriteHello(unsigned char* out, const unsigned char* public_key) {
+  out[0] = IPC_CRYPT_BINARY_MAGIC;
+  out[1] = IPC_CRYPT_BINARY_VERSION;
+  out[2] = IPC_CRYPT_BINARY_TYPE_HELLO;
+  memcpy(out + 3, public_key, crypto_kx_PUBLICKEYBYTES);
+}
+
+/**
+ * @brief returns the public key of a binary hello
+ * @return a pointer into @p buf or @c NULL if @p buf is not a binary hello
+ */
+const unsigned char* ipcCryptHelloPublicKey(const char* buf, size_t len) {
+  if (len != IPC_CRYPT_BINARY_HELLO_LEN ||
+      !_hasBinaryHeader(buf, len, IPC_CRYPT_BINARY_TYPE_HELLO)) {
+    return NULL;
+  }
+  return (const unsigned char*)buf + 3;
+}
+
+/**
+ * @brief determines the length of an encrypted ipc message as produced by
+ * @c encryptForIpc or @c ipcCryptSealBinary
+ * @param buf the data received so far; does not have to be nullterminated
+ * @param len the number of bytes in @p buf
+ * @param max_msg_len the maximum accepted length of the plain message
+ * @return the length of the complete encrypted message, @c 0 if @p buf does
+ * not yet hold the complete message, or @c -1 if @p buf is not the start of an
+ * encrypted ipc message or the message is too long
+ */
+ssize_t ipcCryptMessageLength(const char* buf, size_t len,
+                              size_t max_msg_len) {
+  if (buf == NULL) {
+    return -1;
+  }
+  if (ipcCryptIsBinary(buf, len)) {
+    if (len < IPC_CRYPT_BINARY_HEADER_LEN) {
+      return len < 3 || _hasBinaryHeader(buf, len,
+                                         IPC_CRYPT_BINARY_TYPE_MESSAGE)
+                 ? 0
+                 : -1;
+    }
+    if (!_hasBinaryHeader(buf, len, IPC_CRYPT_BINARY_TYPE_MESSAGE)) {
+      return -1;
+    }
+    const size_t msg_len = _readUint32((const unsigned char*)buf +
+                                         IPC_CRYPT_BINARY_LEN_OFFSET);
+    if (msg_len > max_msg_len) {
+      return -1;
+    }
+    const size_t total = ipcCryptBinaryLength(msg_len);
+    return len >= total ? (ssize_t)total : 0;
+  }
+  size_t digits = 0;
+  while (digits < len && isdigit(buf[digits])) {
+    digits++;
+  }
+  if (digits > IPC_CRYPT_MAX_LEN_DIGITS) {
+    return -1;
+  }
+  if (digits == len) {
+    return 0;
+  }
+  if (digits == 0 || buf[digits] != ':') {
+    return -1;
+  }
+  char len_str[IPC_CRYPT_MAX_LEN_DIGITS + 1];
+  memcpy(len_str, buf, digits);
+  len_str[digits] = '\0';
+  size_t msg_len  = strToULong(len_str);
+  if (msg_len > max_msg_len) {
+    return -1;
+  }
+  struct cryptParameter params = newCryptParameters();
+  size_t                nonce_end =
+      digits + 1 +
+      sodium_base64_ENCODED_LEN(params.nonce_len, params.base64_variant) - 1;
+  if (len <= nonce_end) {
+    return 0;
+  }
+  if (buf[nonce_end] != ':') {
+    return -1;
+  }
+  size_t total = nonce_end + 1 +
+                 sodium_base64_ENCODED_LEN(msg_len + params.mac_len,
+                                           params.base64_variant) -
+                 1;
+  return len >= total ? (ssize_t)total : 0;
+}
@@ -1,7 +1,36 @@
 #ifndef IPC_CRYPT_UTILS_H
 #define IPC_CRYPT_UTILS_H
 
-char* decryptForIpc(const char*, const unsigned char*);
-char* encryptForIpc(const char*, const unsigned char*);
+#include "utils/oidc_error.h"
+
+#include <sodium.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * Binary ipc envelope. Every binary message starts with a three byte header:
+ * magic, version, type. A hello carries the raw public key of the key
+ * exchange; a message carries the length of the plaintext (4 bytes, big
+ * endian), the nonce and the ciphertext including the MAC.
+ */
+#define IPC_CRYPT_BINARY_MAGIC 0xB1
+#define IPC_CRYPT_BINARY_VERSION 1
+#define IPC_CRYPT_BINARY_TYPE_HELLO 1
+#define IPC_CRYPT_BINARY_TYPE_MESSAGE 2
+#define IPC_CRYPT_BINARY_HELLO_LEN (3 + crypto_kx_PUBLICKEYBYTES)
+#define IPC_CRYPT_BINARY_HEADER_LEN (3 + 4 + crypto_secretbox_NONCEBYTES)
+
+char*   decryptForIpc(const char*, const unsigned char*);
+char*   encryptForIpc(const char*, const unsigned char*);
+ssize_t ipcCryptMessageLength(const char* buf, size_t len, size_t max_msg_len);
+
+int            ipcCryptIsBinary(const char* buf, size_t len);
+size_t         ipcCryptBinaryLength(size_t msg_len);
+unsigned char* ipcCryptSealBinary(const char* msg, size_t msg_len,
+                                  const unsigned char* key, size_t* out_len);
+char* ipcCryptOpenBinary(const char* buf, size_t len, const unsigned char* key);
+void  ipcCryptWriteHello(unsigned char*       out,
+                         const unsigned char* public_key);
+const unsigned char* ipcCryptHelloPublicKey(const char* buf, size_t len);
 
 #endif  // IPC_CRYPT_UTILS_H
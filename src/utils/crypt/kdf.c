@@ -0,0 +1,207 @@
+#define _XOPEN_SOURCE 700
+#include "kdf.h"
+#include "crypt.h"
+#include "defines/settings.h"
+#include "utils/file_io/oidc_file_io.h"
+#include "utils/json.h"
+#include "utils/listUtils.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <sodium.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define KDF_CALIBRATION_OPSLIMIT 2
+#define KDF_CALIBRATION_MEMLIMIT (4 * KDF_MIN_MEMLIMIT)
+#define KDF_MEMLIMIT_GRANULARITY 1048576  // 1 MiB
+
+/**
+ * @brief measures a single key derivation with the given parameters
+ * @return the elapsed time in milliseconds or @c 0 if the derivation failed
+ */
+static double _measure(unsigned long long ops_limit, size_t mem_limit) {
+  unsigned char   out[crypto_secretbox_KEYBYTES];
+  unsigned char   salt[crypto_pwhash_SALTBYTES];
+  const char      password[] = "oidc-agent kdf calibration";
+  struct timespec start, end;
+  randombytes_buf(salt, sizeof(salt));
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int rc = crypto_pwhash(out, sizeof(out), password, strlen(password), salt,
+                         ops_limit, mem_limit, crypto_pwhash_ALG_ARGON2ID13);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  sodium_memzero(out, sizeof(out));
+  if (rc != 0) {
+    return 0;
+  }
+  double ms = (end.tv_sec - start.tv_sec) * 1e3 +
+              (end.tv_nsec - start.tv_nsec) / 1e6;
+  return ms > 0 ? ms : 0.001;
+}
+
+static size_t _maxMemLimit() {
+  size_t max   = KDF_MAX_MEMLIMIT;
+  long   pages = sysconf(_SC_PHYS_PAGES);
+  long   psize = sysconf(_SC_PAGESIZE);
+  if (pages > 0 && psize > 0) {
+    size_t share = (size_t)pages / KDF_MAX_MEMORY_SHARE * (size_t)psize;
+    if (share < max) {
+      max = share;
+    }
+  }
+  return max < KDF_MIN_MEMLIMIT ? KDF_MIN_MEMLIMIT : max;
+}
+
+/**
+ * @brief measures the key derivation on this host and chooses argon2id
+ * parameters that take about @p target_ms to derive a key
+ * Memory is raised first, because it is what makes attacks expensive; the
+ * number of passes is only raised once the memory limit is reached, and only
+ * lowered below the libsodium default if even the minimum memory is too slow.
+ * @param target_ms the wanted unlock latency in milliseconds
+ * @return the chosen parameters together with the measured time; if the key
+ * derivation fails the returned @c measured_ms is @c 0
+ */
+struct kdfCalibration kdf_calibrate(unsigned long target_ms) {
+  struct kdfCalibration c = {.params    = newCryptParameters(),
+                             .target_ms = target_ms};
+  c.params.hash_alg       = crypto_pwhash_ALG_ARGON2ID13;
+
+  double base = _measure(KDF_CALIBRATION_OPSLIMIT, KDF_CALIBRATION_MEMLIMIT);
+  if (base == 0) {
+    oidc_errno = OIDC_EMEM;
+    return c;
+  }
+  // argon2 scales linearly with passes * memory
+  double ms_per_unit =
+      base / (KDF_CALIBRATION_OPSLIMIT * (double)KDF_CALIBRATION_MEMLIMIT);
+  double units   = target_ms / ms_per_unit;
+  size_t max_mem = _maxMemLimit();
+
+  unsigned long long ops = KDF_CALIBRATION_OPSLIMIT;
+  double             mem = units / ops;
+  if (mem > max_mem) {
+    mem = max_mem;
+    ops = (unsigned long long)(units / mem);
+    if (ops > KDF_MAX_OPSLIMIT) {
+      ops = KDF_MAX_OPSLIMIT;
+    }
+  } else if (mem < KDF_MIN_MEMLIMIT) {
+    mem = KDF_MIN_MEMLIMIT;
+    ops = crypto_pwhash_argon2id_OPSLIMIT_MIN;
+  }
+  size_t mem_limit =
+      (size_t)mem / KDF_MEMLIMIT_GRANULARITY * KDF_MEMLIMIT_GRANULARITY;
+  if (mem_limit < KDF_MIN_MEMLIMIT) {
+    mem_limit = KDF_MIN_MEMLIMIT;
+  }
+  c.measured_ms           = (unsigned long)(_measure(ops, mem_limit) + 0.5);
+  c.params.hash_ops_limit = (int)ops;
+  c.params.hash_mem_limit = (int)mem_limit;
+  logger(DEBUG, "kdf calibration: %.1f ms base, chose %llu passes over %lu "
+                "bytes (%lu ms)",
+         base, ops, mem_limit, c.measured_ms);
+  return c;
+}
+
+static int _parametersLoaded = 0;
+static struct cryptParameter _defaultParameters;
+
+/**
+ * @brief returns the crypt parameters used to encrypt files
+ * The key derivation parameters chosen with @c kdf_calibrate are read from
+ * the oidc dir once; if there are none, the libsodium defaults are used.
+ * @return a cryptParameter struct
+ */
+struct cryptParameter kdf_getDefaultParameters() {
+  if (_parametersLoaded) {
+    return _defaultParameters;
+  }
+  _parametersLoaded  = 1;
+  _defaultParameters = newCryptParameters();
+  char* content      = readOidcFile(KDF_CONFIG_FILENAME);
+  if (content == NULL) {
+    return _defaultParameters;
+  }
+  INIT_KEY_VALUE("ops_limit", "mem_limit", "alg");
+  if (CALL_GETJSONVALUES(content) < 0) {
+    logger(ERROR, "Could not parse '%s'", KDF_CONFIG_FILENAME);
+    secFree(content);
+    SEC_FREE_KEY_VALUES();
+    return _defaultParameters;
+  }
+  secFree(content);
+  KEY_VALUE_VARS(ops_limit, mem_limit, alg);
+  struct cryptParameter params = _defaultParameters;
+  params.hash_ops_limit        = _ops_limit ? strToInt(_ops_limit) : -1;
+  params.hash_mem_limit        = _mem_limit ? strToInt(_mem_limit) : -1;
+  params.hash_alg              = _alg ? strToInt(_alg) : -1;
+  SEC_FREE_KEY_VALUES();
+  if (!crypt_kdfParametersValid(&params)) {
+    logger(ERROR, "Ignoring invalid key derivation parameters in '%s'",
+           KDF_CONFIG_FILENAME);
+    return _defaultParameters;
+  }
+  _defaultParameters = params;
+  return _defaultParameters;
+}
+
+/**
+ * @brief stores the calibrated key derivation parameters in the oidc dir, so
+ * they are used for all files encrypted afterwards
+ */
+oidc_error_t kdf_saveDefaultParameters(
+    const struct kdfCalibration* calibration) {
+  if (calibration == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+  if (!crypt_kdfParametersValid(&calibration->params)) {
+    oidc_errno = OIDC_ECRYPM;
+    return oidc_errno;
+  }
+  char* content = oidc_sprintf(
+      "{\"ops_limit\":%d,\"mem_limit\":%d,\"alg\":%d,\"target_ms\":%lu,"
+      "\"measured_ms\":%lu}",
+      calibration->params.hash_ops_limit, calibration->params.hash_mem_limit,
+      calibration->params.hash_alg, calibration->target_ms,
+      calibration->measured_ms);
+  oidc_error_t e = writeOidcFile(KDF_CONFIG_FILENAME, content);
+  secFree(content);
+  if (e == OIDC_SUCCESS) {
+    _defaultParameters = calibration->params;
+    _parametersLoaded  = 1;
+  }
+  return e;
+}
+
+/**
+ * @brief checks if an encrypted file was encrypted with the current default
+ * key derivation parameters
+ * @param fileContent the content of a file as written by
+ * @c encryptWithVersionLine
+ * @return @c 1 if the file uses the default parameters, @c 0 if it should be
+ * reencrypted
+ */
+int kdf_usesDefaultParameters(const char* fileContent) {
+  list_t* lines = delimitedStringToList(fileContent, '\n');
+  if (lines == NULL) {
+    return 0;
+  }
+  if (lines->len < 6) {  // hex encoded file format
+    secFreeList(lines);
+    return 0;
+  }
+  struct cryptParameter p;
+  int n = sscanf(list_at(lines, 3)->val, "%lu:%lu:%lu:%lu:%d:%d:%d:%d",
+                 &p.nonce_len, &p.salt_len, &p.mac_len, &p.key_len,
+                 &p.base64_variant, &p.hash_ops_limit, &p.hash_mem_limit,
+                 &p.hash_alg);
+  secFreeList(lines);
+  struct cryptParameter d = kdf_getDefaultParameters();
+  return n == 8 && p.hash_ops_limit == d.hash_ops_limit &&
+         p.hash_mem_limit == d.hash_mem_limit && p.hash_alg == d.hash_alg;
+}
@@ -0,0 +1,31 @@
+#ifndef OIDC_KDF_H
+#define OIDC_KDF_H
+
+#include "cryptdef.h"
+#include "utils/oidc_error.h"
+
+/**
+ * the unlock latency in milliseconds the key derivation is calibrated for, if
+ * none is given
+ */
+#define KDF_DEFAULT_TARGET_MS 500
+#define KDF_DEFAULT_TARGET_MS_STR "500"
+/**
+ * the key derivation is calibrated to use at most 1/KDF_MAX_MEMORY_SHARE of the
+ * physical memory
+ */
+#define KDF_MAX_MEMORY_SHARE 16
+
+struct kdfCalibration {
+  struct cryptParameter params;
+  unsigned long         target_ms;
+  unsigned long         measured_ms;
+};
+
+struct kdfCalibration kdf_calibrate(unsigned long target_ms);
+struct cryptParameter kdf_getDefaultParameters();
+oidc_error_t          kdf_saveDefaultParameters(
+             const struct kdfCalibration* calibration);
+int kdf_usesDefaultParameters(const char* fileContent);
+
+#endif  // OIDC_KDF_H
@@ -29,17 +29,7 @@ char* xorCrypt(const char* string, uint64_t key, size_t len) {
   return s;
 }
 
-/**
- * @brief decryptes the memory encrypted cipher
- * @param cipher the cipher to be decrypted; has to be returned by a previous
- * call to @c memoryEncrypt
- * @return a pointer to the decrypted string. It has to be freed after usage.
- */
-char* memoryDecrypt(const char* cipher) {
-  if (!strValid(cipher)) {
-    // oidc_setArgNullFuncError(__func__);
-    return NULL;
-  }
+static char* _memoryDecrypt(const char* cipher) {
   // logger(DEBUG, "memory decryption '%s'", cipher);
   char*  tmp           = oidc_strcopy(cipher);
   size_t len           = strToInt(strtok(tmp, ":"));
@@ -57,6 +47,23 @@ char* memoryDecrypt(const char* cipher) {
   return decrypted;
 }
 
+/**
+ * @brief decryptes the memory encrypted cipher
+ * @param cipher the cipher to be decrypted; has to be returned by a previous
+ * call to @c memoryEncrypt
+ * @return a pointer to the decrypted string. It has to be freed after usage.
+ */
+char* memoryDecrypt(const char* cipher) {
+  if (!strValid(cipher)) {
+    // oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  enum memorySubsystem previous  = memory_enterSubsystem(MEMORY_CRYPT);
+  char*                decrypted = _memoryDecrypt(cipher);
+  memory_leaveSubsystem(previous);
+  return decrypted;
+}
+
 /**
  * @brief encryptes text
  * @param text the text to be encrypted
@@ -69,25 +76,37 @@ char* memoryEncrypt(const char* text) {
     return NULL;
   }
   // logger(DEBUG, "memory encryption '%s'", text);
-  size_t len           = strlen(text);
-  char*  cipher        = xorCrypt(text, memoryPass, len);
-  char*  cipher_base64 = toBase64(cipher, len);
+  enum memorySubsystem previous      = memory_enterSubsystem(MEMORY_CRYPT);
+  size_t               len           = strlen(text);
+  char*                cipher        = xorCrypt(text, memoryPass, len);
+  char*                cipher_base64 = toBase64(cipher, len);
   secFree(cipher);
   char* fmt      = "%lu:%s";
   char* ciphered = oidc_sprintf(fmt, len, cipher_base64);
   secFree(cipher_base64);
+  memory_leaveSubsystem(previous);
   return ciphered;
 }
 
+/**
+ * @brief generates a random 64bit memory encryption passnumber
+ */
+uint64_t memoryCrypt_generatePass() {
+  uint64_t a = randombytes_random();
+  uint32_t b = randombytes_random();
+  return (a << 32) | b;
+}
+
+/**
+ * @brief sets the memory encryption passnumber used from now on; used to
+ * switch between the memory encryption of different users
+ */
+void memoryCrypt_setPass(uint64_t pass) { memoryPass = pass; }
+
 /**
  * @brief initializes memory encryption
  * generates a random 64bit memory encryption passnumber
  */
-void initMemoryCrypt() {
-  uint64_t a    = randombytes_random();
-  uint32_t b    = randombytes_random();
-  uint64_t pass = (a << 32) | b;
-  memoryPass    = pass;
-}
+void initMemoryCrypt() { memoryPass = memoryCrypt_generatePass(); }
 
 uint64_t _getMemoryPass() { return memoryPass; }
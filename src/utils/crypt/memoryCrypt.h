@@ -1,9 +1,13 @@
 #ifndef MEMORY_CRYP_H
 #define MEMORY_CRYP_H
 
+#include <stdint.h>
+
 char* memoryEncrypt(const char* str);
 char* memoryDecrypt(const char* str);
 
-void initMemoryCrypt();
+void     initMemoryCrypt();
+uint64_t memoryCrypt_generatePass();
+void     memoryCrypt_setPass(uint64_t pass);
 
 #endif
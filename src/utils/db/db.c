@@ -2,25 +2,122 @@
 #include "utils/deathUtils.h"
 #include "utils/logger.h"
 #include "utils/memory.h"
+#include "utils/vector.h"
 #include "wrapper/list.h"
 
-static list_t* dbs = NULL;
+/**
+ * All DBs belong to a scope. Normally only the default scope @c 0 is used; a
+ * multi-user agent uses one scope per user, so that the data of different
+ * users is strictly separated. The DBs of the default scope serve as template
+ * for new scopes. Shared DBs are the same in all scopes.
+ */
+struct db_scope {
+  unsigned long id;
+  list_t*       dbs;
+};
+
+static list_t*       scopes        = NULL;
+static list_t*       dbs           = NULL;  // the DBs of the current scope
+static unsigned long current_scope = 0;
 
 struct oidc_db {
-  db_name db;
-  list_t* list;
+  db_name   db;
+  vector_t* values;
 };
 
+#define DB_IS_SHARED(db) ((db) == OIDC_DB_CONNECTIONS)
+
 int matchDBs(const struct oidc_db* a, const struct oidc_db* b) {
   return a->db == b->db;
 }
 
+int matchScopes(const unsigned long* id, const struct db_scope* s) {
+  return s->id == *id;
+}
+
 void db_init() {
   if (dbs != NULL) {
     return;
   }
-  dbs        = list_new();
-  dbs->match = (matchFunction)matchDBs;
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_DB);
+  dbs                           = list_new();
+  dbs->match                    = (matchFunction)matchDBs;
+  struct db_scope* scope        = secAlloc(sizeof(struct db_scope));
+  scope->id                     = 0;
+  scope->dbs                    = dbs;
+  scopes                        = list_new();
+  scopes->match                 = (matchFunction)matchScopes;
+  list_rpush(scopes, list_node_new(scope));
+  memory_leaveSubsystem(previous);
+}
+
+static list_t* _newScopeDBs() {
+  list_t* defaults  = ((struct db_scope*)scopes->head->val)->dbs;
+  list_t* scope_dbs = list_new();
+  scope_dbs->match  = (matchFunction)matchDBs;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(defaults, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct oidc_db* t = node->val;
+    if (DB_IS_SHARED(t->db)) {
+      list_rpush(scope_dbs, list_node_new(t));
+      continue;
+    }
+    struct oidc_db* db_e = secAlloc(sizeof(struct oidc_db));
+    db_e->db             = t->db;
+    db_e->values         = vector_new();
+    db_e->values->match  = t->values->match;
+    db_e->values->free   = t->values->free;
+    list_rpush(scope_dbs, list_node_new(db_e));
+  }
+  list_iterator_destroy(it);
+  return scope_dbs;
+}
+
+/**
+ * @brief switches to the DBs of another scope; the scope is created if it does
+ * not exist yet
+ * @note all DBs have to be created in the default scope before switching
+ */
+void db_setScope(unsigned long id) {
+  db_init();
+  if (id == current_scope) {
+    return;
+  }
+  list_node_t*     node  = findInList(scopes, &id);
+  struct db_scope* scope = node ? node->val : NULL;
+  if (scope == NULL) {
+    enum memorySubsystem previous = memory_enterSubsystem(MEMORY_DB);
+    scope                         = secAlloc(sizeof(struct db_scope));
+    scope->id                     = id;
+    scope->dbs                    = _newScopeDBs();
+    list_rpush(scopes, list_node_new(scope));
+    memory_leaveSubsystem(previous);
+    logger(DEBUG, "Created db scope %lu", id);
+  }
+  dbs           = scope->dbs;
+  current_scope = id;
+}
+
+unsigned long db_getScope() { return current_scope; }
+
+/**
+ * @brief calls @p callback for every scope while that scope is the current one
+ * and switches back to the current scope afterwards
+ */
+void db_forEachScope(void (*callback)(unsigned long scope, void* arg),
+                     void* arg) {
+  db_init();
+  const unsigned long before = current_scope;
+  list_node_t*        node;
+  list_iterator_t*    it = list_iterator_new(scopes, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    const unsigned long id = ((struct db_scope*)node->val)->id;
+    db_setScope(id);
+    callback(id, arg);
+  }
+  list_iterator_destroy(it);
+  db_setScope(before);
 }
 
 list_node_t* _getDBNode(const db_name db) {
@@ -31,12 +128,12 @@ list_node_t* _getDBNode(const db_name db) {
   return findInList(dbs, &key);
 }
 
-list_t* db_getDB(const db_name db) {
+vector_t* db_getDB(const db_name db) {
   list_node_t* found = _getDBNode(db);
   if (found == NULL) {
     return NULL;
   }
-  return ((struct oidc_db*)found->val)->list;
+  return ((struct oidc_db*)found->val)->values;
 }
 
 void db_newDB(const db_name db) {
@@ -44,58 +141,61 @@ void db_newDB(const db_name db) {
   if (db_getDB(db) != NULL) {
     return;
   }
-  struct oidc_db* db_e = secAlloc(sizeof(struct oidc_db));
-  db_e->db             = db;
-  db_e->list           = list_new();
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_DB);
+  struct oidc_db*      db_e     = secAlloc(sizeof(struct oidc_db));
+  db_e->db                      = db;
+  db_e->values                  = vector_new();
   list_rpush(dbs, list_node_new(db_e));
+  memory_leaveSubsystem(previous);
 }
 
 matchFunction db_setMatchFunction(const db_name db, matchFunction match) {
   db_init();
-  list_t* db_list = db_getDB(db);
-  if (db_list == NULL) {
+  vector_t* values = db_getDB(db);
+  if (values == NULL) {
     db_newDB(db);
     return db_setMatchFunction(db, match);
   }
-  matchFunction oldMatch = db_list->match;
-  db_list->match         = match;
+  matchFunction oldMatch = values->match;
+  values->match          = match;
   return oldMatch;
 }
 
 freeFunction db_setFreeFunction(const db_name db, void (*free_fn)(void*)) {
   db_init();
-  list_t* db_list = db_getDB(db);
-  if (db_list == NULL) {
+  vector_t* values = db_getDB(db);
+  if (values == NULL) {
     db_newDB(db);
     return db_setFreeFunction(db, free_fn);
   }
-  freeFunction oldFree = db_list->free;
-  db_list->free        = free_fn;
+  freeFunction oldFree = values->free;
+  values->free         = free_fn;
   return oldFree;
 }
 
 void db_removeIfFound(const db_name db, void* value) {
-  list_removeIfFound(db_getDB(db), value);
+  vector_removeIfFound(db_getDB(db), value);
 }
 
 void db_addValue(const db_name db, void* value) {
-  list_rpush(db_getDB(db), list_node_new(value));
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_DB);
+  vector_push(db_getDB(db), value);
+  memory_leaveSubsystem(previous);
   logger(DEBUG, "Added value to db %hhu. Now there are %lu entries.", db,
          db_getSize(db));
 }
 
 size_t db_getSize(const db_name db) {
-  list_t* dbl = db_getDB(db);
-  return dbl ? dbl->len : 0;
+  vector_t* values = db_getDB(db);
+  return values ? values->len : 0;
 }
 
 void* db_findValue(const db_name db, void* key) {
-  list_node_t* node = findInList(db_getDB(db), key);
-  return node ? node->val : NULL;
+  return vector_find(db_getDB(db), key);
 }
 
-list_t* db_findAllValues(const db_name db, void* key) {
-  return findAllInList(db_getDB(db), key);
+vector_t* db_findAllValues(const db_name db, void* key) {
+  return vector_findAll(db_getDB(db), key);
 }
 
 void* db_findValueWithFunction(const db_name db, void* key,
@@ -107,18 +207,7 @@ void* db_findValueWithFunction(const db_name db, void* key,
 }
 
 void db_reset(const db_name db) {
-  list_node_t* node = _getDBNode(db);
-  if (node == NULL) {
-    return;
-  }
-  struct oidc_db* db_s   = node->val;
-  list_t*         list   = db_s->list;
-  matchFunction   match  = list->match;
-  void (*free_fn)(void*) = list->free;
-  secFreeList(list);
-  db_s->list        = list_new();
-  db_s->list->match = match;
-  db_s->list->free  = free_fn;
+  vector_clear(db_getDB(db));
 }
 
 time_t db_getMinDeath(const db_name db, time_t (*deathGetter)(void*)) {
@@ -30,9 +30,11 @@ void fileDB_new() {
 }
 
 void fileDB_addValue(const char* key, const char* data) {
-  struct file_dummy* value = secAlloc(sizeof(struct file_dummy));
-  value->filename          = oidc_strcopy(key);
-  value->data              = memoryEncrypt(data);
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_DB);
+  struct file_dummy*   value    = secAlloc(sizeof(struct file_dummy));
+  value->filename               = oidc_strcopy(key);
+  value->data                   = memoryEncrypt(data);
+  memory_leaveSubsystem(previous);
   db_addValue(OIDC_DB_FILES, value);
 }
 
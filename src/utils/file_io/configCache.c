@@ -0,0 +1,405 @@
+#define _DEFAULT_SOURCE
+#include "configCache.h"
+#include "defines/settings.h"
+#include "file_io.h"
+#include "oidc_file_io.h"
+#include "utils/listUtils.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <errno.h>
+#include <libgen.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#ifdef __APPLE__
+#define st_mtim st_mtimespec
+#endif
+
+#define CONFIG_CACHE_WATCH_MASK                                          \
+  (IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | \
+   IN_MOVED_TO | IN_ATTRIB)
+
+/**
+ * a line of a config file; the issuer is a substring of the line
+ */
+struct configCacheEntry {
+  char*                    line;
+  size_t                   issuer_off;
+  size_t                   issuer_len;
+  uint64_t                 hash;
+  struct configCacheEntry* next;  // next entry in the same bucket
+};
+
+/**
+ * a parsed config file with an index on the (normalized) issuer urls
+ * Only the first line for an issuer is indexed, as it was the only one used
+ * when the files were scanned linearly.
+ */
+struct configCache {
+  char*                     path;
+  struct configCacheEntry*  entries;  // in file order
+  size_t                    len;
+  struct configCacheEntry** buckets;
+  size_t                    bucket_count;
+  unsigned char             loaded;
+  unsigned char             stale;
+  unsigned char             exists;
+  int                       wd;  // inotify watch of the dir; 0: stat check
+  struct stat               stamp;
+};
+
+static struct configCache caches[CONFIG_CACHE_FILES];
+
+#ifdef __linux__
+static int inotify_fd = -2;  // -2: not yet initialized, -1: not available
+#endif
+
+static int _isPubClientsFile(enum configCacheFile file) {
+  return file == CONFIG_CACHE_ETC_PUBCLIENTS || file == CONFIG_CACHE_PUBCLIENTS;
+}
+
+/**
+ * @brief returns the path of a cached file; the user files are resolved in
+ * the (cached) oidc dir
+ * @return a newly allocated path or @c NULL if there is no oidc dir
+ */
+static char* _cachePath(enum configCacheFile file) {
+  switch (file) {
+    case CONFIG_CACHE_ETC_PUBCLIENTS:
+      return oidc_strcopy(ETC_PUBCLIENTS_CONFIG_FILE);
+    case CONFIG_CACHE_PUBCLIENTS: return concatToOidcDir(PUBCLIENTS_FILENAME);
+    case CONFIG_CACHE_ETC_ISSUERS: return oidc_strcopy(ETC_ISSUER_CONFIG_FILE);
+    case CONFIG_CACHE_ISSUERS: return concatToOidcDir(ISSUER_CONFIG_FILENAME);
+    default: return NULL;
+  }
+}
+
+/**
+ * @brief compIssuerUrls ignores a trailing slash, so the index does as well
+ */
+static size_t _normalizedLen(const char* issuer, size_t len) {
+  return len > 0 && issuer[len - 1] == '/' ? len - 1 : len;
+}
+
+/** FNV-1a over the normalized issuer url */
+static uint64_t _issuerHash(const char* issuer, size_t len) {
+  len        = _normalizedLen(issuer, len);
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < len; i++) {
+    h ^= (unsigned char)issuer[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static int _issuerEquals(const char* a, size_t a_len, const char* b,
+                         size_t b_len) {
+  a_len = _normalizedLen(a, a_len);
+  b_len = _normalizedLen(b, b_len);
+  return a_len == b_len && memcmp(a, b, a_len) == 0;
+}
+
+/**
+ * @brief finds the issuer of a config line
+ * pubclients.config lines have the format
+ * "client_id:client_secret@issuer@scope" and comments are skipped;
+ * issuer.config lines have the format
+ * "issuer_url [shortname|registration_uri [contact]]".
+ * @return 1 if the line has an issuer, 0 if not
+ */
+static int _findIssuer(enum configCacheFile file, const char* line, size_t len,
+                       size_t* off, size_t* iss_len) {
+  if (!_isPubClientsFile(file)) {
+    const char* space = memchr(line, ' ', len);
+    *off              = 0;
+    *iss_len          = space ? (size_t)(space - line) : len;
+    return *iss_len > 0;
+  }
+  if (isCommentLine(line, len, DEFAULT_COMMENT_CHAR)) {
+    return 0;
+  }
+  const char* at = memchr(line, '@', len);
+  if (at == NULL) {
+    return 0;
+  }
+  const char* iss     = at + 1;
+  const char* iss_end = memchr(iss, '@', line + len - iss) ?: line + len;
+  *off                = iss - line;
+  *iss_len            = iss_end - iss;
+  return *iss_len > 0;
+}
+
+static void _clearCache(struct configCache* c) {
+  for (size_t i = 0; i < c->len; i++) {
+    secFree(c->entries[i].line);
+  }
+  secFree(c->entries);
+  secFree(c->buckets);
+  c->len          = 0;
+  c->bucket_count = 0;
+  c->loaded       = 0;
+  c->exists       = 0;
+}
+
+static struct configCacheEntry* _findEntry(const struct configCache* c,
+                                           const char* issuer, size_t len,
+                                           uint64_t hash) {
+  if (c->bucket_count == 0) {
+    return NULL;
+  }
+  struct configCacheEntry* e = c->buckets[hash & (c->bucket_count - 1)];
+  for (; e != NULL; e = e->next) {
+    if (e->hash == hash &&
+        _issuerEquals(e->line + e->issuer_off, e->issuer_len, issuer, len)) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief parses the lines of @p f into the index of @p c
+ */
+static void _indexFile(struct configCache* c, enum configCacheFile file,
+                       const struct fileContent* f) {
+  size_t      lines = 1;
+  const char* p     = f->data;
+  while ((p = memchr(p, '\n', f->data + f->len - p)) != NULL) {
+    lines++;
+    p++;
+  }
+  c->bucket_count = CONFIG_CACHE_MIN_BUCKETS;
+  while (c->bucket_count < 2 * lines) {
+    c->bucket_count *= 2;
+  }
+  c->buckets = secAlloc(sizeof(struct configCacheEntry*) * c->bucket_count);
+  c->entries = secAlloc(sizeof(struct configCacheEntry) * lines);
+  const char* line;
+  size_t      len;
+  size_t      pos = 0;
+  while (fileContent_nextLine(f, &pos, &line, &len)) {
+    size_t off, iss_len;
+    if (!_findIssuer(file, line, len, &off, &iss_len)) {
+      continue;
+    }
+    uint64_t hash = _issuerHash(line + off, iss_len);
+    if (_findEntry(c, line + off, iss_len, hash) != NULL) {
+      continue;  // only the first line for an issuer was ever used
+    }
+    struct configCacheEntry* e = &c->entries[c->len++];
+    e->line                    = oidc_strncopy(line, len);
+    e->issuer_off              = off;
+    e->issuer_len              = iss_len;
+    e->hash                    = hash;
+    e->next                    = c->buckets[hash & (c->bucket_count - 1)];
+    c->buckets[hash & (c->bucket_count - 1)] = e;
+  }
+}
+
+#ifdef __linux__
+/**
+ * @brief watches the directory of @p c's file, so changes are noticed without
+ * a stat per lookup
+ * @return the watch descriptor or 0 if the file has to be checked with stat
+ */
+static int _watchDir(const struct configCache* c) {
+  if (inotify_fd == -2) {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+      logger(DEBUG, "inotify not available, config files are checked with "
+                    "stat: %m");
+      inotify_fd = -1;
+    }
+  }
+  if (inotify_fd < 0) {
+    return 0;
+  }
+  char* tmp = oidc_strcopy(c->path);
+  int   wd =
+      inotify_add_watch(inotify_fd, dirname(tmp), CONFIG_CACHE_WATCH_MASK);
+  secFree(tmp);
+  return wd < 0 ? 0 : wd;
+}
+
+/**
+ * @brief reads all pending inotify events and marks the affected caches as
+ * stale
+ */
+static void _drainEvents() {
+  if (inotify_fd < 0) {
+    return;
+  }
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t n;
+  while ((n = read(inotify_fd, buf, sizeof(buf))) > 0) {
+    for (char* p = buf; p < buf + n;) {
+      const struct inotify_event* ev = (const struct inotify_event*)p;
+      for (size_t i = 0; i < CONFIG_CACHE_FILES; i++) {
+        struct configCache* c = &caches[i];
+        if (ev->mask & IN_Q_OVERFLOW) {
+          c->stale = 1;
+          continue;
+        }
+        if (c->wd <= 0 || c->wd != ev->wd) {
+          continue;
+        }
+        if (ev->mask & IN_IGNORED) {  // dir was removed; the watch is gone
+          c->wd    = 0;
+          c->stale = 1;
+          continue;
+        }
+        const char* name = strrchr(c->path, '/');
+        if (ev->len && strequal(ev->name, name ? name + 1 : c->path)) {
+          c->stale = 1;
+        }
+      }
+      p += sizeof(struct inotify_event) + ev->len;
+    }
+  }
+}
+#else
+static int  _watchDir(const struct configCache* c __attribute__((unused))) {
+  return 0;
+}
+static void _drainEvents() {}
+#endif
+
+static int _stampChanged(const struct configCache* c) {
+  struct stat st;
+  if (stat(c->path, &st) != 0) {
+    return c->exists;
+  }
+  return !c->exists || st.st_ino != c->stamp.st_ino ||
+         st.st_dev != c->stamp.st_dev || st.st_size != c->stamp.st_size ||
+         st.st_mtim.tv_sec != c->stamp.st_mtim.tv_sec ||
+         st.st_mtim.tv_nsec != c->stamp.st_mtim.tv_nsec;
+}
+
+/**
+ * @brief returns the up to date cache for @p file, (re)loading it if the file
+ * changed since it was parsed
+ * @return the cache or @c NULL if @p file is invalid
+ */
+static const struct configCache* _getCache(enum configCacheFile file) {
+  if (file >= CONFIG_CACHE_FILES) {
+    return NULL;
+  }
+  struct configCache* c    = &caches[file];
+  char*               path = _cachePath(file);
+  if (path == NULL) {  // no oidc dir
+    _clearCache(c);
+    secFree(c->path);
+    return c;
+  }
+  _drainEvents();
+  if (c->loaded && c->path && strequal(c->path, path) && !c->stale &&
+      (c->wd > 0 || !_stampChanged(c))) {
+    secFree(path);
+    return c;
+  }
+  _clearCache(c);
+  secFree(c->path);
+  c->path  = path;
+  c->stale = 0;
+  // the watch is set up before reading, so no change can be missed
+  c->wd     = _watchDir(c);
+  c->exists = stat(c->path, &c->stamp) == 0;
+  if (c->exists) {
+    struct fileContent* f = loadFile(c->path);
+    if (f != NULL) {
+      _indexFile(c, file, f);
+      releaseFile(f);
+    }
+  }
+  c->loaded = 1;
+  logger(DEBUG, "Indexed %lu issuers of '%s'", c->len, c->path);
+  return c;
+}
+
+/**
+ * @brief returns the first line of a config file that is for @p issuer_url
+ * @param file the config file to look in
+ * @param issuer_url the issuer url; a trailing slash does not matter
+ * @return a copy of the line or @c NULL if there is none; has to be freed
+ * after usage
+ */
+char* configCache_getLine(enum configCacheFile file, const char* issuer_url) {
+  if (issuer_url == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  const struct configCache* c = _getCache(file);
+  if (c == NULL) {
+    return NULL;
+  }
+  size_t                   len = strlen(issuer_url);
+  struct configCacheEntry* e =
+      _findEntry(c, issuer_url, len, _issuerHash(issuer_url, len));
+  return e ? oidc_strcopy(e->line) : NULL;
+}
+
+int configCache_hasIssuer(enum configCacheFile file, const char* issuer_url) {
+  if (issuer_url == NULL) {
+    return 0;
+  }
+  const struct configCache* c = _getCache(file);
+  if (c == NULL) {
+    return 0;
+  }
+  size_t len = strlen(issuer_url);
+  return _findEntry(c, issuer_url, len, _issuerHash(issuer_url, len)) != NULL;
+}
+
+/**
+ * @brief returns the issuers listed in a config file in file order, without
+ * duplicates
+ * @return a list of newly allocated issuer urls; has to be freed after usage
+ */
+list_t* configCache_getIssuers(enum configCacheFile file) {
+  list_t* issuers = list_new();
+  issuers->free   = (void (*)(void*)) & _secFree;
+  issuers->match  = (matchFunction)strequal;
+  const struct configCache* c = _getCache(file);
+  for (size_t i = 0; c && i < c->len; i++) {
+    const struct configCacheEntry* e = &c->entries[i];
+    list_rpush(issuers, list_node_new(oidc_strncopy(e->line + e->issuer_off,
+                                                    e->issuer_len)));
+  }
+  return issuers;
+}
+
+int configCache_fileExists(enum configCacheFile file) {
+  const struct configCache* c = _getCache(file);
+  return c ? c->exists : 0;
+}
+
+/**
+ * @brief drops the cached content of @p file, e.g. after it was written by
+ * this process
+ */
+void configCache_invalidate(enum configCacheFile file) {
+  if (file < CONFIG_CACHE_FILES) {
+    caches[file].stale = 1;
+  }
+}
+
+void configCache_free() {
+  for (size_t i = 0; i < CONFIG_CACHE_FILES; i++) {
+    _clearCache(&caches[i]);
+    secFree(caches[i].path);
+    caches[i].wd = 0;
+  }
+#ifdef __linux__
+  if (inotify_fd >= 0) {
+    close(inotify_fd);
+  }
+  inotify_fd = -2;
+#endif
+}
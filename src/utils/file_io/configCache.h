@@ -0,0 +1,26 @@
+#ifndef OIDC_CONFIG_CACHE_H
+#define OIDC_CONFIG_CACHE_H
+
+#include "wrapper/list.h"
+
+/**
+ * the issuer keyed config files that are kept parsed in memory
+ */
+enum configCacheFile {
+  CONFIG_CACHE_ETC_PUBCLIENTS,
+  CONFIG_CACHE_PUBCLIENTS,
+  CONFIG_CACHE_ETC_ISSUERS,
+  CONFIG_CACHE_ISSUERS,
+  CONFIG_CACHE_FILES
+};
+
+#define CONFIG_CACHE_MIN_BUCKETS 16
+
+char* configCache_getLine(enum configCacheFile file, const char* issuer_url);
+int   configCache_hasIssuer(enum configCacheFile file, const char* issuer_url);
+list_t* configCache_getIssuers(enum configCacheFile file);
+int     configCache_fileExists(enum configCacheFile file);
+void    configCache_invalidate(enum configCacheFile file);
+void    configCache_free();
+
+#endif  // OIDC_CONFIG_CACHE_H
@@ -1,12 +1,18 @@
 #include "cryptFileUtils.h"
+#include "defines/agent_values.h"
 #include "utils/crypt/cryptUtils.h"
 #include "utils/file_io/file_io.h"
+#include "utils/file_io/fileUtils.h"
+#include "utils/file_io/keystore.h"
 #include "utils/file_io/oidc_file_io.h"
+#include "utils/json.h"
 #include "utils/listUtils.h"
 #include "utils/logger.h"
 #include "utils/memory.h"
 #include "wrapper/list.h"
 
+#include <string.h>
+
 /**
  * @brief encrypts and writes a given text with the given password.
  * @param text the text to be encrypted
@@ -30,6 +36,32 @@ oidc_error_t encryptAndWriteToFile(const char* text, const char* filepath,
   return OIDC_SUCCESS;
 }
 
+/**
+ * @brief encrypts an account configuration and stores it as a single record in
+ * the keystore; a file with the same name in the oidc dir is removed
+ */
+static oidc_error_t _encryptAndWriteToKeystore(const char* text,
+                                               const char* filename,
+                                               const char* password) {
+  char* toWrite = encryptWithVersionLine(text, password);
+  if (toWrite == NULL) {
+    return oidc_errno;
+  }
+  char*        issuer_url = getJSONValueFromString(text, AGENT_KEY_ISSUERURL);
+  oidc_error_t ret        = keystore_write(filename, toWrite, issuer_url);
+  secFree(issuer_url);
+  secFree(toWrite);
+  if (ret != OIDC_SUCCESS) {
+    return ret;
+  }
+  char* filepath = concatToOidcDir(filename);
+  if (fileDoesExist(filepath)) {
+    removeFile(filepath);
+  }
+  secFree(filepath);
+  return OIDC_SUCCESS;
+}
+
 oidc_error_t encryptAndWriteToOidcFile(const char* text, const char* filename,
                                        const char* password) {
   if (text == NULL || password == NULL || filename == NULL) {
@@ -37,6 +69,10 @@ oidc_error_t encryptAndWriteToOidcFile(const char* text, const char* filename,
     return oidc_errno;
   }
   logger(DEBUG, "Write to oidc file %s", filename);
+  if (keystore_isEnabled() && isAccountConfigFile(filename, NULL) &&
+      strchr(filename, '/') == NULL) {
+    return _encryptAndWriteToKeystore(text, filename, password);
+  }
   char*        filepath = concatToOidcDir(filename);
   oidc_error_t ret      = encryptAndWriteToFile(text, filepath, password);
   secFree(filepath);
@@ -56,6 +92,12 @@ char* decryptOidcFile(const char* filename, const char* password) {
     oidc_setArgNullFuncError(__func__);
     return NULL;
   }
+  char* record = keystore_read(filename);
+  if (record != NULL) {
+    char* ret = decryptFileContent(record, password);
+    secFree(record);
+    return ret;
+  }
   char* filepath = concatToOidcDir(filename);
   char* ret      = decryptFile(filepath, password);
   secFree(filepath);
@@ -1,4 +1,6 @@
 #include "fileUtils.h"
+#include "defines/settings.h"
+#include "keystore.h"
 #include "oidc_file_io.h"
 #include "utils/crypt/crypt.h"
 #include "utils/listUtils.h"
@@ -114,6 +116,13 @@ int isAccountConfigFile(const char* filename,
   if (strEnds(filename, ".config")) {
     return 0;
   }
+  if (strncmp(filename, STATE_SNAPSHOT_FILENAME,
+              strlen(STATE_SNAPSHOT_FILENAME)) == 0) {
+    return 0;
+  }
+  if (strncmp(filename, KEYSTORE_FILENAME, strlen(KEYSTORE_FILENAME)) == 0) {
+    return 0;
+  }
   return 1;
 }
 
@@ -124,6 +133,21 @@ list_t* getAccountConfigFileList() {
   }
   list_t* list = getFileListForDirIf(oidc_dir, &isAccountConfigFile, NULL);
   secFree(oidc_dir);
+  list_t* stored = keystore_getNames();
+  if (list == NULL) {  // e.g. the directory cannot be listed
+    return stored;
+  }
+  if (stored != NULL) {
+    list_node_t*     node;
+    list_iterator_t* it = list_iterator_new(stored, LIST_HEAD);
+    while ((node = list_iterator_next(it))) {
+      if (findInList(list, node->val) == NULL) {
+        list_rpush(list, list_node_new(oidc_strcopy(node->val)));
+      }
+    }
+    list_iterator_destroy(it);
+  }
+  secFreeList(stored);
   return list;
 }
 
@@ -7,6 +7,10 @@
 void assertOidcDirExists();
 void checkOidcDirExists();
 
+list_t* getFileListForDirIf(const char* dirname,
+                            int(match(const char*, const char*)),
+                            const char* arg);
+int     isAccountConfigFile(const char* filename, const char* a);
 list_t* getAccountConfigFileList();
 list_t* getClientConfigFileList();
 
@@ -5,8 +5,10 @@
 #include "utils/memory.h"
 #include "utils/stringUtils.h"
 
+#include <ctype.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,14 +18,21 @@
 
 char* readFILE2(FILE* fp) {
   logger(DEBUG, "I'm reading a file step by step");
-  size_t bsize   = 8;
+  size_t bsize   = 4096;
   char*  buffer  = secAlloc(bsize + 1);
   size_t written = 0;
   while (1) {
-    if (fread(buffer + written, bsize, 1, fp) != 1) {
+    size_t n = fread(buffer + written, 1, bsize - written, fp);
+    written += n;
+    if (written < bsize) {
+      if (ferror(fp)) {
+        oidc_setErrnoError();
+        secFree(buffer);
+        return NULL;
+      }
       if (feof(fp)) {
-        if (buffer[strlen(buffer) - 1] == '\n') {
-          buffer[strlen(buffer) - 1] = '\0';
+        if (written > 0 && buffer[written - 1] == '\n') {
+          buffer[written - 1] = '\0';
         }
         if (buffer[0] == '\0') {
           secFree(buffer);
@@ -31,14 +40,11 @@ char* readFILE2(FILE* fp) {
         }
         return buffer;
       }
-      if (ferror(fp)) {
-        oidc_setErrnoError();
-        secFree(buffer);
-        return NULL;
-      }
+      continue;
     }
-    written += bsize;
-    buffer = secRealloc(buffer, written + bsize + 1);
+    // grow geometrically; secRealloc copies and wipes the old buffer
+    bsize *= 2;
+    buffer = secRealloc(buffer, bsize + 1);
   }
 }
 
@@ -80,6 +86,94 @@ char* readFILE(FILE* fp) {
   return buffer;
 }
 
+/**
+ * @brief reads a whole file into memory with a single read
+ * The file is read instead of mapped, because config files are rewritten in
+ * place, and a truncation while a mapping is parsed would kill the process.
+ * @param path the file to be read
+ * @return a pointer to a @c struct @c fileContent; has to be released with
+ * @c releaseFile, which wipes the content. On failure @c NULL is returned and
+ * oidc_errno is set.
+ */
+struct fileContent* loadFile(const char* path) {
+  if (path == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    logger(NOTICE, "%m\n");
+    oidc_errno = OIDC_EFOPEN;
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    oidc_setErrnoError();
+    close(fd);
+    return NULL;
+  }
+  // one spare byte, so an unchanged file is read without growing the buffer
+  size_t cap = S_ISREG(st.st_mode) ? (size_t)st.st_size + 1 : 4096;
+  struct fileContent* f = secAlloc(sizeof(struct fileContent));
+  f->data               = secAlloc(cap + 1);
+  while (1) {
+    if (f->len == cap) {
+      cap *= 2;
+      f->data = secRealloc(f->data, cap + 1);
+    }
+    ssize_t n = read(fd, f->data + f->len, cap - f->len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      oidc_setErrnoError();
+      close(fd);
+      releaseFile(f);
+      return NULL;
+    }
+    if (n == 0) {
+      break;
+    }
+    f->len += n;
+  }
+  close(fd);
+  f->data[f->len] = '\0';
+  return f;
+}
+
+/**
+ * @brief releases a @c struct @c fileContent and wipes the content
+ */
+void releaseFile(struct fileContent* f) {
+  if (f == NULL) {
+    return;
+  }
+  secFree(f->data);
+  secFree(f);
+}
+
+/**
+ * @brief iterates over the lines of a loaded file without copying them
+ * @param f the loaded file
+ * @param pos the iteration state; has to be @c 0 for the first call
+ * @param line is set to the start of the next line; the line is NOT
+ * nullterminated
+ * @param line_len is set to the length of the line without the newline
+ * @return 1 if a line was found, 0 at the end of the file
+ */
+int fileContent_nextLine(const struct fileContent* f, size_t* pos,
+                         const char** line, size_t* line_len) {
+  if (f == NULL || pos == NULL || *pos >= f->len) {
+    return 0;
+  }
+  const char* start = f->data + *pos;
+  const char* nl    = memchr(start, '\n', f->len - *pos);
+  *line             = start;
+  *line_len         = nl ? (size_t)(nl - start) : f->len - *pos;
+  *pos += *line_len + (nl ? 1 : 0);
+  return 1;
+}
+
 /** @fn char* readFile(const char* path)
  * @brief reads a file and returns a pointer to the content
  * @param path the file to be read
@@ -88,17 +182,18 @@ char* readFILE(FILE* fp) {
  */
 char* readFile(const char* path) {
   logger(DEBUG, "Reading file: %s", path);
-
-  FILE* fp = fopen(path, "rb");
-  if (!fp) {
-    logger(NOTICE, "%m\n");
-    oidc_errno = OIDC_EFOPEN;
+  struct fileContent* f = loadFile(path);
+  if (f == NULL) {
     return NULL;
   }
-
-  char* ret = readFILE(fp);
-  fclose(fp);
-  return ret;
+  if (f->len == 0) {
+    releaseFile(f);
+    oidc_errno = OIDC_EEOF;
+    return NULL;
+  }
+  char* content = f->data;
+  secFree(f);
+  return content;
 }
 
 char* getLineFromFILE(FILE* fp) {
@@ -225,6 +320,19 @@ oidc_error_t createDir(const char* path) {
  */
 int removeFile(const char* path) { return unlink(path); }
 
+/**
+ * @brief checks if a (not nullterminated) line is a comment, i.e. its first
+ * non whitespace character is @p commentChar
+ */
+int isCommentLine(const char* line, size_t len, const char commentChar) {
+  for (size_t i = 0; i < len; i++) {
+    if (!isspace(line[i])) {
+      return line[i] == commentChar;
+    }
+  }
+  return commentChar == 0;
+}
+
 list_t* _getLinesFromFile(const char* path, const unsigned char ignoreComments,
                           const char commentChar) {
   if (path == NULL) {
@@ -232,9 +340,8 @@ list_t* _getLinesFromFile(const char* path, const unsigned char ignoreComments,
     return NULL;
   }
   logger(DEBUG, "Getting Lines from file: %s", path);
-  FILE* fp = fopen(path, "r");
-  if (fp == NULL) {
-    oidc_setErrnoError();
+  struct fileContent* f = loadFile(path);
+  if (f == NULL) {
     return NULL;
   }
 
@@ -242,20 +349,17 @@ list_t* _getLinesFromFile(const char* path, const unsigned char ignoreComments,
   lines->free   = _secFree;
   lines->match  = (matchFunction)strequal;
 
-  char*   line = NULL;
-  size_t  len  = 0;
-  ssize_t read = 0;
-  while ((read = getline(&line, &len, fp)) != -1) {
-    if (line[strlen(line) - 1] == '\n') {
-      line[strlen(line) - 1] = '\0';
-    }
-    if (!ignoreComments || commentChar != firstNonWhiteSpaceChar(line)) {
-      list_rpush(lines, list_node_new(oidc_strcopy(line)));
+  const char* line;
+  size_t      len;
+  size_t      pos = 0;
+  while (fileContent_nextLine(f, &pos, &line, &len)) {
+    if (ignoreComments && isCommentLine(line, len, commentChar)) {
+      continue;
     }
-    secFreeN(line, len);
+    list_rpush(lines, list_node_new(len ? oidc_strncopy(line, len)
+                                        : oidc_strcopy("")));
   }
-  secFreeN(line, len);
-  fclose(fp);
+  releaseFile(f);
   return lines;
 }
 
@@ -12,6 +12,14 @@
 
 #define DEFAULT_COMMENT_CHAR '#'
 
+/**
+ * the content of a file read with @c loadFile; @c data is nullterminated
+ */
+struct fileContent {
+  char*  data;
+  size_t len;
+};
+
 oidc_error_t writeFile(const char* filepath, const char* text);
 oidc_error_t appendFile(const char* path, const char* text);
 char*        readFile(const char* path);
@@ -25,4 +33,10 @@ int          removeFile(const char* path);
 list_t*      getLinesFromFile(const char* path);
 list_t*      getLinesFromFileWithoutComments(const char* path);
 
+struct fileContent* loadFile(const char* path);
+void                releaseFile(struct fileContent* f);
+int  isCommentLine(const char* line, size_t len, const char commentChar);
+int fileContent_nextLine(const struct fileContent* f, size_t* pos,
+                         const char** line, size_t* line_len);
+
 #endif  // FILE_IO_H
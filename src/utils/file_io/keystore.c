@@ -0,0 +1,636 @@
+#define _GNU_SOURCE
+#include "keystore.h"
+
+#include "defines/settings.h"
+#include "utils/crypt/crypt.h"
+#include "utils/file_io/fileUtils.h"
+#include "utils/file_io/file_io.h"
+#include "utils/file_io/oidc_file_io.h"
+#include "utils/listUtils.h"
+#include "utils/logger.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * The keystore is a single file in the oidc dir. After the magic it is a log
+ * of records; each record is a fixed size header followed by the account
+ * short name and the encrypted account configuration:
+ * "<flags:4><name_len:4><data_len:4><mtime:8><sha256(issuer_url):32><name>
+ * <data>"
+ * The headers form the index: listing accounts and looking up accounts for an
+ * issuer only reads them and never touches the encrypted data. Every record is
+ * encrypted on its own (with its own salt and nonce), so updating one account
+ * appends a single record; the last record for a name wins and a record with
+ * the deleted flag removes the name. When superseded records outweigh the live
+ * ones, the live records are copied into a temporary file that atomically
+ * replaces the keystore. The file is never truncated in place; readers take a
+ * shared lock, writers an exclusive one.
+ */
+
+#define KEYSTORE_RECORD_DELETED 0x1
+#define KEYSTORE_HEADER_LEN (4 + 4 + 4 + 8 + KEYSTORE_HASH_LEN)
+
+struct keystore_entry {
+  char*         name;
+  time_t        mtime;
+  unsigned char issuer_hash[KEYSTORE_HASH_LEN];
+  size_t        record_offset;
+  size_t        record_len;
+  size_t        data_offset;
+  size_t        data_len;
+};
+
+struct keystore_map {
+  unsigned char* data;
+  size_t         len;
+  list_t*        entries;
+  size_t         live_len;
+  size_t         valid_len;  // length of the complete records incl. the magic
+};
+
+static void _secFreeKeystoreEntry(struct keystore_entry* e) {
+  if (e == NULL) {
+    return;
+  }
+  secFree(e->name);
+  secFree(e);
+}
+
+static int _matchKeystoreEntryByName(const char*                  name,
+                                     const struct keystore_entry* e) {
+  return strequal(e->name, name);
+}
+
+static char* _keystorePath() { return concatToOidcDir(KEYSTORE_FILENAME); }
+
+/**
+ * @brief checks if @p name can be stored in the keystore; only account
+ * configurations are kept there
+ */
+static int _isKeystoreName(const char* name) {
+  return strValid(name) && strchr(name, '/') == NULL &&
+         isAccountConfigFile(name, NULL);
+}
+
+static void _issuerHash(const char* issuer_url, unsigned char* hash) {
+  memset(hash, 0, KEYSTORE_HASH_LEN);
+  if (!strValid(issuer_url)) {
+    return;
+  }
+  // compIssuerUrls ignores a trailing slash, so the hash does as well
+  char* normalized = withTrailingSlash(issuer_url);
+  char* sha        = sha256(normalized);
+  secFree(normalized);
+  if (sha != NULL) {
+    memcpy(hash, sha, KEYSTORE_HASH_LEN);
+    secFree(sha);
+  }
+}
+
+static uint32_t _readU32(const unsigned char* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint64_t _readU64(const unsigned char* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/**
+ * @brief parses the record headers of a mapped keystore into an index
+ * A truncated record at the end of the file (e.g. from an interrupted append)
+ * is ignored.
+ */
+static oidc_error_t _parseIndex(struct keystore_map* m) {
+  if (m->len < KEYSTORE_MAGIC_LEN ||
+      memcmp(m->data, KEYSTORE_MAGIC, KEYSTORE_MAGIC_LEN) != 0) {
+    oidc_errno = OIDC_EERROR;
+    oidc_seterror("The keystore file has an unknown format.");
+    return oidc_errno;
+  }
+  m->entries        = list_new();
+  m->entries->free  = (freeFunction)_secFreeKeystoreEntry;
+  m->entries->match = (matchFunction)_matchKeystoreEntryByName;
+  m->live_len       = 0;
+  size_t off        = KEYSTORE_MAGIC_LEN;
+  while (off + KEYSTORE_HEADER_LEN <= m->len) {
+    const unsigned char* h        = m->data + off;
+    uint32_t             flags    = _readU32(h);
+    uint32_t             name_len = _readU32(h + 4);
+    uint32_t             data_len = _readU32(h + 8);
+    size_t record_len = KEYSTORE_HEADER_LEN + (size_t)name_len + data_len;
+    if (name_len == 0 || record_len > m->len - off) {
+      logger(NOTICE, "Ignoring truncated keystore record at offset %lu",
+             (unsigned long)off);
+      break;
+    }
+    char* name = oidc_strncopy((const char*)h + KEYSTORE_HEADER_LEN, name_len);
+    list_node_t* old = findInList(m->entries, name);
+    if (old != NULL) {
+      m->live_len -= ((struct keystore_entry*)old->val)->record_len;
+      list_remove(m->entries, old);
+    }
+    if (flags & KEYSTORE_RECORD_DELETED) {
+      secFree(name);
+    } else {
+      struct keystore_entry* e = secAlloc(sizeof(struct keystore_entry));
+      e->name                  = name;
+      e->mtime                 = (time_t)_readU64(h + 12);
+      memcpy(e->issuer_hash, h + 20, KEYSTORE_HASH_LEN);
+      e->record_offset = off;
+      e->record_len    = record_len;
+      e->data_offset   = off + KEYSTORE_HEADER_LEN + name_len;
+      e->data_len      = data_len;
+      list_rpush(m->entries, list_node_new(e));
+      m->live_len += record_len;
+    }
+    off += record_len;
+  }
+  m->valid_len = off;
+  return OIDC_SUCCESS;
+}
+
+static void _unmapKeystore(struct keystore_map* m) {
+  if (m == NULL) {
+    return;
+  }
+  if (m->entries != NULL) {
+    secFreeList(m->entries);
+  }
+  if (m->data != NULL) {
+    munmap(m->data, m->len);
+  }
+  secFree(m);
+}
+
+/**
+ * @brief maps the keystore opened as @p fd read-only and parses its index
+ * @note the caller has to hold a lock on the keystore
+ * @return the mapped keystore or @c NULL if it could not be read
+ */
+static struct keystore_map* _mapKeystoreFd(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    oidc_setErrnoError();
+    return NULL;
+  }
+  struct keystore_map* m = secAlloc(sizeof(struct keystore_map));
+  m->len                 = st.st_size;
+  if (m->len > 0) {
+    void* addr = mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      logger(ERROR, "Could not map keystore: %m");
+      oidc_setErrnoError();
+      secFree(m);
+      return NULL;
+    }
+    m->data = addr;
+  }
+  if (_parseIndex(m) != OIDC_SUCCESS) {
+    _unmapKeystore(m);
+    return NULL;
+  }
+  return m;
+}
+
+/**
+ * @brief maps the keystore read-only and parses its index
+ * The shared lock is only held while mapping; records are only ever appended
+ * and a compaction replaces the file, so the mapping stays consistent.
+ * @return the mapped keystore or @c NULL if there is no keystore or it could
+ * not be read
+ */
+static struct keystore_map* _mapKeystore() {
+  char* path = _keystorePath();
+  int   fd   = open(path, O_RDONLY);
+  secFree(path);
+  if (fd < 0) {
+    oidc_setErrnoError();
+    return NULL;
+  }
+  if (flock(fd, LOCK_SH) != 0) {
+    oidc_setErrnoError();
+    close(fd);
+    return NULL;
+  }
+  struct keystore_map* m = _mapKeystoreFd(fd);
+  close(fd);  // releases the lock
+  return m;
+}
+
+static struct keystore_entry* _findEntry(struct keystore_map* m,
+                                         const char*          name) {
+  list_node_t* node = findInList(m->entries, name);
+  return node ? node->val : NULL;
+}
+
+/**
+ * @brief checks if the keystore is used, i.e. if the keystore file exists in
+ * the oidc dir
+ */
+int keystore_isEnabled() {
+  char* path = _keystorePath();
+  int   b    = fileDoesExist(path);
+  secFree(path);
+  return b;
+}
+
+/**
+ * @brief creates an empty keystore, enabling it
+ * @return an oidc_error code
+ */
+oidc_error_t keystore_create() {
+  if (keystore_isEnabled()) {
+    return OIDC_SUCCESS;
+  }
+  char* path = _keystorePath();
+  int   fd   = open(path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  secFree(path);
+  if (fd < 0) {
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  ssize_t w = write(fd, KEYSTORE_MAGIC, KEYSTORE_MAGIC_LEN);
+  fsync(fd);
+  close(fd);
+  if (w != KEYSTORE_MAGIC_LEN) {
+    oidc_errno = OIDC_EWRITE;
+    return oidc_errno;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief checks if the keystore holds a record for @p name
+ * @return 1 if it does, 0 if not or if the keystore is not used
+ */
+int keystore_contains(const char* name) {
+  if (!_isKeystoreName(name) || !keystore_isEnabled()) {
+    return 0;
+  }
+  struct keystore_map* m = _mapKeystore();
+  if (m == NULL) {
+    return 0;
+  }
+  int b = _findEntry(m, name) != NULL;
+  _unmapKeystore(m);
+  return b;
+}
+
+/**
+ * @brief lists the names of all accounts in the keystore
+ * @return a list of names; has to be freed after usage. @c NULL if the
+ * keystore is not used or could not be read
+ */
+list_t* keystore_getNames() {
+  if (!keystore_isEnabled()) {
+    return NULL;
+  }
+  struct keystore_map* m = _mapKeystore();
+  if (m == NULL) {
+    return NULL;
+  }
+  list_t* names = list_new();
+  names->free   = (freeFunction)_secFree;
+  names->match  = (matchFunction)strequal;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(m->entries, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct keystore_entry* e = node->val;
+    list_rpush(names, list_node_new(oidc_strcopy(e->name)));
+  }
+  list_iterator_destroy(it);
+  _unmapKeystore(m);
+  return names;
+}
+
+/**
+ * @brief reads the (still encrypted) record stored for @p name
+ * @return a pointer to the record; has to be freed after usage. @c NULL if
+ * the keystore is not used or there is no such record
+ */
+char* keystore_read(const char* name) {
+  if (!_isKeystoreName(name) || !keystore_isEnabled()) {
+    oidc_errno = OIDC_EFNEX;
+    return NULL;
+  }
+  struct keystore_map* m = _mapKeystore();
+  if (m == NULL) {
+    return NULL;
+  }
+  struct keystore_entry* e = _findEntry(m, name);
+  char*                  record =
+      e ? oidc_strncopy((const char*)m->data + e->data_offset, e->data_len)
+                         : NULL;
+  if (e == NULL) {
+    oidc_errno = OIDC_EFNEX;
+  }
+  _unmapKeystore(m);
+  return record;
+}
+
+/**
+ * @brief returns the name of the most recently updated account in the
+ * keystore that belongs to @p issuer_url
+ * Only the index is read, no account configuration is decrypted.
+ * @return a pointer to the name; has to be freed after usage. @c NULL if no
+ * account is found
+ */
+char* keystore_getNameForIssuer(const char* issuer_url) {
+  if (!strValid(issuer_url) || !keystore_isEnabled()) {
+    return NULL;
+  }
+  struct keystore_map* m = _mapKeystore();
+  if (m == NULL) {
+    return NULL;
+  }
+  unsigned char hash[KEYSTORE_HASH_LEN];
+  _issuerHash(issuer_url, hash);
+  struct keystore_entry* found = NULL;
+  list_node_t*           node;
+  list_iterator_t*       it = list_iterator_new(m->entries, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    struct keystore_entry* e = node->val;
+    if (memcmp(e->issuer_hash, hash, KEYSTORE_HASH_LEN) == 0 &&
+        (found == NULL || e->mtime >= found->mtime)) {
+      found = e;
+    }
+  }
+  list_iterator_destroy(it);
+  char* name = found ? oidc_strcopy(found->name) : NULL;
+  _unmapKeystore(m);
+  return name;
+}
+
+/**
+ * @brief opens the keystore for writing and takes an exclusive lock on it
+ * If the keystore was replaced by a compaction while waiting for the lock, the
+ * new file is opened instead.
+ * @return the file descriptor or -1 on error
+ */
+static int _openLockedKeystore() {
+  char* path = _keystorePath();
+  while (1) {
+    int fd = open(path, O_RDWR | O_APPEND);
+    if (fd < 0) {
+      oidc_setErrnoError();
+      secFree(path);
+      return -1;
+    }
+    if (flock(fd, LOCK_EX) != 0) {
+      oidc_setErrnoError();
+      close(fd);
+      secFree(path);
+      return -1;
+    }
+    struct stat fd_st;
+    struct stat path_st;
+    if (fstat(fd, &fd_st) == 0 && stat(path, &path_st) == 0 &&
+        fd_st.st_ino == path_st.st_ino && fd_st.st_dev == path_st.st_dev) {
+      secFree(path);
+      return fd;
+    }
+    close(fd);
+  }
+}
+
+static oidc_error_t _appendRecord(int fd, uint32_t flags, const char* name,
+                                  const char* data, const char* issuer_url) {
+  uint32_t name_len = strlen(name);
+  uint32_t data_len = data ? strlen(data) : 0;
+  uint64_t mtime    = time(NULL);
+  size_t   len      = KEYSTORE_HEADER_LEN + (size_t)name_len + data_len;
+  unsigned char* buf = secAlloc(len);
+  memcpy(buf, &flags, 4);
+  memcpy(buf + 4, &name_len, 4);
+  memcpy(buf + 8, &data_len, 4);
+  memcpy(buf + 12, &mtime, 8);
+  _issuerHash(issuer_url, buf + 20);
+  memcpy(buf + KEYSTORE_HEADER_LEN, name, name_len);
+  if (data_len) {
+    memcpy(buf + KEYSTORE_HEADER_LEN + name_len, data, data_len);
+  }
+  ssize_t w = write(fd, buf, len);
+  secFree(buf);
+  if (w < 0 || (size_t)w != len) {
+    oidc_errno = OIDC_EWRITE;
+    return oidc_errno;
+  }
+  if (fsync(fd) != 0) {
+    oidc_setErrnoError();
+    return oidc_errno;
+  }
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief writes the live records into a temporary file and atomically
+ * replaces the keystore with it
+ * A partial record at the end of the keystore is dropped as well.
+ * @param fd the keystore, locked exclusively by the caller
+ */
+static oidc_error_t _compactLocked(int fd) {
+  struct keystore_map* m = _mapKeystoreFd(fd);
+  if (m == NULL) {
+    return oidc_errno;
+  }
+  char* path     = _keystorePath();
+  char* tmp_path = oidc_strcat(path, ".tmp");
+  int tmp_fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (tmp_fd < 0) {
+    oidc_setErrnoError();
+    secFree(tmp_path);
+    secFree(path);
+    _unmapKeystore(m);
+    return oidc_errno;
+  }
+  int ok =
+      write(tmp_fd, KEYSTORE_MAGIC, KEYSTORE_MAGIC_LEN) == KEYSTORE_MAGIC_LEN;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(m->entries, LIST_HEAD);
+  while (ok && (node = list_iterator_next(it))) {
+    struct keystore_entry* e = node->val;
+    ssize_t w = write(tmp_fd, m->data + e->record_offset, e->record_len);
+    ok        = w >= 0 && (size_t)w == e->record_len;
+  }
+  list_iterator_destroy(it);
+  size_t old_len = m->len;
+  size_t new_len = KEYSTORE_MAGIC_LEN + m->live_len;
+  _unmapKeystore(m);
+  ok = ok && fsync(tmp_fd) == 0;
+  close(tmp_fd);
+  if (!ok || rename(tmp_path, path) != 0) {
+    logger(ERROR, "Could not compact keystore: %m");
+    oidc_setErrnoError();
+    unlink(tmp_path);
+    secFree(tmp_path);
+    secFree(path);
+    return oidc_errno;
+  }
+  logger(DEBUG, "Compacted keystore from %lu to %lu bytes",
+         (unsigned long)old_len, (unsigned long)new_len);
+  secFree(tmp_path);
+  secFree(path);
+  return OIDC_SUCCESS;
+}
+
+static void _compactIfNeeded(int fd) {
+  struct keystore_map* m = _mapKeystoreFd(fd);
+  if (m == NULL) {
+    return;
+  }
+  size_t stale = m->len - KEYSTORE_MAGIC_LEN - m->live_len;
+  size_t live  = m->live_len;
+  _unmapKeystore(m);
+  if (stale >= KEYSTORE_COMPACT_MIN && stale > live) {
+    _compactLocked(fd);
+  }
+}
+
+/**
+ * @brief checks if the keystore ends with a partial record, e.g. from an
+ * interrupted append
+ */
+static int _hasPartialRecord(int fd) {
+  struct keystore_map* m = _mapKeystoreFd(fd);
+  if (m == NULL) {
+    return 0;
+  }
+  int b = m->valid_len < m->len;
+  _unmapKeystore(m);
+  return b;
+}
+
+static oidc_error_t _update(uint32_t flags, const char* name,
+                            const char* record, const char* issuer_url) {
+  int fd = _openLockedKeystore();
+  if (fd < 0) {
+    return oidc_errno;
+  }
+  // a record appended behind a partial one would be hidden by it, so the
+  // partial record is dropped first
+  if (_hasPartialRecord(fd)) {
+    oidc_error_t e = _compactLocked(fd);
+    close(fd);
+    if (e != OIDC_SUCCESS) {
+      return e;
+    }
+    return _update(flags, name, record, issuer_url);
+  }
+  oidc_error_t e = _appendRecord(fd, flags, name, record, issuer_url);
+  if (e == OIDC_SUCCESS) {
+    _compactIfNeeded(fd);
+  }
+  close(fd);  // releases the lock
+  return e;
+}
+
+/**
+ * @brief stores an encrypted account configuration in the keystore
+ * Only a single record is appended; the other accounts are not rewritten.
+ * @param name the account short name
+ * @param record the encrypted account configuration
+ * @param issuer_url the issuer of the account; its hash is kept in the index.
+ * Might be @c NULL if unknown.
+ * @return an oidc_error code
+ */
+oidc_error_t keystore_write(const char* name, const char* record,
+                            const char* issuer_url) {
+  if (name == NULL || record == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+  if (!_isKeystoreName(name)) {
+    oidc_errno = OIDC_EERROR;
+    oidc_seterror("This file cannot be stored in the keystore.");
+    return oidc_errno;
+  }
+  logger(DEBUG, "Write '%s' to keystore", name);
+  return _update(0, name, record, issuer_url);
+}
+
+/**
+ * @brief removes an account from the keystore
+ * @return an oidc_error code
+ */
+oidc_error_t keystore_remove(const char* name) {
+  if (name == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+  logger(DEBUG, "Remove '%s' from keystore", name);
+  return _update(KEYSTORE_RECORD_DELETED, name, NULL, NULL);
+}
+
+/**
+ * @brief compacts the keystore, dropping all superseded and deleted records
+ * @return an oidc_error code
+ */
+oidc_error_t keystore_compact() {
+  int fd = _openLockedKeystore();
+  if (fd < 0) {
+    return oidc_errno;
+  }
+  oidc_error_t e = _compactLocked(fd);
+  close(fd);
+  return e;
+}
+
+/**
+ * @brief moves all account configuration files from the oidc dir into the
+ * keystore; creates the keystore if needed
+ * The files are moved as they are, i.e. without reencrypting them.
+ * @param getIssuer returns the issuer url of an account configuration, so that
+ * the account can be found by its issuer; it gets the account name, the file
+ * content and @p arg. A file for which it returns @c NULL is not moved.
+ * @return the number of moved accounts or -1 on error
+ */
+int keystore_importAccountFiles(keystore_issuerFunction getIssuer, void* arg) {
+  if (keystore_create() != OIDC_SUCCESS) {
+    return -1;
+  }
+  char* oidc_dir = getOidcDir();
+  if (oidc_dir == NULL) {
+    return -1;
+  }
+  list_t* files = getFileListForDirIf(oidc_dir, &isAccountConfigFile, NULL);
+  if (files == NULL) {
+    secFree(oidc_dir);
+    return -1;
+  }
+  int              count = 0;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(files, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    char* path       = oidc_strcat(oidc_dir, node->val);
+    char* content    = readFile(path);
+    char* issuer_url = content ? getIssuer(node->val, content, arg) : NULL;
+    if (issuer_url != NULL &&
+        keystore_write(node->val, content, issuer_url) == OIDC_SUCCESS) {
+      removeFile(path);
+      count++;
+    } else {
+      logger(ERROR, "Could not move '%s' into the keystore", node->val);
+    }
+    secFree(issuer_url);
+    secFree(content);
+    secFree(path);
+  }
+  list_iterator_destroy(it);
+  secFreeList(files);
+  secFree(oidc_dir);
+  return count;
+}
@@ -0,0 +1,33 @@
+#ifndef OIDC_KEYSTORE_H
+#define OIDC_KEYSTORE_H
+
+#include "utils/oidc_error.h"
+#include "wrapper/list.h"
+
+#include <time.h>
+
+#define KEYSTORE_MAGIC "OIDCKS01"
+#define KEYSTORE_MAGIC_LEN 8
+#define KEYSTORE_HASH_LEN 32
+/**
+ * the keystore is only compacted if at least this many bytes are occupied by
+ * superseded or deleted records
+ */
+#define KEYSTORE_COMPACT_MIN 4096
+
+typedef char* (*keystore_issuerFunction)(const char* name, const char* content,
+                                         void* arg);
+
+int          keystore_isEnabled();
+oidc_error_t keystore_create();
+int          keystore_contains(const char* name);
+list_t*      keystore_getNames();
+char*        keystore_read(const char* name);
+oidc_error_t keystore_write(const char* name, const char* record,
+                            const char* issuer_url);
+oidc_error_t keystore_remove(const char* name);
+char*        keystore_getNameForIssuer(const char* issuer_url);
+oidc_error_t keystore_compact();
+int keystore_importAccountFiles(keystore_issuerFunction getIssuer, void* arg);
+
+#endif  // OIDC_KEYSTORE_H
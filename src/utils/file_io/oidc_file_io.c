@@ -1,6 +1,8 @@
 #include "oidc_file_io.h"
 #include "defines/settings.h"
+#include "configCache.h"
 #include "file_io.h"
+#include "keystore.h"
 #include "utils/listUtils.h"
 #include "utils/logger.h"
 #include "utils/memory.h"
@@ -16,10 +18,16 @@
 /** @fn char* readOidcFile(const char* filename)
  * @brief reads a file located in the oidc dir and returns a pointer to the
  * content
+ * @note account configurations are read from the keystore if they are stored
+ * there
  * @param filename the filename of the file
  * @return a pointer to the file content. Has to be freed after usage.
  */
 char* readOidcFile(const char* filename) {
+  char* record = keystore_read(filename);
+  if (record != NULL) {
+    return record;
+  }
   char* path = concatToOidcDir(filename);
   char* c    = readFile(path);
   secFree(path);
@@ -49,7 +57,7 @@ oidc_error_t appendOidcFile(const char* filename, const char* text) {
 }
 
 /** @fn int oidcFileDoesExist(const char* filename)
- * @brief checks if a file exists in the oidc dir
+ * @brief checks if a file exists in the oidc dir or in the keystore
  * @param filename the file to be checked
  * @return 1 if the file does exist, 0 if not
  */
@@ -57,7 +65,7 @@ int oidcFileDoesExist(const char* filename) {
   char* path = concatToOidcDir(filename);
   int   b    = fileDoesExist(path);
   secFree(path);
-  return b;
+  return b || keystore_contains(filename);
 }
 
 char* getNonTildePath(const char* path_in) {
@@ -95,12 +103,33 @@ list_t* getPossibleOidcDirLocations() {
   return possibleLocations;
 }
 
-/** @fn char* getOidcDir()
- * @brief get the oidc directory path
- * @return a pointer to the oidc directory path. Has to be freed after usage. If
- * no oidc dir is found, NULL is returned
+/**
+ * the resolved oidc dir together with the environment it was resolved for;
+ * only an existing directory is cached
  */
-char* getOidcDir() {
+static struct {
+  char* dir;
+  char* env_dir;
+  char* env_home;
+} oidcDirCache = {NULL, NULL, NULL};
+
+static int _envEquals(const char* cached, const char* env) {
+  if (cached == NULL || env == NULL) {
+    return cached == env;
+  }
+  return strcmp(cached, env) == 0;
+}
+
+static void _resetOidcDirCache() {
+  secFree(oidcDirCache.dir);
+  secFree(oidcDirCache.env_dir);
+  secFree(oidcDirCache.env_home);
+  oidcDirCache.dir      = NULL;
+  oidcDirCache.env_dir  = NULL;
+  oidcDirCache.env_home = NULL;
+}
+
+static char* _resolveOidcDir() {
   list_t* possibleLocations = getPossibleOidcDirLocations();
   if (possibleLocations == NULL) {
     return NULL;
@@ -126,6 +155,40 @@ char* getOidcDir() {
   return NULL;
 }
 
+/**
+ * @brief returns the cached oidc dir; the candidate locations are only probed
+ * if nothing is cached yet or the environment changed
+ * @return a pointer to the cached path; must not be freed. @c NULL if no oidc
+ * dir is found
+ */
+static const char* _getCachedOidcDir() {
+  const char* env_dir  = getenv(OIDC_CONFIG_DIR_ENV_NAME);
+  const char* env_home = getenv("HOME");
+  if (oidcDirCache.dir != NULL && _envEquals(oidcDirCache.env_dir, env_dir) &&
+      _envEquals(oidcDirCache.env_home, env_home)) {
+    return oidcDirCache.dir;
+  }
+  _resetOidcDirCache();
+  char* dir = _resolveOidcDir();
+  if (dir == NULL) {
+    return NULL;
+  }
+  oidcDirCache.dir      = dir;
+  oidcDirCache.env_dir  = oidc_strcopy(env_dir);
+  oidcDirCache.env_home = oidc_strcopy(env_home);
+  return oidcDirCache.dir;
+}
+
+/** @fn char* getOidcDir()
+ * @brief get the oidc directory path
+ * @return a pointer to the oidc directory path. Has to be freed after usage. If
+ * no oidc dir is found, NULL is returned
+ */
+char* getOidcDir() {
+  const char* dir = _getCachedOidcDir();
+  return dir ? oidc_strcopy(dir) : NULL;
+}
+
 oidc_error_t createOidcDir() {
   list_t* possibleLocations = getPossibleOidcDirLocations();
   if (possibleLocations == NULL) {
@@ -167,6 +230,7 @@ oidc_error_t createOidcDir() {
     case OIDC_DIREXIST_OK: secFreeList(possibleLocations); return OIDC_SUCCESS;
   }
   logger(DEBUG, "Creating '%s' as oidcdir.", path);
+  _resetOidcDirCache();
   oidc_error_t ret        = createDir(path);
   char* issuerconfig_path = oidc_sprintf("%s/%s", path, ISSUER_CONFIG_FILENAME);
   secFreeList(possibleLocations);
@@ -177,12 +241,24 @@ oidc_error_t createOidcDir() {
 }
 
 /** @fn int removeOidcFile(const char* filename)
- * @brief removes a file located in the oidc dir
+ * @brief removes a file located in the oidc dir or an account configuration
+ * stored in the keystore
  * @param filename the filename of the file to be removed
  * @return On success, 0 is returned.  On error, -1 is returned, and errno is
  * set appropriately.
  */
 int removeOidcFile(const char* filename) {
+  if (keystore_contains(filename)) {
+    if (keystore_remove(filename) != OIDC_SUCCESS) {
+      return -1;
+    }
+    char* path = concatToOidcDir(filename);
+    if (fileDoesExist(path)) {
+      removeFile(path);
+    }
+    secFree(path);
+    return 0;
+  }
   char* path = concatToOidcDir(filename);
   int   r    = removeFile(path);
   secFree(path);
@@ -190,10 +266,19 @@ int removeOidcFile(const char* filename) {
 }
 
 char* concatToOidcDir(const char* filename) {
-  char* oidc_dir = getOidcDir();
-  char* path     = oidc_strcat(oidc_dir, filename);
-  secFree(oidc_dir);
-  return path;
+  return oidc_strcat(_getCachedOidcDir(), filename);
+}
+
+/**
+ * @brief loads a file located in the oidc dir
+ * @return a pointer to the loaded file; has to be released with
+ * @c releaseFile. @c NULL if the file could not be read.
+ */
+struct fileContent* loadOidcFile(const char* filename) {
+  char*               path = concatToOidcDir(filename);
+  struct fileContent* f    = loadFile(path);
+  secFree(path);
+  return f;
 }
 
 list_t* getLinesFromOidcFile(const char* filename) {
@@ -220,13 +305,12 @@ void updateIssuerConfig(const char* issuer_url, const char* shortname) {
   if (issuer_url == NULL || shortname == NULL) {
     return;
   }
+  if (configCache_hasIssuer(CONFIG_CACHE_ISSUERS, issuer_url)) {
+    return;
+  }
   char* issuers = readOidcFile(ISSUER_CONFIG_FILENAME);
   char* new_issuers;
   if (issuers) {
-    if (strSubStringCase(issuers, issuer_url)) {
-      secFree(issuers);
-      return;
-    }
     new_issuers = oidc_sprintf("%s\n%s %s", issuers, issuer_url, shortname);
     secFree(issuers);
   } else {
@@ -236,6 +320,7 @@ void updateIssuerConfig(const char* issuer_url, const char* shortname) {
     logger(ERROR, "%s", oidc_serror());
   } else {
     writeOidcFile(ISSUER_CONFIG_FILENAME, new_issuers);
+    configCache_invalidate(CONFIG_CACHE_ISSUERS);
     secFree(new_issuers);
   }
 }
@@ -1,6 +1,7 @@
 #ifndef OIDC_FILE_IO_H
 #define OIDC_FILE_IO_H
 
+#include "file_io.h"
 #include "utils/oidc_error.h"
 #include "wrapper/list.h"
 
@@ -12,6 +13,7 @@ char*        readOidcFile(const char* filename);
 int          oidcFileDoesExist(const char* filename);
 int          removeOidcFile(const char* filename);
 char*        concatToOidcDir(const char* filename);
+struct fileContent* loadOidcFile(const char* filename);
 void         updateIssuerConfig(const char* issuer_url, const char* shortname);
 list_t*      getLinesFromOidcFile(const char* filename);
 list_t*      getLinesFromOidcFileWithoutComments(const char* filename);
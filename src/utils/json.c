@@ -1,6 +1,7 @@
 #include "json.h"
 
 #include "listUtils.h"
+#include "memory.h"
 #include "oidc_error.h"
 #include "pass.h"
 #include "stringUtils.h"
@@ -11,13 +12,25 @@
 static cJSON_Hooks hooks;
 static int         jsonInitDone = 0;
 
+/**
+ * @brief allocator passed to cJSON; accounts the allocation to the json
+ * subsystem
+ * @internal
+ */
+static void* _jsonAlloc(size_t size) {
+  enum memorySubsystem previous = memory_enterSubsystem(MEMORY_JSON);
+  void*                p        = secAlloc(size);
+  memory_leaveSubsystem(previous);
+  return p;
+}
+
 /**
  * @brief initializes the cJSON memory allocator and deallocator if not done yet
  * @internal
  */
 void initCJSON() {
   if (!jsonInitDone) {
-    hooks.malloc_fn = secAlloc;
+    hooks.malloc_fn = _jsonAlloc;
     hooks.free_fn   = _secFree;
     cJSON_InitHooks(&hooks);
     jsonInitDone = 1;
@@ -319,17 +332,41 @@ list_t* JSONArrayToList(const cJSON* cjson) {
     return NULL;
   }
 
-  int     j;
   list_t* l = list_new();
   l->free   = _secFree;
   l->match  = (matchFunction)strequal;
-  for (j = 0; j < cJSON_GetArraySize(cjson); j++) {
-    list_rpush(l,
-               list_node_new(getJSONItemValue(cJSON_GetArrayItem(cjson, j))));
+  cJSON* item;
+  cJSON_ArrayForEach(item, cjson) {
+    list_rpush(l, list_node_new(getJSONItemValue(item)));
   }
   return l;
 }
 
+/**
+ * @brief converts a cJSON JSONArray into a vector
+ * @param cjson the cJSON JSONArray
+ * @return a pointer to a vector. The vector has to be freed after usage using
+ * @c secFreeVector.
+ */
+vector_t* JSONArrayToVector(const cJSON* cjson) {
+  if (NULL == cjson) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  initCJSON();
+  if (!cJSON_IsArray(cjson)) {
+    oidc_errno = OIDC_EJSONARR;
+    return NULL;
+  }
+
+  vector_t* v = vector_newWithCapacity(cJSON_GetArraySize(cjson));
+  v->free     = _secFree;
+  v->match    = (matchFunction)strequal;
+  cJSON* item;
+  cJSON_ArrayForEach(item, cjson) { vector_push(v, getJSONItemValue(item)); }
+  return v;
+}
+
 /**
  * @brief converts a JSONArray string into a list
  * @param json a pointer to a string holding a JSONArray
@@ -364,9 +401,12 @@ char* JSONArrayToDelimitedString(const cJSON* cjson, char* delim) {
     return NULL;
   }
   initCJSON();
-  list_t* list = JSONArrayToList(cjson);
-  char*   str  = listToDelimitedString(list, delim);
-  secFreeList(list);
+  vector_t* v = JSONArrayToVector(cjson);
+  if (v == NULL) {
+    return NULL;
+  }
+  char* str = vectorToDelimitedString(v, delim);
+  secFreeVector(v);
   return str;
 }
 
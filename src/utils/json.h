@@ -3,6 +3,7 @@
 
 #include "key_value.h"
 #include "oidc_error.h"
+#include "vector.h"
 
 #include "wrapper/cjson.h"
 #include "wrapper/list.h"
@@ -21,14 +22,15 @@ int jsonStringHasKey(const char* json, const char* key);
 int isJSONObject(const char* json);
 int jsonArrayIsEmpty(cJSON* json);
 
-char*   jsonToString(cJSON* cjson);
-char*   jsonToStringUnformatted(cJSON* cjson);
-cJSON*  stringToJson(const char* json);
-list_t* JSONArrayToList(const cJSON* cjson);
-list_t* JSONArrayStringToList(const char* json);
-char*   JSONArrayToDelimitedString(const cJSON* cjson, char* delim);
-char*   JSONArrayStringToDelimitedString(const char* json, char* delim);
-cJSON*  listToJSONArray(list_t* list);
+char*     jsonToString(cJSON* cjson);
+char*     jsonToStringUnformatted(cJSON* cjson);
+cJSON*    stringToJson(const char* json);
+list_t*   JSONArrayToList(const cJSON* cjson);
+vector_t* JSONArrayToVector(const cJSON* cjson);
+list_t*   JSONArrayStringToList(const char* json);
+char*     JSONArrayToDelimitedString(const cJSON* cjson, char* delim);
+char*     JSONArrayStringToDelimitedString(const char* json, char* delim);
+cJSON*    listToJSONArray(list_t* list);
 
 cJSON*       generateJSONObject(const char* k1, int type1, const char* v1, ...);
 oidc_error_t setJSONValue(cJSON* cjson, const char* key, const char* value);
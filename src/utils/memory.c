@@ -6,9 +6,137 @@
 #include <stdlib.h>
 #include <string.h>
 
-void* secCalloc(size_t nmemb, size_t size) { return secAlloc(nmemb * size); }
+/*
+ * Every allocation is prefixed with a size_t header holding its size. If the
+ * allocation was accounted, the highest bit of the header is set and the
+ * subsystem it is accounted to is stored in the remaining bits of the highest
+ * byte.
+ */
+#define HEADER_BITS (sizeof(size_t) * 8)
+#define HEADER_ACCOUNTED ((size_t)1 << (HEADER_BITS - 1))
+#define HEADER_SUBSYSTEM_SHIFT (HEADER_BITS - 8)
+#define HEADER_SIZE_MASK (((size_t)1 << HEADER_SUBSYSTEM_SHIFT) - 1)
+
+#define SMALLEST_SIZE_CLASS 16
+
+static int                           accounting       = 0;
+static __thread enum memorySubsystem currentSubsystem = MEMORY_OTHER;
+static struct memoryStats            stats;
+
+static const char* const subsystemNames[MEMORY_SUBSYSTEMS] = {
+    "other", "ipc", "crypt", "json", "http", "db"};
+
+/**
+ * @brief enables or disables the accounting of allocations
+ * Only allocations made while the accounting is enabled are accounted; this
+ * should therefore be called once at the start of a process.
+ */
+void memory_enableAccounting(int enable) { accounting = enable; }
+
+int memory_accountingEnabled() { return accounting; }
+
+/**
+ * @brief accounts the following allocations of this thread to @p subsystem,
+ * unless they are already accounted to another subsystem
+ * @return the previous subsystem; has to be passed to
+ * @c memory_leaveSubsystem
+ */
+enum memorySubsystem memory_enterSubsystem(enum memorySubsystem subsystem) {
+  enum memorySubsystem previous = currentSubsystem;
+  if (previous == MEMORY_OTHER) {
+    currentSubsystem = subsystem;
+  }
+  return previous;
+}
+
+void memory_leaveSubsystem(enum memorySubsystem previous) {
+  currentSubsystem = previous;
+}
+
+const char* memory_subsystemName(enum memorySubsystem subsystem) {
+  return subsystem < MEMORY_SUBSYSTEMS ? subsystemNames[subsystem] : NULL;
+}
+
+/**
+ * @brief returns the upper limit of a size class
+ * @return the largest allocation size in bytes counted in @p size_class or
+ * @c 0 for the last class, which has no limit
+ */
+size_t memory_sizeClassLimit(int size_class) {
+  if (size_class >= MEMORY_SIZE_CLASSES - 1) {
+    return 0;
+  }
+  return (size_t)SMALLEST_SIZE_CLASS << (2 * size_class);
+}
+
+static int _sizeClass(size_t size) {
+  int    size_class = 0;
+  size_t limit      = SMALLEST_SIZE_CLASS;
+  while (size_class < MEMORY_SIZE_CLASSES - 1 && size > limit) {
+    size_class++;
+    limit <<= 2;
+  }
+  return size_class;
+}
+
+static void _raisePeak(size_t* peak, size_t live) {
+  size_t old = __atomic_load_n(peak, __ATOMIC_RELAXED);
+  while (live > old &&
+         !__atomic_compare_exchange_n(peak, &old, live, 1, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {}
+}
+
+static void _accountAlloc(size_t size, enum memorySubsystem subsystem) {
+  struct memorySubsystemStats* s = &stats.subsystems[subsystem];
+  __atomic_fetch_add(&s->allocations, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&s->size_classes[_sizeClass(size)], 1, __ATOMIC_RELAXED);
+  _raisePeak(&s->peak_bytes,
+             __atomic_add_fetch(&s->live_bytes, size, __ATOMIC_RELAXED));
+  _raisePeak(&stats.peak_bytes,
+             __atomic_add_fetch(&stats.live_bytes, size, __ATOMIC_RELAXED));
+}
+
+static void _accountFree(size_t size, enum memorySubsystem subsystem) {
+  struct memorySubsystemStats* s = &stats.subsystems[subsystem];
+  __atomic_fetch_add(&s->frees, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_sub(&s->live_bytes, size, __ATOMIC_RELAXED);
+  __atomic_fetch_sub(&stats.live_bytes, size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief copies the current allocation statistics of this process
+ * @param out the struct to fill; all counters are @c 0 if the accounting was
+ * never enabled
+ */
+void memory_getStats(struct memoryStats* out) {
+  if (out == NULL) {
+    return;
+  }
+  out->live_bytes = __atomic_load_n(&stats.live_bytes, __ATOMIC_RELAXED);
+  out->peak_bytes = __atomic_load_n(&stats.peak_bytes, __ATOMIC_RELAXED);
+  for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+    struct memorySubsystemStats*       o = &out->subsystems[i];
+    const struct memorySubsystemStats* s = &stats.subsystems[i];
+    o->live_bytes  = __atomic_load_n(&s->live_bytes, __ATOMIC_RELAXED);
+    o->peak_bytes  = __atomic_load_n(&s->peak_bytes, __ATOMIC_RELAXED);
+    o->allocations = __atomic_load_n(&s->allocations, __ATOMIC_RELAXED);
+    o->frees       = __atomic_load_n(&s->frees, __ATOMIC_RELAXED);
+    for (int c = 0; c < MEMORY_SIZE_CLASSES; c++) {
+      o->size_classes[c] =
+          __atomic_load_n(&s->size_classes[c], __ATOMIC_RELAXED);
+    }
+  }
+}
+
+static size_t _headerSize(size_t header) {
+  return header & HEADER_ACCOUNTED ? header & HEADER_SIZE_MASK : header;
+}
+
+static enum memorySubsystem _headerSubsystem(size_t header) {
+  return (header & ~HEADER_ACCOUNTED) >> HEADER_SUBSYSTEM_SHIFT;
+}
 
-void* secAlloc(size_t size) {
+static void* _secAllocFor(size_t size, enum memorySubsystem subsystem) {
   if (size == 0) {
     return NULL;
   }
@@ -20,10 +148,19 @@ void* secAlloc(size_t size) {
            size);
     return NULL;
   }
-  *(size_t*)p = size;
+  size_t header = size;
+  if (accounting && size <= HEADER_SIZE_MASK) {
+    header |= HEADER_ACCOUNTED | (size_t)subsystem << HEADER_SUBSYSTEM_SHIFT;
+    _accountAlloc(size, subsystem);
+  }
+  *(size_t*)p = header;
   return p + sizeof(size);
 }
 
+void* secCalloc(size_t nmemb, size_t size) { return secAlloc(nmemb * size); }
+
+void* secAlloc(size_t size) { return _secAllocFor(size, currentSubsystem); }
+
 void* secRealloc(void* p, size_t size) {
   if (p == NULL) {
     return secAlloc(size);
@@ -32,9 +169,13 @@ void* secRealloc(void* p, size_t size) {
     secFree(p);
     return NULL;
   }
-  size_t oldsize = *(size_t*)(p - sizeof(size_t));
+  size_t header  = *(size_t*)(p - sizeof(size_t));
+  size_t oldsize = _headerSize(header);
   size_t movelen = oldsize < size ? oldsize : size;
-  void*  newp    = secAlloc(size);
+  // a grown buffer stays accounted to the subsystem that allocated it
+  void* newp = _secAllocFor(size, header & HEADER_ACCOUNTED
+                                      ? _headerSubsystem(header)
+                                      : currentSubsystem);
   if (newp == NULL) {
     return NULL;
   }
@@ -53,9 +194,13 @@ void _secFree(void* p) {
   if (p == NULL) {
     return;
   }
-  void*  fp  = p - sizeof(size_t);
-  size_t len = *(size_t*)fp;
-  secFreeN(fp, len);
+  void*  fp     = p - sizeof(size_t);
+  size_t header = *(size_t*)fp;
+  size_t len    = _headerSize(header);
+  if (header & HEADER_ACCOUNTED) {
+    _accountFree(len, _headerSubsystem(header));
+  }
+  secFreeN(fp, len + sizeof(size_t));
 }
 /** @fn void secFree(void* p, size_t len)
  * @brief clears and frees allocated memory.
@@ -14,6 +14,48 @@ void            _secFreeArray(char** arr, size_t size);
 void*           oidc_memcopy(void* src, size_t size);
 void            oidc_memshiftr(void* src, size_t size);
 
+/**
+ * the subsystems allocations are accounted to; an allocation is accounted to
+ * the outermost subsystem entered with @c memory_enterSubsystem
+ */
+enum memorySubsystem {
+  MEMORY_OTHER,
+  MEMORY_IPC,
+  MEMORY_CRYPT,
+  MEMORY_JSON,
+  MEMORY_HTTP,
+  MEMORY_DB,
+  MEMORY_SUBSYSTEMS
+};
+
+/**
+ * allocations are counted in size classes of up to 16, 64, 256, ... bytes; the
+ * last class holds all larger allocations
+ */
+#define MEMORY_SIZE_CLASSES 8
+
+struct memorySubsystemStats {
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t allocations;
+  size_t frees;
+  size_t size_classes[MEMORY_SIZE_CLASSES];
+};
+
+struct memoryStats {
+  size_t                      live_bytes;
+  size_t                      peak_bytes;
+  struct memorySubsystemStats subsystems[MEMORY_SUBSYSTEMS];
+};
+
+void                 memory_enableAccounting(int enable);
+int                  memory_accountingEnabled();
+enum memorySubsystem memory_enterSubsystem(enum memorySubsystem subsystem);
+void                 memory_leaveSubsystem(enum memorySubsystem previous);
+void                 memory_getStats(struct memoryStats* stats);
+const char*          memory_subsystemName(enum memorySubsystem subsystem);
+size_t               memory_sizeClassLimit(int size_class);
+
 #ifndef secFree
 #define secFree(ptr) \
   do {               \
@@ -9,8 +9,10 @@
 #include <stdio.h>
 #include <string.h>
 
-int  oidc_errno;
-char oidc_error[1024];
+// thread local, so that threads (e.g. the oidcr worker pool) do not see each
+// others errors
+__thread int  oidc_errno;
+__thread char oidc_error[1024];
 
 void oidc_seterror(const char* error) {
   moresecure_memzero(oidc_error, sizeof(oidc_error));
@@ -70,6 +72,9 @@ char* oidc_serrorFor(oidc_error_t err) {
     case OIDC_EJSONADD: return "The json string does not end with '}'";
     case OIDC_EJSONMERGE: return "Cannot merge json objects";
     case OIDC_EJSONTYPE: return "Unknown cJSON Type";
+    case OIDC_EBINFMT: return "Malformed binary account record";
+    case OIDC_EBINVER:
+      return "Binary account record was written by a newer version";
     case OIDC_ETCS: return "error tcsetattr";
     case OIDC_EIN: return "error getline";
     case OIDC_EBADCONFIG: return "bad configuration";
@@ -92,6 +97,17 @@ char* oidc_serrorFor(oidc_error_t err) {
     case OIDC_EIPCDIS: return "the other party disconnected";
     case OIDC_ETIMEOUT: return "reached timeout";
     case OIDC_EGROUPNF: return "Group does not exist";
+    case OIDC_ENOLISTENFD: return "No listening socket passed";
+    case OIDC_EMULTIUSER: return "Not possible in multi-user mode";
+    case OIDC_EPLAINIPC: return "Unencrypted request not allowed";
+    case OIDC_ENOBINIPC:
+      return "The other party does not support binary ipc messages";
+    case OIDC_EMAXCONS: return "Agent is busy: too many connections";
+    case OIDC_EPEERQUOTA:
+      return "Too many concurrent connections from this user";
+    case OIDC_ERATELIMIT: return "Request rate limit exceeded";
+    case OIDC_ECANCELED: return "Request cancelled: client disconnected";
+    case OIDC_EINTR: return "Interrupted by a signal";
     case OIDC_ESELECT: return "error select";
     case OIDC_EMAXTRIES: return "reached maximum number of tries";
     case OIDC_ENOACCOUNT: return "No account configured with that short name";
@@ -112,6 +128,8 @@ char* oidc_serrorFor(oidc_error_t err) {
              "flag.";
     case OIDC_ENOSUPREV:
       return "Token revocation is not supported by this issuer.";
+    case OIDC_ENOSUPUSERINFO:
+      return "The userinfo endpoint is not supported by this issuer.";
     case OIDC_ENOPUBCLIENT: return "No public client found for this issuer";
     case OIDC_ELOCKED: return "Agent locked";
     case OIDC_ENOTLOCKED: return "Agent not locked";
@@ -35,6 +35,8 @@ enum _oidc_error {
   OIDC_EJSONADD     = -34,
   OIDC_EJSONMERGE   = -35,
   OIDC_EJSONTYPE    = -36,
+  OIDC_EBINFMT      = -37,
+  OIDC_EBINVER      = -38,
 
   OIDC_ETCS = -40,
   OIDC_EIN  = -41,
@@ -48,18 +50,27 @@ enum _oidc_error {
   OIDC_EUNSCOPE   = -56,
   OIDC_EPORTRANGE = -57,
 
-  OIDC_EMKTMP   = -60,
-  OIDC_EENVVAR  = -61,
-  OIDC_EBIND    = -62,
-  OIDC_ECONSOCK = -63,
-  OIDC_ECRSOCK  = -64,
-  OIDC_ESOCKINV = -65,
-  OIDC_EIPCDIS  = -66,
-  OIDC_EMSGSIZE = -67,
-  OIDC_ESELECT  = -68,
-  OIDC_EIOCTL   = -69,
-  OIDC_ETIMEOUT = -600,
-  OIDC_EGROUPNF = -601,
+  OIDC_EMKTMP      = -60,
+  OIDC_EENVVAR     = -61,
+  OIDC_EBIND       = -62,
+  OIDC_ECONSOCK    = -63,
+  OIDC_ECRSOCK     = -64,
+  OIDC_ESOCKINV    = -65,
+  OIDC_EIPCDIS     = -66,
+  OIDC_EMSGSIZE    = -67,
+  OIDC_ESELECT     = -68,
+  OIDC_EIOCTL      = -69,
+  OIDC_ETIMEOUT    = -600,
+  OIDC_EGROUPNF    = -601,
+  OIDC_ENOLISTENFD = -602,
+  OIDC_EMULTIUSER  = -603,
+  OIDC_EPLAINIPC   = -604,
+  OIDC_ENOBINIPC   = -605,
+  OIDC_EMAXCONS    = -606,
+  OIDC_EPEERQUOTA  = -607,
+  OIDC_ERATELIMIT  = -608,
+  OIDC_ECANCELED   = -609,
+  OIDC_EINTR       = -610,
 
   OIDC_EMAXTRIES  = -70,
   OIDC_ENOACCOUNT = -71,
@@ -76,8 +87,9 @@ enum _oidc_error {
 
   OIDC_ENOPRIVCONF = -90,
 
-  OIDC_ENOSUPREG = -100,
-  OIDC_ENOSUPREV = -101,
+  OIDC_ENOSUPREG      = -100,
+  OIDC_ENOSUPREV      = -101,
+  OIDC_ENOSUPUSERINFO = -102,
 
   OIDC_ENOPUBCLIENT = -106,
 
@@ -98,8 +110,8 @@ enum _oidc_error {
 
 typedef enum _oidc_error oidc_error_t;
 
-extern int  oidc_errno;
-extern char oidc_error[1024];
+extern __thread int  oidc_errno;
+extern __thread char oidc_error[1024];
 
 struct oidc_error_state {
   int   oidc_errno;
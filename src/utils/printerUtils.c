@@ -8,12 +8,16 @@
 #include <sys/types.h>
 
 void printEnvs(const char* daemon_socket, pid_t daemon_pid, unsigned char quiet,
-               unsigned char json) {
+               unsigned char json, unsigned char fast_ipc) {
   if (!json) {
     if (daemon_socket != NULL) {
       printStdout("%s=%s; export %s;\n", OIDC_SOCK_ENV_NAME, daemon_socket,
                   OIDC_SOCK_ENV_NAME);
     }
+    if (fast_ipc) {
+      printStdout("%s=1; export %s;\n", OIDC_FAST_IPC_ENV_NAME,
+                  OIDC_FAST_IPC_ENV_NAME);
+    }
     if (daemon_pid != 0) {
       printStdout("%s=%d; export %s;\n", OIDC_PID_ENV_NAME, daemon_pid,
                   OIDC_PID_ENV_NAME);
@@ -25,7 +29,8 @@ void printEnvs(const char* daemon_socket, pid_t daemon_pid, unsigned char quiet,
     char*  pid_str = oidc_sprintf("%d", daemon_pid);
     cJSON* jsonP =
         generateJSONObject("socket", cJSON_String, daemon_socket ?: "", "dpid",
-                           cJSON_String, pid_str, NULL);
+                           cJSON_String, pid_str, "fast_ipc", cJSON_Number,
+                           (long)fast_ipc, NULL);
     secFree(pid_str);
     char* jsonPrint = jsonToString(jsonP);
     secFreeJson(jsonP);
@@ -4,6 +4,6 @@
 #include <sys/types.h>
 
 void printEnvs(const char* daemon_socket, pid_t daemon_pid, unsigned char quiet,
-               unsigned char json);
+               unsigned char json, unsigned char fast_ipc);
 
 #endif  // PRINTER_UTILS_H
@@ -1,9 +1,6 @@
 #include "pubClientInfos.h"
 
-#include "account/issuer_helper.h"
-#include "defines/settings.h"
-#include "utils/file_io/file_io.h"
-#include "utils/file_io/oidc_file_io.h"
+#include "utils/file_io/configCache.h"
 #include "utils/listUtils.h"
 #include "utils/memory.h"
 #include "utils/stringUtils.h"
@@ -20,45 +17,58 @@ void secFreePubClientInfos(struct pubClientInfos* p) {
   secFree(p);
 }
 
-struct pubClientInfos* _getPubClientInfosFromList(list_t*     lines,
-                                                  const char* issuer) {
-  if (lines == NULL) {
+/**
+ * @brief parses a pubclients.config line
+ * Lines have the format "client_id:client_secret@issuer@scope".
+ */
+static struct pubClientInfos* _parsePubClientLine(const char* line) {
+  if (line == NULL) {
     return NULL;
   }
-  list_node_t*     node;
-  list_iterator_t* it = list_iterator_new(lines, LIST_HEAD);
-  while ((node = list_iterator_next(it))) {
-    char* client = strtok(node->val, "@");
-    char* iss    = strtok(NULL, "@");
-    char* scope  = strtok(NULL, "@");
-    // logger(DEBUG, "Found public client for '%s'", iss);
-    if (compIssuerUrls(issuer, iss)) {
-      char*                  client_id     = strtok(client, ":");
-      char*                  client_secret = strtok(NULL, ":");
-      struct pubClientInfos* infos = secAlloc(sizeof(struct pubClientInfos));
-      infos->client_id             = oidc_strcopy(client_id);
-      infos->client_secret         = oidc_strcopy(client_secret);
-      infos->scope                 = oidc_strcopy(scope);
-      list_iterator_destroy(it);
-      return infos;
+  size_t      len = strlen(line);
+  const char* end = line + len;
+  const char* at  = memchr(line, '@', len);
+  if (at == NULL) {
+    return NULL;
+  }
+  const char* iss     = at + 1;
+  const char* iss_end = memchr(iss, '@', end - iss) ?: end;
+  const char* colon   = memchr(line, ':', at - line);
+  const char* id_end  = colon ?: at;
+
+  struct pubClientInfos* infos = secAlloc(sizeof(struct pubClientInfos));
+  if (id_end > line) {
+    infos->client_id = oidc_strncopy(line, id_end - line);
+  }
+  if (colon && at - colon > 1) {
+    const char* secret     = colon + 1;
+    const char* secret_end = memchr(secret, ':', at - secret) ?: at;
+    if (secret_end > secret) {
+      infos->client_secret = oidc_strncopy(secret, secret_end - secret);
     }
   }
-  list_iterator_destroy(it);
-  return NULL;
+  if (end - iss_end > 1) {
+    const char* scope     = iss_end + 1;
+    const char* scope_end = memchr(scope, '@', end - scope) ?: end;
+    if (scope_end > scope) {
+      infos->scope = oidc_strncopy(scope, scope_end - scope);
+    }
+  }
+  return infos;
 }
 
+/**
+ * @brief looks up the public client for @p issuer
+ * The client from the global pubclients.config is preferred over the one from
+ * the user's. Both files are kept indexed in memory by @c configCache.
+ */
 struct pubClientInfos* getPubClientInfos(const char* issuer) {
-  list_t* pubClientLines =
-      getLinesFromFileWithoutComments(ETC_PUBCLIENTS_CONFIG_FILE);
-  struct pubClientInfos* infos =
-      _getPubClientInfosFromList(pubClientLines, issuer);
-  secFreeList(pubClientLines);
-  if (infos != NULL) {
-    return infos;
+  char* line = configCache_getLine(CONFIG_CACHE_ETC_PUBCLIENTS, issuer);
+  if (line == NULL) {
+    line = configCache_getLine(CONFIG_CACHE_PUBCLIENTS, issuer);
   }
-  pubClientLines = getLinesFromOidcFileWithoutComments(PUBCLIENTS_FILENAME);
-  infos          = _getPubClientInfosFromList(pubClientLines, issuer);
-  secFreeList(pubClientLines);
+  struct pubClientInfos* infos = _parsePubClientLine(line);
+  secFree(line);
   return infos;
 }
 
@@ -104,8 +104,19 @@ char* oidc_strncopy(const char* str, int len) {
     oidc_setArgNullFuncError(__func__);
     return NULL;
   }
-  int len_str = (int)strlen(str);
-  return oidc_sprintf("%.*s", len_str < len ? len_str : len, str);
+  if (len < 0) {
+    return oidc_strcopy(str);
+  }
+  // str does not have to be nullterminated within len, e.g. for mapped files
+  const char* end = memchr(str, '\0', len);
+  size_t      n   = end ? (size_t)(end - str) : (size_t)len;
+  char*       s   = secAlloc(n + 1);
+  if (s == NULL) {
+    oidc_errno = OIDC_EALLOC;
+    return NULL;
+  }
+  memcpy(s, str, n);
+  return s;
 }
 
 /** @fn char* getDateString()
@@ -0,0 +1,260 @@
+#include "vector.h"
+#include "utils/memory.h"
+#include "utils/memzero.h"
+#include "utils/stringUtils.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+vector_t* vector_newWithCapacity(size_t cap) {
+  vector_t* v = secAlloc(sizeof(vector_t));
+  if (v == NULL) {
+    return NULL;
+  }
+  if (vector_reserve(v, cap < VECTOR_MIN_CAPACITY ? VECTOR_MIN_CAPACITY
+                                                  : cap) != OIDC_SUCCESS) {
+    secFree(v);
+    return NULL;
+  }
+  return v;
+}
+
+vector_t* vector_new() { return vector_newWithCapacity(VECTOR_MIN_CAPACITY); }
+
+/**
+ * @brief makes sure that @p v can hold at least @p cap values without growing
+ * @note the old array is cleared when it is replaced
+ */
+oidc_error_t vector_reserve(vector_t* v, size_t cap) {
+  if (v == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+  if (cap <= v->cap) {
+    return OIDC_SUCCESS;
+  }
+  void** data = secRealloc(v->data, cap * sizeof(void*));
+  if (data == NULL) {
+    return oidc_errno;
+  }
+  v->data = data;
+  v->cap  = cap;
+  return OIDC_SUCCESS;
+}
+
+/**
+ * @brief appends @p value to @p v; the capacity is doubled if needed
+ */
+oidc_error_t vector_push(vector_t* v, void* value) {
+  if (v == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return oidc_errno;
+  }
+  if (v->len == v->cap) {
+    oidc_error_t e =
+        vector_reserve(v, v->cap ? 2 * v->cap : VECTOR_MIN_CAPACITY);
+    if (e != OIDC_SUCCESS) {
+      return e;
+    }
+  }
+  v->data[v->len++] = value;
+  return OIDC_SUCCESS;
+}
+
+void* vector_at(const vector_t* v, size_t i) {
+  if (v == NULL || i >= v->len) {
+    return NULL;
+  }
+  return v->data[i];
+}
+
+void* vector_last(const vector_t* v) {
+  if (v == NULL || v->len == 0) {
+    return NULL;
+  }
+  return v->data[v->len - 1];
+}
+
+static int _matches(const vector_t* v, const void* key, const void* value) {
+  return v->match ? v->match(key, value) : key == value;
+}
+
+/**
+ * @brief finds the first value in @p v that matches @p key using the match
+ * function of @p v (or pointer equality if there is none)
+ * @return the index of the value or @c VECTOR_NOT_FOUND
+ */
+size_t vector_findIndex(const vector_t* v, const void* key) {
+  if (v == NULL) {
+    return VECTOR_NOT_FOUND;
+  }
+  for (size_t i = 0; i < v->len; i++) {
+    if (_matches(v, key, v->data[i])) {
+      return i;
+    }
+  }
+  return VECTOR_NOT_FOUND;
+}
+
+void* vector_find(const vector_t* v, const void* key) {
+  size_t i = vector_findIndex(v, key);
+  return i == VECTOR_NOT_FOUND ? NULL : v->data[i];
+}
+
+/**
+ * @brief finds all values in @p v that match @p key
+ * @return a vector of the matching values or @c NULL if there are none. The
+ * values are not copied and are not freed with the returned vector.
+ */
+vector_t* vector_findAll(const vector_t* v, const void* key) {
+  if (v == NULL || key == NULL) {
+    return NULL;
+  }
+  vector_t* founds = NULL;
+  for (size_t i = 0; i < v->len; i++) {
+    if (_matches(v, key, v->data[i])) {
+      if (founds == NULL) {
+        founds        = vector_new();
+        founds->match = v->match;
+      }
+      vector_push(founds, v->data[i]);
+    }
+  }
+  return founds;
+}
+
+/**
+ * @brief removes the value at index @p i, keeping the order of the other
+ * values; the value is freed with the free function of @p v
+ */
+void vector_removeAt(vector_t* v, size_t i) {
+  if (v == NULL || i >= v->len) {
+    return;
+  }
+  void* value = v->data[i];
+  memmove(v->data + i, v->data + i + 1, (v->len - i - 1) * sizeof(void*));
+  v->len--;
+  v->data[v->len] = NULL;
+  if (v->free) {
+    v->free(value);
+  }
+}
+
+void vector_removeIfFound(vector_t* v, const void* key) {
+  if (key == NULL) {
+    return;
+  }
+  vector_removeAt(v, vector_findIndex(v, key));
+}
+
+/**
+ * @brief removes all values from @p v and frees them with the free function of
+ * @p v; the capacity is kept
+ */
+void vector_clear(vector_t* v) {
+  if (v == NULL) {
+    return;
+  }
+  if (v->free) {
+    for (size_t i = 0; i < v->len; i++) { v->free(v->data[i]); }
+  }
+  moresecure_memzero(v->data, v->len * sizeof(void*));
+  v->len = 0;
+}
+
+void secFreeVector(vector_t* v) {
+  if (v == NULL) {
+    return;
+  }
+  vector_clear(v);
+  secFree(v->data);
+  secFree(v);
+}
+
+/**
+ * @brief creates a vector of strings, like @c createList
+ * @param copyValues if @c LIST_CREATE_COPY_VALUES the strings are copied and
+ * freed with the vector
+ * @param s the first string; the last argument has to be @c NULL
+ */
+vector_t* createVector(int copyValues, char* s, ...) {
+  vector_t* v = vector_new();
+  v->match    = (matchFunction)strequal;
+  if (copyValues) {
+    v->free = (freeFunction)_secFree;
+  }
+  if (s == NULL) {
+    return v;
+  }
+  va_list args;
+  va_start(args, s);
+  for (char* a = s; a != NULL; a = va_arg(args, char*)) {
+    vector_push(v, copyValues ? oidc_strcopy(a) : a);
+  }
+  va_end(args);
+  return v;
+}
+
+/**
+ * @brief creates a vector with the values of @p list
+ * @return a vector holding the same value pointers; the match function is
+ * taken over, the free function is not
+ */
+vector_t* listToVector(list_t* list) {
+  if (list == NULL) {
+    return NULL;
+  }
+  vector_t* v = vector_newWithCapacity(list->len);
+  v->match    = list->match;
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(list, LIST_HEAD);
+  while ((node = list_iterator_next(it))) { vector_push(v, node->val); }
+  list_iterator_destroy(it);
+  return v;
+}
+
+/**
+ * @brief creates a list with the values of @p v
+ * @return a list holding the same value pointers; the match function is taken
+ * over, the free function is not
+ */
+list_t* vectorToList(const vector_t* v) {
+  if (v == NULL) {
+    return NULL;
+  }
+  list_t* list = list_new();
+  list->match  = v->match;
+  vector_foreach(v, i) { list_rpush(list, list_node_new(v->data[i])); }
+  return list;
+}
+
+/**
+ * @brief joins the strings in @p v with @p delimiter
+ * @return the joined string; it has to be freed after usage
+ */
+char* vectorToDelimitedString(const vector_t* v, const char* delimiter) {
+  if (v == NULL || delimiter == NULL) {
+    oidc_setArgNullFuncError(__func__);
+    return NULL;
+  }
+  size_t del_len = strlen(delimiter);
+  size_t len     = 0;
+  vector_foreach(v, i) {
+    len += strlen(v->data[i]) + (i ? del_len : 0);
+  }
+  char* str = secAlloc(len + 1);
+  if (str == NULL) {
+    return NULL;
+  }
+  char* p = str;
+  vector_foreach(v, i) {
+    if (i) {
+      memcpy(p, delimiter, del_len);
+      p += del_len;
+    }
+    size_t l = strlen(v->data[i]);
+    memcpy(p, v->data[i], l);
+    p += l;
+  }
+  return str;
+}
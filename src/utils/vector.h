@@ -0,0 +1,48 @@
+#ifndef OIDC_VECTOR_H
+#define OIDC_VECTOR_H
+
+#include "utils/listUtils.h"
+#include "utils/oidc_error.h"
+
+#include <stddef.h>
+
+/**
+ * A dynamic array of pointers. The values are stored contiguously, so indexed
+ * access is constant time and iterating does not chase node pointers. Like a
+ * @c list_t a vector has an optional match function used to find values and an
+ * optional free function called for values that are removed. The array itself
+ * is cleared before it is freed or moved on growth.
+ */
+typedef struct vector {
+  void**        data;
+  size_t        len;
+  size_t        cap;
+  matchFunction match;
+  freeFunction  free;
+} vector_t;
+
+#define VECTOR_MIN_CAPACITY 4
+#define VECTOR_NOT_FOUND ((size_t)-1)
+
+#define vector_foreach(v, i) \
+  for (size_t i = 0; (v) != NULL && i < (v)->len; i++)
+
+vector_t*    vector_new();
+vector_t*    vector_newWithCapacity(size_t cap);
+oidc_error_t vector_reserve(vector_t* v, size_t cap);
+oidc_error_t vector_push(vector_t* v, void* value);
+void*        vector_at(const vector_t* v, size_t i);
+void*        vector_last(const vector_t* v);
+size_t       vector_findIndex(const vector_t* v, const void* key);
+void*        vector_find(const vector_t* v, const void* key);
+vector_t*    vector_findAll(const vector_t* v, const void* key);
+void         vector_removeAt(vector_t* v, size_t i);
+void         vector_removeIfFound(vector_t* v, const void* key);
+void         vector_clear(vector_t* v);
+void         secFreeVector(vector_t* v);
+vector_t*    createVector(int copyValues, char* s, ...);
+vector_t*    listToVector(list_t* list);
+list_t*      vectorToList(const vector_t* v);
+char*        vectorToDelimitedString(const vector_t* v, const char* delimiter);
+
+#endif  // OIDC_VECTOR_H
@@ -0,0 +1,119 @@
+/**
+ * Measures the serialization of a fully configured account: the json round
+ * trip (accountToJSONString and getAccountFromJSON) versus the binary round
+ * trip (accountToBinary and getAccountFromBinary). Every round trip also
+ * reports its size and number of allocations.
+ */
+#define _XOPEN_SOURCE 700
+#include "account/account.h"
+#include "account/account_binary.h"
+#include "account/setandget.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 100000
+
+static double now_us() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+/** returns the number of allocations so far */
+static size_t allocations() {
+  struct memoryStats stats;
+  memory_getStats(&stats);
+  size_t n = 0;
+  for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+    n += stats.subsystems[i].allocations;
+  }
+  return n;
+}
+
+static struct oidc_account* createAccount() {
+  struct oidc_account* p   = secAlloc(sizeof(struct oidc_account));
+  struct oidc_issuer*  iss = secAlloc(sizeof(struct oidc_issuer));
+  issuer_setIssuerUrl(iss, oidc_strcopy("https://op.example.org/"));
+  issuer_setDeviceAuthorizationEndpoint(
+      iss, oidc_strcopy("https://op.example.org/device"), 1);
+  account_setIssuer(p, iss);
+  account_setName(p, oidc_strcopy("example"), NULL);
+  account_setClientName(p, oidc_strcopy("oidc-agent:example-host"));
+  account_setClientId(p, oidc_strcopy("0f1b2a6e-6d3c-4c53-9a5f-6f1d3c2b1a0e"));
+  account_setClientSecret(p, oidc_strcopy("Zm9vYmFyYmF6cXV4cXV1eGNvcmdl"
+                                          "Z3JhdWx0Z2FycGx5d2FsZG9mcmVk"));
+  account_setScopeExact(p, oidc_strcopy("openid profile email offline_access"));
+  account_setAudience(p, oidc_strcopy("https://api.example.org"));
+  account_setUsername(p, oidc_strcopy("jdoe"));
+  account_setRefreshToken(
+      p, oidc_strcopy("eyJhbGciOiJub25lIn0.eyJleHAiOjE3MDAwMDAwMDAsImp0aSI6Ij"
+                      "EyMzQ1Njc4OTAiLCJzdWIiOiJqZG9lIn0."));
+  account_setCertPath(p, oidc_strcopy("/etc/ssl/certs/ca-certificates.crt"));
+  account_setRedirectUris(
+      p, createList(1, "http://localhost:4242", "http://localhost:8080",
+                    "edu.kit.data.oidc-agent:/redirect", NULL));
+  return p;
+}
+
+static int sameAccount(const struct oidc_account* a,
+                       const struct oidc_account* b) {
+  return strequal(account_getName(a), account_getName(b)) &&
+         strequal(account_getIssuerUrl(a), account_getIssuerUrl(b)) &&
+         strequal(account_getClientId(a), account_getClientId(b)) &&
+         strequal(account_getClientSecret(a), account_getClientSecret(b)) &&
+         strequal(account_getScope(a), account_getScope(b)) &&
+         strequal(account_getRefreshToken(a), account_getRefreshToken(b)) &&
+         strequal(account_getDeviceAuthorizationEndpoint(a),
+                  account_getDeviceAuthorizationEndpoint(b)) &&
+         account_getRedirectUrisCount(a) == account_getRedirectUrisCount(b);
+}
+
+static int benchRoundTrip(const struct oidc_account* account) {
+  int    failed = 0;
+  size_t allocs = allocations();
+  size_t size   = 0;
+  double start  = now_us();
+  for (int i = 0; i < ROUNDS; i++) {
+    char*                json = accountToJSONString(account);
+    struct oidc_account* copy = getAccountFromJSON(json);
+    size                      = strlen(json);
+    failed |= i == 0 && !sameAccount(account, copy);
+    secFree(json);
+    secFreeAccount(copy);
+  }
+  const double json_us     = (now_us() - start) / ROUNDS;
+  const size_t json_allocs = (allocations() - allocs) / ROUNDS;
+  const size_t json_size   = size;
+
+  allocs = allocations();
+  start  = now_us();
+  for (int i = 0; i < ROUNDS; i++) {
+    unsigned char*       bin  = accountToBinary(account, &size);
+    struct oidc_account* copy = getAccountFromBinary(bin, size);
+    failed |= i == 0 && !sameAccount(account, copy);
+    secFree(bin);
+    secFreeAccount(copy);
+  }
+  const double bin_us     = (now_us() - start) / ROUNDS;
+  const size_t bin_allocs = (allocations() - allocs) / ROUNDS;
+
+  printf("round trip: json %6.2f us, %4lu bytes, %3lu allocations; "
+         "binary %6.2f us, %4lu bytes, %3lu allocations%s\n",
+         json_us, json_size, json_allocs, bin_us, size, bin_allocs,
+         failed ? " (FAILED)" : "");
+  return failed;
+}
+
+int main() {
+  memory_enableAccounting(1);
+  struct oidc_account* account = createAccount();
+  int                  failed  = benchRoundTrip(account);
+  secFreeAccount(account);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/**
+ * Measures the throughput of the base64 codec for every implementation the cpu
+ * supports against libsodium, for sizes typical for the agent: ipc public keys
+ * and nonces, memory encrypted fields, ipc messages and config file ciphers.
+ * The output of every implementation is checked against libsodium.
+ */
+#define _XOPEN_SOURCE 700
+#include "utils/crypt/base64.h"
+
+#include <sodium.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BYTES_PER_SIZE (64 * 1024 * 1024)
+
+static double now_us() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static double mib_per_s(size_t bytes, double us) {
+  return bytes / (1024.0 * 1024.0) / (us / 1e6);
+}
+
+/**
+ * @param impl the implementation to measure; @c BASE64_IMPL_AUTO measures
+ * libsodium
+ */
+static int bench(enum base64_implementation impl, size_t len) {
+  const int      variant = sodium_base64_VARIANT_ORIGINAL;
+  const size_t   b64_len = sodium_base64_ENCODED_LEN(len, variant);
+  const int      rounds  = BYTES_PER_SIZE / len;
+  unsigned char* bin     = malloc(len);
+  unsigned char* out     = malloc(len);
+  char*          b64     = malloc(b64_len);
+  char*          ref     = malloc(b64_len);
+  randombytes_buf(bin, len);
+  sodium_bin2base64(ref, b64_len, bin, len, variant);
+  const char* name = "libsodium";
+  if (impl != BASE64_IMPL_AUTO) {
+    base64_useImplementation(impl);
+    name = base64_implementationName();
+  }
+
+  double start = now_us();
+  for (int i = 0; i < rounds; i++) {
+    if (impl == BASE64_IMPL_AUTO) {
+      sodium_bin2base64(b64, b64_len, bin, len, variant);
+    } else {
+      base64_encode(b64, bin, len, variant);
+    }
+  }
+  const double encode_us = now_us() - start;
+  int          failed    = strcmp(b64, ref) != 0;
+
+  start = now_us();
+  for (int i = 0; i < rounds; i++) {
+    if (impl == BASE64_IMPL_AUTO) {
+      sodium_base642bin(out, len, b64, b64_len - 1, NULL, NULL, NULL, variant);
+    } else {
+      base64_decode(out, len, b64, b64_len - 1, NULL, variant);
+    }
+  }
+  const double decode_us = now_us() - start;
+  failed |= memcmp(out, bin, len) != 0;
+
+  printf("%-9s %8lu bytes: encode %8.1f MiB/s, decode %8.1f MiB/s%s\n", name,
+         (unsigned long)len, mib_per_s((size_t)rounds * len, encode_us),
+         mib_per_s((size_t)rounds * len, decode_us),
+         failed ? " (FAILED)" : "");
+  free(bin);
+  free(out);
+  free(b64);
+  free(ref);
+  return failed;
+}
+
+int main() {
+  if (sodium_init() < 0) {
+    return EXIT_FAILURE;
+  }
+  const size_t sizes[] = {32, 256, 4096, 64 * 1024};
+  const enum base64_implementation impls[] = {
+      BASE64_IMPL_AUTO, BASE64_IMPL_SCALAR, BASE64_IMPL_SSE41,
+      BASE64_IMPL_AVX2};
+  int failed = 0;
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    for (size_t i = 0; i < sizeof(impls) / sizeof(*impls); i++) {
+      if (impls[i] != BASE64_IMPL_AUTO && !base64_useImplementation(impls[i])) {
+        continue;
+      }
+      failed |= bench(impls[i], sizes[s]);
+    }
+  }
+  base64_useImplementation(BASE64_IMPL_AUTO);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/**
+ * Measures reading large pubclients.config and issuer.config files: looking up
+ * the last entry by copying all lines into a list (as done before) versus
+ * the in-memory issuer index of configCache, and resolving paths in the oidc
+ * dir by probing the directory versus using the cached oidc dir. Lookups
+ * also report the number of allocations they make.
+ */
+#define _XOPEN_SOURCE 700
+#include "account/issuer_helper.h"
+#include "defines/settings.h"
+#include "utils/file_io/file_io.h"
+#include "utils/file_io/oidc_file_io.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/pubClientInfos.h"
+#include "utils/stringUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LINES 20000
+// the old deduplication of suggestable issuers was quadratic in the lines
+#define ISSUER_LINES 2000
+#define ROUNDS 50
+#define PATH_ROUNDS 100000
+
+static double now_us() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static void writeConfigs(const char* dir) {
+  char* pubclients = oidc_sprintf("%s/%s", dir, PUBCLIENTS_FILENAME);
+  char* issuers    = oidc_sprintf("%s/%s", dir, ISSUER_CONFIG_FILENAME);
+  FILE* p          = fopen(pubclients, "w");
+  FILE* i          = fopen(issuers, "w");
+  for (int n = 0; n < LINES; n++) {
+    if (n % 10 == 0) {
+      fprintf(p, "# public clients of provider group %d\n", n / 10);
+    }
+    fprintf(p, "client-%d:secret-%d@https://op%d.example.org/@openid profile "
+               "offline_access\n",
+            n, n, n);
+    if (n < ISSUER_LINES) {
+      fprintf(i, "https://op%d.example.org/ account%d\n", n, n);
+    }
+  }
+  fclose(p);
+  fclose(i);
+  secFree(pubclients);
+  secFree(issuers);
+}
+
+/** the lookup as it was done before: copy all lines, then strtok them */
+static char* listLookup(const char* filename, const char* issuer) {
+  list_t* lines  = getLinesFromOidcFileWithoutComments(filename);
+  char*   client = NULL;
+  if (lines == NULL) {
+    return NULL;
+  }
+  list_node_t*     node;
+  list_iterator_t* it = list_iterator_new(lines, LIST_HEAD);
+  while ((node = list_iterator_next(it))) {
+    char* c   = strtok(node->val, "@");
+    char* iss = strtok(NULL, "@");
+    if (iss && compIssuerUrls(issuer, iss)) {
+      client = oidc_strcopy(strtok(c, ":"));
+      break;
+    }
+  }
+  list_iterator_destroy(it);
+  secFreeList(lines);
+  return client;
+}
+
+/** returns the number of allocations so far */
+static size_t allocations() {
+  struct memoryStats stats;
+  memory_getStats(&stats);
+  size_t n = 0;
+  for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+    n += stats.subsystems[i].allocations;
+  }
+  return n;
+}
+
+static int benchLookup(const char* issuer, const char* expected) {
+  int    failed = 0;
+  size_t allocs = allocations();
+  double start  = now_us();
+  for (int r = 0; r < ROUNDS; r++) {
+    char* client = listLookup(PUBCLIENTS_FILENAME, issuer);
+    failed += client == NULL || strcmp(client, expected) != 0;
+    secFree(client);
+  }
+  double list        = (now_us() - start) / ROUNDS;
+  size_t list_allocs = allocations() - allocs;
+  allocs             = allocations();
+  start              = now_us();
+  for (int r = 0; r < ROUNDS; r++) {
+    struct pubClientInfos* infos = getPubClientInfos(issuer);
+    failed += infos == NULL || strcmp(infos->client_id, expected) != 0;
+    secFreePubClientInfos(infos);
+  }
+  double indexed        = (now_us() - start) / ROUNDS;
+  size_t indexed_allocs = allocations() - allocs;
+  printf("pubclients.config %6d lines: %9.1f us list, %9.1f us indexed "
+         "(%d failed)\n",
+         LINES, list, indexed, failed);
+  printf("pubclients.config %6d lines: %9lu allocations list, %9lu "
+         "allocations indexed per lookup\n",
+         LINES, list_allocs / ROUNDS, indexed_allocs / ROUNDS);
+  return failed;
+}
+
+static int benchIssuers() {
+  double start  = now_us();
+  int    failed = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    list_t* issuers = getSuggestableIssuers();
+    failed += issuers == NULL || issuers->len < ISSUER_LINES;
+    secFreeList(issuers);
+  }
+  double elapsed = (now_us() - start) / ROUNDS;
+  printf("issuer.config     %6d lines: %9.1f us suggestable issuers "
+         "(%d failed)\n",
+         ISSUER_LINES, elapsed, failed);
+  return failed;
+}
+
+static void benchPaths(const char* dir) {
+  double start = now_us();
+  for (int r = 0; r < PATH_ROUNDS; r++) {
+    // what every oidc file access did before: probe and normalize the dir
+    if (dirExists(dir) == OIDC_DIREXIST_OK) {
+      char* d    = withTrailingSlash(dir);
+      char* path = oidc_strcat(d, ISSUER_CONFIG_FILENAME);
+      secFree(path);
+      secFree(d);
+    }
+  }
+  double probed = (now_us() - start) * 1e3 / PATH_ROUNDS;
+  start         = now_us();
+  for (int r = 0; r < PATH_ROUNDS; r++) {
+    char* path = concatToOidcDir(ISSUER_CONFIG_FILENAME);
+    secFree(path);
+  }
+  double cached = (now_us() - start) * 1e3 / PATH_ROUNDS;
+  printf("oidc dir path resolution: %8.1f ns probed, %8.1f ns cached\n",
+         probed, cached);
+}
+
+int main() {
+  setlogmask(LOG_UPTO(LOG_ERR));
+  memory_enableAccounting(1);
+  char dir[] = "/tmp/oidc-bench-XXXXXX";
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return 1;
+  }
+  setenv(OIDC_CONFIG_DIR_ENV_NAME, dir, 1);
+  writeConfigs(dir);
+
+  int   failed = 0;
+  char* issuer = oidc_sprintf("https://op%d.example.org", LINES - 1);
+  char* client = oidc_sprintf("client-%d", LINES - 1);
+  failed |= benchLookup(issuer, client);
+  failed |= benchIssuers();
+  benchPaths(dir);
+  secFree(issuer);
+  secFree(client);
+
+  char* cmd = oidc_sprintf("rm -rf %s", dir);
+  if (system(cmd) != 0) {
+    fprintf(stderr, "could not remove %s\n", dir);
+  }
+  secFree(cmd);
+  return failed != 0;
+}
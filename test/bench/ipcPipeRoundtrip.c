@@ -0,0 +1,100 @@
+/**
+ * Measures the round trip latency of the internal channel between oidcp and
+ * oidcd: a forked child echoes every message, once over pipes and once over
+ * the shared memory rings (--shm-ipc). The allocations of the parent are
+ * accounted and reported per round trip.
+ */
+#define _XOPEN_SOURCE 700
+#include "ipc/pipe.h"
+#include "utils/memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ROUNDS 20000
+
+static void echo(struct ipcPipe pipes) {
+  char* msg;
+  while ((msg = ipc_readFromPipe(pipes)) != NULL) {
+    ipc_writeToPipe(pipes, "%s", msg);
+    secFree(msg);
+  }
+  exit(EXIT_SUCCESS);
+}
+
+static double now_us() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+/** returns the number of allocations so far and sets the peak of live bytes */
+static size_t allocations(size_t* peak_bytes) {
+  struct memoryStats stats;
+  memory_getStats(&stats);
+  size_t n = 0;
+  for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+    n += stats.subsystems[i].allocations;
+  }
+  *peak_bytes = stats.peak_bytes;
+  return n;
+}
+
+static int bench(unsigned char shm, size_t msg_len, int rounds) {
+  struct pipeSet set = shm ? ipc_pipe_initWithShm() : ipc_pipe_init();
+  if (set.pipe1.rx == -1 || (shm && set.shm == NULL)) {
+    fprintf(stderr, "could not set up %s\n", shm ? "shared memory" : "pipes");
+    return 1;
+  }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    echo(toClientPipes(set));
+  }
+  struct ipcPipe pipes = toServerPipes(set);
+  char*          msg   = secAlloc(msg_len + 1);
+  memset(msg, 'x', msg_len);
+  int    failed = 0;
+  size_t peak;
+  size_t allocs = allocations(&peak);
+  double start  = now_us();
+  for (int i = 0; i < rounds; i++) {
+    char* res = ipc_communicateThroughPipe(pipes, "%s", msg);
+    if (res == NULL || strcmp(res, msg) != 0) {
+      failed++;
+    }
+    secFree(res);
+  }
+  double elapsed = now_us() - start;
+  allocs         = allocations(&peak) - allocs;
+  ipc_closePipes(pipes);
+  waitpid(pid, NULL, 0);
+  secFree(msg);
+  printf("%-6s %8lu bytes: %8.2f us/roundtrip, %5.1f allocations/roundtrip, "
+         "%8lu bytes peak (%d failed)\n",
+         shm ? "shm" : "pipe", (unsigned long)msg_len, elapsed / rounds,
+         (double)allocs / rounds, peak, failed);
+  return failed != 0;
+}
+
+int main() {
+  setlogmask(LOG_UPTO(LOG_ERR));
+  memory_enableAccounting(1);
+  // a pipe write is only atomic up to PIPE_BUF; larger messages only work
+  // with the rings
+  const size_t pipe_sizes[] = {64, 1024, 4000};
+  const size_t shm_sizes[]  = {64, 1024, 4000, 256 * 1024};
+  int          failed       = 0;
+  for (size_t i = 0; i < sizeof(pipe_sizes) / sizeof(*pipe_sizes); i++) {
+    failed |= bench(0, pipe_sizes[i], ROUNDS);
+  }
+  for (size_t i = 0; i < sizeof(shm_sizes) / sizeof(*shm_sizes); i++) {
+    failed |= bench(1, shm_sizes[i], shm_sizes[i] > 4000 ? ROUNDS / 20 : ROUNDS);
+  }
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,8 @@
+#include "suite.h"
+#include "tc_getAccountFromBinary.h"
+
+Suite* test_suite_accountBinary() {
+  Suite* ts_accountBinary = suite_create("accountBinary");
+  suite_add_tcase(ts_accountBinary, test_case_getAccountFromBinary());
+  return ts_accountBinary;
+}
@@ -0,0 +1,130 @@
+#include "tc_getAccountFromBinary.h"
+
+#include "account/account.h"
+#include "account/account_binary.h"
+#include "account/setandget.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/oidc_error.h"
+#include "utils/stringUtils.h"
+
+#include <string.h>
+
+static struct oidc_account* _createAccount() {
+  struct oidc_account* p   = secAlloc(sizeof(struct oidc_account));
+  struct oidc_issuer*  iss = secAlloc(sizeof(struct oidc_issuer));
+  issuer_setIssuerUrl(iss, oidc_strcopy("https://op.example.org/"));
+  issuer_setDeviceAuthorizationEndpoint(
+      iss, oidc_strcopy("https://op.example.org/device"), 1);
+  account_setIssuer(p, iss);
+  account_setName(p, oidc_strcopy("example"), NULL);
+  account_setClientId(p, oidc_strcopy("client"));
+  account_setClientSecret(p, oidc_strcopy("secret"));
+  account_setScopeExact(p, oidc_strcopy("openid offline_access"));
+  account_setRefreshToken(p, oidc_strcopy("refresh_token"));
+  account_setTokenExpiresAt(p, 1700000000);
+  account_setRedirectUris(
+      p, createList(1, "http://localhost:4242", "http://localhost:8080", NULL));
+  return p;
+}
+
+static unsigned char* _encode(size_t* len) {
+  struct oidc_account* account = _createAccount();
+  unsigned char*       bin     = accountToBinary(account, len);
+  secFreeAccount(account);
+  ck_assert_ptr_ne(bin, NULL);
+  return bin;
+}
+
+/**
+ * @brief appends a field with @p tag to the record and fixes its length
+ */
+static unsigned char* _appendField(unsigned char* bin, size_t* len,
+                                   unsigned char tag) {
+  const char     value[] = "unknown";
+  const size_t   new_len = *len + ACCOUNT_BINARY_FIELD_HEADER_LEN + 7;
+  unsigned char* out     = secAlloc(new_len);
+  memcpy(out, bin, *len);
+  out[*len]     = tag;
+  out[*len + 1] = 7;
+  memcpy(out + *len + ACCOUNT_BINARY_FIELD_HEADER_LEN, value, 7);
+  out[4] = new_len & 0xFF;
+  out[5] = (new_len >> 8) & 0xFF;
+  out[6] = (new_len >> 16) & 0xFF;
+  out[7] = (new_len >> 24) & 0xFF;
+  secFree(bin);
+  *len = new_len;
+  return out;
+}
+
+START_TEST(test_roundTrip) {
+  size_t               len  = 0;
+  unsigned char*       bin  = _encode(&len);
+  struct oidc_account* copy = getAccountFromBinary(bin, len);
+  secFree(bin);
+  ck_assert_ptr_ne(copy, NULL);
+  ck_assert_str_eq(account_getName(copy), "example");
+  ck_assert_str_eq(account_getIssuerUrl(copy), "https://op.example.org/");
+  ck_assert_str_eq(account_getDeviceAuthorizationEndpoint(copy),
+                   "https://op.example.org/device");
+  ck_assert_str_eq(account_getClientId(copy), "client");
+  ck_assert_str_eq(account_getClientSecret(copy), "secret");
+  ck_assert_str_eq(account_getScope(copy), "openid offline_access");
+  ck_assert_str_eq(account_getRefreshToken(copy), "refresh_token");
+  ck_assert_uint_eq(account_getTokenExpiresAt(copy), 1700000000);
+  ck_assert_int_eq(account_getRedirectUrisCount(copy), 2);
+  ck_assert_ptr_eq(account_getUsername(copy), NULL);
+  secFreeAccount(copy);
+}
+END_TEST
+
+START_TEST(test_truncated) {
+  size_t         len = 0;
+  unsigned char* bin = _encode(&len);
+  for (size_t l = 0; l < len; l += 3) {
+    ck_assert_ptr_eq(getAccountFromBinary(bin, l), NULL);
+    ck_assert_int_eq(oidc_errno, OIDC_EBINFMT);
+  }
+  // a field running past the end of the record
+  bin[ACCOUNT_BINARY_HEADER_LEN + 1] = 0xFF;
+  ck_assert_ptr_eq(getAccountFromBinary(bin, len), NULL);
+  ck_assert_int_eq(oidc_errno, OIDC_EBINFMT);
+  secFree(bin);
+}
+END_TEST
+
+START_TEST(test_unknownTag) {
+  size_t         len = 0;
+  unsigned char* bin = _encode(&len);
+  bin                = _appendField(bin, &len, ACCOUNT_BINARY_MAX_TAG - 1);
+  bin                = _appendField(bin, &len, 0xFE);
+  struct oidc_account* copy = getAccountFromBinary(bin, len);
+  secFree(bin);
+  ck_assert_ptr_ne(copy, NULL);
+  ck_assert_str_eq(account_getName(copy), "example");
+  ck_assert_str_eq(account_getRefreshToken(copy), "refresh_token");
+  secFreeAccount(copy);
+}
+END_TEST
+
+START_TEST(test_newerVersion) {
+  size_t         len = 0;
+  unsigned char* bin = _encode(&len);
+  bin[3]             = ACCOUNT_BINARY_VERSION + 1;
+  ck_assert_ptr_eq(getAccountFromBinary(bin, len), NULL);
+  ck_assert_int_eq(oidc_errno, OIDC_EBINVER);
+  memcpy(bin, "OAX", 3);
+  ck_assert_ptr_eq(getAccountFromBinary(bin, len), NULL);
+  ck_assert_int_eq(oidc_errno, OIDC_EBINFMT);
+  secFree(bin);
+}
+END_TEST
+
+TCase* test_case_getAccountFromBinary() {
+  TCase* tc = tcase_create("getAccountFromBinary");
+  tcase_add_test(tc, test_roundTrip);
+  tcase_add_test(tc, test_truncated);
+  tcase_add_test(tc, test_unknownTag);
+  tcase_add_test(tc, test_newerVersion);
+  return tc;
+}
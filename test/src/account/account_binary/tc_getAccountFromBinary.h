@@ -0,0 +1,8 @@
+#ifndef TEST_ACCOUNT_ACCOUNTBINARY_GETACCOUNTFROMBINARY_H
+#define TEST_ACCOUNT_ACCOUNTBINARY_GETACCOUNTFROMBINARY_H
+
+#include <check.h>
+
+TCase* test_case_getAccountFromBinary();
+
+#endif  // TEST_ACCOUNT_ACCOUNTBINARY_GETACCOUNTFROMBINARY_H
@@ -0,0 +1,9 @@
+#include "suite.h"
+#include "tc_server_ipc_cryptReadBinary.h"
+
+Suite* test_suite_cryptIpc() {
+  Suite* ts_cryptIpc = suite_create("cryptIpc");
+  suite_add_tcase(ts_cryptIpc, test_case_server_ipc_cryptReadBinary());
+
+  return ts_cryptIpc;
+}
@@ -0,0 +1,87 @@
+#include "tc_server_ipc_cryptReadBinary.h"
+
+#include "ipc/cryptIpc.h"
+#include "ipc/ipc.h"
+#include "utils/crypt/ipcCryptUtils.h"
+#include "utils/memory.h"
+
+#include <pthread.h>
+#include <sodium.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define REQUEST "{\"request\":\"access_token\"}"
+
+struct client {
+  int                   sock;
+  unsigned char         encrypt;
+  struct pubsec_keySet* keys;
+};
+
+/**
+ * the client side of the binary key exchange; sends REQUEST encrypted or
+ * unencrypted
+ */
+static void* _client(void* arg) {
+  struct client* c     = arg;
+  size_t         len   = 0;
+  char*          hello = ipc_readBytes(c->sock, &len);
+  if (hello == NULL) {
+    return NULL;
+  }
+  if (!c->encrypt) {
+    ipc_writeBytes(c->sock, REQUEST, strlen(REQUEST));
+    secFree(hello);
+    return NULL;
+  }
+  unsigned char* key =
+      generateIpcKey(ipcCryptHelloPublicKey(hello, len), c->keys->sk);
+  secFree(hello);
+  unsigned char* sealed =
+      ipcCryptSealBinary(REQUEST, strlen(REQUEST), key, &len);
+  ipc_writeBytes(c->sock, sealed, len);
+  secFree(sealed);
+  secFree(key);
+  return NULL;
+}
+
+static char* _serverRead(unsigned char encrypt) {
+  int sv[2];
+  ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+  struct pubsec_keySet* keys   = generatePubSecKeys();
+  struct client         client = {sv[1], encrypt, keys};
+  pthread_t             thread;
+  ck_assert_int_eq(pthread_create(&thread, NULL, _client, &client), 0);
+  struct ipc_key* session_key = NULL;
+  char* request = server_ipc_cryptReadBinary(sv[0], keys->pk, &session_key);
+  pthread_join(thread, NULL);
+  close(sv[0]);
+  close(sv[1]);
+  secFreePubSecKeySet(keys);
+  if (request == NULL) {
+    ck_assert_ptr_eq(session_key, NULL);
+  }
+  secFreeIpcKey(session_key);
+  return request;
+}
+
+START_TEST(test_encrypted) {
+  char* request = _serverRead(1);
+  ck_assert_ptr_ne(request, NULL);
+  ck_assert_str_eq(request, REQUEST);
+  secFree(request);
+}
+END_TEST
+
+START_TEST(test_plainAfterKeyExchange) {
+  ck_assert_ptr_eq(_serverRead(0), NULL);
+}
+END_TEST
+
+TCase* test_case_server_ipc_cryptReadBinary() {
+  TCase* tc = tcase_create("server_ipc_cryptReadBinary");
+  tcase_add_test(tc, test_encrypted);
+  tcase_add_test(tc, test_plainAfterKeyExchange);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_IPC_CRYPTIPC_SERVER_IPC_CRYPTREADBINARY_H
+#define TEST_IPC_CRYPTIPC_SERVER_IPC_CRYPTREADBINARY_H
+
+#include <check.h>
+
+TCase* test_case_server_ipc_cryptReadBinary();
+
+#endif  // TEST_IPC_CRYPTIPC_SERVER_IPC_CRYPTREADBINARY_H
@@ -1,10 +1,18 @@
 #include "test/src/account/account/suite.h"
+#include "test/src/account/account_binary/suite.h"
+#include "test/src/ipc/cryptIpc/suite.h"
+#include "test/src/oidc-agent/oidcd/state_snapshot/suite.h"
+#include "test/src/oidc-agent/oidcp/request_queue/suite.h"
+#include "test/src/utils/crypt/base64/suite.h"
 #include "test/src/utils/crypt/crypt/suite.h"
+#include "test/src/utils/crypt/ipcCryptUtils/suite.h"
 #include "test/src/utils/crypt/memoryCrypt/suite.h"
+#include "test/src/utils/file_io/keystore/suite.h"
 #include "test/src/utils/json/suite.h"
 #include "test/src/utils/portUtils/suite.h"
 #include "test/src/utils/stringUtils/suite.h"
 #include "test/src/utils/uriUtils/suite.h"
+#include "test/src/utils/vector/suite.h"
 
 #include <check.h>
 #include <stdlib.h>
@@ -27,7 +35,15 @@ int main() {
   number_failed |= runSuite(test_suite_stringUtils());
   number_failed |= runSuite(test_suite_memoryCrypt());
   number_failed |= runSuite(test_suite_crypt());
+  number_failed |= runSuite(test_suite_base64());
+  number_failed |= runSuite(test_suite_ipcCryptUtils());
+  number_failed |= runSuite(test_suite_cryptIpc());
   number_failed |= runSuite(test_suite_account());
+  number_failed |= runSuite(test_suite_accountBinary());
   number_failed |= runSuite(test_suite_uriUtils());
+  number_failed |= runSuite(test_suite_stateSnapshot());
+  number_failed |= runSuite(test_suite_requestQueue());
+  number_failed |= runSuite(test_suite_keystore());
+  number_failed |= runSuite(test_suite_vector());
   return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,8 @@
+#include "suite.h"
+#include "tc_snapshot.h"
+
+Suite* test_suite_stateSnapshot() {
+  Suite* ts_snapshot = suite_create("stateSnapshot");
+  suite_add_tcase(ts_snapshot, test_case_snapshot());
+  return ts_snapshot;
+}
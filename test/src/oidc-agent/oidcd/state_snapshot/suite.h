@@ -0,0 +1,8 @@
+#ifndef TEST_OIDCAGENT_OIDCD_STATESNAPSHOT_SUITE_H
+#define TEST_OIDCAGENT_OIDCD_STATESNAPSHOT_SUITE_H
+
+#include <check.h>
+
+Suite* test_suite_stateSnapshot();
+
+#endif  // TEST_OIDCAGENT_OIDCD_STATESNAPSHOT_SUITE_H
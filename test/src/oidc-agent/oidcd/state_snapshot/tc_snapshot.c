@@ -0,0 +1,162 @@
+#define _XOPEN_SOURCE 700
+#include "tc_snapshot.h"
+
+#include "account/account.h"
+#include "account/setandget.h"
+#include "defines/settings.h"
+#include "oidc-agent/oidcd/state_snapshot.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/crypt.h"
+#include "utils/crypt/dbCryptUtils.h"
+#include "utils/crypt/memoryCrypt.h"
+#include "utils/db/account_db.h"
+#include "utils/file_io/oidc_file_io.h"
+#include "utils/memory.h"
+#include "utils/oidc_error.h"
+#include "utils/stringUtils.h"
+
+#include <sodium.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char oidc_dir[] = "/tmp/oidc-test-snapshot-XXXXXX";
+
+static void _setRandomKey() {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  crypto_secretbox_keygen(key);
+  char* key_base64 = toBase64((char*)key, sizeof(key));
+  snapshot_setKey(key_base64);
+  secFree(key_base64);
+}
+
+static void _setup() {
+  setLogWithoutTerminal();
+  ck_assert_ptr_ne(mkdtemp(oidc_dir), NULL);
+  setenv(OIDC_CONFIG_DIR_ENV_NAME, oidc_dir, 1);
+  initCrypt();
+  initMemoryCrypt();
+  accountDB_new();
+  accountDB_setFreeFunction((freeFunction)_secFreeAccount);
+  accountDB_setMatchFunction((matchFunction)account_matchByName);
+  _setRandomKey();
+}
+
+static void _teardown() {
+  snapshot_forgetAll();
+  snapshot_clearKey();
+  removeOidcFile(STATE_SNAPSHOT_FILENAME);
+  removeOidcFile(STATE_UNLOADED_FILENAME);
+  rmdir(oidc_dir);
+}
+
+static void _addAccount(const char* name) {
+  struct oidc_account* account = secAlloc(sizeof(struct oidc_account));
+  account_setName(account, oidc_strcopy(name), NULL);
+  account_setIssuerUrl(account, oidc_strcopy("https://issuer.example.com/"));
+  account_setClientId(account, oidc_strcopy("client"));
+  account_setRefreshToken(account, oidc_strcopy("refresh_token"));
+  db_addAccountEncrypted(account);
+}
+
+START_TEST(test_setKey) {
+  // a key that fills the whole encoding must be accepted
+  ck_assert(snapshot_isEnabled());
+  snapshot_setKey("not a key");
+  ck_assert(!snapshot_isEnabled());
+}
+END_TEST
+
+START_TEST(test_writeRestore) {
+  _addAccount("test");
+  ck_assert_int_eq(snapshot_write(), OIDC_SUCCESS);
+  accountDB_reset();
+  ck_assert_int_eq(accountDB_getSize(), 0);
+
+  ck_assert_int_eq(snapshot_restore(), OIDC_SUCCESS);
+  list_t* names = list_new();
+  snapshot_addPendingNames(names);
+  ck_assert_int_eq(names->len, 1);
+  list_destroy(names);
+
+  ck_assert_int_eq(snapshot_unsealAccount("test"), OIDC_SUCCESS);
+  ck_assert_int_eq(accountDB_getSize(), 1);
+  struct oidc_account  key     = {.shortname = "test"};
+  struct oidc_account* account = accountDB_findValue(&key);
+  ck_assert_ptr_ne(account, NULL);
+  _db_decryptFoundAccount(account);
+  ck_assert_str_eq(account_getIssuerUrl(account),
+                   "https://issuer.example.com/");
+  ck_assert_str_eq(account_getRefreshToken(account), "refresh_token");
+  ck_assert_int_eq(snapshot_unsealAccount("test"), OIDC_ENOACCOUNT);
+}
+END_TEST
+
+START_TEST(test_wrongKey) {
+  _addAccount("test");
+  ck_assert_int_eq(snapshot_write(), OIDC_SUCCESS);
+  accountDB_reset();
+  _setRandomKey();
+  ck_assert_int_eq(snapshot_restore(), OIDC_SUCCESS);
+  ck_assert_int_ne(snapshot_unsealAccount("test"), OIDC_SUCCESS);
+  ck_assert_int_eq(accountDB_getSize(), 0);
+}
+END_TEST
+
+START_TEST(test_unloadUnsealAll) {
+  snapshot_clearKey();  // unloaded accounts are sealed with the in-memory key
+  _addAccount("first");
+  _addAccount("second");
+  snapshot_unloadIdleAccounts(1);
+  ck_assert_int_eq(accountDB_getSize(), 1);
+  ck_assert(oidcFileDoesExist(STATE_UNLOADED_FILENAME));
+  list_t* names = list_new();
+  snapshot_addPendingNames(names);
+  ck_assert_int_eq(names->len, 1);
+  list_destroy(names);
+
+  snapshot_unsealAll();
+  ck_assert_int_eq(accountDB_getSize(), 2);
+  ck_assert(!oidcFileDoesExist(STATE_UNLOADED_FILENAME));
+  names = list_new();
+  snapshot_addPendingNames(names);
+  ck_assert_int_eq(names->len, 0);
+  list_destroy(names);
+  // a new key is generated for accounts unloaded afterwards
+  snapshot_unloadIdleAccounts(1);
+  ck_assert_int_eq(accountDB_getSize(), 1);
+  snapshot_unsealAll();
+  ck_assert_int_eq(accountDB_getSize(), 2);
+}
+END_TEST
+
+START_TEST(test_unloadWriteRestore) {
+  _addAccount("first");
+  _addAccount("second");
+  snapshot_unloadIdleAccounts(1);
+  ck_assert_int_eq(accountDB_getSize(), 1);
+  ck_assert_int_eq(snapshot_write(), OIDC_SUCCESS);
+  accountDB_reset();
+  snapshot_forgetAll();
+  ck_assert(!oidcFileDoesExist(STATE_UNLOADED_FILENAME));
+
+  ck_assert_int_eq(snapshot_restore(), OIDC_SUCCESS);
+  list_t* names = list_new();
+  snapshot_addPendingNames(names);
+  ck_assert_int_eq(names->len, 2);
+  list_destroy(names);
+  snapshot_unsealAll();
+  ck_assert_int_eq(accountDB_getSize(), 2);
+}
+END_TEST
+
+TCase* test_case_snapshot() {
+  TCase* tc = tcase_create("snapshot");
+  tcase_add_checked_fixture(tc, _setup, _teardown);
+  tcase_add_test(tc, test_setKey);
+  tcase_add_test(tc, test_writeRestore);
+  tcase_add_test(tc, test_wrongKey);
+  tcase_add_test(tc, test_unloadUnsealAll);
+  tcase_add_test(tc, test_unloadWriteRestore);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_OIDCAGENT_OIDCD_STATESNAPSHOT_SNAPSHOT_H
+#define TEST_OIDCAGENT_OIDCD_STATESNAPSHOT_SNAPSHOT_H
+
+#include <check.h>
+
+TCase* test_case_snapshot();
+
+#endif  // TEST_OIDCAGENT_OIDCD_STATESNAPSHOT_SNAPSHOT_H
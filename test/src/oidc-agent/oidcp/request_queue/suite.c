@@ -0,0 +1,8 @@
+#include "suite.h"
+#include "tc_requestQueue.h"
+
+Suite* test_suite_requestQueue() {
+  Suite* ts_requestQueue = suite_create("requestQueue");
+  suite_add_tcase(ts_requestQueue, test_case_requestQueue());
+  return ts_requestQueue;
+}
@@ -0,0 +1,115 @@
+#include "tc_requestQueue.h"
+
+#include "defines/ipc_values.h"
+#include "oidc-agent/oidcp/request_queue.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#define LATENCY_REQUEST \
+  "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_ACCESSTOKEN "\"}"
+#define BULK_REQUEST "{\"" IPC_KEY_REQUEST "\":\"" REQUEST_VALUE_GEN "\"}"
+
+// only the addresses are used by the queue
+static struct connection latency[16];
+static struct connection bulk[4];
+
+static void _push(struct connection* con, const char* request) {
+  requestQueue_push(con, oidc_strcopy(request));
+}
+
+static struct connection* _pop() {
+  struct connection* con     = NULL;
+  char*              request = requestQueue_pop(&con);
+  ck_assert_ptr_ne(request, NULL);
+  secFree(request);
+  return con;
+}
+
+START_TEST(test_classify) {
+  ck_assert_int_eq(requestQueue_classify(REQUEST_VALUE_ACCESSTOKEN),
+                   REQUEST_CLASS_LATENCY);
+  ck_assert_int_eq(requestQueue_classify(REQUEST_VALUE_STATUS),
+                   REQUEST_CLASS_LATENCY);
+  ck_assert_int_eq(requestQueue_classify(REQUEST_VALUE_GEN),
+                   REQUEST_CLASS_BULK);
+  ck_assert_int_eq(requestQueue_classify(REQUEST_VALUE_REGISTER),
+                   REQUEST_CLASS_BULK);
+  ck_assert_int_eq(requestQueue_classify("unknown"), REQUEST_CLASS_BULK);
+  ck_assert_int_eq(requestQueue_classify(NULL), REQUEST_CLASS_BULK);
+}
+END_TEST
+
+START_TEST(test_latencyFirst) {
+  _push(&bulk[0], BULK_REQUEST);
+  _push(&latency[0], LATENCY_REQUEST);
+  _push(&latency[1], LATENCY_REQUEST);
+  ck_assert_ptr_eq(_pop(), &latency[0]);
+  ck_assert_ptr_eq(_pop(), &latency[1]);
+  ck_assert_ptr_eq(_pop(), &bulk[0]);
+  ck_assert(requestQueue_isEmpty());
+  struct connection* con = NULL;
+  ck_assert_ptr_eq(requestQueue_pop(&con), NULL);
+}
+END_TEST
+
+START_TEST(test_bulkAfterBurst) {
+  _push(&bulk[0], BULK_REQUEST);
+  _push(&bulk[1], BULK_REQUEST);
+  const size_t n = 2 * REQUEST_QUEUE_MAX_LATENCY_BURST + 2;
+  for (size_t i = 0; i < n; i++) {
+    _push(&latency[i], LATENCY_REQUEST);
+  }
+  size_t next = 0;
+  for (size_t b = 0; b < 2; b++) {
+    for (size_t i = 0; i < REQUEST_QUEUE_MAX_LATENCY_BURST; i++) {
+      ck_assert_ptr_eq(_pop(), &latency[next++]);
+    }
+    ck_assert_ptr_eq(_pop(), &bulk[b]);
+  }
+  // without waiting bulk requests there is no limit
+  while (next < n) {
+    ck_assert_ptr_eq(_pop(), &latency[next++]);
+  }
+  ck_assert(requestQueue_isEmpty());
+}
+END_TEST
+
+START_TEST(test_fifoWithinClass) {
+  for (size_t i = 0; i < 4; i++) {
+    _push(&bulk[i], BULK_REQUEST);
+  }
+  for (size_t i = 0; i < 3; i++) {
+    _push(&latency[i], LATENCY_REQUEST);
+  }
+  ck_assert_ptr_eq(_pop(), &latency[0]);
+  ck_assert_ptr_eq(_pop(), &latency[1]);
+  ck_assert_ptr_eq(_pop(), &latency[2]);
+  for (size_t i = 0; i < 4; i++) {
+    ck_assert_ptr_eq(_pop(), &bulk[i]);
+  }
+}
+END_TEST
+
+START_TEST(test_removeConnection) {
+  _push(&latency[0], LATENCY_REQUEST);
+  _push(&bulk[0], BULK_REQUEST);
+  _push(&latency[1], LATENCY_REQUEST);
+  ck_assert(requestQueue_contains(&bulk[0]));
+  requestQueue_removeConnection(&bulk[0]);
+  requestQueue_removeConnection(&latency[0]);
+  ck_assert(!requestQueue_contains(&bulk[0]));
+  ck_assert(!requestQueue_contains(&latency[0]));
+  ck_assert_ptr_eq(_pop(), &latency[1]);
+  ck_assert(requestQueue_isEmpty());
+}
+END_TEST
+
+TCase* test_case_requestQueue() {
+  TCase* tc = tcase_create("requestQueue");
+  tcase_add_test(tc, test_classify);
+  tcase_add_test(tc, test_latencyFirst);
+  tcase_add_test(tc, test_bulkAfterBurst);
+  tcase_add_test(tc, test_fifoWithinClass);
+  tcase_add_test(tc, test_removeConnection);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_OIDCAGENT_OIDCP_REQUESTQUEUE_REQUESTQUEUE_H
+#define TEST_OIDCAGENT_OIDCP_REQUESTQUEUE_REQUESTQUEUE_H
+
+#include <check.h>
+
+TCase* test_case_requestQueue();
+
+#endif  // TEST_OIDCAGENT_OIDCP_REQUESTQUEUE_REQUESTQUEUE_H
@@ -0,0 +1,10 @@
+#include "suite.h"
+#include "tc_base64_decode.h"
+#include "tc_base64_encode.h"
+
+Suite* test_suite_base64() {
+  Suite* ts_base64 = suite_create("base64");
+  suite_add_tcase(ts_base64, test_case_base64_decode());
+  suite_add_tcase(ts_base64, test_case_base64_encode());
+  return ts_base64;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_CRYPT_BASE64_SUITE_H
+#define TEST_UTILS_CRYPT_BASE64_SUITE_H
+
+#include <check.h>
+
+Suite* test_suite_base64();
+
+#endif  // TEST_UTILS_CRYPT_BASE64_SUITE_H
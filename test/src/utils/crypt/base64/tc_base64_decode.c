@@ -0,0 +1,125 @@
+#include "tc_base64_decode.h"
+
+#include "utils/crypt/base64.h"
+
+#include <sodium.h>
+#include <string.h>
+
+#define MAX_LEN 100
+
+static const int variants[] = {
+    sodium_base64_VARIANT_ORIGINAL, sodium_base64_VARIANT_ORIGINAL_NO_PADDING,
+    sodium_base64_VARIANT_URLSAFE, sodium_base64_VARIANT_URLSAFE_NO_PADDING};
+
+static const enum base64_implementation implementations[] = {
+    BASE64_IMPL_SCALAR, BASE64_IMPL_SSE41, BASE64_IMPL_AVX2};
+
+static void _teardown() { base64_useImplementation(BASE64_IMPL_AUTO); }
+
+static void _fill(unsigned char* bin, size_t len, unsigned int seed) {
+  for (size_t i = 0; i < len; i++) { bin[i] = (i * 151 + seed * 29) & 0xFF; }
+}
+
+/**
+ * @brief decodes @p b64 with base64_decode and sodium_base642bin and checks
+ * that both accept or reject it and decode the same bytes
+ */
+static void _assertDecodesLikeSodium(const char* b64, size_t b64_len,
+                                     int variant) {
+  unsigned char bin[MAX_LEN + 3];
+  unsigned char expected[MAX_LEN + 3];
+  size_t        bin_len      = 0;
+  size_t        expected_len = 0;
+  int ret = base64_decode(bin, sizeof(bin), b64, b64_len, &bin_len, variant);
+  int expected_ret = sodium_base642bin(expected, sizeof(expected), b64,
+                                       b64_len, NULL, &expected_len, NULL,
+                                       variant);
+  ck_assert_msg(ret == expected_ret, "'%.*s' (variant %d): %d vs %d",
+                (int)b64_len, b64, variant, ret, expected_ret);
+  if (ret == 0) {
+    ck_assert_uint_eq(bin_len, expected_len);
+    ck_assert_mem_eq(bin, expected, bin_len);
+  }
+}
+
+START_TEST(test_matchesSodium) {
+  if (!base64_useImplementation(implementations[_i])) {
+    return;  // not supported by this cpu
+  }
+  unsigned char bin[MAX_LEN];
+  char          b64[sodium_base64_ENCODED_LEN(MAX_LEN, 1)];
+  for (size_t len = 0; len <= MAX_LEN; len++) {
+    for (size_t v = 0; v < sizeof(variants) / sizeof(*variants); v++) {
+      for (unsigned int seed = 0; seed < 3; seed++) {
+        _fill(bin, len, seed);
+        sodium_bin2base64(b64, sizeof(b64), bin, len, variants[v]);
+        // every variant must accept or reject every encoding alike, e.g.
+        // url-safe characters or padding in a variant without them
+        for (size_t w = 0; w < sizeof(variants) / sizeof(*variants); w++) {
+          _assertDecodesLikeSodium(b64, strlen(b64), variants[w]);
+        }
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_highBytes) {
+  if (!base64_useImplementation(implementations[_i])) {
+    return;
+  }
+  unsigned char bin[MAX_LEN];
+  char          b64[sodium_base64_ENCODED_LEN(MAX_LEN, 1)];
+  memset(bin, 0xFF, sizeof(bin));
+  sodium_bin2base64(b64, sizeof(b64), bin, sizeof(bin),
+                    sodium_base64_VARIANT_ORIGINAL);
+  _assertDecodesLikeSodium(b64, strlen(b64), sodium_base64_VARIANT_ORIGINAL);
+  // libsodium decodes non-ascii characters like '/', we reject them
+  for (size_t pos = 0; pos < 64; pos += 7) {
+    char invalid[sizeof(b64)];
+    strcpy(invalid, b64);
+    invalid[pos] = (char)0xC1;
+    ck_assert_int_eq(base64_decode(bin, sizeof(bin), invalid, strlen(invalid),
+                                   NULL, sodium_base64_VARIANT_ORIGINAL),
+                     -1);
+  }
+}
+END_TEST
+
+START_TEST(test_invalidInBlock) {
+  if (!base64_useImplementation(implementations[_i])) {
+    return;
+  }
+  unsigned char bin[48];
+  char          b64[sodium_base64_ENCODED_LEN(sizeof(bin), 1)];
+  _fill(bin, sizeof(bin), 1);
+  sodium_bin2base64(b64, sizeof(b64), bin, sizeof(bin),
+                    sodium_base64_VARIANT_ORIGINAL);
+  // an invalid character inside the first 16 and 32 character blocks as well
+  // as in the scalar tail
+  const size_t positions[]  = {0, 5, 15, 16, 23, 31, 32, 40, 63};
+  const char   characters[] = {'*', '-', '_', '=', '\0', ' ', 0x7F};
+  for (size_t p = 0; p < sizeof(positions) / sizeof(*positions); p++) {
+    for (size_t c = 0; c < sizeof(characters); c++) {
+      char invalid[sizeof(b64)];
+      memcpy(invalid, b64, sizeof(b64));
+      invalid[positions[p]] = characters[c];
+      for (size_t v = 0; v < sizeof(variants) / sizeof(*variants); v++) {
+        _assertDecodesLikeSodium(invalid, 64, variants[v]);
+      }
+    }
+  }
+}
+END_TEST
+
+TCase* test_case_base64_decode() {
+  TCase* tc = tcase_create("base64_decode");
+  tcase_add_checked_fixture(tc, NULL, _teardown);
+  tcase_add_loop_test(tc, test_matchesSodium, 0,
+                      sizeof(implementations) / sizeof(*implementations));
+  tcase_add_loop_test(tc, test_highBytes, 0,
+                      sizeof(implementations) / sizeof(*implementations));
+  tcase_add_loop_test(tc, test_invalidInBlock, 0,
+                      sizeof(implementations) / sizeof(*implementations));
+  return tc;
+}
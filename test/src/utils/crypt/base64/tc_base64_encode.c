@@ -0,0 +1,73 @@
+#include "tc_base64_encode.h"
+
+#include "utils/crypt/base64.h"
+
+#include <sodium.h>
+#include <string.h>
+
+#define MAX_LEN 100
+
+static const int variants[] = {
+    sodium_base64_VARIANT_ORIGINAL, sodium_base64_VARIANT_ORIGINAL_NO_PADDING,
+    sodium_base64_VARIANT_URLSAFE, sodium_base64_VARIANT_URLSAFE_NO_PADDING};
+
+static const enum base64_implementation implementations[] = {
+    BASE64_IMPL_SCALAR, BASE64_IMPL_SSE41, BASE64_IMPL_AVX2};
+
+static void _teardown() { base64_useImplementation(BASE64_IMPL_AUTO); }
+
+/**
+ * @brief fills @p bin with bytes covering the whole range, so that every
+ * base64 character (including '+' / '-' and '/' / '_') is produced
+ */
+static void _fill(unsigned char* bin, size_t len, unsigned int seed) {
+  for (size_t i = 0; i < len; i++) { bin[i] = (i * 151 + seed * 29) & 0xFF; }
+}
+
+START_TEST(test_matchesSodium) {
+  const enum base64_implementation impl = implementations[_i];
+  if (!base64_useImplementation(impl)) {
+    return;  // not supported by this cpu
+  }
+  unsigned char bin[MAX_LEN];
+  char          b64[sodium_base64_ENCODED_LEN(MAX_LEN, 1)];
+  char          expected[sodium_base64_ENCODED_LEN(MAX_LEN, 1)];
+  for (size_t len = 0; len <= MAX_LEN; len++) {
+    for (size_t v = 0; v < sizeof(variants) / sizeof(*variants); v++) {
+      for (unsigned int seed = 0; seed < 3; seed++) {
+        _fill(bin, len, seed);
+        sodium_bin2base64(expected, sizeof(expected), bin, len, variants[v]);
+        size_t b64_len = base64_encode(b64, bin, len, variants[v]);
+        ck_assert_uint_eq(b64_len, strlen(expected));
+        ck_assert_str_eq(b64, expected);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_highBytes) {
+  const enum base64_implementation impl = implementations[_i];
+  if (!base64_useImplementation(impl)) {
+    return;
+  }
+  unsigned char bin[MAX_LEN];
+  char          b64[sodium_base64_ENCODED_LEN(MAX_LEN, 1)];
+  char          expected[sodium_base64_ENCODED_LEN(MAX_LEN, 1)];
+  memset(bin, 0xFF, sizeof(bin));
+  sodium_bin2base64(expected, sizeof(expected), bin, sizeof(bin),
+                    sodium_base64_VARIANT_ORIGINAL);
+  base64_encode(b64, bin, sizeof(bin), sodium_base64_VARIANT_ORIGINAL);
+  ck_assert_str_eq(b64, expected);
+}
+END_TEST
+
+TCase* test_case_base64_encode() {
+  TCase* tc = tcase_create("base64_encode");
+  tcase_add_checked_fixture(tc, NULL, _teardown);
+  tcase_add_loop_test(tc, test_matchesSodium, 0,
+                      sizeof(implementations) / sizeof(*implementations));
+  tcase_add_loop_test(tc, test_highBytes, 0,
+                      sizeof(implementations) / sizeof(*implementations));
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_CRYPT_BASE64_BASE64ENCODE_H
+#define TEST_UTILS_CRYPT_BASE64_BASE64ENCODE_H
+
+#include <check.h>
+
+TCase* test_case_base64_encode();
+
+#endif  // TEST_UTILS_CRYPT_BASE64_BASE64ENCODE_H
@@ -1,6 +1,7 @@
 #include "suite.h"
 #include "tc_crypt_decrypt.h"
 #include "tc_crypt_encrypt.h"
+#include "tc_crypt_kdfParameters.h"
 #include "tc_fromBase64.h"
 #include "tc_fromBase64UrlSafe.h"
 #include "tc_s256.h"
@@ -11,6 +12,7 @@ Suite* test_suite_crypt() {
   Suite* ts_crypt = suite_create("crypt");
   suite_add_tcase(ts_crypt, test_case_crypt_decrypt());
   suite_add_tcase(ts_crypt, test_case_crypt_encrypt());
+  suite_add_tcase(ts_crypt, test_case_crypt_kdfParameters());
   suite_add_tcase(ts_crypt, test_case_fromBase64());
   suite_add_tcase(ts_crypt, test_case_fromBase64UrlSafe());
   suite_add_tcase(ts_crypt, test_case_s256());
@@ -0,0 +1,154 @@
+#define _XOPEN_SOURCE 700
+#include "tc_crypt_kdfParameters.h"
+
+#include "defines/settings.h"
+#include "utils/crypt/crypt.h"
+#include "utils/crypt/cryptdef.h"
+#include "utils/crypt/kdf.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/oidc_error.h"
+#include "utils/stringUtils.h"
+
+#include <sodium.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static struct cryptParameter _params(int ops, int mem, int alg) {
+  struct cryptParameter p = newCryptParameters();
+  p.hash_ops_limit        = ops;
+  p.hash_mem_limit        = mem;
+  p.hash_alg              = alg;
+  return p;
+}
+
+/**
+ * @brief replaces the key derivation parameters in the header of an encrypted
+ * string
+ */
+static char* _withHeader(const char* encrypted, int ops, int mem, int alg) {
+  list_t* lines = delimitedStringToList(encrypted, '\n');
+  ck_assert_ptr_ne(lines, NULL);
+  struct cryptParameter p = newCryptParameters();
+  char*                 header =
+      oidc_sprintf("%lu:%lu:%lu:%lu:%d:%d:%d:%d", p.nonce_len, p.salt_len,
+                   p.mac_len, p.key_len, p.base64_variant, ops, mem, alg);
+  char* crafted = oidc_sprintf(
+      "%s\n%s\n%s\n%s\n%s\n%s", (char*)list_at(lines, 0)->val,
+      (char*)list_at(lines, 1)->val, (char*)list_at(lines, 2)->val, header,
+      (char*)list_at(lines, 4)->val, (char*)list_at(lines, 5)->val);
+  secFree(header);
+  secFreeList(lines);
+  return crafted;
+}
+
+START_TEST(test_bounds) {
+  const int id = crypto_pwhash_ALG_ARGON2ID13;
+  struct cryptParameter p = _params(2, KDF_MIN_MEMLIMIT, id);
+  ck_assert(crypt_kdfParametersValid(&p));
+  p = _params(KDF_MAX_OPSLIMIT, KDF_MAX_MEMLIMIT, id);
+  ck_assert(crypt_kdfParametersValid(&p));
+  p = newCryptParameters();
+  ck_assert(crypt_kdfParametersValid(&p));
+
+  p = _params(KDF_MAX_OPSLIMIT + 1, KDF_MIN_MEMLIMIT, id);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  p = _params(crypto_pwhash_argon2id_OPSLIMIT_MIN - 1, KDF_MIN_MEMLIMIT, id);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  p = _params(-1, KDF_MIN_MEMLIMIT, id);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  p = _params(2, KDF_MIN_MEMLIMIT - 1, id);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  p = _params(2, KDF_MAX_MEMLIMIT + 1, id);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  p = _params(2, -1, id);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  // argon2i needs at least 3 passes
+  p = _params(2, KDF_MIN_MEMLIMIT, crypto_pwhash_ALG_ARGON2I13);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  p = _params(3, KDF_MIN_MEMLIMIT, 42);
+  ck_assert(!crypt_kdfParametersValid(&p));
+  ck_assert(!crypt_kdfParametersValid(NULL));
+}
+END_TEST
+
+START_TEST(test_roundTripNonDefault) {
+  struct cryptParameter p =
+      _params(3, KDF_MIN_MEMLIMIT, crypto_pwhash_ALG_ARGON2I13);
+  char* encrypted = crypt_encryptWithParameters("secret", "password", p);
+  ck_assert_ptr_ne(encrypted, NULL);
+  char* header = oidc_sprintf(":%d:%d:%d\n", p.hash_ops_limit,
+                              p.hash_mem_limit, p.hash_alg);
+  ck_assert_ptr_ne(strstr(encrypted, header), NULL);
+  secFree(header);
+  char* plain = crypt_decrypt(encrypted, "password");
+  ck_assert_ptr_ne(plain, NULL);
+  ck_assert_str_eq(plain, "secret");
+  secFree(plain);
+  ck_assert_ptr_eq(crypt_decrypt(encrypted, "wrong"), NULL);
+  ck_assert_int_eq(oidc_errno, OIDC_EPASS);
+  secFree(encrypted);
+}
+END_TEST
+
+START_TEST(test_rejectOutOfRangeHeader) {
+  const int id = crypto_pwhash_ALG_ARGON2ID13;
+  ck_assert_ptr_eq(crypt_encryptWithParameters(
+                       "secret", "password",
+                       _params(2, KDF_MAX_MEMLIMIT + 1, id)),
+                   NULL);
+  ck_assert_int_eq(oidc_errno, OIDC_ECRYPM);
+  char* encrypted = crypt_encryptWithParameters(
+      "secret", "password", _params(2, KDF_MIN_MEMLIMIT, id));
+  ck_assert_ptr_ne(encrypted, NULL);
+  const int crafted_params[][3] = {
+      {2, KDF_MAX_MEMLIMIT + 1, id},
+      {KDF_MAX_OPSLIMIT + 1, KDF_MIN_MEMLIMIT, id},
+      {2, KDF_MIN_MEMLIMIT - 1, id},
+      {0, KDF_MIN_MEMLIMIT, id},
+      {2, KDF_MIN_MEMLIMIT, 42},
+  };
+  for (size_t i = 0; i < sizeof(crafted_params) / sizeof(*crafted_params);
+       i++) {
+    char* crafted = _withHeader(encrypted, crafted_params[i][0],
+                                crafted_params[i][1], crafted_params[i][2]);
+    oidc_errno    = OIDC_SUCCESS;
+    ck_assert_ptr_eq(crypt_decrypt(crafted, "password"), NULL);
+    ck_assert_int_eq(oidc_errno, OIDC_ECRYPM);
+    secFree(crafted);
+  }
+  secFree(encrypted);
+}
+END_TEST
+
+START_TEST(test_usesDefaultParameters) {
+  char dir[] = "/tmp/oidc-test-kdf-XXXXXX";
+  ck_assert_ptr_ne(mkdtemp(dir), NULL);
+  setenv(OIDC_CONFIG_DIR_ENV_NAME, dir, 1);
+  struct cryptParameter d = kdf_getDefaultParameters();
+  char* encrypted = crypt_encryptWithParameters("secret", "password", d);
+  ck_assert_ptr_ne(encrypted, NULL);
+  ck_assert(kdf_usesDefaultParameters(encrypted));
+  secFree(encrypted);
+  struct cryptParameter other = d;
+  other.hash_mem_limit =
+      d.hash_mem_limit == KDF_MIN_MEMLIMIT ? 2 * KDF_MIN_MEMLIMIT
+                                           : KDF_MIN_MEMLIMIT;
+  encrypted = crypt_encryptWithParameters("secret", "password", other);
+  ck_assert_ptr_ne(encrypted, NULL);
+  ck_assert(!kdf_usesDefaultParameters(encrypted));
+  secFree(encrypted);
+  rmdir(dir);
+}
+END_TEST
+
+TCase* test_case_crypt_kdfParameters() {
+  TCase* tc = tcase_create("crypt_kdfParameters");
+  tcase_add_test(tc, test_bounds);
+  tcase_add_test(tc, test_roundTripNonDefault);
+  tcase_add_test(tc, test_rejectOutOfRangeHeader);
+  tcase_add_test(tc, test_usesDefaultParameters);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_CRYPT_CRYPT_CRYPT_KDFPARAMETERS_H
+#define TEST_UTILS_CRYPT_CRYPT_CRYPT_KDFPARAMETERS_H
+
+#include <check.h>
+
+TCase* test_case_crypt_kdfParameters();
+
+#endif  // TEST_UTILS_CRYPT_CRYPT_CRYPT_KDFPARAMETERS_H
@@ -26,10 +26,29 @@ START_TEST(test_wrong_decode) {
 }
 END_TEST
 
+START_TEST(test_decode_exact_length) {
+  // the encoding fills the whole buffer; nothing but the null byte follows it
+  unsigned char s[32];
+  ck_assert_int_eq(
+      fromBase64("AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8=", 32, s), 0);
+  for (int i = 0; i < 32; i++) {
+    ck_assert_int_eq(s[i], i);
+  }
+}
+END_TEST
+
+START_TEST(test_decode_too_long) {
+  unsigned char s[4];
+  ck_assert_int_ne(fromBase64("dGVzdA==dGVzdA==", 4, s), 0);
+}
+END_TEST
+
 TCase* test_case_fromBase64() {
   TCase* tc = tcase_create("fromBase64");
   tcase_add_test(tc, test_NULL);
   tcase_add_test(tc, test_decode);
   tcase_add_test(tc, test_wrong_decode);
+  tcase_add_test(tc, test_decode_exact_length);
+  tcase_add_test(tc, test_decode_too_long);
   return tc;
 }
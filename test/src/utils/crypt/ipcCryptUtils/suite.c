@@ -0,0 +1,11 @@
+#include "suite.h"
+#include "tc_ipcCryptBinary.h"
+#include "tc_ipcCryptMessageLength.h"
+
+Suite* test_suite_ipcCryptUtils() {
+  Suite* ts_ipcCryptUtils = suite_create("ipcCryptUtils");
+  suite_add_tcase(ts_ipcCryptUtils, test_case_ipcCryptMessageLength());
+  suite_add_tcase(ts_ipcCryptUtils, test_case_ipcCryptBinary());
+
+  return ts_ipcCryptUtils;
+}
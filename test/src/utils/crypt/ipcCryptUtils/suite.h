@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_CRYPT_IPCCRYPTUTILS_SUITE_H
+#define TEST_UTILS_CRYPT_IPCCRYPTUTILS_SUITE_H
+
+#include <check.h>
+
+Suite* test_suite_ipcCryptUtils();
+
+#endif  // TEST_UTILS_CRYPT_IPCCRYPTUTILS_SUITE_H
@@ -0,0 +1,76 @@
+#include "tc_ipcCryptBinary.h"
+
+#include "utils/crypt/ipcCryptUtils.h"
+#include "utils/memory.h"
+
+#include <sodium.h>
+#include <string.h>
+
+START_TEST(test_roundtrip) {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  randombytes_buf(key, sizeof(key));
+  const char*    msg    = "{\"request\":\"access_token\"}";
+  size_t         len    = 0;
+  unsigned char* sealed = ipcCryptSealBinary(msg, strlen(msg), key, &len);
+  ck_assert_ptr_ne(sealed, NULL);
+  ck_assert_int_eq(len, ipcCryptBinaryLength(strlen(msg)));
+  ck_assert(ipcCryptIsBinary((char*)sealed, len));
+  char* opened = ipcCryptOpenBinary((char*)sealed, len, key);
+  ck_assert_ptr_ne(opened, NULL);
+  ck_assert_str_eq(opened, msg);
+  secFree(opened);
+  secFree(sealed);
+}
+END_TEST
+
+START_TEST(test_tampered) {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  randombytes_buf(key, sizeof(key));
+  size_t         len    = 0;
+  unsigned char* sealed = ipcCryptSealBinary("secret", 6, key, &len);
+  ck_assert_ptr_ne(sealed, NULL);
+  sealed[len - 1] ^= 1;
+  ck_assert_ptr_eq(ipcCryptOpenBinary((char*)sealed, len, key), NULL);
+  sealed[len - 1] ^= 1;
+  ck_assert_ptr_eq(ipcCryptOpenBinary((char*)sealed, len - 1, key), NULL);
+  secFree(sealed);
+}
+END_TEST
+
+START_TEST(test_messageLength) {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  randombytes_buf(key, sizeof(key));
+  size_t         len    = 0;
+  unsigned char* sealed = ipcCryptSealBinary("first", 5, key, &len);
+  ck_assert_int_eq(ipcCryptMessageLength((char*)sealed, len, 1024), len);
+  ck_assert_int_eq(ipcCryptMessageLength((char*)sealed, 2, 1024), 0);
+  ck_assert_int_eq(ipcCryptMessageLength((char*)sealed, len - 1, 1024), 0);
+  ck_assert_int_eq(ipcCryptMessageLength((char*)sealed, len, 4), -1);
+  secFree(sealed);
+}
+END_TEST
+
+START_TEST(test_hello) {
+  unsigned char pk[crypto_kx_PUBLICKEYBYTES];
+  randombytes_buf(pk, sizeof(pk));
+  unsigned char hello[IPC_CRYPT_BINARY_HELLO_LEN];
+  ipcCryptWriteHello(hello, pk);
+  const unsigned char* parsed =
+      ipcCryptHelloPublicKey((char*)hello, sizeof(hello));
+  ck_assert_ptr_ne(parsed, NULL);
+  ck_assert_int_eq(memcmp(parsed, pk, sizeof(pk)), 0);
+  ck_assert_ptr_eq(ipcCryptHelloPublicKey((char*)hello, sizeof(hello) - 1),
+                   NULL);
+  const char* base64 = "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=";
+  ck_assert_ptr_eq(ipcCryptHelloPublicKey(base64, strlen(base64)), NULL);
+}
+END_TEST
+
+TCase* test_case_ipcCryptBinary() {
+  TCase* tc = tcase_create("ipcCryptBinary");
+  tcase_add_test(tc, test_roundtrip);
+  tcase_add_test(tc, test_tampered);
+  tcase_add_test(tc, test_messageLength);
+  tcase_add_test(tc, test_hello);
+  return tc;
+}
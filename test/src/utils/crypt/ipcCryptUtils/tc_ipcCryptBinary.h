@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_CRYPT_IPCCRYPTUTILS_IPCCRYPTBINARY_H
+#define TEST_UTILS_CRYPT_IPCCRYPTUTILS_IPCCRYPTBINARY_H
+
+#include <check.h>
+
+TCase* test_case_ipcCryptBinary();
+
+#endif  // TEST_UTILS_CRYPT_IPCCRYPTUTILS_IPCCRYPTBINARY_H
@@ -0,0 +1,76 @@
+#include "tc_ipcCryptMessageLength.h"
+
+#include "utils/crypt/ipcCryptUtils.h"
+#include "utils/memory.h"
+#include "utils/stringUtils.h"
+
+#include <sodium.h>
+#include <string.h>
+
+START_TEST(test_NULL) {
+  ck_assert_int_eq(ipcCryptMessageLength(NULL, 0, 1024), -1);
+}
+END_TEST
+
+START_TEST(test_complete) {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  randombytes_buf(key, sizeof(key));
+  char* msg = encryptForIpc("{\"request\":\"access_token\"}", key);
+  ck_assert_ptr_ne(msg, NULL);
+  size_t len = strlen(msg);
+  ck_assert_int_eq(ipcCryptMessageLength(msg, len, 1024), len);
+  secFree(msg);
+}
+END_TEST
+
+START_TEST(test_incomplete) {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  randombytes_buf(key, sizeof(key));
+  char* msg = encryptForIpc("{\"request\":\"access_token\"}", key);
+  ck_assert_ptr_ne(msg, NULL);
+  size_t len = strlen(msg);
+  ck_assert_int_eq(ipcCryptMessageLength(msg, 1, 1024), 0);
+  ck_assert_int_eq(ipcCryptMessageLength(msg, len / 2, 1024), 0);
+  ck_assert_int_eq(ipcCryptMessageLength(msg, len - 1, 1024), 0);
+  secFree(msg);
+}
+END_TEST
+
+START_TEST(test_pipelined) {
+  unsigned char key[crypto_secretbox_KEYBYTES];
+  randombytes_buf(key, sizeof(key));
+  char* first  = encryptForIpc("first", key);
+  char* second = encryptForIpc("second", key);
+  char* both   = oidc_strcat(first, second);
+  ck_assert_int_eq(ipcCryptMessageLength(both, strlen(both), 1024),
+                   strlen(first));
+  secFree(first);
+  secFree(second);
+  secFree(both);
+}
+END_TEST
+
+START_TEST(test_invalid) {
+  const char* json = "{\"request\":\"access_token\"}";
+  ck_assert_int_eq(ipcCryptMessageLength(json, strlen(json), 1024), -1);
+  const char* nonce = "12:abc:defghijklmnopqrstuvwxyzabcdefghijkl";
+  ck_assert_int_eq(ipcCryptMessageLength(nonce, strlen(nonce), 1024), -1);
+}
+END_TEST
+
+START_TEST(test_tooLong) {
+  const char* msg = "4096:";
+  ck_assert_int_eq(ipcCryptMessageLength(msg, strlen(msg), 1024), -1);
+}
+END_TEST
+
+TCase* test_case_ipcCryptMessageLength() {
+  TCase* tc = tcase_create("ipcCryptMessageLength");
+  tcase_add_test(tc, test_NULL);
+  tcase_add_test(tc, test_complete);
+  tcase_add_test(tc, test_incomplete);
+  tcase_add_test(tc, test_pipelined);
+  tcase_add_test(tc, test_invalid);
+  tcase_add_test(tc, test_tooLong);
+  return tc;
+}
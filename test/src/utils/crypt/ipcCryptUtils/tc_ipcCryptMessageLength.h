@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_CRYPT_IPCCRYPTUTILS_IPCCRYPTMESSAGELENGTH_H
+#define TEST_UTILS_CRYPT_IPCCRYPTUTILS_IPCCRYPTMESSAGELENGTH_H
+
+#include <check.h>
+
+TCase* test_case_ipcCryptMessageLength();
+
+#endif  // TEST_UTILS_CRYPT_IPCCRYPTUTILS_IPCCRYPTMESSAGELENGTH_H
@@ -0,0 +1,8 @@
+#include "suite.h"
+#include "tc_keystore.h"
+
+Suite* test_suite_keystore() {
+  Suite* ts_keystore = suite_create("keystore");
+  suite_add_tcase(ts_keystore, test_case_keystore());
+  return ts_keystore;
+}
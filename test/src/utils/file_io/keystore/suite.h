@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_FILEIO_KEYSTORE_SUITE_H
+#define TEST_UTILS_FILEIO_KEYSTORE_SUITE_H
+
+#include <check.h>
+
+Suite* test_suite_keystore();
+
+#endif  // TEST_UTILS_FILEIO_KEYSTORE_SUITE_H
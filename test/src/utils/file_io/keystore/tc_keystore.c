@@ -0,0 +1,157 @@
+#define _XOPEN_SOURCE 700
+#include "tc_keystore.h"
+
+#include "defines/agent_values.h"
+#include "defines/settings.h"
+#include "utils/agentLogger.h"
+#include "utils/crypt/crypt.h"
+#include "utils/file_io/fileUtils.h"
+#include "utils/file_io/file_io.h"
+#include "utils/file_io/keystore.h"
+#include "utils/file_io/oidc_file_io.h"
+#include "utils/json.h"
+#include "utils/listUtils.h"
+#include "utils/memory.h"
+#include "utils/oidc_error.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char oidc_dir[] = "/tmp/oidc-test-keystore-XXXXXX";
+
+static void _setup() {
+  setLogWithoutTerminal();
+  strcpy(oidc_dir + strlen(oidc_dir) - 6, "XXXXXX");
+  ck_assert_ptr_ne(mkdtemp(oidc_dir), NULL);
+  setenv(OIDC_CONFIG_DIR_ENV_NAME, oidc_dir, 1);
+  initCrypt();
+  ck_assert_int_eq(keystore_create(), OIDC_SUCCESS);
+}
+
+static void _teardown() {
+  removeOidcFile(KEYSTORE_FILENAME);
+  rmdir(oidc_dir);
+}
+
+static void _appendRaw(const char* data, size_t len) {
+  char* path = concatToOidcDir(KEYSTORE_FILENAME);
+  FILE* f    = fopen(path, "a");
+  secFree(path);
+  ck_assert_ptr_ne(f, NULL);
+  ck_assert_uint_eq(fwrite(data, 1, len, f), len);
+  fclose(f);
+}
+
+START_TEST(test_writeRead) {
+  ck_assert(keystore_isEnabled());
+  ck_assert_ptr_eq(keystore_read("test"), NULL);
+  ck_assert_int_eq(keystore_write("test", "first", "https://example.com"),
+                   OIDC_SUCCESS);
+  ck_assert_int_eq(keystore_write("other", "other", NULL), OIDC_SUCCESS);
+  ck_assert_int_eq(keystore_write("test", "second", "https://example.com"),
+                   OIDC_SUCCESS);
+  char* record = keystore_read("test");
+  ck_assert_ptr_ne(record, NULL);
+  ck_assert_str_eq(record, "second");
+  secFree(record);
+  list_t* names = keystore_getNames();
+  ck_assert_ptr_ne(names, NULL);
+  ck_assert_int_eq(names->len, 2);
+  secFreeList(names);
+  char* name = keystore_getNameForIssuer("https://example.com/");
+  ck_assert_ptr_ne(name, NULL);
+  ck_assert_str_eq(name, "test");
+  secFree(name);
+}
+END_TEST
+
+START_TEST(test_remove) {
+  ck_assert_int_eq(keystore_write("test", "record", NULL), OIDC_SUCCESS);
+  ck_assert_int_eq(keystore_remove("test"), OIDC_SUCCESS);
+  ck_assert_ptr_eq(keystore_read("test"), NULL);
+  ck_assert(!keystore_contains("test"));
+  ck_assert_int_eq(keystore_compact(), OIDC_SUCCESS);
+  ck_assert_ptr_eq(keystore_read("test"), NULL);
+}
+END_TEST
+
+START_TEST(test_partialRecord) {
+  ck_assert_int_eq(keystore_write("test", "record", NULL), OIDC_SUCCESS);
+  // a header promising more data than the file holds, e.g. from an
+  // interrupted append
+  const char partial[] = "\0\0\0\0\4\0\0\0\377\0\0\0";
+  _appendRaw(partial, sizeof(partial) - 1);
+  char* record = keystore_read("test");
+  ck_assert_ptr_ne(record, NULL);
+  ck_assert_str_eq(record, "record");
+  secFree(record);
+  // the next update must not end up behind the partial record
+  ck_assert_int_eq(keystore_write("new", "new record", NULL), OIDC_SUCCESS);
+  record = keystore_read("new");
+  ck_assert_ptr_ne(record, NULL);
+  ck_assert_str_eq(record, "new record");
+  secFree(record);
+  record = keystore_read("test");
+  ck_assert_ptr_ne(record, NULL);
+  secFree(record);
+}
+END_TEST
+
+START_TEST(test_unknownFormat) {
+  removeOidcFile(KEYSTORE_FILENAME);
+  ck_assert_int_eq(writeOidcFile(KEYSTORE_FILENAME, "not a keystore"),
+                   OIDC_SUCCESS);
+  ck_assert_ptr_eq(keystore_read("test"), NULL);
+  ck_assert_ptr_eq(keystore_getNames(), NULL);
+}
+END_TEST
+
+static void _writeRawFile(const char* name, const char* content) {
+  char* path = concatToOidcDir(name);
+  FILE* f    = fopen(path, "w");
+  secFree(path);
+  ck_assert_ptr_ne(f, NULL);
+  fputs(content, f);
+  fclose(f);
+}
+
+static char* _getIssuer(const char* name, const char* content, void* arg) {
+  ck_assert_str_eq(arg, "arg");
+  if (strcmp(name, "undecryptable") == 0) {
+    return NULL;
+  }
+  return getJSONValueFromString(content, AGENT_KEY_ISSUERURL);
+}
+
+START_TEST(test_importAccountFiles) {
+  _writeRawFile("imported",
+                "{\"" AGENT_KEY_ISSUERURL "\":\"https://issuer.example/\"}");
+  _writeRawFile("undecryptable", "encrypted");
+  ck_assert_int_eq(keystore_importAccountFiles(_getIssuer, "arg"), 1);
+  char* name = keystore_getNameForIssuer("https://issuer.example/");
+  ck_assert_ptr_ne(name, NULL);
+  ck_assert_str_eq(name, "imported");
+  secFree(name);
+  ck_assert(keystore_contains("imported"));
+  ck_assert(!keystore_contains("undecryptable"));
+  list_t* accounts = getAccountConfigFileList();
+  ck_assert_ptr_ne(accounts, NULL);
+  ck_assert_int_eq(accounts->len, 2);
+  ck_assert_ptr_ne(findInList(accounts, "imported"), NULL);
+  ck_assert_ptr_ne(findInList(accounts, "undecryptable"), NULL);
+  secFreeList(accounts);
+  removeOidcFile("undecryptable");
+}
+END_TEST
+
+TCase* test_case_keystore() {
+  TCase* tc = tcase_create("keystore");
+  tcase_add_checked_fixture(tc, _setup, _teardown);
+  tcase_add_test(tc, test_writeRead);
+  tcase_add_test(tc, test_remove);
+  tcase_add_test(tc, test_partialRecord);
+  tcase_add_test(tc, test_unknownFormat);
+  tcase_add_test(tc, test_importAccountFiles);
+  return tc;
+}
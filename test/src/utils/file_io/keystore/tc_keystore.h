@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_FILEIO_KEYSTORE_KEYSTORE_H
+#define TEST_UTILS_FILEIO_KEYSTORE_KEYSTORE_H
+
+#include <check.h>
+
+TCase* test_case_keystore();
+
+#endif  // TEST_UTILS_FILEIO_KEYSTORE_KEYSTORE_H
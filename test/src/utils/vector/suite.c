@@ -0,0 +1,14 @@
+#include "suite.h"
+#include "tc_listToVector.h"
+#include "tc_vector_findAll.h"
+#include "tc_vector_push.h"
+#include "tc_vector_removeAt.h"
+
+Suite* test_suite_vector() {
+  Suite* ts_vector = suite_create("vector");
+  suite_add_tcase(ts_vector, test_case_listToVector());
+  suite_add_tcase(ts_vector, test_case_vector_findAll());
+  suite_add_tcase(ts_vector, test_case_vector_push());
+  suite_add_tcase(ts_vector, test_case_vector_removeAt());
+  return ts_vector;
+}
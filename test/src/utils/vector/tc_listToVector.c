@@ -0,0 +1,47 @@
+#include "tc_listToVector.h"
+
+#include "utils/listUtils.h"
+#include "utils/stringUtils.h"
+#include "utils/vector.h"
+
+START_TEST(test_listToVector) {
+  list_t*   list = createList(LIST_CREATE_COPY_VALUES, "a", "b", "c", NULL);
+  vector_t* v    = listToVector(list);
+  ck_assert_ptr_ne(v, NULL);
+  ck_assert_uint_eq(v->len, 3);
+  ck_assert_ptr_eq(v->match, list->match);
+  ck_assert_ptr_eq(v->free, NULL);
+  ck_assert_ptr_eq(vector_at(v, 0), list_at(list, 0)->val);
+  ck_assert_ptr_eq(vector_at(v, 2), list_at(list, 2)->val);
+  secFreeVector(v);
+  secFreeList(list);
+}
+END_TEST
+
+START_TEST(test_vectorToList) {
+  vector_t* v    = createVector(LIST_CREATE_COPY_VALUES, "a", "b", "c", NULL);
+  list_t*   list = vectorToList(v);
+  ck_assert_ptr_ne(list, NULL);
+  ck_assert_uint_eq(list->len, 3);
+  ck_assert_ptr_eq(list->match, v->match);
+  ck_assert_ptr_eq(list->free, NULL);
+  ck_assert_ptr_eq(list_at(list, 1)->val, vector_at(v, 1));
+  ck_assert_ptr_ne(findInList(list, "c"), NULL);
+  list_destroy(list);
+  secFreeVector(v);
+}
+END_TEST
+
+START_TEST(test_NULL) {
+  ck_assert_ptr_eq(listToVector(NULL), NULL);
+  ck_assert_ptr_eq(vectorToList(NULL), NULL);
+}
+END_TEST
+
+TCase* test_case_listToVector() {
+  TCase* tc = tcase_create("listToVector");
+  tcase_add_test(tc, test_listToVector);
+  tcase_add_test(tc, test_vectorToList);
+  tcase_add_test(tc, test_NULL);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_VECTOR_LISTTOVECTOR_H
+#define TEST_UTILS_VECTOR_LISTTOVECTOR_H
+
+#include <check.h>
+
+TCase* test_case_listToVector();
+
+#endif  // TEST_UTILS_VECTOR_LISTTOVECTOR_H
@@ -0,0 +1,34 @@
+#include "tc_vector_findAll.h"
+
+#include "utils/stringUtils.h"
+#include "utils/vector.h"
+
+START_TEST(test_findAll) {
+  vector_t* v = createVector(LIST_CREATE_COPY_VALUES, "a", "b", "a", "c", NULL);
+  vector_t* found = vector_findAll(v, "a");
+  ck_assert_ptr_ne(found, NULL);
+  ck_assert_uint_eq(found->len, 2);
+  ck_assert_ptr_eq(vector_at(found, 0), vector_at(v, 0));
+  ck_assert_ptr_eq(vector_at(found, 1), vector_at(v, 2));
+  ck_assert_ptr_eq(found->free, NULL);
+  secFreeVector(found);
+  ck_assert_str_eq(vector_at(v, 0), "a");
+  secFreeVector(v);
+}
+END_TEST
+
+START_TEST(test_noMatch) {
+  vector_t* v = createVector(LIST_CREATE_DONT_COPY_VALUES, "a", "b", NULL);
+  ck_assert_ptr_eq(vector_findAll(v, "c"), NULL);
+  ck_assert_ptr_eq(vector_findAll(v, NULL), NULL);
+  ck_assert_ptr_eq(vector_findAll(NULL, "a"), NULL);
+  secFreeVector(v);
+}
+END_TEST
+
+TCase* test_case_vector_findAll() {
+  TCase* tc = tcase_create("vector_findAll");
+  tcase_add_test(tc, test_findAll);
+  tcase_add_test(tc, test_noMatch);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_VECTOR_VECTORFINDALL_H
+#define TEST_UTILS_VECTOR_VECTORFINDALL_H
+
+#include <check.h>
+
+TCase* test_case_vector_findAll();
+
+#endif  // TEST_UTILS_VECTOR_VECTORFINDALL_H
@@ -0,0 +1,48 @@
+#include "tc_vector_push.h"
+
+#include "utils/oidc_error.h"
+#include "utils/vector.h"
+
+#include <stdint.h>
+
+START_TEST(test_growth) {
+  vector_t* v = vector_new();
+  ck_assert_uint_eq(v->cap, VECTOR_MIN_CAPACITY);
+  const size_t n = 10 * VECTOR_MIN_CAPACITY + 1;
+  for (size_t i = 0; i < n; i++) {
+    ck_assert_int_eq(vector_push(v, (void*)(uintptr_t)(i + 1)), OIDC_SUCCESS);
+  }
+  ck_assert_uint_eq(v->len, n);
+  ck_assert_uint_ge(v->cap, n);
+  for (size_t i = 0; i < n; i++) {
+    ck_assert_ptr_eq(vector_at(v, i), (void*)(uintptr_t)(i + 1));
+  }
+  ck_assert_ptr_eq(vector_last(v), (void*)(uintptr_t)n);
+  ck_assert_ptr_eq(vector_at(v, n), NULL);
+  secFreeVector(v);
+}
+END_TEST
+
+START_TEST(test_reserve) {
+  vector_t* v = vector_newWithCapacity(1);
+  ck_assert_uint_eq(v->cap, VECTOR_MIN_CAPACITY);
+  ck_assert_int_eq(vector_reserve(v, 100), OIDC_SUCCESS);
+  ck_assert_uint_eq(v->cap, 100);
+  ck_assert_int_eq(vector_reserve(v, 10), OIDC_SUCCESS);
+  ck_assert_uint_eq(v->cap, 100);
+  secFreeVector(v);
+}
+END_TEST
+
+START_TEST(test_NULL) {
+  ck_assert_int_eq(vector_push(NULL, NULL), OIDC_EARGNULLFUNC);
+}
+END_TEST
+
+TCase* test_case_vector_push() {
+  TCase* tc = tcase_create("vector_push");
+  tcase_add_test(tc, test_growth);
+  tcase_add_test(tc, test_reserve);
+  tcase_add_test(tc, test_NULL);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_VECTOR_VECTORPUSH_H
+#define TEST_UTILS_VECTOR_VECTORPUSH_H
+
+#include <check.h>
+
+TCase* test_case_vector_push();
+
+#endif  // TEST_UTILS_VECTOR_VECTORPUSH_H
@@ -0,0 +1,59 @@
+#include "tc_vector_removeAt.h"
+
+#include "utils/vector.h"
+
+static int freed[4];
+
+static void _free(int* value) { freed[value - freed]++; }
+
+static vector_t* _newVector() {
+  for (int i = 0; i < 4; i++) { freed[i] = 0; }
+  vector_t* v = vector_new();
+  v->free     = (freeFunction)_free;
+  for (int i = 0; i < 4; i++) { vector_push(v, &freed[i]); }
+  return v;
+}
+
+START_TEST(test_middle) {
+  vector_t* v = _newVector();
+  vector_removeAt(v, 1);
+  ck_assert_uint_eq(v->len, 3);
+  ck_assert_ptr_eq(vector_at(v, 0), &freed[0]);
+  ck_assert_ptr_eq(vector_at(v, 1), &freed[2]);
+  ck_assert_ptr_eq(vector_at(v, 2), &freed[3]);
+  ck_assert_int_eq(freed[1], 1);
+  ck_assert_int_eq(freed[0] + freed[2] + freed[3], 0);
+  v->free = NULL;
+  secFreeVector(v);
+}
+END_TEST
+
+START_TEST(test_last) {
+  vector_t* v = _newVector();
+  vector_removeAt(v, 3);
+  ck_assert_uint_eq(v->len, 3);
+  ck_assert_ptr_eq(vector_last(v), &freed[2]);
+  ck_assert_int_eq(freed[3], 1);
+  v->free = NULL;
+  secFreeVector(v);
+}
+END_TEST
+
+START_TEST(test_outOfRange) {
+  vector_t* v = _newVector();
+  vector_removeAt(v, 4);
+  vector_removeAt(v, VECTOR_NOT_FOUND);
+  ck_assert_uint_eq(v->len, 4);
+  ck_assert_int_eq(freed[0] + freed[1] + freed[2] + freed[3], 0);
+  secFreeVector(v);
+  ck_assert_int_eq(freed[0] + freed[1] + freed[2] + freed[3], 4);
+}
+END_TEST
+
+TCase* test_case_vector_removeAt() {
+  TCase* tc = tcase_create("vector_removeAt");
+  tcase_add_test(tc, test_middle);
+  tcase_add_test(tc, test_last);
+  tcase_add_test(tc, test_outOfRange);
+  return tc;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_UTILS_VECTOR_VECTORREMOVEAT_H
+#define TEST_UTILS_VECTOR_VECTORREMOVEAT_H
+
+#include <check.h>
+
+TCase* test_case_vector_removeAt();
+
+#endif  // TEST_UTILS_VECTOR_VECTORREMOVEAT_H